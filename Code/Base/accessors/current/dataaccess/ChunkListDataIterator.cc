@@ -0,0 +1,86 @@
+/// @file
+/// @brief iterator over chunks held in memory
+///
+/// @details This class iterates over a list of in-memory accessors filled
+/// beforehand (e.g. single-channel slices of a dataset read in one pass).
+/// The list is shared, so a number of iterators can be created for the same
+/// data and the data can be iterated over many times without any I/O.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <dataaccess/ChunkListDataIterator.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief setup with the given list of chunks
+/// @param[in] chunks shared pointer to the list of chunks to iterate over
+ChunkListDataIterator::ChunkListDataIterator(const boost::shared_ptr<const ChunkList> &chunks) :
+      itsChunks(chunks), itsCurrent(0)
+{
+  ASKAPCHECK(itsChunks, "ChunkListDataIterator requires a valid list of chunks");
+}
+
+/// Restart the iteration from the beginning
+void ChunkListDataIterator::init()
+{
+  itsCurrent = 0;
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+const IConstDataAccessor& ChunkListDataIterator::operator*() const
+{
+  if (!hasMore()) {
+      ASKAPTHROW(DataAccessLogicError, "An attempt to access data past the end of the chunk list");
+  }
+  const boost::shared_ptr<PrefetchedDataAccessor> &acc = (*itsChunks)[itsCurrent];
+  ASKAPDEBUGASSERT(acc);
+  return *acc;
+}
+
+/// Checks whether there are more data available.
+/// @return True if there are more data available
+casa::Bool ChunkListDataIterator::hasMore() const throw()
+{
+  return itsCurrent < itsChunks->size();
+}
+
+/// advance the iterator one step further 
+/// @return True if there are more data (so constructions like 
+///         while(it.next()) {} are possible)
+casa::Bool ChunkListDataIterator::next()
+{
+  if (hasMore()) {
+      ++itsCurrent;
+  }
+  return hasMore();
+}
+
+} // namespace accessors
+
+} // namespace askap
@@ -0,0 +1,94 @@
+/// @file
+/// @brief iterator over chunks held in memory
+///
+/// @details This class iterates over a list of in-memory accessors filled
+/// beforehand (e.g. single-channel slices of a dataset read in one pass).
+/// The list is shared, so a number of iterators can be created for the same
+/// data and the data can be iterated over many times without any I/O.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_ACCESSORS_CHUNK_LIST_DATA_ITERATOR_H
+#define ASKAP_ACCESSORS_CHUNK_LIST_DATA_ITERATOR_H
+
+// own includes
+#include <dataaccess/IConstDataIterator.h>
+#include <dataaccess/PrefetchedDataAccessor.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator over chunks held in memory
+/// @details This class iterates over a list of in-memory accessors filled
+/// beforehand (see PrefetchedDataAccessor::assignChannel). The list is held by
+/// a shared pointer, so the data stay valid as long as any iterator refers to them.
+/// The accessors returned by this iterator are read-only; use DataIteratorAdapter
+/// if a non-const iterator type is required.
+/// @ingroup dataaccess_hlp
+class ChunkListDataIterator : virtual public IConstDataIterator
+{
+public:
+  /// @brief type of the list of chunks
+  typedef std::vector<boost::shared_ptr<PrefetchedDataAccessor> > ChunkList;
+
+  /// @brief setup with the given list of chunks
+  /// @param[in] chunks shared pointer to the list of chunks to iterate over
+  explicit ChunkListDataIterator(const boost::shared_ptr<const ChunkList> &chunks);
+
+  /// Restart the iteration from the beginning
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual const IConstDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further 
+  /// @return True if there are more data (so constructions like 
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+private:
+  /// @brief list of chunks
+  boost::shared_ptr<const ChunkList> itsChunks;
+
+  /// @brief index of the current chunk
+  size_t itsCurrent;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_CHUNK_LIST_DATA_ITERATOR_H
@@ -0,0 +1,233 @@
+/// @file
+/// @brief in-memory copy of a data accessor filled by the prefetching iterator
+///
+/// @details This accessor holds a deep copy of all fields of another accessor,
+/// so it can be used while the original iterator (and the table behind it) is
+/// being advanced by another thread. Rotated uvw and associated delays are
+/// computed on demand from the copied uvw and pointing directions.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <dataaccess/PrefetchedDataAccessor.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+#include <casacore/casa/Arrays/Slicer.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief helper method to copy an array field
+/// @details The output array is only resized if the shape has changed. Storage
+/// shared with another accessor (see referenceMetadata) is never overwritten.
+/// @param[in] in input array
+/// @param[out] out output array
+template<typename T>
+static void copyField(const T &in, T &out)
+{
+  if (out.nrefs() > 1) {
+      out.reference(T());
+  }
+  out.resize(in.shape());
+  out = in;
+}
+
+/// @brief helper method to refer to an array field of another accessor
+/// @param[in] in input array
+/// @param[out] out output array
+template<typename T>
+static void referenceField(const T &in, T &out)
+{
+  // the storage is shared, but the accessors are read-only
+  out.reference(in);
+}
+
+/// @brief constructor
+/// @param[in] cacheSize uvw-machine cache size
+/// @param[in] tolerance pointing direction tolerance in radians, exceeding
+/// which leads to initialisation of a new UVW machine and recompute of the rotated uvws/delays
+PrefetchedDataAccessor::PrefetchedDataAccessor(size_t cacheSize, double tolerance) : 
+              DataAccessorStub(false), itsRotatedUVW(cacheSize, tolerance) {}
+
+/// @brief copy all fields from the given accessor
+/// @details Buffers are reused if the shape doesn't change between calls.
+/// @param[in] acc accessor to copy
+void PrefetchedDataAccessor::assign(const IConstDataAccessor &acc)
+{
+  assignMetadata(acc);
+  copyField(acc.visibility(), itsVisibility);
+  copyField(acc.flag(), itsFlag);
+  copyField(acc.noise(), itsNoise);
+  copyField(acc.frequency(), itsFrequency);
+}
+
+/// @brief copy a single spectral channel of the given accessor
+/// @details All row-based fields are copied as they are, while the visibility,
+/// flag, noise and frequency fields only contain the given channel. This allows
+/// a number of single-channel accessors to be filled from one pass over the data.
+/// @param[in] acc accessor to copy
+/// @param[in] channel channel of the given accessor to copy (0-based)
+void PrefetchedDataAccessor::assignChannel(const IConstDataAccessor &acc, const casa::uInt channel)
+{
+  ASKAPCHECK(channel < acc.nChannel(), "Channel "<<channel<<" is outside the range of the accessor with "<<
+             acc.nChannel()<<" channels");
+  assignMetadata(acc);
+  assignChannelData(acc, channel);
+}
+
+/// @brief copy a single spectral channel sharing row-based fields with another accessor
+/// @details This version doesn't copy the row-based fields (uvw, pointing directions,
+/// antenna and feed indices, time, etc), but refers to the storage of the given accessor
+/// which must have been filled from the same chunk. A number of single-channel accessors
+/// filled from one chunk then hold one copy of the metadata, so the memory is dominated by
+/// the visibilities. Rotated uvw and delays are still cached per accessor.
+/// @param[in] acc accessor to copy
+/// @param[in] channel channel of the given accessor to copy (0-based)
+/// @param[in] metadata accessor filled from acc to share row-based fields with
+void PrefetchedDataAccessor::assignChannel(const IConstDataAccessor &acc, const casa::uInt channel,
+                                           const PrefetchedDataAccessor &metadata)
+{
+  ASKAPCHECK(channel < acc.nChannel(), "Channel "<<channel<<" is outside the range of the accessor with "<<
+             acc.nChannel()<<" channels");
+  ASKAPCHECK(metadata.nRow() == acc.nRow(), "Accessor to share metadata with has "<<metadata.nRow()<<
+             " rows, the accessor to copy has "<<acc.nRow());
+  referenceMetadata(metadata);
+  assignChannelData(acc, channel);
+}
+
+/// @brief copy spectral channel dependent fields for a single channel
+/// @param[in] acc accessor to copy
+/// @param[in] channel channel of the given accessor to copy (0-based)
+void PrefetchedDataAccessor::assignChannelData(const IConstDataAccessor &acc, const casa::uInt channel)
+{
+  const casa::IPosition start(3, 0, channel, 0);
+  const casa::IPosition length(3, acc.nRow(), 1, acc.nPol());
+  const casa::Slicer slicer(start, length);
+  itsVisibility.resize(length);
+  itsVisibility = acc.visibility()(slicer);
+  itsFlag.resize(length);
+  itsFlag = acc.flag()(slicer);
+  itsNoise.resize(length);
+  itsNoise = acc.noise()(slicer);
+  itsFrequency.resize(1);
+  itsFrequency[0] = acc.frequency()[channel];
+}
+
+/// @brief copy all fields which don't depend on the spectral channel
+/// @param[in] acc accessor to copy
+void PrefetchedDataAccessor::assignMetadata(const IConstDataAccessor &acc)
+{
+  copyField(acc.antenna1(), itsAntenna1);
+  copyField(acc.antenna2(), itsAntenna2);
+  copyField(acc.feed1(), itsFeed1);
+  copyField(acc.feed2(), itsFeed2);
+  copyField(acc.feed1PA(), itsFeed1PA);
+  copyField(acc.feed2PA(), itsFeed2PA);
+  copyField(acc.pointingDir1(), itsPointingDir1);
+  copyField(acc.pointingDir2(), itsPointingDir2);
+  copyField(acc.dishPointing1(), itsDishPointing1);
+  copyField(acc.dishPointing2(), itsDishPointing2);
+  copyField(acc.uvw(), itsUVW);
+  itsTime = acc.time();
+  copyField(acc.stokes(), itsStokes);
+  // rotated uvw and delays have to be recomputed for the new data
+  itsRotatedUVW.invalidate();
+}
+
+/// @brief refer to the row-based fields of another accessor
+/// @param[in] other accessor to share the fields with
+void PrefetchedDataAccessor::referenceMetadata(const PrefetchedDataAccessor &other)
+{
+  referenceField(other.itsAntenna1, itsAntenna1);
+  referenceField(other.itsAntenna2, itsAntenna2);
+  referenceField(other.itsFeed1, itsFeed1);
+  referenceField(other.itsFeed2, itsFeed2);
+  referenceField(other.itsFeed1PA, itsFeed1PA);
+  referenceField(other.itsFeed2PA, itsFeed2PA);
+  referenceField(other.itsPointingDir1, itsPointingDir1);
+  referenceField(other.itsPointingDir2, itsPointingDir2);
+  referenceField(other.itsDishPointing1, itsDishPointing1);
+  referenceField(other.itsDishPointing2, itsDishPointing2);
+  referenceField(other.itsUVW, itsUVW);
+  itsTime = other.itsTime;
+  referenceField(other.itsStokes, itsStokes);
+  // rotated uvw and delays have to be recomputed for the new data
+  itsRotatedUVW.invalidate();
+}
+
+/// @brief uvw after rotation
+/// @details This method calls UVWMachine to rotate baseline coordinates 
+/// for a new tangent point. Delays corresponding to this correction are
+/// returned by a separate method.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @return uvw after rotation to the new coordinate system for each row
+const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+                 PrefetchedDataAccessor::rotatedUVW(const casa::MDirection &tangentPoint) const
+{
+  return itsRotatedUVW.uvw(*this, tangentPoint);
+}                 
+   
+/// @brief delay associated with uvw rotation
+/// @details This is a companion method to rotatedUVW. It returns delays corresponding
+/// to the baseline coordinate rotation. An additional delay corresponding to the 
+/// translation in the tangent plane can also be applied using the image 
+/// centre parameter. Set it to tangent point to apply no extra translation.
+/// @param[in] tangentPoint tangent point to rotate the coordinates to
+/// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+/// @return delays corresponding to the uvw rotation for each row
+const casa::Vector<casa::Double>& PrefetchedDataAccessor::uvwRotationDelay(
+                 const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const
+{
+  return itsRotatedUVW.delays(*this,tangentPoint,imageCentre);
+}
+   
+/// Velocity for each channel
+/// @return a reference to vector containing velocities for each
+///         spectral channel (vector size is nChannel). Velocities
+///         are given as Doubles, the frame/units are specified by
+///         the DataSource object (via IDataConverter).
+const casa::Vector<casa::Double>& PrefetchedDataAccessor::velocity() const
+{
+  ASKAPTHROW(DataAccessLogicError, "PrefetchedDataAccessor::velocity() has not been implemented, "
+             "switch off prefetching if velocities are required");
+}
+
+/// @brief read-write visibilities (not supported)
+/// @details Always throws an exception as this accessor is read-only
+casa::Cube<casa::Complex>& PrefetchedDataAccessor::rwVisibility()
+{
+  ASKAPTHROW(DataAccessLogicError, "Prefetched data are read-only, rwVisibility() is not supported");
+}
+
+/// @brief non-const access to flags (not supported)
+/// @details Always throws an exception as this accessor is read-only
+casa::Cube<casa::Bool>& PrefetchedDataAccessor::rwFlag()
+{
+  ASKAPTHROW(DataAccessLogicError, "Prefetched data are read-only, rwFlag() is not supported");
+}
+
+} // namespace accessors
+
+} // namespace askap
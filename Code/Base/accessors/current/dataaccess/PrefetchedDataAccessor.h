@@ -0,0 +1,144 @@
+/// @file
+/// @brief in-memory copy of a data accessor filled by the prefetching iterator
+///
+/// @details This accessor holds a deep copy of all fields of another accessor,
+/// so it can be used while the original iterator (and the table behind it) is
+/// being advanced by another thread. Rotated uvw and associated delays are
+/// computed on demand from the copied uvw and pointing directions.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_ACCESSORS_PREFETCHED_DATA_ACCESSOR_H
+#define ASKAP_ACCESSORS_PREFETCHED_DATA_ACCESSOR_H
+
+#include <dataaccess/DataAccessorStub.h>
+#include <dataaccess/UVWRotationHandler.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief in-memory copy of a data accessor filled by the prefetching iterator
+/// @details This accessor holds a deep copy of all fields of another accessor,
+/// so it can be used while the original iterator (and the table behind it) is
+/// being advanced by another thread. Rotated uvw and associated delays are
+/// computed on demand from the copied uvw and pointing directions, like it is
+/// done on the client side of the parallel write iterator. Velocities are not
+/// copied as they require the rest frequency to be set up in the converter.
+/// The accessor is read-only: an attempt to get write access to visibilities
+/// or flags throws an exception because changes couldn't reach the dataset.
+/// @ingroup dataaccess_hlp
+class PrefetchedDataAccessor : public DataAccessorStub {
+public:
+   /// @brief constructor
+   /// @param[in] cacheSize uvw-machine cache size
+   /// @param[in] tolerance pointing direction tolerance in radians, exceeding
+   /// which leads to initialisation of a new UVW machine and recompute of the rotated uvws/delays
+   explicit PrefetchedDataAccessor(size_t cacheSize = 1, double tolerance = 1e-6);
+
+   /// @brief copy all fields from the given accessor
+   /// @details Buffers are reused if the shape doesn't change between calls.
+   /// @param[in] acc accessor to copy
+   void assign(const IConstDataAccessor &acc);
+
+   /// @brief copy a single spectral channel of the given accessor
+   /// @details All row-based fields are copied as they are, while the visibility,
+   /// flag, noise and frequency fields only contain the given channel. This allows
+   /// a number of single-channel accessors to be filled from one pass over the data.
+   /// @param[in] acc accessor to copy
+   /// @param[in] channel channel of the given accessor to copy (0-based)
+   void assignChannel(const IConstDataAccessor &acc, const casa::uInt channel);
+
+   /// @brief copy a single spectral channel sharing row-based fields with another accessor
+   /// @details This version doesn't copy the row-based fields (uvw, pointing directions,
+   /// antenna and feed indices, time, etc), but refers to the storage of the given accessor
+   /// which must have been filled from the same chunk. A number of single-channel accessors
+   /// filled from one chunk then hold one copy of the metadata, so the memory is dominated by
+   /// the visibilities. Rotated uvw and delays are still cached per accessor.
+   /// @param[in] acc accessor to copy
+   /// @param[in] channel channel of the given accessor to copy (0-based)
+   /// @param[in] metadata accessor filled from acc to share row-based fields with
+   void assignChannel(const IConstDataAccessor &acc, const casa::uInt channel,
+                      const PrefetchedDataAccessor &metadata);
+
+   // override some stub methods
+
+   /// @brief uvw after rotation
+   /// @details This method calls UVWMachine to rotate baseline coordinates 
+   /// for a new tangent point. Delays corresponding to this correction are
+   /// returned by a separate method.
+   /// @param[in] tangentPoint tangent point to rotate the coordinates to
+   /// @return uvw after rotation to the new coordinate system for each row
+   virtual const casa::Vector<casa::RigidVector<casa::Double, 3> >&
+                 rotatedUVW(const casa::MDirection &tangentPoint) const;
+   
+   /// @brief delay associated with uvw rotation
+   /// @details This is a companion method to rotatedUVW. It returns delays corresponding
+   /// to the baseline coordinate rotation. An additional delay corresponding to the 
+   /// translation in the tangent plane can also be applied using the image 
+   /// centre parameter. Set it to tangent point to apply no extra translation.
+   /// @param[in] tangentPoint tangent point to rotate the coordinates to
+   /// @param[in] imageCentre image centre (additional translation is done if imageCentre!=tangentPoint)
+   /// @return delays corresponding to the uvw rotation for each row
+   virtual const casa::Vector<casa::Double>& uvwRotationDelay(
+                 const casa::MDirection &tangentPoint, const casa::MDirection &imageCentre) const;
+   
+   /// Velocity for each channel
+   /// @return a reference to vector containing velocities for each
+   ///         spectral channel (vector size is nChannel). Velocities
+   ///         are given as Doubles, the frame/units are specified by
+   ///         the DataSource object (via IDataConverter).
+   virtual const casa::Vector<casa::Double>& velocity() const;
+
+   /// @brief read-write visibilities (not supported)
+   /// @details Always throws an exception as this accessor is read-only
+   virtual casa::Cube<casa::Complex>& rwVisibility();
+
+   /// @brief non-const access to flags (not supported)
+   /// @details Always throws an exception as this accessor is read-only
+   virtual casa::Cube<casa::Bool>& rwFlag();
+   
+private:
+   /// @brief copy all fields which don't depend on the spectral channel
+   /// @param[in] acc accessor to copy
+   void assignMetadata(const IConstDataAccessor &acc);
+
+   /// @brief refer to the row-based fields of another accessor
+   /// @param[in] other accessor to share the fields with
+   void referenceMetadata(const PrefetchedDataAccessor &other);
+
+   /// @brief copy spectral channel dependent fields for a single channel
+   /// @param[in] acc accessor to copy
+   /// @param[in] channel channel of the given accessor to copy (0-based)
+   void assignChannelData(const IConstDataAccessor &acc, const casa::uInt channel);
+
+   /// @brief handler of uvw rotations
+   UVWRotationHandler itsRotatedUVW;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_PREFETCHED_DATA_ACCESSOR_H
@@ -0,0 +1,229 @@
+/// @file
+/// @brief iterator reading the following chunks in a background thread
+///
+/// @details This class wraps another read-only iterator. A background thread
+/// advances the wrapped iterator and copies a given number of chunks ahead of
+/// the one being processed into a bounded pool of in-memory accessors. This
+/// allows the disk I/O to overlap with the processing of the current chunk.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <dataaccess/PrefetchingDataIterator.h>
+#include <dataaccess/DataAccessError.h>
+#include <askap/AskapError.h>
+
+#include <boost/bind.hpp>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief setup with the given iterator
+/// @details Prefetching starts straight away from the start of the iteration.
+/// @param[in] iter shared pointer to iterator to be wrapped
+/// @param[in] nChunks maximum number of chunks read ahead of the current one
+/// @param[in] cacheSize uvw-machine cache size of prefetched accessors
+/// @param[in] tolerance pointing direction tolerance in radians for the uvw-machine cache
+PrefetchingDataIterator::PrefetchingDataIterator(const boost::shared_ptr<IConstDataIterator> &iter,
+                     const casa::uInt nChunks, const size_t cacheSize, const double tolerance) :
+      itsIterator(iter), itsEndReached(false), itsStopRequested(false), itsAtStart(true)
+{
+  ASKAPCHECK(itsIterator, "PrefetchingDataIterator requires a valid iterator to wrap");
+  ASKAPCHECK(nChunks > 0, "Number of chunks to prefetch should be positive");
+  // one extra accessor is held by the client as the current chunk
+  itsPool.resize(nChunks + 1);
+  for (size_t index = 0; index < itsPool.size(); ++index) {
+       itsPool[index].reset(new PrefetchedDataAccessor(cacheSize, tolerance));
+  }
+  start();
+}
+
+/// @brief destructor, stops the background thread
+PrefetchingDataIterator::~PrefetchingDataIterator()
+{
+  stop();
+}
+
+/// @brief start the background thread from the start of the iteration
+void PrefetchingDataIterator::start()
+{
+  ASKAPDEBUGASSERT(!itsThread);
+  itsFilled.clear();
+  itsFree.clear();
+  // fill the stack in the reverse order, so the accessors are used sequentially
+  for (size_t index = itsPool.size(); index > 0; --index) {
+       itsFree.push_back(index - 1);
+  }
+  itsEndReached = false;
+  itsStopRequested = false;
+  itsAtStart = true;
+  itsError.clear();
+  itsThread.reset(new boost::thread(boost::bind(&PrefetchingDataIterator::prefetch, this)));
+}
+
+/// @brief stop the background thread and discard all prefetched chunks
+void PrefetchingDataIterator::stop()
+{
+  if (itsThread) {
+      {
+        boost::lock_guard<boost::mutex> lock(itsMutex);
+        itsStopRequested = true;
+      }
+      itsCondVar.notify_all();
+      itsThread->join();
+      itsThread.reset();
+  }
+}
+
+/// @brief body of the background thread
+void PrefetchingDataIterator::prefetch()
+{
+  try {
+     itsIterator->init();
+     while (true) {
+        size_t index = 0;
+        {
+          boost::unique_lock<boost::mutex> lock(itsMutex);
+          while (itsFree.empty() && !itsStopRequested) {
+                 itsCondVar.wait(lock);
+          }
+          if (itsStopRequested) {
+              return;
+          }
+          index = itsFree.back();
+          itsFree.pop_back();
+        }
+        // the table is only accessed outside the lock
+        const bool endReached = !itsIterator->hasMore();
+        if (!endReached) {
+            itsPool[index]->assign(*(*itsIterator));
+            itsIterator->next();
+        }
+        {
+          boost::lock_guard<boost::mutex> lock(itsMutex);
+          if (endReached) {
+              itsFree.push_back(index);
+              itsEndReached = true;
+          } else {
+              itsFilled.push_back(index);
+          }
+        }
+        itsCondVar.notify_all();
+        if (endReached) {
+            return;
+        }
+     }
+  }
+  catch (const std::exception &ex) {
+     {
+       boost::lock_guard<boost::mutex> lock(itsMutex);
+       itsError = ex.what();
+       itsEndReached = true;
+     }
+     itsCondVar.notify_all();
+  }
+}
+
+/// @brief wait until the current chunk is read or the end of data is reached
+/// @details The lock should be held by the caller
+/// @param[in] lock lock on itsMutex
+void PrefetchingDataIterator::waitForChunk(boost::unique_lock<boost::mutex> &lock) const
+{
+  while (itsFilled.empty() && !itsEndReached) {
+         itsCondVar.wait(lock);
+  }
+}
+
+/// Restart the iteration from the beginning
+void PrefetchingDataIterator::init()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(itsMutex);
+    if (itsAtStart && itsError.empty()) {
+        // the background thread has started from the beginning and nothing
+        // has been consumed yet, keep the chunks which are already read
+        return;
+    }
+  }
+  stop();
+  start();
+}
+
+/// operator* delivers a reference to data accessor (current chunk)
+/// @return a reference to the current chunk
+const IConstDataAccessor& PrefetchingDataIterator::operator*() const
+{
+  boost::unique_lock<boost::mutex> lock(itsMutex);
+  waitForChunk(lock);
+  if (itsFilled.empty()) {
+      if (itsError.size()) {
+          ASKAPTHROW(DataAccessError, "Unable to prefetch the data: "<<itsError);
+      }
+      ASKAPTHROW(DataAccessLogicError, "An attempt to access data past the end of iteration");
+  }
+  // the background thread never touches an accessor in the filled queue,
+  // so the reference remains valid until the next call to next()
+  return *itsPool[itsFilled.front()];
+}
+
+/// Checks whether there are more data available.
+/// @details This method blocks until the current chunk has been read
+/// @return True if there are more data available
+casa::Bool PrefetchingDataIterator::hasMore() const throw()
+{
+  try {
+     boost::unique_lock<boost::mutex> lock(itsMutex);
+     waitForChunk(lock);
+     // an error is reported via operator*
+     return !itsFilled.empty() || !itsError.empty();
+  }
+  catch (...) {}
+  return false;
+}
+
+/// advance the iterator one step further 
+/// @return True if there are more data (so constructions like 
+///         while(it.next()) {} are possible)
+casa::Bool PrefetchingDataIterator::next()
+{
+  {
+    boost::unique_lock<boost::mutex> lock(itsMutex);
+    waitForChunk(lock);
+    if (itsFilled.empty()) {
+        if (itsError.size()) {
+            ASKAPTHROW(DataAccessError, "Unable to prefetch the data: "<<itsError);
+        }
+        return false;
+    }
+    itsFree.push_back(itsFilled.front());
+    itsFilled.pop_front();
+    itsAtStart = false;
+  }
+  itsCondVar.notify_all();
+  return hasMore();
+}
+
+} // namespace accessors
+
+} // namespace askap
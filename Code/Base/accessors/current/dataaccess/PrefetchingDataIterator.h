@@ -0,0 +1,155 @@
+/// @file
+/// @brief iterator reading the following chunks in a background thread
+///
+/// @details This class wraps another read-only iterator. A background thread
+/// advances the wrapped iterator and copies a given number of chunks ahead of
+/// the one being processed into a bounded pool of in-memory accessors. This
+/// allows the disk I/O to overlap with the processing of the current chunk.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_ACCESSORS_PREFETCHING_DATA_ITERATOR_H
+#define ASKAP_ACCESSORS_PREFETCHING_DATA_ITERATOR_H
+
+// own includes
+#include <dataaccess/IConstDataIterator.h>
+#include <dataaccess/PrefetchedDataAccessor.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// std includes
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief iterator reading the following chunks in a background thread
+/// @details This class wraps another read-only iterator. A background thread
+/// advances the wrapped iterator and copies a given number of chunks ahead of
+/// the one being processed into a bounded pool of in-memory accessors
+/// (see PrefetchedDataAccessor). This allows the disk I/O to overlap with the
+/// processing of the current chunk. The wrapped iterator is only accessed from
+/// the background thread (or while it is stopped), so the underlying table is
+/// never accessed concurrently. The accessors returned by this iterator are
+/// read-only; use DataIteratorAdapter if a non-const iterator type is required.
+/// Any exception raised while reading the data is rethrown in the thread using
+/// this iterator when the affected chunk is requested.
+/// @ingroup dataaccess_hlp
+class PrefetchingDataIterator : virtual public IConstDataIterator,
+                                public boost::noncopyable
+{
+public:
+  /// @brief setup with the given iterator
+  /// @details Prefetching starts straight away from the start of the iteration.
+  /// @param[in] iter shared pointer to iterator to be wrapped
+  /// @param[in] nChunks maximum number of chunks read ahead of the current one
+  /// @param[in] cacheSize uvw-machine cache size of prefetched accessors
+  /// @param[in] tolerance pointing direction tolerance in radians for the uvw-machine cache
+  explicit PrefetchingDataIterator(const boost::shared_ptr<IConstDataIterator> &iter,
+                                   const casa::uInt nChunks = 2, const size_t cacheSize = 1,
+                                   const double tolerance = 1e-6);
+
+  /// @brief destructor, stops the background thread
+  virtual ~PrefetchingDataIterator();
+
+  /// Restart the iteration from the beginning
+  virtual void init();
+
+  /// operator* delivers a reference to data accessor (current chunk)
+  /// @return a reference to the current chunk
+  virtual const IConstDataAccessor& operator*() const;
+
+  /// Checks whether there are more data available.
+  /// @details This method blocks until the current chunk has been read
+  /// @return True if there are more data available
+  virtual casa::Bool hasMore() const throw();
+
+  /// advance the iterator one step further 
+  /// @return True if there are more data (so constructions like 
+  ///         while(it.next()) {} are possible)
+  virtual casa::Bool next();
+
+private:
+  /// @brief start the background thread from the start of the iteration
+  void start();
+
+  /// @brief stop the background thread and discard all prefetched chunks
+  void stop();
+
+  /// @brief body of the background thread
+  void prefetch();
+
+  /// @brief wait until the current chunk is read or the end of data is reached
+  /// @details The lock should be held by the caller
+  /// @param[in] lock lock on itsMutex
+  void waitForChunk(boost::unique_lock<boost::mutex> &lock) const;
+
+  /// @brief wrapped iterator
+  boost::shared_ptr<IConstDataIterator> itsIterator;
+
+  /// @brief pool of accessors
+  std::vector<boost::shared_ptr<PrefetchedDataAccessor> > itsPool;
+
+  /// @brief indices of accessors filled with data, the first one is the current chunk
+  std::deque<size_t> itsFilled;
+
+  /// @brief indices of accessors available to the background thread
+  std::vector<size_t> itsFree;
+
+  /// @brief true if the background thread has reached the end of data
+  bool itsEndReached;
+
+  /// @brief true if the background thread has been asked to stop
+  bool itsStopRequested;
+
+  /// @brief true if no chunk has been consumed since the iteration has been started
+  bool itsAtStart;
+
+  /// @brief error message if reading has failed, empty otherwise
+  std::string itsError;
+
+  /// @brief synchronisation of the state between threads
+  mutable boost::mutex itsMutex;
+
+  /// @brief condition variable signalling changes in the state
+  mutable boost::condition_variable itsCondVar;
+
+  /// @brief background thread
+  boost::scoped_ptr<boost::thread> itsThread;
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_PREFETCHING_DATA_ITERATOR_H
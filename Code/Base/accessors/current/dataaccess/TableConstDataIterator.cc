@@ -44,6 +44,9 @@
 #include <casacore/casa/Arrays/Slicer.h>
 #include <casacore/casa/Arrays/IPosition.h>
 
+/// std includes
+#include <algorithm>
+
 /// Local package
 #include <dataaccess/TableConstDataIterator.h>
 #include <dataaccess/DataAccessError.h>
@@ -75,12 +78,11 @@ struct WholeRowFlagger
   /// @details in the default version input parameter is not used
   inline WholeRowFlagger(const casa::Table &) {}
   
-  /// @brief determine whether element by element copy is needed
+  /// @brief apply whole row flags to a block of rows
   /// @details This method analyses other columns of the table specific
-  /// for a particular type and fills the cube with appropriate data.
-  /// If it can't do this, it returns true, which forces an element by element 
-  /// processing. By default parameters are not used
-  inline bool copyRequired(casa::uInt, casa::Cube<T> &) { return true;}
+  /// for a particular type and overrides the data copied to the cube
+  /// where necessary. By default it does nothing and parameters are not used
+  inline void flagRows(casa::uInt, casa::uInt, casa::uInt, casa::Cube<T> &) {}
 };
 
 
@@ -96,14 +98,15 @@ struct WholeRowFlagger<casa::Bool>
   /// @param[in] iteration current iteration (table returned by the iterator)
   inline WholeRowFlagger(const casa::Table &iteration);
   
-  /// @brief determine whether element by element copy is needed
-  /// @details This method analyses other columns of the table specific
-  /// for a particular type and fills the cube with appropriate data.
-  /// If it can't do this, it returns true, which forces an element by element 
-  /// processing. By default parameters are not used
-  /// @param[in] row a row to work with 
+  /// @brief apply whole row flags to a block of rows
+  /// @details All rows with FLAG_ROW set are flagged in the cube, which
+  /// has already been filled from the FLAG column.
+  /// @param[in] tableRow first row in the table
+  /// @param[in] cubeRow corresponding row of the cube
+  /// @param[in] nRows number of rows to process
   /// @param[in] cube cube to work with
-  inline bool copyRequired(casa::uInt row, casa::Cube<casa::Bool> &cube);
+  inline void flagRows(casa::uInt tableRow, casa::uInt cubeRow, casa::uInt nRows,
+                       casa::Cube<casa::Bool> &cube);
 private:
   /// @brief accessor to the FLAG_ROW column
   ROScalarColumn<casa::Bool> itsFlagRowCol;
@@ -119,17 +122,64 @@ WholeRowFlagger<casa::Bool>::WholeRowFlagger(const casa::Table &iteration) :
   }
 }
 
-bool WholeRowFlagger<casa::Bool>::copyRequired(casa::uInt row, 
-                 casa::Cube<casa::Bool> &cube)
+void WholeRowFlagger<casa::Bool>::flagRows(casa::uInt tableRow, casa::uInt cubeRow, 
+                 casa::uInt nRows, casa::Cube<casa::Bool> &cube)
 {
-  ASKAPDEBUGASSERT(!itsFlagRowCol.isNull());
   if (itsHasFlagRow) {
-      if (itsFlagRowCol.asBool(row)) {
-          cube.yzPlane(row) = true;
-          return false;
-      } 
+      const casa::Vector<casa::Bool> flagRow = itsFlagRowCol.getColumnRange(
+                Slicer(IPosition(1, tableRow), IPosition(1, nRows), Slicer::endIsLength));
+      for (casa::uInt row = 0; row < nRows; ++row) {
+           if (flagRow[row]) {
+               cube.yzPlane(cubeRow + row) = true;
+           }
+      }
+  }
+}
+
+/// @brief copy a block of rows read from the table into the cube
+/// @details The table stores every row as nPol x nChannel (polarisation
+/// varying fastest), while the cube is nRow x nChannel x nPol (row varying
+/// fastest), i.e. the order of axes is reversed. The copy is done in small
+/// tiles of rows and channels, so both the reads and the writes are served
+/// from cache even for a large number of channels.
+/// @param[in] buf nPol x nChannel x nRow array as returned by getColumnRange
+/// @param[in] cube nRow x nChannel x nPol cube to fill
+/// @param[in] startRow row of the cube corresponding to the first row in buf
+/// @ingroup dataaccess_tab
+template<typename T>
+void copyRowsToCube(const casa::Array<T> &buf, casa::Cube<T> &cube, const casa::uInt startRow)
+{
+  const casa::uInt tileRows = 16;
+  const casa::uInt tileChannels = 64;
+
+  ASKAPDEBUGASSERT(buf.contiguousStorage() && cube.contiguousStorage());
+  ASKAPDEBUGASSERT(buf.ndim() == 3);
+  const casa::uInt nPol = buf.shape()[0];
+  const casa::uInt nChan = buf.shape()[1];
+  const casa::uInt nRow = buf.shape()[2];
+  ASKAPDEBUGASSERT((nPol == cube.nplane()) && (nChan == cube.ncolumn()));
+  ASKAPDEBUGASSERT(startRow + nRow <= cube.nrow());
+
+  const size_t inRowStep = size_t(nPol) * nChan;
+  const size_t outPlaneStep = size_t(cube.nrow()) * nChan;
+  const T* in = buf.data();
+  T* out = cube.data() + startRow;
+
+  for (casa::uInt row0 = 0; row0 < nRow; row0 += tileRows) {
+       const casa::uInt row1 = std::min(nRow, row0 + tileRows);
+       for (casa::uInt chan0 = 0; chan0 < nChan; chan0 += tileChannels) {
+            const casa::uInt chan1 = std::min(nChan, chan0 + tileChannels);
+            for (casa::uInt pol = 0; pol < nPol; ++pol) {
+                 for (casa::uInt chan = chan0; chan < chan1; ++chan) {
+                      T* outPtr = out + pol * outPlaneStep + size_t(chan) * cube.nrow();
+                      const T* inPtr = in + pol + size_t(chan) * nPol;
+                      for (casa::uInt row = row0; row < row1; ++row) {
+                           outPtr[row] = inPtr[row * inRowStep];
+                      }
+                 }
+            }
+       }
   }
-  return true;
 }
 
 
@@ -431,11 +481,12 @@ void TableConstDataIterator::fillCube(casa::Cube<T> &cube,
   // FLAG_ROW for flagging
   WholeRowFlagger<T> wrFlagger(itsCurrentIteration);
   
-  // temporary buffer and position in this buffer, declared outside the loop
-  IPosition curPos(2, itsNumberOfPols, nChan);
-  Array<T> buf(curPos);
+  // check the shape of all rows first. For a fixed shape column it is
+  // enough to check the column shape
+  const casa::IPosition columnShape = tableCol.shapeColumn();
   for (uInt row=0;row<itsNumberOfRows;++row) {
-       const casa::IPosition shape = tableCol.shape(row);
+       const casa::IPosition shape = columnShape.size() ? columnShape :
+                                     tableCol.shape(row + itsCurrentTopRow);
        ASKAPASSERT(shape.size() && (shape.size()<3));
        const casa::uInt thisRowNumberOfPols=shape[0];
        const casa::uInt thisRowNumberOfChannels = shape.size() > 1 ? shape[1] : 1;
@@ -449,23 +500,32 @@ void TableConstDataIterator::fillCube(casa::Cube<T> &cube,
 	               "conformant for row "<<row<<" of the "<<columnName<<
 	               "column");           	       
        }
-       // for now just copy. In the future we will pass this array through
-       // the transformation which will do averaging, selection,
-       // polarization conversion
-
-       if (wrFlagger.copyRequired(row + itsCurrentTopRow, cube)) {
-           // Extract slice for this row
-           tableCol.getSlice(row + itsCurrentTopRow, chanSlicer, buf, False);
-
-           // Copy the slice into the cube 
-           for (uInt chan = 0; chan < nChan; ++chan) {
-               curPos[1] = chan;
-               for (uInt pol = 0; pol < itsNumberOfPols; ++pol) {
-                   curPos[0] = pol;
-                   cube(row,chan,pol) = buf(curPos);
-               }
-           }
+       if (columnShape.size()) {
+           break;
+       }
+  }
+
+  // for now just copy. In the future we will pass this array through
+  // the transformation which will do averaging, selection,
+  // polarization conversion
+  
+  // Rows are read in blocks with a single call rather than one by one. The 
+  // block size is limited to keep the temporary buffer small
+  const casa::uInt maxBufferElements = 1u << 20;
+  const casa::uInt rowsPerBlock = std::max(1u, maxBufferElements / 
+                                  std::max(1u, itsNumberOfPols * nChan));
+  Array<T> buf;
+  for (uInt row=0;row<itsNumberOfRows;row+=rowsPerBlock) {
+       const casa::uInt nRows = std::min(rowsPerBlock, itsNumberOfRows - row);
+       const IPosition bufShape(3, itsNumberOfPols, nChan, nRows);
+       if (!buf.shape().isEqual(bufShape)) {
+           buf.resize(bufShape);
        }
+       const Slicer rowSlicer(IPosition(1, row + itsCurrentTopRow), IPosition(1, nRows),
+                              Slicer::endIsLength);
+       tableCol.getColumnRange(rowSlicer, chanSlicer, buf, False);
+       copyRowsToCube(buf, cube, row);
+       wrFlagger.flagRows(row + itsCurrentTopRow, row, nRows, cube);
   }
 }               
 
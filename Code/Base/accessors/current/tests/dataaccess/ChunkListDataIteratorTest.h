@@ -0,0 +1,112 @@
+/// @file 
+/// @brief Tests of the iterator over single-channel chunks held in memory
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef CHUNK_LIST_DATA_ITERATOR_TEST_H
+#define CHUNK_LIST_DATA_ITERATOR_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// casa includes
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/Slicer.h>
+// own includes
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/ChunkListDataIterator.h>
+#include <askap/AskapError.h>
+#include "TableTestRunner.h"
+
+
+namespace askap {
+
+namespace accessors {
+
+class ChunkListDataIteratorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(ChunkListDataIteratorTest);
+  CPPUNIT_TEST(testChannelSlices);
+  CPPUNIT_TEST_SUITE_END();
+public:
+  void testChannelSlices() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     IDataConverterPtr conv=ds.createConverter();
+     conv->setEpochFrame(); // ensures seconds since 0 MJD
+     IConstDataSharedIter directIt = ds.createConstIterator(conv);
+     CPPUNIT_ASSERT(directIt != directIt.end());
+     const casa::uInt channel = directIt->nChannel() - 1;
+
+     // one pass over the data
+     boost::shared_ptr<ChunkListDataIterator::ChunkList> chunks(new ChunkListDataIterator::ChunkList);
+     boost::shared_ptr<ChunkListDataIterator::ChunkList> firstChannel(new ChunkListDataIterator::ChunkList);
+     for (; directIt != directIt.end(); ++directIt) {
+          boost::shared_ptr<PrefetchedDataAccessor> first(new PrefetchedDataAccessor);
+          first->assignChannel(*directIt, 0);
+          firstChannel->push_back(first);
+          // the last channel shares row-based fields with the first one
+          boost::shared_ptr<PrefetchedDataAccessor> acc(new PrefetchedDataAccessor);
+          acc->assignChannel(*directIt, channel, *first);
+          CPPUNIT_ASSERT(acc->uvw().data() == first->uvw().data());
+          CPPUNIT_ASSERT(acc->antenna1().data() == first->antenna1().data());
+          chunks->push_back(acc);
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), chunks->size());
+     // assigning new data to one of the accessors must not change the other one
+     const casa::Vector<casa::uInt> antenna1 = chunks->back()->antenna1().copy();
+     firstChannel->back()->assignChannel(*chunks->front(), 0);
+     CPPUNIT_ASSERT(firstChannel->back()->antenna1().data() != chunks->back()->antenna1().data());
+     CPPUNIT_ASSERT(casa::allEQ(antenna1, chunks->back()->antenna1()));
+
+     IConstDataSharedIter it(boost::shared_ptr<ChunkListDataIterator>(new ChunkListDataIterator(chunks)));
+     // iterate twice to check that the data can be reused
+     for (int pass = 0; pass < 2; ++pass) {
+          size_t counter = 0;
+          for (directIt.init(), it.init(); directIt != directIt.end(); ++directIt, ++it, ++counter) {
+               CPPUNIT_ASSERT(it != it.end());
+               CPPUNIT_ASSERT_EQUAL(directIt->nRow(), it->nRow());
+               CPPUNIT_ASSERT_EQUAL(casa::uInt(1), it->nChannel());
+               CPPUNIT_ASSERT_EQUAL(directIt->nPol(), it->nPol());
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(directIt->time(), it->time(), 1e-6);
+               CPPUNIT_ASSERT(casa::allEQ(directIt->antenna1(), it->antenna1()));
+               CPPUNIT_ASSERT(casa::allEQ(directIt->antenna2(), it->antenna2()));
+               const casa::Slicer slicer(casa::IPosition(3, 0, channel, 0),
+                        casa::IPosition(3, directIt->nRow(), 1, directIt->nPol()));
+               CPPUNIT_ASSERT(casa::allEQ(directIt->visibility()(slicer), it->visibility()));
+               CPPUNIT_ASSERT(casa::allEQ(directIt->flag()(slicer), it->flag()));
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(directIt->frequency()[channel], it->frequency()[0], 1e-6);
+          }
+          CPPUNIT_ASSERT_EQUAL(size_t(420), counter);
+          CPPUNIT_ASSERT(it == it.end());
+     }
+  }
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef CHUNK_LIST_DATA_ITERATOR_TEST_H
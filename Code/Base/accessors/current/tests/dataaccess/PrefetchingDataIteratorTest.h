@@ -0,0 +1,154 @@
+/// @file 
+/// @brief Tests of the iterator reading data ahead in a separate thread
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef PREFETCHING_DATA_ITERATOR_TEST_H
+#define PREFETCHING_DATA_ITERATOR_TEST_H
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+
+// std includes
+#include <vector>
+
+// cppunit includes
+#include <cppunit/extensions/HelperMacros.h>
+// casa includes
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/Cube.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+// own includes
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IConstDataSource.h>
+#include <dataaccess/PrefetchingDataIterator.h>
+#include <askap/AskapError.h>
+#include "TableTestRunner.h"
+
+
+namespace askap {
+
+namespace accessors {
+
+class PrefetchingDataIteratorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PrefetchingDataIteratorTest);
+  CPPUNIT_TEST(testSameData);
+  CPPUNIT_TEST(testRestart);
+  CPPUNIT_TEST_EXCEPTION(testReadOnlyAccessor,AskapError);
+  CPPUNIT_TEST_SUITE_END();
+protected:
+  /// @brief copy of the accessor fields compared by the test
+  struct ChunkCopy {
+     explicit ChunkCopy(const IConstDataAccessor &acc) : itsNRow(acc.nRow()),
+          itsNChannel(acc.nChannel()), itsNPol(acc.nPol()), itsTime(acc.time()),
+          itsAntenna1(acc.antenna1().copy()), itsAntenna2(acc.antenna2().copy()),
+          itsVisibility(acc.visibility().copy()), itsFlag(acc.flag().copy()),
+          itsFrequency(acc.frequency().copy()), itsUVW(acc.uvw().copy()) {}
+
+     casa::uInt itsNRow;
+     casa::uInt itsNChannel;
+     casa::uInt itsNPol;
+     double itsTime;
+     casa::Vector<casa::uInt> itsAntenna1;
+     casa::Vector<casa::uInt> itsAntenna2;
+     casa::Cube<casa::Complex> itsVisibility;
+     casa::Cube<casa::Bool> itsFlag;
+     casa::Vector<double> itsFrequency;
+     casa::Vector<casa::RigidVector<casa::Double, 3> > itsUVW;
+  };
+
+  static size_t countSteps(const IConstDataSharedIter &it) {
+     size_t counter;
+     for (counter = 0; it!=it.end(); ++it,++counter) {}
+     return counter;
+  }
+public:
+  void testSameData() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     IDataConverterPtr conv=ds.createConverter();
+     conv->setEpochFrame(); // ensures seconds since 0 MJD
+     // casacore tables can't be read from two threads at once, so the reference
+     // data are collected before the prefetching iterator starts its thread
+     std::vector<ChunkCopy> reference;
+     for (IConstDataSharedIter directIt = ds.createConstIterator(conv); directIt != directIt.end(); ++directIt) {
+          reference.push_back(ChunkCopy(*directIt));
+     }
+     CPPUNIT_ASSERT_EQUAL(size_t(420), reference.size());
+     for (casa::uInt nChunks = 1; nChunks < 4; nChunks += 2) {
+          IConstDataSharedIter it(boost::shared_ptr<PrefetchingDataIterator>(
+                 new PrefetchingDataIterator(ds.createConstIterator(conv), nChunks)));
+          for (size_t chunk = 0; chunk < reference.size(); ++chunk, ++it) {
+               CPPUNIT_ASSERT(it != it.end());
+               const ChunkCopy &ref = reference[chunk];
+               CPPUNIT_ASSERT_EQUAL(ref.itsNRow, it->nRow());
+               CPPUNIT_ASSERT_EQUAL(ref.itsNChannel, it->nChannel());
+               CPPUNIT_ASSERT_EQUAL(ref.itsNPol, it->nPol());
+               CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.itsTime, it->time(), 1e-6);
+               CPPUNIT_ASSERT(casa::allEQ(ref.itsAntenna1, it->antenna1()));
+               CPPUNIT_ASSERT(casa::allEQ(ref.itsAntenna2, it->antenna2()));
+               CPPUNIT_ASSERT(casa::allEQ(ref.itsVisibility, it->visibility()));
+               CPPUNIT_ASSERT(casa::allEQ(ref.itsFlag, it->flag()));
+               CPPUNIT_ASSERT(casa::allEQ(ref.itsFrequency, it->frequency()));
+               for (casa::uInt row = 0; row < it->nRow(); ++row) {
+                    for (casa::uInt dim = 0; dim < 3; ++dim) {
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(ref.itsUVW(row)(dim),
+                                    it->uvw()(row)(dim), 1e-6);
+                    }
+               }
+          }
+          CPPUNIT_ASSERT(it == it.end());
+     }
+  }
+
+  void testRestart() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     IConstDataSharedIter it(boost::shared_ptr<PrefetchingDataIterator>(
+                 new PrefetchingDataIterator(ds.createConstIterator(), 2)));
+     CPPUNIT_ASSERT_EQUAL(size_t(420), countSteps(it));
+     // partial pass, then restart from the beginning
+     it.init();
+     for (size_t step = 0; step < 10; ++step, ++it) {
+          CPPUNIT_ASSERT(it != it.end());
+     }
+     it.init();
+     CPPUNIT_ASSERT_EQUAL(size_t(420), countSteps(it));
+  }
+
+  void testReadOnlyAccessor() {
+     TableConstDataSource ds(TableTestRunner::msName());
+     PrefetchingDataIterator it(ds.createConstIterator());
+     const IConstDataAccessor &acc = *it;
+     const IDataAccessor *rwAcc = dynamic_cast<const IDataAccessor*>(&acc);
+     CPPUNIT_ASSERT(rwAcc);
+     // this should generate an exception
+     const_cast<IDataAccessor*>(rwAcc)->rwVisibility();
+  }
+};
+
+} // namespace accessors
+
+} // namespace askap
+
+#endif // #ifndef PREFETCHING_DATA_ITERATOR_TEST_H
@@ -37,6 +37,8 @@
 #include "DataAccessorAdapterTest.h"
 #include "CachedAccessorFieldTest.h"
 #include "TimeChunkIteratorAdapterTest.h"
+#include "PrefetchingDataIteratorTest.h"
+#include "ChunkListDataIteratorTest.h"
 
 #include "TableTestRunner.h"
 
@@ -52,6 +54,8 @@ int main(int argc, char *argv[])
    runner.addTest(askap::accessors::DataAccessorAdapterTest::suite());
    runner.addTest(askap::accessors::CachedAccessorFieldTest::suite());
    runner.addTest(askap::accessors::TimeChunkIteratorAdapterTest::suite());
+   runner.addTest(askap::accessors::PrefetchingDataIteratorTest::suite());
+   runner.addTest(askap::accessors::ChunkListDataIteratorTest::suite());
    runner.run();
    return 0;
  }
@@ -38,6 +38,7 @@
 #include <stdint.h>
 #include <limits>
 #include <algorithm>
+#include <vector>
 
 // boost
 #include <boost/shared_array.hpp>
@@ -74,6 +75,14 @@ MPIComms::MPIComms(int argc, char *argv[]) : itsCommunicators(1, MPI_COMM_NULL)
 
 MPIComms::~MPIComms()
 {
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+    for (std::map<void*, MPI_Win>::iterator it = itsSharedWindows.begin();
+         it != itsSharedWindows.end(); ++it) {
+         MPI_Win_unlock_all(it->second);
+         MPI_Win_free(&(it->second));
+    }
+#endif
+    itsSharedWindows.clear();
     for (size_t comm = itsCommunicators.size(); comm>0; --comm) {
          if (itsCommunicators[comm-1] != MPI_COMM_NULL) {
              MPI_Comm_free(&itsCommunicators[comm-1]);
@@ -174,6 +183,127 @@ size_t MPIComms::createComm(const std::vector<int> &group, size_t comm)
   return newIndex;
 }
 
+/// @brief split a communicator
+/// @details This method creates a new communicator for each distinct colour
+/// (see MPI_Comm_split) and returns the index of the one this rank belongs to.
+/// It should be called by all ranks of the original communicator.
+/// @param[in] colour ranks with the same colour end up in the same communicator
+/// @param[in] key ranks are ordered by this key in the new communicator
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::splitComm(int colour, int key, size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+  MPI_Comm newComm = MPI_COMM_NULL;
+  const int result = MPI_Comm_split(itsCommunicators[comm], colour, key, &newComm);
+  checkError(result, "MPI_Comm_split");
+  const size_t newIndex = itsCommunicators.size();
+  itsCommunicators.push_back(newComm);
+  return newIndex;
+}
+
+/// @brief create a communicator for ranks which can share memory
+/// @details This method splits the given communicator into communicators
+/// of ranks running on the same node (MPI-3 is required).
+/// It should be called by all ranks of the original communicator.
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::createSharedMemoryComm(size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  MPI_Comm newComm = MPI_COMM_NULL;
+  const int result = MPI_Comm_split_type(itsCommunicators[comm], MPI_COMM_TYPE_SHARED,
+                                         rank(comm), MPI_INFO_NULL, &newComm);
+  checkError(result, "MPI_Comm_split_type");
+  const size_t newIndex = itsCommunicators.size();
+  itsCommunicators.push_back(newComm);
+  return newIndex;
+#else
+  ASKAPTHROW(AskapError, "MPIComms::createSharedMemoryComm() requires MPI-3");
+#endif
+}
+
+/// @brief allocate memory shared between all ranks of the communicator
+/// @details This is a collective call for the communicator, which should be
+/// created by createSharedMemoryComm. The memory is allocated by rank 0 and
+/// the returned pointer refers to the same memory on all ranks. Use
+/// syncSharedMemory to make the content written by one rank visible to others.
+/// @param[in] size number of bytes to allocate
+/// @param[in] comm communicator index
+/// @return pointer to the shared memory
+void* MPIComms::allocateSharedMemory(size_t size, size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  const bool isRoot = (rank(comm) == 0);
+  void *base = 0;
+  MPI_Win win = MPI_WIN_NULL;
+  int result = MPI_Win_allocate_shared(MPI_Aint(isRoot ? size : 0), 1, MPI_INFO_NULL,
+                                       itsCommunicators[comm], &base, &win);
+  checkError(result, "MPI_Win_allocate_shared");
+  if (!isRoot) {
+      MPI_Aint rootSize = 0;
+      int dispUnit = 0;
+      result = MPI_Win_shared_query(win, 0, &rootSize, &dispUnit, &base);
+      checkError(result, "MPI_Win_shared_query");
+      ASKAPCHECK(size_t(rootSize) == size, "Size of the shared memory on rank 0 ("<<rootSize<<
+                 " bytes) differs from the requested size ("<<size<<" bytes)");
+  }
+  // passive target epoch is kept open until the memory is released,
+  // syncSharedMemory is then sufficient for the synchronisation
+  result = MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+  checkError(result, "MPI_Win_lock_all");
+  ASKAPCHECK(itsSharedWindows.find(base) == itsSharedWindows.end(),
+             "Shared memory at this address has already been allocated");
+  itsSharedWindows[base] = win;
+  return base;
+#else
+  ASKAPTHROW(AskapError, "MPIComms::allocateSharedMemory() requires MPI-3");
+#endif
+}
+
+/// @brief synchronise shared memory between ranks
+/// @details This is a collective call acting as a barrier. All writes done
+/// to the shared memory before the call are visible to all ranks after the call.
+/// @param[in] ptr pointer returned by allocateSharedMemory
+/// @param[in] comm communicator index used to allocate the memory
+void MPIComms::syncSharedMemory(void *ptr, size_t comm)
+{
+  ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+  const std::map<void*, MPI_Win>::const_iterator ci = itsSharedWindows.find(ptr);
+  ASKAPCHECK(ci != itsSharedWindows.end(), "Unknown shared memory pointer");
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  int result = MPI_Win_sync(ci->second);
+  checkError(result, "MPI_Win_sync");
+  result = MPI_Barrier(itsCommunicators[comm]);
+  checkError(result, "MPI_Barrier");
+  result = MPI_Win_sync(ci->second);
+  checkError(result, "MPI_Win_sync");
+#endif
+}
+
+/// @brief release shared memory
+/// @details This is a collective call for the communicator used to allocate the
+/// memory. Shared memory which has not been released explicitly is released
+/// in the destructor.
+/// @param[in] ptr pointer returned by allocateSharedMemory
+void MPIComms::freeSharedMemory(void *ptr)
+{
+  const std::map<void*, MPI_Win>::iterator it = itsSharedWindows.find(ptr);
+  ASKAPCHECK(it != itsSharedWindows.end(), "Unknown shared memory pointer");
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+  int result = MPI_Win_unlock_all(it->second);
+  checkError(result, "MPI_Win_unlock_all");
+  result = MPI_Win_free(&(it->second));
+  checkError(result, "MPI_Win_free");
+#endif
+  itsSharedWindows.erase(it);
+}
+
 
 void MPIComms::send(const void* buf, size_t size, int dest, int tag, size_t comm)
 {
@@ -220,6 +350,58 @@ int MPIComms::receiveAnySrc(void* buf, size_t size, int tag, size_t comm)
     return receiveImpl(buf, size, MPI_ANY_SOURCE, tag, comm);
 }
 
+void MPIComms::sendNonBlocking(const void* buf, size_t size, int dest, int tag, size_t comm)
+{
+    ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+    ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+    const unsigned int c_maxint = std::numeric_limits<int>::max();
+
+    // First send the size of the buffer, the same way as send does
+    itsSendSizes.push_back(size);
+    MPI_Request request;
+    int result = MPI_Isend(&itsSendSizes.back(), 1, MPI_UNSIGNED_LONG, dest, tag,
+                           itsCommunicators[comm], &request);
+    checkError(result, "MPI_Isend");
+    itsSendRequests.push_back(request);
+
+    // Send in chunks of size MAXINT until complete
+    size_t remaining = size;
+
+    while (remaining > 0) {
+        size_t offset = size - remaining;
+
+        void* addr = addOffset(buf, offset);
+
+        const size_t chunk = (remaining >= c_maxint) ? c_maxint : remaining;
+        result = MPI_Isend(addr, chunk, MPI_BYTE, dest, tag, itsCommunicators[comm], &request);
+        checkError(result, "MPI_Isend");
+        itsSendRequests.push_back(request);
+        remaining -= chunk;
+    }
+}
+
+void MPIComms::waitSends()
+{
+    if (itsSendRequests.size() > 0) {
+        const int result = MPI_Waitall(itsSendRequests.size(), &itsSendRequests[0],
+                                       MPI_STATUSES_IGNORE);
+        checkError(result, "MPI_Waitall");
+    }
+    itsSendRequests.clear();
+    itsSendSizes.clear();
+}
+
+bool MPIComms::probeAnySrc(int tag, size_t comm)
+{
+    ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+    ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+    int flag = 0;
+    const int result = MPI_Iprobe(MPI_ANY_SOURCE, tag, itsCommunicators[comm], &flag,
+                                  MPI_STATUS_IGNORE);
+    checkError(result, "MPI_Iprobe");
+    return flag != 0;
+}
+
 int MPIComms::receiveImpl(void* buf, size_t size, int source, int tag, size_t comm)
 {
     ASKAPDEBUGASSERT(comm < itsCommunicators.size());
@@ -310,6 +492,51 @@ void MPIComms::sumAndBroadcast(float *buf, size_t size, size_t comm)
    checkError(result,"MPI_Allreduce");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator to the root rank
+/// @details The reduction is done in chunks. If the MPI library supports MPI-3,
+/// up to maxPending chunks are reduced with non-blocking calls at any time, so
+/// transfer and summation of successive chunks overlap. The sum is written in place
+/// on the root rank, buffers on other ranks are left intact.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank receiving the sum
+/// @param[in] chunkSize number of elements reduced in one operation
+/// @param[in] maxPending maximum number of outstanding chunk reductions
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *buf, size_t size, int root, size_t chunkSize,
+                         unsigned int maxPending, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   ASKAPCHECK(chunkSize > 0, "Chunk size for the reduction should be positive");
+   const size_t step = std::min(chunkSize, size_t(std::numeric_limits<int>::max()));
+   const bool isRoot = (rank(comm) == root);
+#if defined(MPI_VERSION) && (MPI_VERSION >= 3)
+   // ring of outstanding requests, a slot is reused after the reduction it holds is complete
+   std::vector<MPI_Request> requests(std::max(maxPending, 1u), MPI_REQUEST_NULL);
+   size_t slot = 0;
+   for (size_t offset = 0; offset < size; offset += step) {
+        // waiting on the null request returns immediately
+        int result = MPI_Wait(&requests[slot], MPI_STATUS_IGNORE);
+        checkError(result, "MPI_Wait");
+        const int count = int(std::min(step, size - offset));
+        result = MPI_Ireduce(isRoot ? MPI_IN_PLACE : buf + offset, isRoot ? buf + offset : 0,
+                  count, MPI_DOUBLE, MPI_SUM, root, itsCommunicators[comm], &requests[slot]);
+        checkError(result, "MPI_Ireduce");
+        slot = (slot + 1) % requests.size();
+   }
+   const int result = MPI_Waitall(int(requests.size()), &requests[0], MPI_STATUSES_IGNORE);
+   checkError(result, "MPI_Waitall");
+#else
+   for (size_t offset = 0; offset < size; offset += step) {
+        const int count = int(std::min(step, size - offset));
+        const int result = MPI_Reduce(isRoot ? MPI_IN_PLACE : buf + offset, isRoot ? buf + offset : 0,
+                  count, MPI_DOUBLE, MPI_SUM, root, itsCommunicators[comm]);
+        checkError(result, "MPI_Reduce");
+   }
+#endif
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -400,6 +627,22 @@ void MPIComms::sumAndBroadcast(float *, size_t, size_t)
     ASKAPTHROW(AskapError, "MPIComms::sumAndBroadcast() cannot be used - configured without MPI");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator to the root rank
+/// @details The reduction is done in chunks. If the MPI library supports MPI-3,
+/// up to maxPending chunks are reduced with non-blocking calls at any time, so
+/// transfer and summation of successive chunks overlap. The sum is written in place
+/// on the root rank, buffers on other ranks are left intact.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank receiving the sum
+/// @param[in] chunkSize number of elements reduced in one operation
+/// @param[in] maxPending maximum number of outstanding chunk reductions
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *, size_t, int, size_t, unsigned int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumToRoot() cannot be used - configured without MPI");
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -425,6 +668,63 @@ size_t MPIComms::createComm(const std::vector<int> &, size_t)
     ASKAPTHROW(AskapError, "MPIComms::createComm() cannot be used - configured without MPI");
 }
 
+/// @brief split a communicator
+/// @details This method creates a new communicator for each distinct colour
+/// (see MPI_Comm_split) and returns the index of the one this rank belongs to.
+/// It should be called by all ranks of the original communicator.
+/// @param[in] colour ranks with the same colour end up in the same communicator
+/// @param[in] key ranks are ordered by this key in the new communicator
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::splitComm(int, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::splitComm() cannot be used - configured without MPI");
+}
+
+/// @brief create a communicator for ranks which can share memory
+/// @details This method splits the given communicator into communicators
+/// of ranks running on the same node (MPI-3 is required).
+/// It should be called by all ranks of the original communicator.
+/// @param[in] comm communicator index to split
+/// @return new communicator index
+size_t MPIComms::createSharedMemoryComm(size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::createSharedMemoryComm() cannot be used - configured without MPI");
+}
+
+/// @brief allocate memory shared between all ranks of the communicator
+/// @details This is a collective call for the communicator, which should be
+/// created by createSharedMemoryComm. The memory is allocated by rank 0 and
+/// the returned pointer refers to the same memory on all ranks. Use
+/// syncSharedMemory to make the content written by one rank visible to others.
+/// @param[in] size number of bytes to allocate
+/// @param[in] comm communicator index
+/// @return pointer to the shared memory
+void* MPIComms::allocateSharedMemory(size_t, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::allocateSharedMemory() cannot be used - configured without MPI");
+}
+
+/// @brief synchronise shared memory between ranks
+/// @details This is a collective call acting as a barrier. All writes done
+/// to the shared memory before the call are visible to all ranks after the call.
+/// @param[in] ptr pointer returned by allocateSharedMemory
+/// @param[in] comm communicator index used to allocate the memory
+void MPIComms::syncSharedMemory(void *, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::syncSharedMemory() cannot be used - configured without MPI");
+}
+
+/// @brief release shared memory
+/// @details This is a collective call for the communicator used to allocate the
+/// memory. Shared memory which has not been released explicitly is released
+/// in the destructor.
+/// @param[in] ptr pointer returned by allocateSharedMemory
+void MPIComms::freeSharedMemory(void *)
+{
+    ASKAPTHROW(AskapError, "MPIComms::freeSharedMemory() cannot be used - configured without MPI");
+}
+
 void MPIComms::send(const void* buf, size_t size, int dest, int tag, size_t)
 {
     ASKAPTHROW(AskapError, "MPIComms::send() cannot be used - configured without MPI");
@@ -440,6 +740,21 @@ int MPIComms::receiveAnySrc(void* buf, size_t size, int tag, size_t)
     ASKAPTHROW(AskapError, "MPIComms::receiveAnySrc() cannot be used - configured without MPI");
 }
 
+void MPIComms::sendNonBlocking(const void*, size_t, int, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sendNonBlocking() cannot be used - configured without MPI");
+}
+
+void MPIComms::waitSends()
+{
+    ASKAPTHROW(AskapError, "MPIComms::waitSends() cannot be used - configured without MPI");
+}
+
+bool MPIComms::probeAnySrc(int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::probeAnySrc() cannot be used - configured without MPI");
+}
+
 void MPIComms::broadcast(void* buf, size_t size, int root, size_t)
 {
     ASKAPTHROW(AskapError, "MPIComms::broadcast() cannot be used - configured without MPI");
@@ -30,6 +30,8 @@
 // System includes
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
 
 // MPI-specific includes
 #ifdef HAVE_MPI
@@ -110,6 +112,31 @@ class MPIComms {
         /// world communicator)
         virtual int receiveAnySrc(void* buf, size_t size, int tag = 0, size_t comm = 0);
 
+        /// @brief MPI_Isend a raw buffer to the specified destination
+        /// process.
+        /// @details The message can be received by receive or receiveAnySrc in
+        /// the same way as the one sent by send. The method returns straight away,
+        /// the buffer must not be modified or released until waitSends returns.
+        ///
+        /// @param[in] buf a pointer to the buffer to send.
+        /// @param[in] size    the number of bytes to send.
+        /// @param[in] dest    the id of the process to send to.
+        /// @param[in] tag the MPI tag to be used in the communication.
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        virtual void sendNonBlocking(const void* buf, size_t size, int dest, int tag = 0, size_t comm = 0);
+
+        /// @brief wait until all non-blocking sends are complete
+        virtual void waitSends();
+
+        /// @brief check whether a message can be received without blocking
+        /// @details This is MPI_Iprobe for any source.
+        /// @param[in] tag the MPI tag of the message.
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        /// @return true if a message with the given tag is waiting to be received
+        virtual bool probeAnySrc(int tag = 0, size_t comm = 0);
+
         /// @brief MPI_Bcast a raw buffer.
         ///
         /// @param[in,out] buf    data buffer.
@@ -126,6 +153,21 @@ class MPIComms {
         /// @param[in] size number of elements in the buffer (float type is assumed)
         /// @param[in] comm communicator index
         virtual void sumAndBroadcast(float *buf, size_t size, size_t comm);
+
+        /// @brief sum raw double buffers across all ranks of the communicator to the root rank
+        /// @details The reduction is done in chunks. If the MPI library supports MPI-3,
+        /// up to maxPending chunks are reduced with non-blocking calls at any time, so
+        /// transfer and summation of successive chunks overlap. The sum is written in place
+        /// on the root rank, buffers on other ranks are left intact.
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer
+        /// @param[in] root rank receiving the sum
+        /// @param[in] chunkSize number of elements reduced in one operation
+        /// @param[in] maxPending maximum number of outstanding chunk reductions
+        /// @param[in] comm communicator index, defaults to 0 (copy of the default 
+        /// world communicator)
+        virtual void sumToRoot(double *buf, size_t size, int root, size_t chunkSize,
+                               unsigned int maxPending, size_t comm = 0);
         
         /// @brief reduce a boolean flag across the number of ranks
         /// @details This method aggregates a flag (i.e. single boolean variable) across
@@ -146,6 +188,50 @@ class MPIComms {
         /// @return new communicator index
         virtual size_t createComm(const std::vector<int> &group, size_t comm = 0);
 
+        /// @brief split a communicator
+        /// @details This method creates a new communicator for each distinct colour
+        /// (see MPI_Comm_split) and returns the index of the one this rank belongs to.
+        /// It should be called by all ranks of the original communicator.
+        /// @param[in] colour ranks with the same colour end up in the same communicator
+        /// @param[in] key ranks are ordered by this key in the new communicator
+        /// @param[in] comm communicator index to split, defaults to 0 (copy of the default 
+        /// world communicator)
+        /// @return new communicator index
+        virtual size_t splitComm(int colour, int key, size_t comm = 0);
+
+        /// @brief create a communicator for ranks which can share memory
+        /// @details This method splits the given communicator into communicators
+        /// of ranks running on the same node (MPI-3 is required).
+        /// It should be called by all ranks of the original communicator.
+        /// @param[in] comm communicator index to split, defaults to 0 (copy of the default 
+        /// world communicator)
+        /// @return new communicator index
+        virtual size_t createSharedMemoryComm(size_t comm = 0);
+
+        /// @brief allocate memory shared between all ranks of the communicator
+        /// @details This is a collective call for the communicator, which should be
+        /// created by createSharedMemoryComm. The memory is allocated by rank 0 and
+        /// the returned pointer refers to the same memory on all ranks. Use
+        /// syncSharedMemory to make the content written by one rank visible to others.
+        /// @param[in] size number of bytes to allocate
+        /// @param[in] comm communicator index
+        /// @return pointer to the shared memory
+        virtual void* allocateSharedMemory(size_t size, size_t comm);
+
+        /// @brief synchronise shared memory between ranks
+        /// @details This is a collective call acting as a barrier. All writes done
+        /// to the shared memory before the call are visible to all ranks after the call.
+        /// @param[in] ptr pointer returned by allocateSharedMemory
+        /// @param[in] comm communicator index used to allocate the memory
+        virtual void syncSharedMemory(void *ptr, size_t comm);
+
+        /// @brief release shared memory
+        /// @details This is a collective call for the communicator used to allocate the
+        /// memory. Shared memory which has not been released explicitly is released
+        /// in the destructor.
+        /// @param[in] ptr pointer returned by allocateSharedMemory
+        virtual void freeSharedMemory(void *ptr);
+
     private:
         // Check for error status and handle accordingly
         void checkError(const int error, const std::string location) const;
@@ -163,6 +249,16 @@ class MPIComms {
 
         // Specific MPI Communicator for this class
         std::vector<MPI_Comm> itsCommunicators;
+
+        // Windows of the allocated shared memory
+        std::map<void*, MPI_Win> itsSharedWindows;
+
+        // Requests of the outstanding non-blocking sends
+        std::vector<MPI_Request> itsSendRequests;
+
+        // Message sizes sent ahead of the outstanding non-blocking sends,
+        // they have to stay in place until the sends are complete
+        std::list<unsigned long> itsSendSizes;
 #endif
 
         // No support for assignment
@@ -242,6 +242,21 @@ namespace askap {
                 bool coordinatesAreConsistent(const CoordinateSystem& coordSys1,
                                               const CoordinateSystem& coordSys2);
 
+                /// @brief fill a plane with primary-beam weights (beam squared)
+                /// @details Offsets of the output pixels from the beam centre are cached,
+                ///     so coordinate conversions are only done once per beam and output grid.
+                ///     Only the frequency-dependent beam evaluation is done for each plane.
+                /// @param[out] Matrix<T>& wgtPlane: weights, resized to the given shape
+                /// @param[in] const MVDirection& centre: beam centre
+                /// @param[in] const DirectionCoordinate& outDC: direction coordinate of the output grid
+                /// @param[in] const IPosition& shape: shape of the plane (first two axes are used)
+                /// @param[in] const double freq: frequency of the current plane
+                void beamWeights(Matrix<T>& wgtPlane,
+                                 const MVDirection& centre,
+                                 const DirectionCoordinate& outDC,
+                                 const IPosition& shape,
+                                 const double freq);
+
                 // regridding options
                 ImageRegrid<T> itsRegridder;
                 IPosition itsAxes;
@@ -284,6 +299,12 @@ namespace askap {
                 //
                 PrimaryBeam::ShPtr itsPB;
 
+                // cached offsets of the output pixels from the beam centre (see beamWeights)
+                Matrix<double> itsBeamOffsets;
+                MVDirection itsBeamOffsetsCentre;
+                // buffer for primary-beam values
+                Matrix<double> itsBeamValues;
+
         };
 
     } // namespace imagemath
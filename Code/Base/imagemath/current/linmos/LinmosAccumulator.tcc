@@ -32,6 +32,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 #include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
 #include <casacore/images/Images/ImageRegrid.h>
 #include <casacore/lattices/LatticeMath/LatticeMathUtil.h>
 
@@ -796,6 +797,8 @@ namespace askap {
                                                        const CoordinateSystem& outCoordSys) {
             itsOutShape = outShape;
             itsOutCoordSys = outCoordSys;
+            // the output grid has changed, invalidate the cached beam offsets
+            itsBeamOffsets.resize(0,0);
         }
 
         template<typename T>
@@ -865,6 +868,8 @@ namespace askap {
             // set up a coord system for the merged images
             itsOutCoordSys = refCS;
             itsOutCoordSys.replaceCoordinate(newDC, dcPos);
+            // the output grid has changed, invalidate the cached beam offsets
+            itsBeamOffsets.resize(0,0);
 
         }
 
@@ -1009,14 +1014,13 @@ namespace askap {
             IPosition pos(2);
 
             // set the weights, either to those read in or using the primary-beam model
-            TempImage<T> wgtBuffer;
+            // whole planes are read from the temporary images rather than pixel by pixel
+            Array<T> wgtBuffer;
             if (itsWeightType == FROM_WEIGHT_IMAGES) {
-                wgtBuffer = itsOutWgtBuffer;
+                wgtBuffer = itsOutWgtBuffer.get();
             } else {
 
-                Vector<double> pixel(2,0.);
-                MVDirection world0, world1;
-                T offsetBeam, pb;
+                MVDirection world0;
 
                 // get coordinates of the spectral axis and the current frequency
                 const int scPos = itsInCoordSys.findCoordinate(Coordinate::SPECTRAL,-1);
@@ -1038,31 +1042,13 @@ namespace askap {
                 // set the centre of the input beam (needs to be more flexible -- and correct...)
                 inDC.toWorld(world0,inDC.referencePixel());
 
-                // apparently the +100 forces it to use the memory
-                double maxMemoryInMB = double(itsOutBuffer.shape().product()*sizeof(T))/1024./1024.+100;
-                wgtBuffer = TempImage<T>(itsOutBuffer.shape(), itsOutBuffer.coordinates(), maxMemoryInMB);
-
-                // step through the pixels, setting the weights (power primary beam squared)
-                for (int x=0; x<outPix.shape()[0];++x) {
-                    for (int y=0; y<outPix.shape()[1];++y) {
-                        pos[0] = x;
-                        pos[1] = y;
-
-                        // get the current pixel location and distance from beam centre
-                        pixel[0] = double(x);
-                        pixel[1] = double(y);
-                        outDC.toWorld(world1,pixel);
-                        offsetBeam = world0.separation(world1);
-
-                        // set the weight
-                        //pb = exp(-offsetBeam*offsetBeam*4.*log(2.)/fwhm/fwhm);
-                        pb = itsPB->evaluateAtOffset(offsetBeam,freq);
-                        wgtBuffer.putAt(pb * pb, pos);
-
-                    }
-                }
+                // set the weights (power primary beam squared)
+                Matrix<T> beamWgt;
+                beamWeights(beamWgt, world0, outDC, itsOutBuffer.shape(), freq);
+                wgtBuffer.reference(beamWgt);
 
             }
+            const Array<T> outBuffer = itsOutBuffer.get();
 
             T minVal, maxVal;
             IPosition minPos, maxPos;
@@ -1078,9 +1064,9 @@ namespace askap {
                         fullpos[1] = y;
                         pos[0] = x;
                         pos[1] = y;
-                        if (wgtBuffer.getAt(pos)>=wgtCutoff) {
-                            outPix(fullpos) = outPix(fullpos) + itsOutBuffer.getAt(pos) * wgtBuffer.getAt(pos);
-                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer.getAt(pos);
+                        if (wgtBuffer(pos)>=wgtCutoff) {
+                            outPix(fullpos) = outPix(fullpos) + outBuffer(pos) * wgtBuffer(pos);
+                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer(pos);
                         }
                     }
                 }
@@ -1091,9 +1077,9 @@ namespace askap {
                         fullpos[1] = y;
                         pos[0] = x;
                         pos[1] = y;
-                        if (wgtBuffer.getAt(pos)>=wgtCutoff) {
-                            outPix(fullpos) = outPix(fullpos) + itsOutBuffer.getAt(pos) * sqrt(wgtBuffer.getAt(pos));
-                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer.getAt(pos);
+                        if (wgtBuffer(pos)>=wgtCutoff) {
+                            outPix(fullpos) = outPix(fullpos) + outBuffer(pos) * sqrt(wgtBuffer(pos));
+                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer(pos);
                         }
                     }
                 }
@@ -1104,9 +1090,9 @@ namespace askap {
                         fullpos[1] = y;
                         pos[0] = x;
                         pos[1] = y;
-                        if (wgtBuffer.getAt(pos)>=wgtCutoff) {
-                            outPix(fullpos) = outPix(fullpos) + itsOutBuffer.getAt(pos);
-                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer.getAt(pos);
+                        if (wgtBuffer(pos)>=wgtCutoff) {
+                            outPix(fullpos) = outPix(fullpos) + outBuffer(pos);
+                            outWgtPix(fullpos) = outWgtPix(fullpos) + wgtBuffer(pos);
                         }
                     }
                 }
@@ -1114,7 +1100,8 @@ namespace askap {
             // Accumulate sensitivity for this slice.
             if (itsDoSensitivity) {
                 T invVariance;
-                minMax(minVal,maxVal,minPos,maxPos,itsOutSnrBuffer);
+                const Array<T> outSnrBuffer = itsOutSnrBuffer.get();
+                minMax(minVal,maxVal,minPos,maxPos,outSnrBuffer);
                 T snrCutoff = itsCutoff * itsCutoff * maxVal;
                 for (int x=0; x<outPix.shape()[0];++x) {
                     for (int y=0; y<outPix.shape()[1];++y) {
@@ -1122,8 +1109,8 @@ namespace askap {
                         fullpos[1] = y;
                         pos[0] = x;
                         pos[1] = y;
-                        invVariance = itsOutSnrBuffer.getAt(pos);
-                        if (invVariance>=snrCutoff && wgtBuffer.getAt(pos)>=wgtCutoff) {
+                        invVariance = outSnrBuffer(pos);
+                        if (invVariance>=snrCutoff && wgtBuffer(pos)>=wgtCutoff) {
                             outSenPix(fullpos) = outSenPix(fullpos) + invVariance;
                         }
                     }
@@ -1155,10 +1142,6 @@ namespace askap {
                 wgtPix.reference(inWgtPix);
             } else {
 
-                Vector<double> pixel(2,0.);
-                MVDirection world;
-                T offsetBeam, pb;
-
                 // get coordinates of the spectral axis and the current frequency
                 const int scPos = itsInCoordSys.findCoordinate(Coordinate::SPECTRAL,-1);
                 const SpectralCoordinate inSC = itsInCoordSys.spectralCoordinate(scPos);
@@ -1179,27 +1162,15 @@ namespace askap {
                 for (uInt dim=0; dim<curpos.nelements(); ++dim) {
                     wgtpos[dim] = 0;
                 }
-                // set the array
-                wgtPix = Array<T>(itsInShape);
-
-                for (int x=0; x<outPix.shape()[0];++x) {
-                    for (int y=0; y<outPix.shape()[1];++y) {
-                        wgtpos[0] = x;
-                        wgtpos[1] = y;
 
-                        // get the current pixel location and distance from beam centre
-                        pixel[0] = double(x);
-                        pixel[1] = double(y);
-                        outDC.toWorld(world,pixel);
-                        offsetBeam = itsInCentre.separation(world);
-
-                        // set the weight
-                        //pb = exp(-offsetBeam*offsetBeam*4.*log(2.)/fwhm/fwhm);
-                        pb = itsPB->evaluateAtOffset(offsetBeam,freq);
-                        wgtPix(wgtpos) = pb * pb;
-
-                    }
-                }
+                // set the weights (power primary beam squared)
+                Matrix<T> beamWgt;
+                beamWeights(beamWgt, itsInCentre, outDC, outPix.shape(), freq);
+                // add degenerate higher-order axes, so the plane can be indexed with wgtpos
+                IPosition wgtShape(itsInShape.nelements(), 1);
+                wgtShape[0] = beamWgt.shape()[0];
+                wgtShape[1] = beamWgt.shape()[1];
+                wgtPix.reference(beamWgt.reform(wgtShape));
             }
 
             T minVal, maxVal;
@@ -1312,6 +1283,48 @@ namespace askap {
 
         }
 
+        template<typename T>
+        void LinmosAccumulator<T>::beamWeights(Matrix<T>& wgtPlane,
+                                               const MVDirection& centre,
+                                               const DirectionCoordinate& outDC,
+                                               const IPosition& shape,
+                                               const double freq) {
+
+            ASKAPDEBUGASSERT(shape.nelements() >= 2);
+            ASKAPCHECK(itsPB, "Primary beam model is not defined");
+            const IPosition planeShape(2, shape[0], shape[1]);
+
+            // the offsets only depend on the beam centre and the output grid
+            if (!itsBeamOffsets.shape().isEqual(planeShape) || !itsBeamOffsetsCentre.near(centre)) {
+                ASKAPLOG_INFO_STR(linmoslogger, " - caching primary-beam offsets for a "<<planeShape<<" plane");
+                itsBeamOffsets.resize(planeShape);
+                Vector<double> pixel(2,0.);
+                MVDirection world;
+                for (int y=0; y<planeShape[1]; ++y) {
+                    for (int x=0; x<planeShape[0]; ++x) {
+                        pixel[0] = double(x);
+                        pixel[1] = double(y);
+                        outDC.toWorld(world,pixel);
+                        itsBeamOffsets(x,y) = centre.separation(world);
+                    }
+                }
+                itsBeamOffsetsCentre = centre;
+            }
+
+            itsPB->evaluateAtOffsets(itsBeamOffsets, freq, itsBeamValues);
+
+            wgtPlane.resize(planeShape);
+            bool deleteIn, deleteOut;
+            const double *pb = itsBeamValues.getStorage(deleteIn);
+            T *wgt = wgtPlane.getStorage(deleteOut);
+            const size_t nElements = wgtPlane.nelements();
+            for (size_t i = 0; i < nElements; ++i) {
+                 wgt[i] = T(pb[i] * pb[i]);
+            }
+            itsBeamValues.freeStorage(pb, deleteIn);
+            wgtPlane.putStorage(wgt, deleteOut);
+        }
+
         template<typename T>
         Vector<IPosition> LinmosAccumulator<T>::convertImageCornersToRef(const DirectionCoordinate& refDC) {
             // based on SynthesisParamsHelper::facetSlicer, but don't want
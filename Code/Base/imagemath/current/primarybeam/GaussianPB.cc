@@ -75,6 +75,27 @@ namespace askap {
 
             }
 
+            void GaussianPB::evaluateAtOffsets(const casa::Array<double> &offsets, double frequency,
+                                               casa::Array<double> &pb) {
+
+                if (!pb.shape().isEqual(offsets.shape())) {
+                    pb.resize(offsets.shape());
+                }
+                const double fwhm = getFWHM(frequency);
+                const double scale = -getExpScaling()/(fwhm*fwhm);
+
+                bool deleteIn, deleteOut;
+                const double *in = offsets.getStorage(deleteIn);
+                double *out = pb.getStorage(deleteOut);
+                const size_t nElements = offsets.nelements();
+                for (size_t i = 0; i < nElements; ++i) {
+                     out[i] = exp(in[i]*in[i]*scale);
+                }
+                offsets.freeStorage(in, deleteIn);
+                pb.putStorage(out, deleteOut);
+
+            }
+
             casa::Matrix<casa::Complex> GaussianPB::getJonesAtOffset(double offset, double frequency) {
 
                 casa::IPosition shape(2,2,2);
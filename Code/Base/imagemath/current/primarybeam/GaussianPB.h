@@ -53,6 +53,14 @@ namespace imagemath {
 
         virtual double evaluateAtOffset(double offset, double frequency);
 
+        /// @brief evaluate the beam for a number of offsets at once
+        /// @details The exponent scaling is computed once for the given frequency.
+        /// @param[in] offsets offsets from the beam centre (radians)
+        /// @param[in] frequency frequency (Hz)
+        /// @param[out] pb beam values, resized to the shape of offsets if necessary
+        virtual void evaluateAtOffsets(const casa::Array<double> &offsets, double frequency,
+                                       casa::Array<double> &pb);
+
         /// Probably should have a "generate weight" - that calls evaluate for
         /// every pixel ....
 
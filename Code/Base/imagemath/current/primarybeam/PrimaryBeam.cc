@@ -37,5 +37,16 @@ namespace askap {
                                       "PrimaryBeam::createPrimaryBeam should never be called");
                return PrimaryBeam::ShPtr();
             }
+            void PrimaryBeam::evaluateAtOffsets(const casa::Array<double> &offsets, double frequency,
+                                                casa::Array<double> &pb)
+            {
+                if (!pb.shape().isEqual(offsets.shape())) {
+                    pb.resize(offsets.shape());
+                }
+                casa::Array<double>::const_iterator in = offsets.begin();
+                for (casa::Array<double>::iterator out = pb.begin(); out != pb.end(); ++out, ++in) {
+                     *out = evaluateAtOffset(*in, frequency);
+                }
+            }
     }
 }
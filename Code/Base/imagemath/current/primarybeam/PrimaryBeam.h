@@ -40,6 +40,16 @@ namespace askap
 
             virtual double evaluateAtOffset(double offset, double frequency) = 0;
 
+            /// @brief evaluate the beam for a number of offsets at once
+            /// @details The default implementation calls evaluateAtOffset for every
+            /// element. Derived classes can override it to take the frequency-dependent
+            /// part out of the loop.
+            /// @param[in] offsets offsets from the beam centre (radians)
+            /// @param[in] frequency frequency (Hz)
+            /// @param[out] pb beam values, resized to the shape of offsets if necessary
+            virtual void evaluateAtOffsets(const casa::Array<double> &offsets, double frequency,
+                                           casa::Array<double> &pb);
+
             virtual casa::Matrix<casa::Complex> getJonesAtOffset(double offset, double frequency) = 0;
 
         private:
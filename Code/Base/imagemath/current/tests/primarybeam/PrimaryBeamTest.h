@@ -37,6 +37,7 @@ namespace askap
       CPPUNIT_TEST(testCreateGaussian);
       CPPUNIT_TEST_EXCEPTION(testCreateAbstract,AskapError);
       CPPUNIT_TEST(testEvaluateGaussian);
+      CPPUNIT_TEST(testEvaluateGaussianOffsets);
       CPPUNIT_TEST_SUITE_END();
 
   private:
@@ -189,6 +190,33 @@ namespace askap
           CPPUNIT_ASSERT(abs(testVal - beamval*beamval) < 1E-7);
 
 
+      }
+      void testEvaluateGaussianOffsets() {
+          LOFAR::ParameterSet parset;
+          parset.add("aperture", "12");
+          parset.add("fwhmscaling", "0.5");
+          parset.add("primarybeam","GaussianPB");
+          PrimaryBeam::ShPtr GaussPB =  PrimaryBeamFactory::make(parset);
+
+          casa::Matrix<double> offsets(17,9);
+          for (uInt x = 0; x < offsets.nrow(); ++x) {
+               for (uInt y = 0; y < offsets.ncolumn(); ++y) {
+                    offsets(x,y) = 1e-3 * double(x) + 2e-3 * double(y);
+               }
+          }
+          const double frequencies[2] = {0.7e9, 1.4e9};
+          casa::Array<double> pb;
+          for (int f = 0; f < 2; ++f) {
+               GaussPB->evaluateAtOffsets(offsets, frequencies[f], pb);
+               CPPUNIT_ASSERT(pb.shape() == offsets.shape());
+               for (uInt x = 0; x < offsets.nrow(); ++x) {
+                    for (uInt y = 0; y < offsets.ncolumn(); ++y) {
+                         const casa::IPosition index(2,int(x),int(y));
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(GaussPB->evaluateAtOffset(offsets(x,y),frequencies[f]),
+                                                      pb(index), 1e-12);
+                    }
+               }
+          }
       }
       void testCreateGaussian()
       {
@@ -33,23 +33,266 @@
 
 // ASKAPsoft includes
 #include "askap/AskapError.h"
+#include "askap/AskapLogging.h"
 #include "profile/AskapProfiler.h"
 #include "casacore/casa/Arrays/Vector.h"
-#include "casacore/casa/Arrays/Matrix.h"
 #include "casacore/casa/Arrays/ArrayIter.h"
+#include "casacore/casa/BasicSL/String.h"
 #include "fftw3.h"
 
 // boost include
 #include "boost/thread/mutex.hpp"
+#include "boost/thread/locks.hpp"
+#include "boost/noncopyable.hpp"
+
+// std includes
+#include <algorithm>
+#include <map>
+#include <sstream>
+#include <cstdio>
+#include <unistd.h>
+
+ASKAP_LOGGER(logger, ".fft");
 
 using namespace casa;
 
 namespace askap {
     namespace scimath {
 
-        /// @brief mutex to ensure thread safety in the calls to fft
+        /// @brief mutex to ensure thread safety in the calls to the FFTW planner
+        /// @details Plan execution via the new-array interface is thread safe,
+        /// so the lock is only held while the plan is looked up or created.
         static boost::mutex fftWrapperMutex;
 
+        /// @brief number of threads used for large 2D transforms
+        static int fftNumberOfThreads = 1;
+
+        /// @brief FFTW planner flags used for new plans
+        static unsigned fftPlanFlags = FFTW_ESTIMATE;
+
+        /// @brief file name to import/export wisdom, empty if not used
+        static std::string fftWisdomFile;
+
+        /// @brief true, if FFTW threads have been initialised
+        static bool fftThreadsInitialised = false;
+
+        /// @brief smallest 2D plane (in elements) transformed with multiple threads
+        /// @details Thread synchronisation overheads outweigh the gain for small planes
+        /// (e.g. convolution function support), so they are always transformed serially.
+        static const size_t fftMinThreadedSize = 512 * 512;
+
+        /// @brief key of the plan cache
+        /// @details FFTW plans can be applied to any array with the same shape,
+        /// the same alignment and the same in-place property as the array used
+        /// for planning. All transforms here are in-place.
+        struct FFTPlanKey {
+            FFTPlanKey(const int rank, const int *n, const bool forward, const int alignment,
+                       const int nThreads, const unsigned flags) :
+                itsN0(n[0]), itsN1(rank > 1 ? n[1] : 0), itsForward(forward),
+                itsAlignment(alignment), itsNThreads(nThreads), itsFlags(flags) {}
+
+            bool operator<(const FFTPlanKey &other) const {
+                if (itsN0 != other.itsN0) {
+                    return itsN0 < other.itsN0;
+                }
+                if (itsN1 != other.itsN1) {
+                    return itsN1 < other.itsN1;
+                }
+                if (itsForward != other.itsForward) {
+                    return itsForward < other.itsForward;
+                }
+                if (itsAlignment != other.itsAlignment) {
+                    return itsAlignment < other.itsAlignment;
+                }
+                if (itsNThreads != other.itsNThreads) {
+                    return itsNThreads < other.itsNThreads;
+                }
+                return itsFlags < other.itsFlags;
+            }
+
+            int itsN0;
+            int itsN1;
+            bool itsForward;
+            int itsAlignment;
+            int itsNThreads;
+            unsigned itsFlags;
+        };
+
+        /// @brief single precision FFTW interface
+        struct FFTWSingle {
+            typedef fftwf_plan Plan;
+            typedef casa::Complex Value;
+
+            static Plan plan(const int rank, const int *n, Value *data, const int sign,
+                             const unsigned flags) {
+                fftwf_complex *buf = reinterpret_cast<fftwf_complex*>(data);
+                return fftwf_plan_dft(rank, n, buf, buf, sign, flags);
+            }
+            static void execute(const Plan p, Value *data) {
+                fftwf_complex *buf = reinterpret_cast<fftwf_complex*>(data);
+                fftwf_execute_dft(p, buf, buf);
+            }
+            static void destroy(Plan p) { fftwf_destroy_plan(p); }
+            static int alignmentOf(Value *data) {
+                return fftwf_alignment_of(reinterpret_cast<float*>(data));
+            }
+            static Value* allocate(const size_t n) {
+                return static_cast<Value*>(fftwf_malloc(sizeof(Value) * n));
+            }
+            static void release(Value *data) { fftwf_free(data); }
+            static void planWithNThreads(const int nThreads) { fftwf_plan_with_nthreads(nThreads); }
+            static bool importWisdom(const std::string &fname) {
+                return fftwf_import_wisdom_from_filename(fname.c_str()) != 0;
+            }
+            static bool exportWisdom(const std::string &fname) {
+                return fftwf_export_wisdom_to_filename(fname.c_str()) != 0;
+            }
+            static const char* wisdomSuffix() { return ""; }
+        };
+
+        /// @brief double precision FFTW interface
+        struct FFTWDouble {
+            typedef fftw_plan Plan;
+            typedef casa::DComplex Value;
+
+            static Plan plan(const int rank, const int *n, Value *data, const int sign,
+                             const unsigned flags) {
+                fftw_complex *buf = reinterpret_cast<fftw_complex*>(data);
+                return fftw_plan_dft(rank, n, buf, buf, sign, flags);
+            }
+            static void execute(const Plan p, Value *data) {
+                fftw_complex *buf = reinterpret_cast<fftw_complex*>(data);
+                fftw_execute_dft(p, buf, buf);
+            }
+            static void destroy(Plan p) { fftw_destroy_plan(p); }
+            static int alignmentOf(Value *data) {
+                return fftw_alignment_of(reinterpret_cast<double*>(data));
+            }
+            static Value* allocate(const size_t n) {
+                return static_cast<Value*>(fftw_malloc(sizeof(Value) * n));
+            }
+            static void release(Value *data) { fftw_free(data); }
+            static void planWithNThreads(const int nThreads) { fftw_plan_with_nthreads(nThreads); }
+            static bool importWisdom(const std::string &fname) {
+                return fftw_import_wisdom_from_filename(fname.c_str()) != 0;
+            }
+            static bool exportWisdom(const std::string &fname) {
+                return fftw_export_wisdom_to_filename(fname.c_str()) != 0;
+            }
+            static const char* wisdomSuffix() { return ".double"; }
+        };
+
+        /// @brief import wisdom for the given precision
+        /// @details Must be called with fftWrapperMutex locked.
+        template<typename Traits>
+        static void importWisdom()
+        {
+            const std::string fname = fftWisdomFile + Traits::wisdomSuffix();
+            if (access(fname.c_str(), R_OK) != 0) {
+                ASKAPLOG_INFO_STR(logger, "FFTW wisdom file " << fname << " does not exist yet");
+            } else if (Traits::importWisdom(fname)) {
+                ASKAPLOG_INFO_STR(logger, "Imported FFTW wisdom from " << fname);
+            } else {
+                ASKAPLOG_WARN_STR(logger, "Unable to import FFTW wisdom from " << fname);
+            }
+        }
+
+        /// @brief export wisdom for the given precision
+        /// @details The wisdom is written into a temporary file first and then renamed,
+        /// so concurrent processes sharing the file never see a partially written one.
+        /// Must be called with fftWrapperMutex locked.
+        template<typename Traits>
+        static void exportWisdom()
+        {
+            const std::string fname = fftWisdomFile + Traits::wisdomSuffix();
+            std::ostringstream os;
+            os << fname << ".tmp" << getpid();
+            const std::string tmpName = os.str();
+            if (!Traits::exportWisdom(tmpName) || (std::rename(tmpName.c_str(), fname.c_str()) != 0)) {
+                ASKAPLOG_WARN_STR(logger, "Unable to export FFTW wisdom to " << fname);
+                std::remove(tmpName.c_str());
+            }
+        }
+
+        /// @brief cache of FFTW plans for the given precision
+        /// @details Plans are kept for the lifetime of the process. The number of
+        /// distinct shapes is small in practice (grid size, convolution function size).
+        template<typename Traits>
+        class FFTPlanCache : private boost::noncopyable {
+        public:
+            typedef typename Traits::Plan Plan;
+            typedef typename Traits::Value Value;
+
+            ~FFTPlanCache() {
+                for (typename std::map<FFTPlanKey, Plan>::iterator it = itsPlans.begin();
+                        it != itsPlans.end(); ++it) {
+                    Traits::destroy(it->second);
+                }
+            }
+
+            /// @brief obtain a plan for an in-place transform of the given array
+            /// @details The content of the array is preserved. If the configured
+            /// planning mode needs to measure and no wisdom is available, the plan
+            /// is measured on a scratch buffer of the same size.
+            /// Must be called with fftWrapperMutex locked.
+            /// @param[in] rank number of dimensions (1 or 2)
+            /// @param[in] n dimensions in the row-major (FFTW) order
+            /// @param[in] data array to be transformed
+            /// @param[in] forward true for the forward transform
+            /// @return the plan
+            Plan getPlan(const int rank, const int *n, Value *data, const bool forward) {
+                const size_t nElements = size_t(n[0]) * (rank > 1 ? size_t(n[1]) : 1);
+                const int nThreads = (rank > 1) && (nElements >= fftMinThreadedSize) ?
+                                     fftNumberOfThreads : 1;
+                const FFTPlanKey key(rank, n, forward, Traits::alignmentOf(data), nThreads,
+                                     fftPlanFlags);
+                const typename std::map<FFTPlanKey, Plan>::const_iterator ci = itsPlans.find(key);
+                if (ci != itsPlans.end()) {
+                    return ci->second;
+                }
+
+                if (fftThreadsInitialised) {
+                    Traits::planWithNThreads(nThreads);
+                }
+                const int sign = forward ? FFTW_FORWARD : FFTW_BACKWARD;
+                Plan p = NULL;
+                if (fftPlanFlags == FFTW_ESTIMATE) {
+                    p = Traits::plan(rank, n, data, sign, FFTW_ESTIMATE);
+                } else {
+                    p = Traits::plan(rank, n, data, sign, fftPlanFlags | FFTW_WISDOM_ONLY);
+                    if (p == NULL) {
+                        Value *scratch = Traits::allocate(nElements);
+                        if ((scratch != NULL) && (Traits::alignmentOf(scratch) == key.itsAlignment)) {
+                            p = Traits::plan(rank, n, scratch, sign, fftPlanFlags);
+                            if ((p != NULL) && (fftWisdomFile != "")) {
+                                exportWisdom<Traits>();
+                            }
+                        }
+                        Traits::release(scratch);
+                    }
+                    if (p == NULL) {
+                        p = Traits::plan(rank, n, data, sign, FFTW_ESTIMATE);
+                    }
+                }
+                ASKAPCHECK(p != NULL, "Unable to create FFTW plan for the transform of size " << n[0] <<
+                           (rank > 1 ? "x" : "") << (rank > 1 ? n[1] : 0));
+                itsPlans[key] = p;
+                return p;
+            }
+
+        private:
+            /// @brief cached plans
+            std::map<FFTPlanKey, Plan> itsPlans;
+        };
+
+        /// @brief plan cache for the given precision
+        template<typename Traits>
+        static FFTPlanCache<Traits>& planCache()
+        {
+            static FFTPlanCache<Traits> cache;
+            return cache;
+        }
+
         /**
          * Scale the array by 1/N were N is the total number of elements in
          * the array
@@ -63,221 +306,167 @@ namespace askap {
             }
         }
 
-        /*
-         * Execute a Double-precision FFT plan.
+        /**
+         * Execute an in-place transform of a contiguous array using a cached plan.
          */
-        static inline void fftExec(casa::Vector<casa::DComplex>& vec, const bool forward,
-                            fftw_plan& p, fftw_complex* buf, size_t bufsz)
+        template<typename Traits>
+        static void fftExec(typename Traits::Value *data, const int rank, const int *n,
+                            const bool forward)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
-
-            Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft).
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                             reinterpret_cast<casa::DComplex*>(buf));
-
-            fftw_execute(p);
+            typename Traits::Plan p;
+            {
+                boost::lock_guard<boost::mutex> lock(fftWrapperMutex);
+                p = planCache<Traits>().getPlan(rank, n, data, forward);
+            }
 
-            // rotate output and copy back to the vectors storage
-            std::rotate_copy(reinterpret_cast<casa::DComplex*>(buf),
-                             reinterpret_cast<casa::DComplex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::DComplex*>(buf) + nElements,
-                             dataPtr);
+            Traits::execute(p, data);
 
             if (!forward) {
-                scaleResult(dataPtr, nElements);
+                scaleResult(data, size_t(n[0]) * (rank > 1 ? size_t(n[1]) : 1));
             }
-
-            vec.putStorage(dataPtr, deleteIt);
         }
 
         /**
-         * Execute a Single-precision FFT plan.
+         * Rotate both axes of a contiguous plane by half of their lengths, because
+         * the origin for FFTW is at 0, not n/2 (casa fft).
          */
-        static inline void fftExec(casa::Vector<casa::Complex>& vec, const bool forward,
-                            fftwf_plan& p, fftwf_complex* buf, size_t bufsz)
+        template<typename T>
+        static void rotatePlane(T* data, const size_t nx, const size_t ny)
         {
-            const size_t nElements = vec.nelements();
-            ASKAPDEBUGASSERT(nElements == bufsz);
+            // the second axis: rotate whole lines
+            std::rotate(data, data + (ny / 2) * nx, data + nx * ny);
+            // the first axis: rotate within each line
+            for (size_t line = 0; line < ny; ++line) {
+                T* lineData = data + line * nx;
+                std::rotate(lineData, lineData + (nx / 2), lineData + nx);
+            }
+        }
 
+        /**
+         * Transform a vector in-place.
+         */
+        template<typename Traits>
+        static void fft1dImpl(casa::Vector<typename Traits::Value>& vec, const bool forward)
+        {
             Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
+            typename Traits::Value *dataPtr = vec.getStorage(deleteIt);
+            const int n = vec.nelements();
 
             // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate_copy(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements,
-                    reinterpret_cast<casa::Complex*>(buf));
+            std::rotate(dataPtr, dataPtr + (n / 2), dataPtr + n);
 
-            fftwf_execute(p);
+            fftExec<Traits>(dataPtr, 1, &n, forward);
 
             // rotate output
-            std::rotate_copy(reinterpret_cast<casa::Complex*>(buf),
-                             reinterpret_cast<casa::Complex*>(buf) + (nElements / 2),
-                             reinterpret_cast<casa::Complex*>(buf) + nElements,
-                             dataPtr);
-
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
+            std::rotate(dataPtr, dataPtr + (n / 2), dataPtr + n);
 
             vec.putStorage(dataPtr, deleteIt);
         }
 
-        void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
+        /**
+         * Transform the first two axes of an array in-place, plane by plane.
+         */
+        template<typename Traits>
+        static void fft2dImpl(casa::Array<typename Traits::Value>& arr, const bool forward)
         {
-            ASKAPTRACE("fft<casa::DComplex>");
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-
-            Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
+            casa::ArrayIterator<typename Traits::Value> it(arr, 2);
 
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+            while (!it.pastEnd()) {
+                casa::Array<typename Traits::Value>& plane = it.array();
+                const size_t nx = plane.shape()(0);
+                const size_t ny = plane.shape()(1);
+                ASKAPDEBUGASSERT(nx > 0 && ny > 0);
 
-            fftw_plan p = fftw_plan_dft_1d(nElements, reinterpret_cast<fftw_complex*>(dataPtr),
-                                           reinterpret_cast<fftw_complex*>(dataPtr),
-                                           (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+                Bool deleteIt;
+                typename Traits::Value *dataPtr = plane.getStorage(deleteIt);
 
-            fftw_execute(p);
+                rotatePlane(dataPtr, nx, ny);
 
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
-            }
+                // FFTW uses the row-major order, i.e. the first casa axis is the last one here
+                const int n[2] = {static_cast<int>(ny), static_cast<int>(nx)};
+                fftExec<Traits>(dataPtr, 2, n, forward);
 
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+                rotatePlane(dataPtr, nx, ny);
 
-            vec.putStorage(dataPtr, deleteIt);
-            fftw_destroy_plan(p);
+                plane.putStorage(dataPtr, deleteIt);
+                it.next();
+            }
         }
 
-        void fft(casa::Vector<casa::Complex>& vec, const bool forward)
+        void configureFFT(const int nThreads, const FFTPlanEffort effort,
+                          const std::string &wisdomFile)
         {
-            ASKAPTRACE("fft<casa::Complex>");
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-
-            Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
+            ASKAPCHECK(nThreads > 0, "Number of FFT threads should be positive, you have " << nThreads);
+            boost::lock_guard<boost::mutex> lock(fftWrapperMutex);
 
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+            if ((nThreads > 1) && !fftThreadsInitialised) {
+                ASKAPCHECK(fftw_init_threads() != 0 && fftwf_init_threads() != 0,
+                           "Unable to initialise FFTW threads");
+                fftThreadsInitialised = true;
+            }
+            fftNumberOfThreads = nThreads;
+
+            switch (effort) {
+                case FFT_ESTIMATE:
+                    fftPlanFlags = FFTW_ESTIMATE;
+                    break;
+                case FFT_MEASURE:
+                    fftPlanFlags = FFTW_MEASURE;
+                    break;
+                case FFT_PATIENT:
+                    fftPlanFlags = FFTW_PATIENT;
+                    break;
+                default:
+                    ASKAPTHROW(AskapError, "Unknown FFT planning effort " << effort);
+            }
 
-            fftwf_plan p = fftwf_plan_dft_1d(nElements, reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-            fftwf_execute(p);
+            fftWisdomFile = wisdomFile;
+            if (fftWisdomFile != "") {
+                importWisdom<FFTWSingle>();
+                importWisdom<FFTWDouble>();
+            }
+            const char* effortNames[] = {"estimate", "measure", "patient"};
+            ASKAPLOG_INFO_STR(logger, "FFT plans will be created with effort=" << effortNames[effort] <<
+                              ", nthreads=" << nThreads <<
+                              (fftWisdomFile != "" ? ", wisdom file " : "") << fftWisdomFile);
+        }
 
-            if (!forward) {
-                scaleResult(dataPtr, nElements);
+        FFTPlanEffort fftPlanEffort(const std::string &effort)
+        {
+            const casa::String str = casa::downcase(effort);
+            if (str == "estimate") {
+                return FFT_ESTIMATE;
+            } else if (str == "measure") {
+                return FFT_MEASURE;
+            } else if (str == "patient") {
+                return FFT_PATIENT;
             }
+            ASKAPTHROW(AskapError, "Unknown FFT planning effort " << effort <<
+                       ", supported values are estimate, measure and patient");
+        }
 
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+        void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
+        {
+            ASKAPTRACE("fft<casa::DComplex>");
+            fft1dImpl<FFTWDouble>(vec, forward);
+        }
 
-            vec.putStorage(dataPtr, deleteIt);
-            fftwf_destroy_plan(p);
+        void fft(casa::Vector<casa::Complex>& vec, const bool forward)
+        {
+            ASKAPTRACE("fft<casa::Complex>");
+            fft1dImpl<FFTWSingle>(vec, forward);
         }
 
         void fft2d(casa::Array<casa::Complex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::Complex>");
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-
-            // 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::Complex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::Complex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftwf_complex* buf = (fftwf_complex*) fftw_malloc(sizeof(fftwf_complex) * bufsz);
-                fftwf_plan p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                                 (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::Complex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 4: If the row are of different length to the rows then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftwf_destroy_plan(p);
-                    fftwf_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftwf_complex* buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bufsz);
-                    p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                          (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::Complex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 6: Delete the plan and temporary buffer
-                fftwf_destroy_plan(p);
-                fftwf_free(buf);
-
-                it.next();
-            }
+            fft2dImpl<FFTWSingle>(arr, forward);
         }
 
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::DComplex>");
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-
-            /// 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::DComplex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::DComplex> mat(it.array());
-                ASKAPDEBUGASSERT(mat.ncolumn() > 0 && mat.nrow() > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = mat.nrow();
-                fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                fftw_plan p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                               (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < mat.ncolumn(); col++) {
-                    casa::Vector<casa::DComplex> vec(mat.column(col));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 4: If the rows are of different length to the columns then
-                // re-allocate buffer and regen the plan
-                if (mat.ncolumn() != mat.nrow()) {
-                    fftw_destroy_plan(p);
-                    fftw_free(buf);
-                    bufsz = mat.ncolumn();
-                    fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                    p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                         (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_MEASURE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < mat.nrow(); row++) {
-                    casa::Vector<casa::DComplex> vec(mat.row(row));
-                    fftExec(vec, forward, p, buf, bufsz);
-                }
-
-                // 6: Delete the plan and temporary buffer
-                fftw_destroy_plan(p);
-                fftw_free(buf);
-
-                it.next();
-            }
+            fft2dImpl<FFTWDouble>(arr, forward);
         }
     }
 }
@@ -35,10 +35,46 @@
 #include <casacore/casa/Arrays/Vector.h>
 #include <casacore/casa/Arrays/Array.h>
 
+// std includes
+#include <string>
+
 namespace askap
 {
     namespace scimath
     {
+        /// @brief planning effort used when a new FFTW plan has to be created
+        /// @details Plans are cached per transform shape, so the cost of a more
+        /// expensive planning mode is paid only once per shape (or not at all if
+        /// the wisdom file already has a suitable plan).
+        /// @ingroup fft
+        enum FFTPlanEffort {
+            FFT_ESTIMATE = 0,
+            FFT_MEASURE,
+            FFT_PATIENT
+        };
+
+        /// @brief configure the plans created by subsequent transforms
+        /// @details This is a process-wide setting. Plans already in the cache
+        /// are kept, new plans are created with the given parameters.
+        /// It is not safe to call this method while transforms are executed
+        /// by other threads.
+        /// @param[in] nThreads number of threads used for large 2D transforms
+        /// (1 means single-threaded execution)
+        /// @param[in] effort planning effort for new plans
+        /// @param[in] wisdomFile file to import FFTW wisdom from and to export
+        /// it to after new plans were measured. Single precision wisdom is kept
+        /// in the given file, double precision wisdom in the same file with the
+        /// ".double" suffix. An empty string disables wisdom persistence.
+        /// @ingroup fft
+        void configureFFT(const int nThreads, const FFTPlanEffort effort = FFT_ESTIMATE,
+                          const std::string &wisdomFile = "");
+
+        /// @brief convert string into the planning effort
+        /// @param[in] effort one of "estimate", "measure" or "patient" (case insensitive)
+        /// @return planning effort enum
+        /// @ingroup fft
+        FFTPlanEffort fftPlanEffort(const std::string &effort);
+
         /// @brief 1-D inplace transform
         /// @param vec Complex vector
         /// @param forward Forward transform?
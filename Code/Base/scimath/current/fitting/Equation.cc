@@ -80,7 +80,7 @@ namespace askap
            // use assignment operator of Params class, i.e. 
            // copy will happen at itsParams side and shared pointer will
            // not change (we somewhat rely on this behavior in the calibration
-           // code)
+           // code). Parameters with shared storage are referenced rather than copied
            *rwParameters() = ip;
        } else {
          // current parameters are empty, clone the input parameters and setup
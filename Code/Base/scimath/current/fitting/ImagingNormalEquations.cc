@@ -664,6 +664,163 @@ const std::map<std::string, casa::Vector<double> >& ImagingNormalEquations::data
       }
       return result;
     } // unknowns method
+
+    /// @brief write the layout of these normal equations to a blob stream
+    /// @details The layout is everything except the content of the vectors:
+    /// shapes, reference points, coordinate systems and lengths of all vectors
+    /// for every parameter. Together with contiguousBuffers, it allows to sum
+    /// normal equations across processes without serialising the vectors.
+    /// @param[in] os the output stream
+    void ImagingNormalEquations::writeLayoutToBlob(LOFAR::BlobOStream& os) const
+    {
+      os.putStart("nelayout", 1);
+      os << itsShape << itsReference << itsCoordSys << vectorLengths();
+      os.putEnd();
+    }
+
+    /// @brief check the layout read from a blob stream
+    /// @details Normal equations without data (e.g. those created from the
+    /// model for the solver) are compatible with any layout. Otherwise, the
+    /// parameters, shapes, reference points, vector lengths and coordinate
+    /// systems have to match, so the normal equations can be summed element by element
+    /// (which is equivalent to merge in this case).
+    /// @param[in] is the input stream (written by writeLayoutToBlob)
+    /// @param[in] adopt if true and these normal equations have no data, they
+    ///            are set up with zero vectors according to the layout
+    /// @return true, if the layout is compatible
+    bool ImagingNormalEquations::matchLayoutFromBlob(LOFAR::BlobIStream& is, bool adopt)
+    {
+      std::map<std::string, casa::IPosition> shape;
+      std::map<std::string, casa::IPosition> reference;
+      std::map<std::string, casa::CoordinateSystem> coordSys;
+      std::map<std::string, casa::IPosition> lengths;
+      const int version = is.getStart("nelayout");
+      ASKAPCHECK(version == 1, "Unsupported version of the normal equations layout: "<<version);
+      is >> shape >> reference >> coordSys >> lengths;
+      is.getEnd();
+
+      if (hasNoData()) {
+          if (adopt) {
+              itsShape = shape;
+              itsReference = reference;
+              itsCoordSys = coordSys;
+              itsNormalMatrixSlice.clear();
+              itsNormalMatrixDiagonal.clear();
+              itsPreconditionerSlice.clear();
+              itsDataVector.clear();
+              for (std::map<std::string, casa::IPosition>::const_iterator ci = lengths.begin();
+                   ci != lengths.end(); ++ci) {
+                   ASKAPDEBUGASSERT(ci->second.nelements() == 4);
+                   itsNormalMatrixSlice[ci->first] = casa::Vector<double>(ci->second(0), 0.);
+                   itsNormalMatrixDiagonal[ci->first] = casa::Vector<double>(ci->second(1), 0.);
+                   itsPreconditionerSlice[ci->first] = casa::Vector<double>(ci->second(2), 0.);
+                   itsDataVector[ci->first] = casa::Vector<double>(ci->second(3), 0.);
+              }
+          }
+          return true;
+      }
+
+      const std::map<std::string, casa::IPosition> ownLengths = vectorLengths();
+      if ((lengths.size() != ownLengths.size()) || (shape.size() != itsShape.size()) ||
+          (reference.size() != itsReference.size()) || (coordSys.size() != itsCoordSys.size())) {
+          return false;
+      }
+      imagemath::LinmosAccumulator<double> accumulator;
+      for (std::map<std::string, casa::IPosition>::const_iterator ci = lengths.begin();
+           ci != lengths.end(); ++ci) {
+           const std::string &name = ci->first;
+           const std::map<std::string, casa::IPosition>::const_iterator ownLen = ownLengths.find(name);
+           if ((ownLen == ownLengths.end()) || !ownLen->second.isEqual(ci->second)) {
+               return false;
+           }
+           const std::map<std::string, casa::IPosition>::const_iterator newShape = shape.find(name);
+           const std::map<std::string, casa::IPosition>::const_iterator ownShape = itsShape.find(name);
+           if ((newShape == shape.end()) || (ownShape == itsShape.end()) ||
+               !newShape->second.isEqual(ownShape->second)) {
+               return false;
+           }
+           const std::map<std::string, casa::IPosition>::const_iterator newRef = reference.find(name);
+           const std::map<std::string, casa::IPosition>::const_iterator ownRef = itsReference.find(name);
+           if ((newRef == reference.end()) || (ownRef == itsReference.end()) ||
+               !newRef->second.isEqual(ownRef->second)) {
+               return false;
+           }
+           const std::map<std::string, casa::CoordinateSystem>::const_iterator newCS = coordSys.find(name);
+           const std::map<std::string, casa::CoordinateSystem>::const_iterator ownCS = itsCoordSys.find(name);
+           if ((newCS == coordSys.end()) || (ownCS == itsCoordSys.end()) ||
+               (newCS->second.nCoordinates() != ownCS->second.nCoordinates())) {
+               return false;
+           }
+           if ((newCS->second.nCoordinates() > 0) && !accumulator.coordinatesAreEqual(newCS->second,
+                               ownCS->second, newShape->second, ownShape->second)) {
+               return false;
+           }
+      }
+      return true;
+    }
+
+    /// @brief obtain the storage of all vectors
+    /// @details This method gives raw access to the vectors, e.g. to sum them
+    /// in place across processes. The order of buffers is the same for all
+    /// normal equations with the same layout.
+    /// @param[out] buffers pointers to the first element and lengths of all non-empty vectors
+    void ImagingNormalEquations::contiguousBuffers(std::vector<std::pair<double*, size_t> > &buffers)
+    {
+      buffers.clear();
+      std::map<std::string, casa::Vector<double> >* maps[4] = {&itsNormalMatrixSlice,
+               &itsNormalMatrixDiagonal, &itsPreconditionerSlice, &itsDataVector};
+      const std::vector<std::string> names = unknowns();
+      for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+           for (size_t i = 0; i < 4; ++i) {
+                const std::map<std::string, casa::Vector<double> >::iterator it = maps[i]->find(*ci);
+                if ((it != maps[i]->end()) && (it->second.nelements() > 0)) {
+                    ASKAPCHECK(it->second.contiguousStorage(), "Vector "<<i<<" of parameter "<<*ci<<
+                               " is expected to have contiguous storage");
+                    buffers.push_back(std::make_pair(it->second.data(), size_t(it->second.nelements())));
+                }
+           }
+      }
+    }
+
+    /// @brief check whether these normal equations contain any data
+    /// @return true, if all vectors are empty
+    bool ImagingNormalEquations::hasNoData() const
+    {
+      const std::map<std::string, casa::IPosition> lengths = vectorLengths();
+      for (std::map<std::string, casa::IPosition>::const_iterator ci = lengths.begin();
+           ci != lengths.end(); ++ci) {
+           for (size_t i = 0; i < ci->second.nelements(); ++i) {
+                if (ci->second(i) > 0) {
+                    return false;
+                }
+           }
+      }
+      return true;
+    }
+
+    /// @brief lengths of all vectors for every parameter
+    /// @details Elements of the returned IPosition are the lengths of the normal
+    /// matrix slice, normal matrix diagonal, preconditioner slice and data vector
+    /// for the given parameter (zero, if the vector is missing).
+    /// @return map of lengths
+    std::map<std::string, casa::IPosition> ImagingNormalEquations::vectorLengths() const
+    {
+      const std::map<std::string, casa::Vector<double> >* maps[4] = {&itsNormalMatrixSlice,
+               &itsNormalMatrixDiagonal, &itsPreconditionerSlice, &itsDataVector};
+      std::map<std::string, casa::IPosition> result;
+      const std::vector<std::string> names = unknowns();
+      for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+           casa::IPosition lengths(4, 0);
+           for (size_t i = 0; i < 4; ++i) {
+                const std::map<std::string, casa::Vector<double> >::const_iterator it = maps[i]->find(*ci);
+                if (it != maps[i]->end()) {
+                    lengths(i) = it->second.nelements();
+                }
+           }
+           result[*ci] = lengths;
+      }
+      return result;
+    }
     
   } // namespace scimath
 } // namespace askap
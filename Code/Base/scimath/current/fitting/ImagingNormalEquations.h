@@ -51,6 +51,11 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 namespace askap
 {
   namespace scimath
@@ -248,8 +253,46 @@ namespace askap
       /// @param[in] is the input stream
       /// @note Not sure whether the parameter should be made const or not 
       virtual void readFromBlob(LOFAR::BlobIStream& is); 
+
+      /// @brief write the layout of these normal equations to a blob stream
+      /// @details The layout is everything except the content of the vectors:
+      /// shapes, reference points, coordinate systems and lengths of all vectors
+      /// for every parameter. Together with contiguousBuffers, it allows to sum
+      /// normal equations across processes without serialising the vectors.
+      /// @param[in] os the output stream
+      void writeLayoutToBlob(LOFAR::BlobOStream& os) const;
+
+      /// @brief check the layout read from a blob stream
+      /// @details Normal equations without data (e.g. those created from the
+      /// model for the solver) are compatible with any layout. Otherwise, the
+      /// parameters, shapes, reference points, vector lengths and coordinate
+      /// systems have to match, so the normal equations can be summed element by element
+      /// (which is equivalent to merge in this case).
+      /// @param[in] is the input stream (written by writeLayoutToBlob)
+      /// @param[in] adopt if true and these normal equations have no data, they
+      ///            are set up with zero vectors according to the layout
+      /// @return true, if the layout is compatible
+      bool matchLayoutFromBlob(LOFAR::BlobIStream& is, bool adopt);
+
+      /// @brief obtain the storage of all vectors
+      /// @details This method gives raw access to the vectors, e.g. to sum them
+      /// in place across processes. The order of buffers is the same for all
+      /// normal equations with the same layout.
+      /// @param[out] buffers pointers to the first element and lengths of all non-empty vectors
+      void contiguousBuffers(std::vector<std::pair<double*, size_t> > &buffers);
               
     private:
+      /// @brief check whether these normal equations contain any data
+      /// @return true, if all vectors are empty
+      bool hasNoData() const;
+
+      /// @brief lengths of all vectors for every parameter
+      /// @details Elements of the returned IPosition are the lengths of the normal
+      /// matrix slice, normal matrix diagonal, preconditioner slice and data vector
+      /// for the given parameter (zero, if the vector is missing).
+      /// @return map of lengths
+      std::map<std::string, casa::IPosition> vectorLengths() const;
+
       /// A slice through a specified plane
       std::map<std::string, casa::Vector<double> > itsNormalMatrixSlice;
       /// The diagonal 
@@ -40,7 +40,6 @@
 
 #include <askap/AskapUtil.h>
 #include <askap/AskapError.h>
-#include <utils/DeepCopyUtils.h>
 
 #include <iostream>
 #include <map>
@@ -60,9 +59,9 @@ namespace askap
 		}
 
 		Params::Params(const Params& other) :  itsAxes(other.itsAxes),
-		      itsFree(other.itsFree)
+		      itsFree(other.itsFree), itsShared(other.itsShared)
 		{
-            deepCopyOfSTDMap(other.itsArrays, itsArrays);
+            copyArrays(other);
  
 			// itsChangeMonitors is not copied deliberately
 			ASKAPDEBUGASSERT(itsChangeMonitors.size() == 0);
@@ -72,7 +71,9 @@ namespace askap
 		{
 			if(this!=&other)
 			{
-                deepCopyOfSTDMap(other.itsArrays, itsArrays);
+                // old values are released rather than overwritten, so shared storage is never written to
+                itsShared=other.itsShared;
+                copyArrays(other);
 				itsAxes=other.itsAxes;
 				itsFree=other.itsFree;
 				// change monitor map is reset deliberately
@@ -81,6 +82,23 @@ namespace askap
 			return *this;
 		}
 		
+        /// @brief copy values from another object
+        /// @details Parameters which are not shared are copied, shared parameters
+        /// are referenced to keep using the same storage.
+        /// @param[in] other object to take the values from
+        void Params::copyArrays(const Params &other)
+        {
+            itsArrays.clear();
+            for (std::map<std::string, casa::Array<double> >::const_iterator ci = other.itsArrays.begin();
+                 ci != other.itsArrays.end(); ++ci) {
+                 if (other.isShared(ci->first)) {
+                     itsArrays[ci->first].reference(ci->second);
+                 } else {
+                     itsArrays[ci->first] = ci->second.copy();
+                 }
+            }
+        }
+
 		/// @brief make a slice of another params class
         /// @details This method extracts one or more parameters 
         /// from the given Params object and stores them in the 
@@ -207,6 +225,7 @@ namespace askap
 		void Params::update(const std::string& name, const casa::Array<double>& ip)
 		{
 			ASKAPCHECK(has(name), "Parameter " + name + " does not already exist");
+			ASKAPCHECK(!isShared(name), "Parameter " + name + " refers to shared storage and is read-only");
 			itsArrays[name]=ip.copy();
 			itsFree[name]=true;
             notifyAboutChange(name);	
@@ -225,6 +244,7 @@ namespace askap
                             const casa::IPosition &blc)
         {
            ASKAPCHECK(has(name), "Parameter " + name + " does not already exist");
+           ASKAPCHECK(!isShared(name), "Parameter " + name + " refers to shared storage and is read-only");
            ASKAPDEBUGASSERT(value.shape().nelements() == blc.nelements());
            casa::Array<double> &arr = itsArrays[name];
            casa::IPosition trc(value.shape());
@@ -241,6 +261,36 @@ namespace askap
            notifyAboutChange(name);
         }		
 		
+        /// @brief add a parameter sharing storage with the given array
+        /// @details Unlike add and update, this method doesn't copy the value, so the
+        /// parameter refers to the same storage as the given array (e.g. memory shared
+        /// between processes, which is not owned by this object). An existing parameter
+        /// with the same name is replaced. Copies of this object (including clone) keep
+        /// referring to the same storage. Shared parameters are read-only, update
+        /// methods and non-const value access throw an exception for them.
+        /// @param[in] name parameter name
+        /// @param[in] value array to refer to
+        /// @param[in] axes axes of the parameter
+        /// @param[in] free true, if the parameter is free
+        void Params::share(const std::string &name, const casa::Array<double> &value,
+                           const Axes &axes, const bool free)
+        {
+            // assignment would copy the values, reference the storage instead
+            itsArrays[name].reference(value);
+            itsFree[name] = free;
+            itsAxes[name] = axes;
+            itsShared.insert(name);
+            notifyAboutChange(name);
+        }
+
+        /// @brief check whether the parameter refers to shared storage
+        /// @param[in] name parameter name
+        /// @return true, if the parameter has been set up with share
+        bool Params::isShared(const std::string &name) const
+        {
+            return itsShared.find(name) != itsShared.end();
+        }
+
 		/// @brief Add an empty array parameter        
         /// @details This version of the method creates a new array parameter with the
         /// given shape. It is largely intended to be used together with the partial slice
@@ -293,6 +343,7 @@ namespace askap
 		void Params::update(const std::string& name, const double ip)
 		{
 			ASKAPCHECK(has(name), "Parameter " + name + " does not already exist");
+			ASKAPCHECK(!isShared(name), "Parameter " + name + " refers to shared storage and is read-only");
 			casa::Array<double> ipArray(casa::IPosition(1,1));
 			ipArray(casa::IPosition(1,0))=ip;
 			itsArrays[name]=ipArray.copy();
@@ -325,6 +376,7 @@ namespace askap
 		casa::Array<double>& Params::value(const std::string& name)
 		{
 			ASKAPCHECK(has(name), "Parameter " + name + " does not already exist");
+			ASKAPCHECK(!isShared(name), "Parameter " + name + " refers to shared storage and is read-only");
 			notifyAboutChange(name);
 			return itsArrays.find(name)->second;
 		}
@@ -486,6 +538,7 @@ namespace askap
           itsArrays.erase(name);
           itsAxes.erase(name);
           itsFree.erase(name);
+          itsShared.erase(name);
           // change monitor map doesn't need to contain all parameters
           std::map<std::string, ChangeMonitor>::iterator it = itsChangeMonitors.find(name);
           if (it != itsChangeMonitors.end()) {          
@@ -499,6 +552,7 @@ namespace askap
 			itsArrays.clear();
 			itsAxes.clear();
 			itsFree.clear();
+			itsShared.clear();
 			itsChangeMonitors.clear();
 		}
 
@@ -631,6 +685,12 @@ bool Params::isChanged(const std::string &name, const ChangeMonitor &cm) const
 		    ASKAPCHECK(version == BLOBVERSION, 
 		        "Attempting to read from a blob stream a Params object of the wrong version, expect "<<
 		        BLOBVERSION<<" got "<<version);		
+			// drop references to shared storage, so it is not overwritten
+			for (std::set<std::string>::const_iterator ci = par.itsShared.begin();
+			     ci != par.itsShared.end(); ++ci) {
+			     par.itsArrays.erase(*ci);
+			}
+			par.itsShared.clear();
 			is >> par.itsArrays >> par.itsAxes >> par.itsFree;
             is.getEnd();
             // as the object has been updated one needs to obtain new change monitor
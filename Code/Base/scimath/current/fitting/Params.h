@@ -49,6 +49,7 @@
 #include <utils/ChangeMonitor.h>
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include <ostream>
@@ -125,6 +126,25 @@ void add(const std::string &name, const casa::IPosition &shape, const Axes &axes
 /// @param[in] value a value of the paramter to be added
 void addComplexVector(const std::string &name, const casa::Vector<casa::Complex> &value);
 
+        /// @brief add a parameter sharing storage with the given array
+        /// @details Unlike add and update, this method doesn't copy the value, so the
+        /// parameter refers to the same storage as the given array (e.g. memory shared
+        /// between processes, which is not owned by this object). An existing parameter
+        /// with the same name is replaced. Copies of this object (including clone) keep
+        /// referring to the same storage. Shared parameters are read-only, update
+        /// methods and non-const value access throw an exception for them.
+        /// @param[in] name parameter name
+        /// @param[in] value array to refer to
+        /// @param[in] axes axes of the parameter
+        /// @param[in] free true, if the parameter is free
+        void share(const std::string &name, const casa::Array<double> &value,
+                   const Axes &axes, const bool free = true);
+
+        /// @brief check whether the parameter refers to shared storage
+        /// @param[in] name parameter name
+        /// @return true, if the parameter has been set up with share
+        bool isShared(const std::string &name) const;
+
         /// @brief remove a parameter
         /// @details One needs to be able to remove a given parameter to avoid passing
         /// unused parameters to design matrix.
@@ -192,6 +212,7 @@ void updateComplexVector(const std::string &name, const casa::Vector<casa::Compl
         const casa::Array<double>& value(const std::string& name) const;
 
 /// Return array value for the parameter with this name (non-const)
+/// @note An exception is thrown for shared parameters, use the const version to read them
 /// @param name Name of param
         casa::Array<double>& value(const std::string& name);
 
@@ -327,6 +348,12 @@ casa::Vector<casa::Complex> complexVectorValue(const std::string &name) const;
         void notifyAboutChange(const std::string &name); 
         
      private:
+        /// @brief copy values from another object
+        /// @details Parameters which are not shared are copied, shared parameters
+        /// are referenced to keep using the same storage.
+        /// @param[in] other object to take the values from
+        void copyArrays(const Params &other);
+
         /// @todo Use single map map<string, struct>
         /// The value arrays, ordered as a map
         std::map<std::string, casa::Array<double> > itsArrays;
@@ -334,6 +361,8 @@ casa::Vector<casa::Complex> complexVectorValue(const std::string &name) const;
         std::map<std::string, Axes> itsAxes;
         /// The free/fixed status, ordered as a map
         std::map<std::string, bool> itsFree;
+        /// @brief names of parameters referring to the storage not owned by this object
+        std::set<std::string> itsShared;
         /// The update count, ordered as a map. This is logically a cache 
 
         /// @brief change monitors for all tracked parameters
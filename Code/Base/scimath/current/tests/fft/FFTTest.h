@@ -137,6 +137,40 @@ static bool forward_backward_test(const int N, casa::Matrix<T>& mat, MetricNames
     return returnVal;
 }
 
+//---------------------------------------------------------------------------------------------
+template <typename T>
+static bool fft2d_test(const int nRow, const int nCol, MetricNames metric, const double diffP)
+{
+    casa::Matrix<T> mat(nRow, nCol);
+    for(int c=0; c < nCol; c++){
+        for(int r = 0; r < nRow; r++){
+            mat(r,c) = T(myRand(-0.5,0.5), myRand(-0.5,0.5));
+        }
+    }
+    bool returnVal = true;
+    double diff = 0.0;
+    for (int pass = 0; pass < 2; ++pass) {
+         const bool forward = (pass == 0);
+         casa::Matrix<T> expected = mat.copy();
+         for(int c=0; c<nCol; c++){
+             casa::Vector<T> y = expected.column(c);
+             askap::scimath::fft(y, forward);
+         }
+         for(int r=0; r<nRow; r++){
+             casa::Vector<T> y = expected.row(r);
+             askap::scimath::fft(y, forward);
+         }
+         // the second transform of the same shape reuses the cached plan
+         for (int rep = 0; rep < 2; ++rep) {
+              casa::Matrix<T> result = mat.copy();
+              askap::scimath::fft2d(result, forward);
+              returnVal = returnVal && test_for_equality(result, expected, metric, diffP, diff);
+         }
+         mat = expected;
+    }
+    return returnVal;
+}
+
 //===============================================================================================
 
 namespace askap
@@ -150,6 +184,8 @@ namespace askap
       CPPUNIT_TEST_SUITE(FFTTest);
       CPPUNIT_TEST(testForwardBackwardSinglePrecision);
       CPPUNIT_TEST(testForwardBackwardDoublePrecision);      
+      CPPUNIT_TEST(test2DSinglePrecision);
+      CPPUNIT_TEST(test2DDoublePrecision);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -194,6 +230,22 @@ namespace askap
                 CPPUNIT_ASSERT(forward_backward_test(N, dp_mat, NRMSE, dp_precision) == true);
             }
         }
+
+        void test2DSinglePrecision()
+        {
+            // non-square and odd shapes exercise the axis rotation, absolute error is
+            // used because both sides are computed with the same precision
+            CPPUNIT_ASSERT(fft2d_test<casa::Complex>(64, 32, RMSE, 1e-4));
+            CPPUNIT_ASSERT(fft2d_test<casa::Complex>(15, 24, RMSE, 1e-4));
+            CPPUNIT_ASSERT(fft2d_test<casa::Complex>(128, 128, RMSE, 1e-4));
+        }
+
+        void test2DDoublePrecision()
+        {
+            CPPUNIT_ASSERT(fft2d_test<casa::DComplex>(64, 32, RMSE, 1e-10));
+            CPPUNIT_ASSERT(fft2d_test<casa::DComplex>(15, 24, RMSE, 1e-10));
+            CPPUNIT_ASSERT(fft2d_test<casa::DComplex>(128, 128, RMSE, 1e-10));
+        }
         
     };
     
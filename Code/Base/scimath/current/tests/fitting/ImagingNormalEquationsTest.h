@@ -58,6 +58,7 @@ namespace askap
       CPPUNIT_TEST_EXCEPTION(testAddWrongDimension, askap::AskapError);
 #endif // #ifdef ASKAP_DEBUG
       CPPUNIT_TEST(testBlobStream);
+      CPPUNIT_TEST(testLayout);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -410,6 +411,62 @@ namespace askap
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Value1") != params.end());
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Image2") != params.end());                                                            
         }
+
+        void testLayout() {
+          p1->addSlice("Image", casa::Vector<double>(5,0.1), casa::Vector<double>(5, 1.),
+                  casa::Vector<double>(5,0.5), casa::Vector<double>(5,-40.),
+                  casa::IPosition(1,5), casa::IPosition(1,0));
+          p3->addSlice("Image", casa::Vector<double>(4,0.1), casa::Vector<double>(4, 1.),
+                  casa::Vector<double>(4,0.5), casa::Vector<double>(4,-40.),
+                  casa::IPosition(1,4), casa::IPosition(1,0));
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          p1->writeLayoutToBlob(bos);
+
+          // empty normal equations (as created for the solver) adopt the layout
+          Params ip;
+          ip.add("Image");
+          p2.reset(new ImagingNormalEquations(ip));
+          {
+            LOFAR::BlobIBufString bib(b1);
+            LOFAR::BlobIStream bis(bib);
+            CPPUNIT_ASSERT(p2->matchLayoutFromBlob(bis, true));
+          }
+          testAllElements(p2->dataVector("Image"),5,0.);
+          // the layout is now the same, check again without adopting
+          {
+            LOFAR::BlobIBufString bib(b1);
+            LOFAR::BlobIStream bis(bib);
+            CPPUNIT_ASSERT(p2->matchLayoutFromBlob(bis, false));
+          }
+          // different vector lengths
+          {
+            LOFAR::BlobIBufString bib(b1);
+            LOFAR::BlobIStream bis(bib);
+            CPPUNIT_ASSERT(!p3->matchLayoutFromBlob(bis, true));
+          }
+          testAllElements(p3->dataVector("Image"),4,-40.);
+
+          // add twice the first normal equations element by element
+          std::vector<std::pair<double*, size_t> > buf1;
+          std::vector<std::pair<double*, size_t> > buf2;
+          p1->contiguousBuffers(buf1);
+          p2->contiguousBuffers(buf2);
+          CPPUNIT_ASSERT_EQUAL(size_t(4), buf1.size());
+          CPPUNIT_ASSERT_EQUAL(buf1.size(), buf2.size());
+          for (size_t i = 0; i < buf1.size(); ++i) {
+               CPPUNIT_ASSERT_EQUAL(buf1[i].second, buf2[i].second);
+               for (size_t elem = 0; elem < buf1[i].second; ++elem) {
+                    buf2[i].first[elem] += 2. * buf1[i].first[elem];
+               }
+          }
+          testAllElements(p2->normalMatrixSlice("Image"),5,0.2);
+          testAllElements(p2->normalMatrixDiagonal("Image"),5,2.);
+          testAllElements(p2->preconditionerSlice("Image"),5,1.);
+          testAllElements(p2->dataVector("Image"),5,-80.);
+        }
+
     protected:
         /// @brief a helper method to access map elements
         /// @details This method extracts a casa::Vector out of the map
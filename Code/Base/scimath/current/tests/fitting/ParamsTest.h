@@ -36,6 +36,8 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <vector>
+
 namespace askap
 {
   namespace scimath
@@ -53,6 +55,10 @@ namespace askap
       CPPUNIT_TEST(testCompletions);
       CPPUNIT_TEST(testCopy);
       CPPUNIT_TEST(testArraySlice);
+      CPPUNIT_TEST(testSharedStorage);
+      CPPUNIT_TEST(testSharedCopy);
+      CPPUNIT_TEST_EXCEPTION(testSharedUpdate, askap::CheckError);
+      CPPUNIT_TEST_EXCEPTION(testSharedWriteAccess, askap::CheckError);
       CPPUNIT_TEST(testComplexVector);
       CPPUNIT_TEST(testBlobStream);
       CPPUNIT_TEST_EXCEPTION(testDuplicate, askap::CheckError);
@@ -201,6 +207,67 @@ namespace askap
           
         }
 
+        void testSharedStorage()
+        {
+          std::vector<double> storage(6, 2.);
+          casa::Array<double> external(casa::IPosition(2,2,3), &storage[0], casa::SHARE);
+          p1->add("Value", 1.);
+          p1->share("Value", external, Axes(), false);
+          CPPUNIT_ASSERT(!p1->isFree("Value"));
+          const Params &cp1 = *p1;
+          CPPUNIT_ASSERT(cp1.value("Value").shape() == casa::IPosition(2,2,3));
+          // no copy is made
+          CPPUNIT_ASSERT(cp1.value("Value").data() == &storage[0]);
+          storage[5] = 3.;
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(3., cp1.value("Value")(casa::IPosition(2,1,2)), 1e-7);
+          p1->share("NewValue", external, Axes());
+          CPPUNIT_ASSERT(p1->isFree("NewValue"));
+          CPPUNIT_ASSERT_EQUAL(size_t(2), p1->names().size());
+        }
+
+        void testSharedCopy()
+        {
+          std::vector<double> storage(6, 2.);
+          casa::Array<double> external(casa::IPosition(2,2,3), &storage[0], casa::SHARE);
+          p1->add("Private", 1.);
+          p1->share("Value", external, Axes());
+          CPPUNIT_ASSERT(p1->isShared("Value"));
+          CPPUNIT_ASSERT(!p1->isShared("Private"));
+          // copies refer to the same storage for shared parameters only
+          const boost::shared_ptr<const Params> cloned = p1->clone();
+          CPPUNIT_ASSERT(cloned->isShared("Value"));
+          CPPUNIT_ASSERT(cloned->value("Value").data() == &storage[0]);
+          CPPUNIT_ASSERT(cloned->value("Private").data() != p1->value("Private").data());
+          p2->add("Value", 3.);
+          *p2 = *p1;
+          const Params &cp2 = *p2;
+          CPPUNIT_ASSERT(cp2.value("Value").data() == &storage[0]);
+          // assignment releases the shared storage without writing to it
+          *p2 = *p3;
+          CPPUNIT_ASSERT(!p2->has("Value"));
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(2., storage[0], 1e-7);
+          p1->remove("Value");
+          CPPUNIT_ASSERT(!p1->isShared("Value"));
+        }
+
+        void testSharedUpdate()
+        {
+          std::vector<double> storage(6, 2.);
+          casa::Array<double> external(casa::IPosition(2,2,3), &storage[0], casa::SHARE);
+          p1->share("Value", external, Axes());
+          // shared parameters are read-only
+          p1->update("Value", casa::Array<double>(casa::IPosition(2,2,3), 1.));
+        }
+
+        void testSharedWriteAccess()
+        {
+          std::vector<double> storage(6, 2.);
+          casa::Array<double> external(casa::IPosition(2,2,3), &storage[0], casa::SHARE);
+          p1->share("Value", external, Axes());
+          // non-const access would allow writing into the shared storage
+          p1->value("Value").set(1.);
+        }
+
         void testIndices()
         {
           CPPUNIT_ASSERT( p1->size()==0);
@@ -38,6 +38,7 @@
 #include <catalogues/CasdaPolarisationEntry.h>
 #include <catalogues/CasdaComponent.h>
 #include <catalogues/ComponentCatalogue.h>
+#include <polarisation/FaradayDepthTransform.h>
 
 #include <Blob/BlobString.h>
 #include <Blob/BlobIBufString.h>
@@ -79,6 +80,9 @@ void DistributedRMsynthesis::parameterise()
             itsOutputList.push_back(pol);
         }
 
+        // The Faraday depth transforms are shared by all components
+        // with the same frequency setup - release them once done
+        FaradayDepthTransform::clearCache();
 
     }
 
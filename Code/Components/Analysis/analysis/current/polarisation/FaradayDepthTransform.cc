@@ -0,0 +1,148 @@
+/// @file
+///
+/// Cached Faraday-depth transform used by RM Synthesis
+///
+/// @copyright (c) 2014 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <polarisation/FaradayDepthTransform.h>
+#include <askap_analysis.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+#include <cmath>
+
+///@brief Where the log messages go.
+ASKAP_LOGGER(logger, ".fdtransform");
+
+namespace askap {
+
+namespace analysis {
+
+/// Maximum number of distinct transforms kept in the cache
+static const size_t maxCachedTransforms = 8;
+
+/// The cached transforms, most recently created last
+static std::vector<boost::shared_ptr<const FaradayDepthTransform> > theTransformCache;
+
+/// Protects theTransformCache
+static boost::mutex theTransformCacheMutex;
+
+FaradayDepthTransform::FaradayDepthTransform(const casa::Vector<float> &lsq,
+                                             const casa::Vector<float> &phi):
+    itsLamSq(lsq.copy()),
+    itsPhi(phi.copy()),
+    itsCos(lsq.size() * phi.size()),
+    itsSin(lsq.size() * phi.size())
+{
+    const size_t numPhi = itsPhi.size();
+    for (size_t k = 0; k < itsLamSq.size(); k++) {
+        for (size_t j = 0; j < numPhi; j++) {
+            const double phase = 2. * double(itsPhi[j]) * double(itsLamSq[k]);
+            itsCos[k * numPhi + j] = cos(phase);
+            itsSin[k * numPhi + j] = sin(phase);
+        }
+    }
+}
+
+boost::shared_ptr<const FaradayDepthTransform>
+FaradayDepthTransform::get(const casa::Vector<float> &lsq, const casa::Vector<float> &phi)
+{
+    // the lock is held while a new transform is created, so concurrent
+    // requests for the same setup do not build it twice
+    boost::mutex::scoped_lock lock(theTransformCacheMutex);
+    for (size_t i = 0; i < theTransformCache.size(); i++) {
+        if (theTransformCache[i]->matches(lsq, phi)) {
+            return theTransformCache[i];
+        }
+    }
+
+    ASKAPLOG_DEBUG_STR(logger, "Creating Faraday depth transform for " << lsq.size() <<
+                       " channels and " << phi.size() << " Faraday depths");
+    boost::shared_ptr<const FaradayDepthTransform> transform(new FaradayDepthTransform(lsq, phi));
+    if (theTransformCache.size() >= maxCachedTransforms) {
+        theTransformCache.erase(theTransformCache.begin());
+    }
+    theTransformCache.push_back(transform);
+    return transform;
+}
+
+void FaradayDepthTransform::clearCache()
+{
+    boost::mutex::scoped_lock lock(theTransformCacheMutex);
+    theTransformCache.clear();
+}
+
+bool FaradayDepthTransform::matches(const casa::Vector<float> &lsq,
+                                    const casa::Vector<float> &phi) const
+{
+    return (lsq.size() == itsLamSq.size()) && (phi.size() == itsPhi.size()) &&
+           casa::allEQ(lsq, itsLamSq) && casa::allEQ(phi, itsPhi);
+}
+
+void FaradayDepthTransform::transform(const casa::Vector<casa::Complex> &spectrum,
+                                      const float refLambdaSq,
+                                      casa::Vector<casa::Complex> &result) const
+{
+    ASKAPASSERT(spectrum.size() == itsLamSq.size());
+    const size_t numPhi = itsPhi.size();
+
+    // result_j = sum_k p_k (cos(2 phi_j lsq_k) - i sin(2 phi_j lsq_k)),
+    // accumulated one channel at a time so the inner loop runs over
+    // contiguous Faraday depths
+    std::vector<float> sumReal(numPhi, 0.), sumImag(numPhi, 0.);
+    for (size_t k = 0; k < itsLamSq.size(); k++) {
+        const float pReal = spectrum[k].real();
+        const float pImag = spectrum[k].imag();
+        if ((pReal == 0.) && (pImag == 0.)) {
+            continue;
+        }
+        const float *cosTerm = &itsCos[k * numPhi];
+        const float *sinTerm = &itsSin[k * numPhi];
+        for (size_t j = 0; j < numPhi; j++) {
+            sumReal[j] += pReal * cosTerm[j] + pImag * sinTerm[j];
+            sumImag[j] += pImag * cosTerm[j] - pReal * sinTerm[j];
+        }
+    }
+
+    // rotate by exp(2i phi_j refLambdaSq) to refer to the reference lambda-squared
+    result.resize(numPhi);
+    for (size_t j = 0; j < numPhi; j++) {
+        const double phase = 2. * double(itsPhi[j]) * double(refLambdaSq);
+        const float rotReal = cos(phase);
+        const float rotImag = sin(phase);
+        result[j] = casa::Complex(sumReal[j] * rotReal - sumImag[j] * rotImag,
+                                  sumReal[j] * rotImag + sumImag[j] * rotReal);
+    }
+}
+
+}
+
+}
@@ -0,0 +1,102 @@
+/// @file
+///
+/// Cached Faraday-depth transform used by RM Synthesis
+///
+/// @copyright (c) 2014 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_ANALYSIS_FARADAY_DEPTH_TRANSFORM_H_
+#define ASKAP_ANALYSIS_FARADAY_DEPTH_TRANSFORM_H_
+
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+namespace askap {
+
+namespace analysis {
+
+/// @brief The transform between lambda-squared and Faraday depth
+/// @details This holds the phase terms exp(-2i phi_j lambda^2_k) for a
+/// given set of lambda-squared channels and Faraday depths, so that the
+/// Faraday Dispersion Function of any spectrum sampled at those channels is
+/// a single complex matrix-vector product. The dependence on the reference
+/// lambda-squared (which depends on the weights) is factored out as a
+/// phase rotation of the result. The phase terms are evaluated in double
+/// precision.
+///
+/// Catalogues of many components typically share the same frequency
+/// setup, so the transforms are cached and shared between RMSynthesis
+/// objects through the get() method. Access to the cache is serialised,
+/// so get() and clearCache() can be called from several threads.
+class FaradayDepthTransform {
+    public:
+        /// @brief Evaluate the phase terms
+        /// @param[in] lsq lambda-squared values of the channels [m2]
+        /// @param[in] phi Faraday depth values [rad/m2]
+        FaradayDepthTransform(const casa::Vector<float> &lsq,
+                              const casa::Vector<float> &phi);
+
+        /// @brief Shared transform for the given channels and Faraday depths
+        /// @details Returns a cached transform if one has been created for
+        /// the same lambda-squared and Faraday depth values, otherwise
+        /// creates a new one and adds it to the cache.
+        /// @param[in] lsq lambda-squared values of the channels [m2]
+        /// @param[in] phi Faraday depth values [rad/m2]
+        static boost::shared_ptr<const FaradayDepthTransform>
+        get(const casa::Vector<float> &lsq, const casa::Vector<float> &phi);
+
+        /// @brief Remove all cached transforms
+        static void clearCache();
+
+        /// @brief Transform a (weighted) spectrum to Faraday depth
+        /// @details Calculates
+        /// result_j = sum_k spectrum_k exp(-2i phi_j (lsq_k - refLambdaSq)).
+        /// @param[in] spectrum complex spectrum, one value per channel
+        /// @param[in] refLambdaSq reference lambda-squared value [m2]
+        /// @param[out] result transform, one value per Faraday depth
+        void transform(const casa::Vector<casa::Complex> &spectrum,
+                       const float refLambdaSq,
+                       casa::Vector<casa::Complex> &result) const;
+
+        /// @brief Check whether the transform is defined for these channels and depths
+        bool matches(const casa::Vector<float> &lsq,
+                     const casa::Vector<float> &phi) const;
+
+    private:
+        /// @brief Lambda-squared values of the channels [m2]
+        casa::Vector<float> itsLamSq;
+        /// @brief Faraday depth values [rad/m2]
+        casa::Vector<float> itsPhi;
+        /// @brief cos(2 phi_j lsq_k), with the Faraday depth index varying fastest
+        std::vector<float> itsCos;
+        /// @brief sin(2 phi_j lsq_k), with the Faraday depth index varying fastest
+        std::vector<float> itsSin;
+};
+
+}
+
+}
+
+#endif
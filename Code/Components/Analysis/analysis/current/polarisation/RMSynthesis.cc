@@ -30,6 +30,7 @@
 #include <askap_analysis.h>
 
 #include <polarisation/PolarisationData.h>
+#include <polarisation/FaradayDepthTransform.h>
 
 #include <askap/AskapLogging.h>
 #include <askap/AskapError.h>
@@ -43,6 +44,7 @@
 #include <casacore/scimath/Fitting/FitGaussian.h>
 
 #include <Common/ParameterSet.h>
+#include <boost/shared_ptr.hpp>
 
 ///@brief Where the log messages go.
 ASKAP_LOGGER(logger, ".rmsynthesis");
@@ -154,25 +156,28 @@ void RMSynthesis::calculate(const casa::Vector<float> &lsq,
     itsLambdaSquaredVariance = (casa::sum(itsLamSq * itsLamSq) - pow(casa::sum(itsLamSq), 2) / itsLamSq.size()) /
                                float(itsLamSq.size() - 1);
 
-    // Compute FDF
-    for (size_t j = 0; j < itsNumPhiChan; j++) {
-        casa::Vector<float> phase = -2.F * itsPhi[j] * (itsLamSq - itsRefLambdaSquared);
-        casa::Vector<casa::Complex> sampling = casa::makeComplex(itsWeights * cos(phase),
-                                               itsWeights * sin(phase));
-        itsFaradayDF[j] = itsNormalisation * casa::sum(itsFracPolSpectrum * sampling);
+    // Compute FDF and RMSF with the transform shared by all spectra
+    // with the same channels
+    casa::Vector<casa::Complex> weightedSpectrum(itsLamSq.size());
+    casa::Vector<casa::Complex> weightsAsComplex(itsLamSq.size());
+    for (size_t i = 0; i < itsLamSq.size(); i++) {
+        weightedSpectrum[i] = itsWeights[i] * itsFracPolSpectrum[i];
+        weightsAsComplex[i] = casa::Complex(itsWeights[i], 0.);
     }
 
+    boost::shared_ptr<const FaradayDepthTransform> transform =
+        FaradayDepthTransform::get(itsLamSq, itsPhi);
+    transform->transform(weightedSpectrum, itsRefLambdaSquared, itsFaradayDF);
+    itsFaradayDF *= casa::Complex(itsNormalisation, 0.);
+
     // Put back into Jy by multiplying by the Stokes I model at the reference wavelength
     float nuRef = QC::c.getValue() / sqrt(itsRefLambdaSquared);
     itsFaradayDF *= itsImodel.flux(nuRef);
 
-    // Compute RMSF
-    for (size_t j = 0; j < 2.*itsNumPhiChan; j++) {
-        casa::Vector<float> phase = -2.F * itsPhiForRMSF[j] * (itsLamSq - itsRefLambdaSquared);
-        casa::Vector<casa::Complex> sampling = casa::makeComplex(itsWeights * cos(phase),
-                                               itsWeights * sin(phase));
-        itsRMSF[j] = itsNormalisation * casa::sum(sampling);
-    }
+    boost::shared_ptr<const FaradayDepthTransform> transformForRMSF =
+        FaradayDepthTransform::get(itsLamSq, itsPhiForRMSF);
+    transformForRMSF->transform(weightsAsComplex, itsRefLambdaSquared, itsRMSF);
+    itsRMSF *= casa::Complex(itsNormalisation, 0.);
 
     this->fitRMSF();
 
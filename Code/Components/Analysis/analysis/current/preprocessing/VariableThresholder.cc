@@ -62,6 +62,9 @@ VariableThresholder::VariableThresholder(askap::askapparallel::AskapParallel& co
     itsParset(parset)
 {
     itsBoxSize = parset.getInt16("boxSize", 50);
+    itsFlagIncremental = parset.getBool("fastStats", false);
+    itsNumThreads = parset.getUint("nThreads", 1);
+    ASKAPCHECK(itsNumThreads > 0, "VariableThreshold.nThreads should be positive");
     itsSNRimageName = parset.getString("SNRimageName", "");
     itsThresholdImageName = parset.getString("ThresholdImageName", "");
     itsNoiseImageName = parset.getString("NoiseImageName", "");
@@ -229,6 +232,10 @@ void VariableThresholder::calculate()
                           " using  '" << itsSearchType <<
                           "' mode with chunks of shape " << chunkshape <<
                           " and a box of shape " << box);
+        if (itsFlagRobustStats && itsFlagIncremental) {
+            ASKAPLOG_INFO_STR(logger, "Robust statistics will be calculated incrementally using " <<
+                              itsNumThreads << " thread(s)");
+        }
 
         casa::Array<Float> full_middle(itsInputShape, 0.);
         casa::Array<Float> full_spread(itsInputShape, 0.);
@@ -268,8 +275,13 @@ void VariableThresholder::calculate()
 
                 this->defineChunk(inputChunk, inputMaskedChunk, ctr);
                 //slidingBoxStats(inputChunk, middle, spread, box, itsFlagRobustStats);
-                slidingBoxMaskedStats(inputMaskedChunk, middle, spread, box,
-                                      itsFlagRobustStats);
+                if (itsFlagRobustStats && itsFlagIncremental) {
+                    slidingBoxMaskedRobustStats(inputMaskedChunk, middle, spread, box,
+                                                itsNumThreads);
+                } else {
+                    slidingBoxMaskedStats(inputMaskedChunk, middle, spread, box,
+                                          itsFlagRobustStats);
+                }
                 // snr = calcSNR(inputChunk,middle,spread);
                 snr = calcMaskedSNR(inputMaskedChunk, middle, spread);
                 ASKAPLOG_DEBUG_STR(logger, "Adding data for location " << loc-itsLocation
@@ -160,6 +160,11 @@ class VariableThresholder {
         std::string itsSearchType;
         /// The half-box-width used for the sliding-box calculations
         unsigned int itsBoxSize;
+        /// Should the robust statistics be calculated incrementally
+        /// as the box slides, rather than from scratch for each box
+        bool itsFlagIncremental;
+        /// Number of threads used for the incremental calculation
+        unsigned int itsNumThreads;
 
         std::string itsInputImage;
 
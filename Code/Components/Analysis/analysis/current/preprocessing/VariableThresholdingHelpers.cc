@@ -29,6 +29,7 @@
 #include <casacore/casa/Arrays/IPosition.h>
 #include <casacore/casa/Arrays/ArrayPartMath.h>
 #include <casacore/casa/Arrays/MaskArrMath.h>
+#include <casacore/casa/BasicMath/Math.h>
 #include <casacore/casa/namespace.h>
 
 #include <duchamp/Utils/Statistics.hh>
@@ -36,6 +37,9 @@
 #include <askap/AskapLogging.h>
 #include <askap/AskapError.h>
 
+#include <vector>
+#include <algorithm>
+
 ///@brief Where the log messages go.
 ASKAP_LOGGER(logger, ".varthreshhelp");
 
@@ -102,6 +106,269 @@ void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
     }
 }
 
+namespace {
+
+/// @brief Counts of the values within a sliding box
+/// @details Values are identified by their rank amongst all values the box
+/// can ever contain, and the counts are kept in a binary indexed (Fenwick)
+/// tree, so that adding or removing a value and selecting the k-th smallest
+/// value all take logarithmic time.
+class SlidingBoxCounts {
+    public:
+        /// @param[in] values distinct values in ascending order, the counter
+        /// refers to this vector which should outlive it
+        explicit SlidingBoxCounts(const std::vector<Float> &values) :
+            itsValues(values), itsTree(values.size() + 1, 0), itsCount(0), itsTopBit(1)
+        {
+            while (2 * itsTopBit <= itsValues.size()) {
+                itsTopBit *= 2;
+            }
+        }
+
+        /// @brief add a value with the given rank to the box
+        void add(const int rank)
+        {
+            ++itsCount;
+            for (size_t i = size_t(rank) + 1; i < itsTree.size(); i += i & (~i + 1)) {
+                ++itsTree[i];
+            }
+        }
+
+        /// @brief remove a value with the given rank from the box
+        void remove(const int rank)
+        {
+            --itsCount;
+            for (size_t i = size_t(rank) + 1; i < itsTree.size(); i += i & (~i + 1)) {
+                --itsTree[i];
+            }
+        }
+
+        /// @brief number of values in the box
+        size_t count() const { return itsCount; }
+
+        /// @brief k-th smallest value in the box (k is zero-based)
+        Float select(const size_t k) const
+        {
+            ASKAPDEBUGASSERT(k < itsCount);
+            size_t pos = 0;
+            unsigned int remaining = k + 1;
+            for (size_t step = itsTopBit; step > 0; step >>= 1) {
+                if ((pos + step < itsTree.size()) && (itsTree[pos + step] < remaining)) {
+                    pos += step;
+                    remaining -= itsTree[pos];
+                }
+            }
+            return itsValues[pos];
+        }
+
+    private:
+        const std::vector<Float> &itsValues;
+        std::vector<unsigned int> itsTree;
+        size_t itsCount;
+        size_t itsTopBit;
+};
+
+/// @brief k-th smallest absolute deviation from the median
+/// @details The deviations of the values below the split point (taken
+/// in reverse order) and of those above it form two sorted sequences, the
+/// k-th smallest element of their union is found by bisection.
+/// @param[in] counts content of the box
+/// @param[in] median median of the box
+/// @param[in] split number of values not greater than the median
+/// @param[in] k zero-based index of the deviation required
+Float selectDeviation(const SlidingBoxCounts &counts, const Float median,
+                      const size_t split, const size_t k)
+{
+    const size_t nBelow = split;
+    const size_t nAbove = counts.count() - split;
+    // number of deviations taken from the values below the median
+    size_t lo = (k + 1 > nAbove) ? k + 1 - nAbove : 0;
+    size_t hi = std::min(k + 1, nBelow);
+    while (lo < hi) {
+        const size_t a = (lo + hi) / 2;
+        const size_t b = k + 1 - a;
+        if ((b > 0) && (counts.select(split + b - 1) - median > median - counts.select(split - 1 - a))) {
+            lo = a + 1;
+        } else {
+            hi = a;
+        }
+    }
+    const size_t b = k + 1 - lo;
+    Float result = 0.;
+    if (lo > 0) {
+        result = median - counts.select(split - lo);
+    }
+    if (b > 0) {
+        result = std::max(result, counts.select(split + b - 1) - median);
+    }
+    return result;
+}
+
+/// @brief median and MADFM of the box content
+/// @details Medians of an even number of values are the mean of the two
+/// middle values, as for casacore's MaskedMedianFunc and MaskedMadfmFunc.
+void boxRobustStats(const SlidingBoxCounts &counts, Float &median, Float &madfm)
+{
+    const size_t n = counts.count();
+    if (n == 0) {
+        median = madfm = 0.;
+        return;
+    }
+    const size_t half = n / 2;
+    if (n % 2 == 1) {
+        median = counts.select(half);
+        madfm = selectDeviation(counts, median, half, half);
+    } else {
+        median = Float(0.5) * (counts.select(half - 1) + counts.select(half));
+        madfm = Float(0.5) * (selectDeviation(counts, median, half, half - 1) +
+                              selectDeviation(counts, median, half, half));
+    }
+}
+
+/// @brief process a band of rows of a single plane
+/// @param[in] data pixel values of the plane
+/// @param[in] mask pixel mask of the plane
+/// @param[out] middle median values of the plane
+/// @param[out] spread MADFM values of the plane
+/// @param[in] nx plane size along the first axis
+/// @param[in] hx half-width of the box along the first axis
+/// @param[in] hy half-width of the box along the second axis
+/// @param[in] yStart first row to process (not less than hy)
+/// @param[in] yEnd row after the last row to process (not greater than ny-hy)
+void robustStatsBand(const Float *data, const Bool *mask, Float *middle, Float *spread,
+                     const int nx, const int hx, const int hy,
+                     const int yStart, const int yEnd)
+{
+    // all pixels covered by the box for this band
+    const size_t offset = size_t(yStart - hy) * nx;
+    const size_t nPix = size_t(yEnd - yStart + 2 * hy) * nx;
+    std::vector<Float> values;
+    values.reserve(nPix);
+    for (size_t pix = offset; pix < offset + nPix; ++pix) {
+        if (mask[pix] && !isNaN(data[pix])) {
+            values.push_back(data[pix]);
+        }
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    // rank of each pixel, negative for excluded pixels
+    std::vector<int> ranks(nPix, -1);
+    for (size_t pix = 0; pix < nPix; ++pix) {
+        if (mask[offset + pix] && !isNaN(data[offset + pix])) {
+            ranks[pix] = int(std::lower_bound(values.begin(), values.end(),
+                                              data[offset + pix]) - values.begin());
+        }
+    }
+    // rows of the rank array are counted from the top of the band
+    const int yBase = yStart - hy;
+    const int *rank = &ranks[0];
+
+    SlidingBoxCounts counts(values);
+    for (size_t pix = 0; pix < size_t(2 * hy + 1) * nx; ++pix) {
+        if ((int(pix % nx) <= 2 * hx) && (rank[pix] >= 0)) {
+            counts.add(rank[pix]);
+        }
+    }
+
+    // serpentine path: along the first row, back along the second one, etc.
+    int x = hx;
+    int y = yStart;
+    int dir = 1;
+    while (true) {
+        const size_t pix = size_t(y) * nx + x;
+        boxRobustStats(counts, middle[pix], spread[pix]);
+        if ((x + dir >= hx) && (x + dir < nx - hx)) {
+            const size_t leaving = size_t(x - dir * hx);
+            const size_t entering = size_t(x + dir * (hx + 1));
+            for (int row = y - hy; row <= y + hy; ++row) {
+                const int *rowRank = rank + size_t(row - yBase) * nx;
+                if (rowRank[leaving] >= 0) {
+                    counts.remove(rowRank[leaving]);
+                }
+                if (rowRank[entering] >= 0) {
+                    counts.add(rowRank[entering]);
+                }
+            }
+            x += dir;
+        } else {
+            if (y + 1 >= yEnd) {
+                break;
+            }
+            const int *leaving = rank + size_t(y - hy - yBase) * nx;
+            const int *entering = rank + size_t(y + hy + 1 - yBase) * nx;
+            for (int col = x - hx; col <= x + hx; ++col) {
+                if (leaving[col] >= 0) {
+                    counts.remove(leaving[col]);
+                }
+                if (entering[col] >= 0) {
+                    counts.add(entering[col]);
+                }
+            }
+            ++y;
+            dir = -dir;
+        }
+    }
+}
+
+}
+
+void slidingBoxMaskedRobustStats(const casa::MaskedArray<Float> &input,
+                                 casa::Array<Float> &middle,
+                                 casa::Array<Float> &spread,
+                                 const casa::IPosition &box,
+                                 unsigned int nThreads)
+{
+    ASKAPASSERT(input.shape() == middle.shape());
+    ASKAPASSERT(input.shape() == spread.shape());
+    ASKAPCHECK(box.size() <= 2, "Incremental sliding box statistics support 1D and 2D boxes only, you have "
+               << box);
+    ASKAPCHECK(nThreads > 0, "Number of threads should be positive");
+
+    middle = Float(0.);
+    spread = Float(0.);
+    const casa::IPosition shape = input.shape();
+    if (shape.product() == 0) {
+        return;
+    }
+    // as for slidingArrayMath, the box does not extend along the remaining axes
+    const int hx = box.size() > 0 ? box(0) : 0;
+    const int hy = (box.size() > 1) && (shape.size() > 1) ? box(1) : 0;
+    const int nx = shape(0);
+    const int ny = shape.size() > 1 ? shape(1) : 1;
+    if ((nx <= 2 * hx) || (ny <= 2 * hy)) {
+        // the box doesn't fit, the result is zero everywhere
+        return;
+    }
+    const size_t planeSize = size_t(nx) * ny;
+    const int nPlanes = int(shape.product() / planeSize);
+    const int nRows = ny - 2 * hy;
+    const int nBands = std::min(nRows, int(nThreads));
+
+    Bool deleteData, deleteMask, deleteMiddle, deleteSpread;
+    const Float *data = input.getArray().getStorage(deleteData);
+    const Bool *mask = input.getMask().getStorage(deleteMask);
+    Float *middleData = middle.getStorage(deleteMiddle);
+    Float *spreadData = spread.getStorage(deleteSpread);
+
+    #ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+    #endif
+    for (int item = 0; item < nPlanes * nBands; ++item) {
+        const int plane = item / nBands;
+        const int band = item % nBands;
+        const size_t planeOffset = size_t(plane) * planeSize;
+        robustStatsBand(data + planeOffset, mask + planeOffset,
+                        middleData + planeOffset, spreadData + planeOffset,
+                        nx, hx, hy, hy + band * nRows / nBands, hy + (band + 1) * nRows / nBands);
+    }
+
+    input.getArray().freeStorage(data, deleteData);
+    input.getMask().freeStorage(mask, deleteMask);
+    middle.putStorage(middleData, deleteMiddle);
+    spread.putStorage(spreadData, deleteSpread);
+    spread /= Float(Statistics::correctionFactor);
+}
+
 casa::Array<Float> calcMaskedSNR(casa::MaskedArray<Float> &input,
                                  casa::Array<Float> &middle,
                                  casa::Array<Float> &spread)
@@ -28,6 +28,7 @@
 #include <casacore/casa/aipstype.h>
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
 #include <casacore/casa/namespace.h>
 
 namespace askap {
@@ -50,6 +51,30 @@ void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
                            casa::IPosition &box,
                            bool useRobust);
 
+/// @brief Sliding-box median and MADFM of a masked array, calculated
+/// incrementally as the box moves.
+/// @details This gives the same result as slidingBoxMaskedStats with
+/// useRobust=true, but rather than sorting the content of every box from
+/// scratch it keeps the counts of the values within the box, updating them
+/// with the column (or row) entering and leaving the box as it moves along
+/// a serpentine path. The median and the MADFM are then selected from the
+/// counts in logarithmic time. The box applies to the first one or two axes
+/// of the array (as for slidingArrayMath), the array is processed plane by
+/// plane and the rows of each plane are split into bands processed in
+/// parallel (OpenMP is required for threading). Masked and NaN pixels are
+/// excluded, pixels within the half box width of the edge are set to zero,
+/// as are pixels with no valid data in the box.
+/// @param[in] input masked array
+/// @param[out] middle median array, same shape as the input
+/// @param[out] spread MADFM array converted to the equivalent standard deviation
+/// @param[in] box half-width of the box
+/// @param[in] nThreads number of threads to use
+void slidingBoxMaskedRobustStats(const casa::MaskedArray<Float> &input,
+                                 casa::Array<Float> &middle,
+                                 casa::Array<Float> &spread,
+                                 const casa::IPosition &box,
+                                 unsigned int nThreads = 1);
+
 casa::Array<Float> calcMaskedSNR(casa::MaskedArray<Float> &input,
                                  casa::Array<Float> &middle,
                                  casa::Array<Float> &spread);
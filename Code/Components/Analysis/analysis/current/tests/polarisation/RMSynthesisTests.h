@@ -28,6 +28,7 @@
 ///
 #include <polarisation/RMSynthesis.h>
 #include <polarisation/RMData.h>
+#include <polarisation/FaradayDepthTransform.h>
 #include <cppunit/extensions/HelperMacros.h>
 #include <askap/AskapLogging.h>
 #include <askap/AskapError.h>
@@ -53,6 +54,7 @@ class RMSynthesisTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRMsynth);
         CPPUNIT_TEST(testRMSF);
         CPPUNIT_TEST(testRMSFwidth);
+        CPPUNIT_TEST(testTransform);
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -289,6 +291,46 @@ class RMSynthesisTest : public CppUnit::TestFixture {
                            expectedRMSFwidth < 0.1);
         }
 
+        void testTransform()
+        {
+            ASKAPLOG_INFO_STR(logger, "+++++++++++++++++++++++++++++++++++++");
+            ASKAPLOG_INFO_STR(logger, "Test the cached Faraday depth transform");
+
+            RMSynthesis rmsynthV(parset_variance);
+            rmsynthV.setImodel(model);
+            rmsynthV.imodel().setCoeffs(coeffs);
+            rmsynthV.imodel().setType("poly");
+            rmsynthV.calculate(lamsq, q, u, noise);
+
+            // spectra with the same channels share the transform
+            boost::shared_ptr<const FaradayDepthTransform> transform =
+                FaradayDepthTransform::get(lamsq, rmsynthV.phi());
+            CPPUNIT_ASSERT(transform == FaradayDepthTransform::get(lamsq, rmsynthV.phi()));
+            CPPUNIT_ASSERT(transform->matches(lamsq, rmsynthV.phi()));
+            CPPUNIT_ASSERT(!transform->matches(lamsq, rmsynthV.phi_rmsf()));
+
+            // compare with the direct sum, with unit Stokes I model
+            const casa::Vector<casa::Complex> fdf = rmsynthV.fdf();
+            const float lsqRef = rmsynthV.refLambdaSq();
+            for (size_t j = 0; j < numPhiChan; j += 50) {
+                casa::DComplex direct(0., 0.);
+                double sumWeights = 0.;
+                for (int i = 0; i < nchan; i++) {
+                    const double weight = 1. / (noise[i] * noise[i]);
+                    const double phase = -2. * rmsynthV.phi()[j] * (lamsq[i] - lsqRef);
+                    direct += weight * casa::DComplex(q[i], u[i]) *
+                              casa::DComplex(cos(phase), sin(phase));
+                    sumWeights += weight;
+                }
+                direct /= sumWeights;
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.real(), fdf[j].real(), 1.e-5);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.imag(), fdf[j].imag(), 1.e-5);
+            }
+
+            FaradayDepthTransform::clearCache();
+            CPPUNIT_ASSERT(transform != FaradayDepthTransform::get(lamsq, rmsynthV.phi()));
+        }
+
         void tearDown()
         {
         }
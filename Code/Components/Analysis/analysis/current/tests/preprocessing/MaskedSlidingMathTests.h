@@ -31,6 +31,7 @@
 #include <askap/AskapLogging.h>
 #include <askap/AskapError.h>
 #include <duchamp/Utils/Statistics.hh>
+#include <casacore/casa/Arrays/ArrayLogical.h>
 
 ASKAP_LOGGER(logger2, ".maskSlidingMathTest");
 namespace askap {
@@ -45,6 +46,8 @@ class MaskedSlidingMathTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testBoxStddev);
         CPPUNIT_TEST(testBoxMedian);
         CPPUNIT_TEST(testBoxMadfm);
+        CPPUNIT_TEST(testIncrementalMedianMadfm);
+        CPPUNIT_TEST(testIncrementalMatchesFull);
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -276,6 +279,48 @@ class MaskedSlidingMathTest : public CppUnit::TestFixture {
 
         }
 
+        void testIncrementalMedianMadfm()
+        {
+            casa::IPosition box(2, boxWidth, boxWidth);
+            casa::Array<Float> middle(shape, 0.);
+            casa::Array<Float> spread(shape, 0.);
+            ASKAPLOG_DEBUG_STR(logger2, "Sliding math test - incremental median & madfm");
+            casa::MaskedArray<Float> localInput(inputMaskArr);
+            slidingBoxMaskedRobustStats(localInput, middle, spread, box, 2);
+            for (size_t y = 0; y < dim; y++) {
+                for (size_t x = 0; x < dim; x++) {
+                    casa::IPosition pos(2, x, y);
+                    CPPUNIT_ASSERT(fabs(middle(pos) - checkBoxMedianArr(pos)) < 1.e-5);
+                    CPPUNIT_ASSERT(fabs(spread(pos) - checkBoxMadfmArr(pos)) < 1.e-5);
+                    CPPUNIT_ASSERT(fabs(inputArr(pos) - localInput.getArray()(pos)) < 1.e-5);
+                }
+            }
+        }
+
+        void testIncrementalMatchesFull()
+        {
+            // pseudo-random data with repeated values and a scattered mask
+            const casa::IPosition bigShape(3, 37, 29, 2);
+            casa::Array<Float> data(bigShape);
+            casa::LogicalArray mask(bigShape);
+            unsigned int seed = 12345;
+            casa::Array<Float>::iterator iterData(data.begin());
+            casa::LogicalArray::iterator iterMask(mask.begin());
+            for (; iterData != data.end(); iterData++, iterMask++) {
+                seed = seed * 1103515245 + 12345;
+                *iterData = ((seed >> 16) % 11) - 5.;
+                *iterMask = ((seed >> 8) % 7) != 0;
+            }
+            casa::MaskedArray<Float> localInput(data, mask);
+            casa::IPosition box(2, 3, 2);
+            casa::Array<Float> middle(bigShape, 0.), spread(bigShape, 0.);
+            casa::Array<Float> fastMiddle(bigShape, 0.), fastSpread(bigShape, 0.);
+            slidingBoxMaskedStats(localInput, middle, spread, box, true);
+            slidingBoxMaskedRobustStats(localInput, fastMiddle, fastSpread, box, 3);
+            CPPUNIT_ASSERT(allNear(middle, fastMiddle, 1.e-6));
+            CPPUNIT_ASSERT(allNear(spread, fastSpread, 1.e-6));
+        }
+
         void tearDown()
         {
         }
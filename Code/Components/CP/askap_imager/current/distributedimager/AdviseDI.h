@@ -114,6 +114,10 @@ namespace askap {
 
             cp::ContinuumWorkUnit getAllocation(int id);
 
+            /// @brief static allocation of work units for every worker (rank - 1)
+            const std::vector< std::vector<cp::ContinuumWorkUnit> >& getAllocations() const
+            { return itsAllocatedWork; };
+
             double getBaseFrequencyAllocation(int workerNumber);
 
             void updateComms();
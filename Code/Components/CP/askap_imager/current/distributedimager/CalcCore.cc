@@ -98,22 +98,29 @@ void CalcCore::doCalc()
     ASKAPLOG_DEBUG_STR(logger, "Calculating NE .... for channel " << itsChannel);
     if (!itsEquation) {
 
-        accessors::TableDataSource ds = itsData;
+        IDataSharedIter it = itsDataIter;
 
-        // Setup data iterator
+        if (!it) {
+            accessors::TableDataSource ds = itsData;
 
-        IDataSelectorPtr sel = ds.createSelector();
+            // Setup data iterator
 
-        sel->chooseCrossCorrelations();
-        sel << parset();
-        sel->chooseChannels(1, itsChannel);
+            IDataSelectorPtr sel = ds.createSelector();
 
-        IDataConverterPtr conv = ds.createConverter();
-        conv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
-        conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
-        conv->setEpochFrame();
+            sel->chooseCrossCorrelations();
+            sel << parset();
+            sel->chooseChannels(1, itsChannel);
 
-        IDataSharedIter it = ds.createIterator(sel, conv);
+            IDataConverterPtr conv = ds.createConverter();
+            conv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+            conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+            conv->setEpochFrame();
+
+            it = ds.createIterator(sel, conv);
+        }
+        else {
+            ASKAPLOG_DEBUG_STR(logger, "Using the supplied (in-memory) data iterator");
+        }
 
 
         ASKAPCHECK(itsModel, "Model not defined");
@@ -162,6 +169,12 @@ void CalcCore::doCalc()
 
 }
 
+void CalcCore::setDataIterator(const accessors::IDataSharedIter& it)
+{
+    ASKAPCHECK(!itsEquation, "The data iterator has to be set before the first calcNE");
+    itsDataIter = it;
+}
+
 void CalcCore::calcNE()
 {
 
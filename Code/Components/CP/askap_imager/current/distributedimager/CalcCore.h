@@ -42,6 +42,7 @@
 #include <casacore/casa/Quanta/Quantum.h>
 #include <casacore/casa/Arrays/Vector.h>
 #include <dataaccess/TableDataSource.h>
+#include <dataaccess/SharedIter.h>
 
 // Local includes
 
@@ -76,6 +77,12 @@ namespace cp {
 
         void writeLocalModel(const std::string& postfix);
 
+        /// @brief use the given iterator instead of reading the datasource
+        /// @details This has to be called before the first calcNE. The iterator
+        /// is expected to deliver the data of the selected channel only.
+        /// @param[in] it iterator over the data to image
+        void setDataIterator(const accessors::IDataSharedIter& it);
+
     private:
 
         // Parameter set
@@ -96,6 +103,9 @@ namespace cp {
         // Its channel in the dataset
         int itsChannel;
 
+        // Iterator to use instead of the datasource, if set
+        accessors::IDataSharedIter itsDataIter;
+
         // No support for assignment
         CalcCore& operator=(const CalcCore& rhs);
 
@@ -0,0 +1,170 @@
+/// @file ChannelDataCache.cc
+///
+/// Single-channel slices of datasets read in one pass and held in memory
+///
+/// @copyright (c) 2013 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include <distributedimager/ChannelDataCache.h>
+
+// Include package level header file
+#include <askap_imager.h>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+#include <casacore/casa/OS/Timer.h>
+#include <dataaccess/TableDataSource.h>
+#include <dataaccess/IDataConverter.h>
+#include <dataaccess/IDataSelector.h>
+#include <dataaccess/DataIteratorAdapter.h>
+#include <dataaccess/PrefetchedDataAccessor.h>
+#include <dataaccess/ParsetInterface.h>
+
+ASKAP_LOGGER(logger, ".ChannelDataCache");
+
+using namespace askap;
+using namespace askap::cp;
+using namespace askap::accessors;
+
+/// @brief Constructor
+/// @param[in] cacheSize uvw-machine cache size of the in-memory accessors
+/// @param[in] tolerance pointing direction tolerance in radians for the uvw-machine cache
+ChannelDataCache::ChannelDataCache(const size_t cacheSize, const double tolerance) :
+    itsCacheSize(cacheSize), itsTolerance(tolerance)
+{
+}
+
+/// @brief register a channel to be read
+/// @details All channels known in advance should be registered before the data are
+/// read, so they are obtained in a single pass.
+/// @param[in] ms dataset name
+/// @param[in] beam beam (feed) number
+/// @param[in] channel local (0-based) channel in the dataset
+void ChannelDataCache::addChannel(const std::string &ms, const casa::uInt beam, const casa::uInt channel)
+{
+    itsChannels[DatasetKey(ms, beam)].insert(channel);
+}
+
+/// @brief obtain an iterator over the data for the given channel
+/// @details The dataset is read on the first request for any of its channels
+/// which have been registered but not read yet.
+/// @param[in] ms dataset name
+/// @param[in] beam beam (feed) number
+/// @param[in] channel local (0-based) channel in the dataset
+/// @param[in] parset parameters of the work unit (data column and selection)
+/// @return iterator over the in-memory data of the channel
+IDataSharedIter ChannelDataCache::createIterator(const std::string &ms, const casa::uInt beam,
+                        const casa::uInt channel, const LOFAR::ParameterSet &parset)
+{
+    const DatasetKey key(ms, beam);
+    const std::map<DatasetKey, std::set<casa::uInt> >::const_iterator pending = itsChannels.find(key);
+    if ((pending != itsChannels.end()) && (pending->second.count(channel) > 0)) {
+        load(key, parset);
+    }
+    const std::map<casa::uInt, boost::shared_ptr<const ChunkListDataIterator::ChunkList> > &channels = itsData[key];
+    const std::map<casa::uInt, boost::shared_ptr<const ChunkListDataIterator::ChunkList> >::const_iterator ci =
+          channels.find(channel);
+    ASKAPCHECK(ci != channels.end(), "Channel " << channel << " of " << ms << " (beam " << beam <<
+               ") is either not registered or has already been released");
+    const boost::shared_ptr<ChunkListDataIterator> it(new ChunkListDataIterator(ci->second));
+    return IDataSharedIter(new DataIteratorAdapter(it));
+}
+
+/// @brief release the data of the given channel
+/// @details The memory is freed when the last iterator referring to the data is destroyed.
+/// @param[in] ms dataset name
+/// @param[in] beam beam (feed) number
+/// @param[in] channel local (0-based) channel in the dataset
+void ChannelDataCache::release(const std::string &ms, const casa::uInt beam, const casa::uInt channel)
+{
+    const std::map<DatasetKey, std::map<casa::uInt,
+                   boost::shared_ptr<const ChunkListDataIterator::ChunkList> > >::iterator it =
+                   itsData.find(DatasetKey(ms, beam));
+    if (it != itsData.end()) {
+        it->second.erase(channel);
+    }
+}
+
+/// @brief read all pending channels of the given dataset and beam
+/// @param[in] key dataset and beam
+/// @param[in] parset parameters of the work unit (data column and selection)
+void ChannelDataCache::load(const DatasetKey &key, const LOFAR::ParameterSet &parset)
+{
+    const std::set<casa::uInt> &channels = itsChannels[key];
+    ASKAPCHECK(channels.size() > 0, "No channels have been registered for " << key.first <<
+               " (beam " << key.second << ")");
+    // the set is ordered, read the range covering all channels in one pass
+    const casa::uInt startChannel = *channels.begin();
+    const casa::uInt nChannels = *channels.rbegin() - startChannel + 1;
+
+    ASKAPLOG_INFO_STR(logger, "Reading " << channels.size() << " channel(s) of " << key.first <<
+                      " (beam " << key.second << ") into memory, channel range starts at " <<
+                      startChannel << " and has " << nChannels << " channels");
+    casa::Timer timer;
+    timer.mark();
+
+    const std::string colName = parset.getString("datacolumn", "DATA");
+    TableDataSource ds(key.first, TableDataSource::DEFAULT, colName);
+
+    IDataSelectorPtr sel = ds.createSelector();
+    sel->chooseCrossCorrelations();
+    sel << parset;
+    sel->chooseFeed(key.second);
+    sel->chooseChannels(nChannels, startChannel);
+
+    IDataConverterPtr conv = ds.createConverter();
+    conv->setFrequencyFrame(casa::MFrequency::Ref(casa::MFrequency::TOPO), "Hz");
+    conv->setDirectionFrame(casa::MDirection::Ref(casa::MDirection::J2000));
+    conv->setEpochFrame();
+
+    std::map<casa::uInt, boost::shared_ptr<ChunkListDataIterator::ChunkList> > data;
+    for (std::set<casa::uInt>::const_iterator ci = channels.begin(); ci != channels.end(); ++ci) {
+         data[*ci].reset(new ChunkListDataIterator::ChunkList);
+    }
+
+    size_t nChunks = 0;
+    for (IDataSharedIter it = ds.createIterator(sel, conv); it != it.end(); ++it, ++nChunks) {
+         // row-based fields are copied once per chunk and shared by all channels
+         boost::shared_ptr<const PrefetchedDataAccessor> first;
+         for (std::set<casa::uInt>::const_iterator ci = channels.begin(); ci != channels.end(); ++ci) {
+              boost::shared_ptr<PrefetchedDataAccessor> acc(new PrefetchedDataAccessor(itsCacheSize, itsTolerance));
+              if (first) {
+                  acc->assignChannel(*it, *ci - startChannel, *first);
+              } else {
+                  acc->assignChannel(*it, *ci - startChannel);
+                  first = acc;
+              }
+              data[*ci]->push_back(acc);
+         }
+    }
+
+    for (std::map<casa::uInt, boost::shared_ptr<ChunkListDataIterator::ChunkList> >::const_iterator ci = data.begin();
+         ci != data.end(); ++ci) {
+         itsData[key][ci->first] = ci->second;
+    }
+    itsChannels.erase(key);
+    ASKAPLOG_INFO_STR(logger, "Read " << nChunks << " chunks of " << key.first << " in " <<
+                      timer.real() << " seconds");
+}
@@ -0,0 +1,118 @@
+/// @file ChannelDataCache.h
+///
+/// Single-channel slices of datasets read in one pass and held in memory
+///
+/// @copyright (c) 2013 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_CP_SIMAGER_CHANNELDATACACHE_H
+#define ASKAP_CP_SIMAGER_CHANNELDATACACHE_H
+
+// System includes
+#include <string>
+#include <map>
+#include <set>
+#include <utility>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include <Common/ParameterSet.h>
+#include <dataaccess/SharedIter.h>
+#include <dataaccess/IDataIterator.h>
+#include <dataaccess/ChunkListDataIterator.h>
+
+namespace askap {
+namespace cp {
+
+/// @brief single-channel slices of datasets held in memory
+/// @details This is an alternative to splitting a single-channel measurement set
+/// into tmpfs for every work unit (usetmpfs=true). All channels of a given dataset
+/// and beam which have been allocated to this worker are registered first. The
+/// first request for any of them reads the dataset once and fans the data out
+/// into per-channel lists of in-memory accessors. Major cycles then iterate over
+/// memory without further I/O and no intermediate measurement sets are written.
+/// Row-based metadata (uvw, pointing directions, antenna and feed indices, times)
+/// are held once per chunk and shared by the accessors of all channels, so the memory
+/// is dominated by the visibilities, flags and noise. Rotated uvw and delays are cached
+/// by each channel accessor once it is gridded (4 doubles per row).
+/// Channels registered after the dataset has been read (e.g. work received from
+/// the dynamic scheduler) are read in a further pass on the first request for them.
+class ChannelDataCache {
+    public:
+        /// @brief Constructor
+        /// @param[in] cacheSize uvw-machine cache size of the in-memory accessors
+        /// @param[in] tolerance pointing direction tolerance in radians for the uvw-machine cache
+        ChannelDataCache(const size_t cacheSize = 1, const double tolerance = 1e-6);
+
+        /// @brief register a channel to be read
+        /// @details All channels known in advance should be registered before the data are
+        /// read, so they are obtained in a single pass.
+        /// @param[in] ms dataset name
+        /// @param[in] beam beam (feed) number
+        /// @param[in] channel local (0-based) channel in the dataset
+        void addChannel(const std::string &ms, const casa::uInt beam, const casa::uInt channel);
+
+        /// @brief obtain an iterator over the data for the given channel
+        /// @details The dataset is read on the first request for any of its channels
+        /// which have been registered but not read yet.
+        /// @param[in] ms dataset name
+        /// @param[in] beam beam (feed) number
+        /// @param[in] channel local (0-based) channel in the dataset
+        /// @param[in] parset parameters of the work unit (data column and selection)
+        /// @return iterator over the in-memory data of the channel
+        accessors::IDataSharedIter createIterator(const std::string &ms, const casa::uInt beam,
+                        const casa::uInt channel, const LOFAR::ParameterSet &parset);
+
+        /// @brief release the data of the given channel
+        /// @details The memory is freed when the last iterator referring to the data is destroyed.
+        /// @param[in] ms dataset name
+        /// @param[in] beam beam (feed) number
+        /// @param[in] channel local (0-based) channel in the dataset
+        void release(const std::string &ms, const casa::uInt beam, const casa::uInt channel);
+
+    private:
+        /// @brief dataset and beam
+        typedef std::pair<std::string, casa::uInt> DatasetKey;
+
+        /// @brief read all pending channels of the given dataset and beam
+        /// @param[in] key dataset and beam
+        /// @param[in] parset parameters of the work unit (data column and selection)
+        void load(const DatasetKey &key, const LOFAR::ParameterSet &parset);
+
+        /// @brief uvw-machine cache size
+        size_t itsCacheSize;
+
+        /// @brief pointing direction tolerance for the uvw-machine cache
+        double itsTolerance;
+
+        /// @brief registered channels which have not been read yet for every dataset and beam
+        std::map<DatasetKey, std::set<casa::uInt> > itsChannels;
+
+        /// @brief data for every dataset, beam and channel
+        std::map<DatasetKey, std::map<casa::uInt,
+                 boost::shared_ptr<const accessors::ChunkListDataIterator::ChunkList> > > itsData;
+};
+
+}
+}
+
+#endif
@@ -58,6 +58,7 @@
 #include "distributedimager/AdviseDI.h"
 #include "distributedimager/CalcCore.h"
 #include "distributedimager/CubeComms.h"
+#include "distributedimager/ContinuumScheduler.h"
 #include "messages/ContinuumWorkUnit.h"
 #include "messages/ContinuumWorkRequest.h"
 
@@ -145,6 +146,34 @@ void ContinuumMaster::run(void)
     // channels
     int id; // incoming rank ID
 
+    if (ContinuumScheduler::isDynamic(unitParset, itsComms.nGroups())) {
+        // Channels are handed out in batches until every worker has been told
+        // there is nothing left. This lasts until the end of imaging.
+        ContinuumScheduler scheduler(diadvise.getAllocations());
+        int nFinished = 0;
+        const int nWorkers = itsComms.nProcs() - 1;
+        while (nFinished < nWorkers) {
+            ContinuumWorkRequest wrequest;
+            wrequest.receiveRequest(id, itsComms);
+            std::vector<ContinuumWorkUnit> batch = scheduler.nextBatch(id - 1);
+            ASKAPLOG_DEBUG_STR(logger, "Sending " << batch.size() << " units to " << id << ", " <<
+                               scheduler.nChannels() << " channels remaining");
+            if (batch.empty()) {
+                ContinuumWorkUnit wu;
+                wu.set_payloadType(ContinuumWorkUnit::DONE);
+                wu.sendUnit(id, itsComms);
+                ++nFinished;
+            } else {
+                batch.back().set_payloadType(ContinuumWorkUnit::LAST);
+                for (size_t unit = 0; unit < batch.size(); ++unit) {
+                    batch[unit].sendUnit(id, itsComms);
+                }
+            }
+        }
+        ASKAPLOG_INFO_STR(logger, "All channels have been processed, master no longer required");
+        return;
+    }
+
     while(diadvise.getWorkUnitCount()) {
 
         ContinuumWorkRequest wrequest;
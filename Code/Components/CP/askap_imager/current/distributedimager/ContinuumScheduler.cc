@@ -0,0 +1,208 @@
+/// @file ContinuumScheduler.cc
+///
+/// Dynamic allocation of channels to the workers of the spectral-line imager
+///
+///
+/// @copyright (c) 2013 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include <distributedimager/ContinuumScheduler.h>
+
+// Include package level header file
+#include <askap_imager.h>
+
+// System includes
+#include <string>
+#include <algorithm>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <askap/AskapLogging.h>
+
+ASKAP_LOGGER(logger, ".ContinuumScheduler");
+
+using namespace askap;
+using namespace askap::cp;
+
+/// @brief check whether dynamic scheduling should be used
+/// @details A warning is given and false is returned if dynamic
+/// scheduling is requested but not supported for this configuration.
+/// @param[in] parset parameter set
+/// @param[in] nGroups number of worker groups
+/// @return true if channels should be allocated dynamically
+bool ContinuumScheduler::isDynamic(const LOFAR::ParameterSet& parset, const size_t nGroups)
+{
+    const std::string scheduler = parset.getString("scheduler", "static");
+    ASKAPCHECK((scheduler == "static") || (scheduler == "dynamic"),
+               "scheduler is supposed to be either static or dynamic, you have " << scheduler);
+    if (scheduler == "static") {
+        return false;
+    }
+    if (!parset.getBool("solverpercore", false)) {
+        ASKAPLOG_WARN_STR(logger, "Dynamic scheduling requires solverpercore=true, using the static allocation");
+        return false;
+    }
+    if (nGroups > 1) {
+        ASKAPLOG_WARN_STR(logger, "Dynamic scheduling is not supported with multiple worker groups, using the static allocation");
+        return false;
+    }
+    return true;
+}
+
+/// @brief Constructor
+/// @param[in] allocations static allocation of work units for each worker (rank - 1)
+ContinuumScheduler::ContinuumScheduler(const std::vector<std::vector<ContinuumWorkUnit> >& allocations) :
+    itsQueues(allocations.size()), itsTotalCost(0.)
+{
+    double maxFrequency = 0.;
+    for (size_t worker = 0; worker < allocations.size(); ++worker) {
+        for (size_t unit = 0; unit < allocations[worker].size(); ++unit) {
+            if (allocations[worker][unit].get_payloadType() != ContinuumWorkUnit::NA) {
+                maxFrequency = std::max(maxFrequency, allocations[worker][unit].get_channelFrequency());
+            }
+        }
+    }
+    ASKAPCHECK(maxFrequency > 0., "No work units to schedule");
+
+    size_t nTasks = 0;
+    for (size_t worker = 0; worker < allocations.size(); ++worker) {
+        Queue &queue = itsQueues[worker];
+        queue.itsCost = 0.;
+        queue.itsWriter = 0;
+        queue.itsStarted = false;
+        // units of the same channel (different datasets) are next to each other
+        for (size_t unit = 0; unit < allocations[worker].size(); ++unit) {
+            const ContinuumWorkUnit &wu = allocations[worker][unit];
+            if (wu.get_payloadType() == ContinuumWorkUnit::NA) {
+                continue;
+            }
+            if (queue.itsTasks.empty() || (queue.itsTasks.back().itsGlobalChannel != wu.get_globalChannel())) {
+                Task task;
+                task.itsGlobalChannel = wu.get_globalChannel();
+                task.itsCost = 0.;
+                queue.itsTasks.push_back(task);
+                ++nTasks;
+            }
+            const double relFreq = wu.get_channelFrequency() / maxFrequency;
+            const double cost = relFreq * relFreq;
+            Task &task = queue.itsTasks.back();
+            task.itsUnits.push_back(wu);
+            task.itsUnits.back().set_payloadType(ContinuumWorkUnit::WORK);
+            task.itsCost += cost;
+            queue.itsCost += cost;
+            queue.itsWriter = wu.get_writer();
+            itsWriters.insert(wu.get_writer());
+        }
+        itsTotalCost += queue.itsCost;
+    }
+    ASKAPLOG_INFO_STR(logger, "Scheduling " << nTasks << " channels for " << itsQueues.size() <<
+                      " workers and " << itsWriters.size() << " writer(s)");
+}
+
+/// @brief work units for the next batch of the given worker
+/// @param[in] worker worker number (rank - 1)
+/// @return work units of whole channels, empty if there is no work left for this worker
+std::vector<ContinuumWorkUnit> ContinuumScheduler::nextBatch(const unsigned int worker)
+{
+    ASKAPCHECK(worker < itsQueues.size(), "Worker " << worker << " is not known to the scheduler");
+    Queue &own = itsQueues[worker];
+    own.itsStarted = true;
+
+    // guided self-scheduling by cost
+    const double targetCost = itsTotalCost / (2. * itsQueues.size());
+    std::vector<ContinuumWorkUnit> batch;
+    double batchCost = 0.;
+    size_t nTasks = 0;
+
+    if (!own.itsTasks.empty()) {
+        do {
+            const Task &task = own.itsTasks.front();
+            batch.insert(batch.end(), task.itsUnits.begin(), task.itsUnits.end());
+            batchCost += task.itsCost;
+            ++nTasks;
+            own.itsTasks.pop_front();
+        } while (!own.itsTasks.empty() && (batchCost < targetCost));
+        own.itsCost -= batchCost;
+        ASKAPLOG_DEBUG_STR(logger, "Worker " << worker + 1 << " gets " << nTasks <<
+                           " channel(s) of its own allocation, " << own.itsTasks.size() << " left");
+    } else {
+        const int victim = findVictim(worker);
+        if (victim < 0) {
+            ASKAPLOG_DEBUG_STR(logger, "Nothing left for worker " << worker + 1);
+            return batch;
+        }
+        Queue &from = itsQueues[victim];
+        // never take more than half of the remaining work of the victim, and leave
+        // at least one channel to workers which haven't asked for work yet
+        const double maxCost = std::min(targetCost, 0.5 * from.itsCost);
+        const size_t keep = from.itsStarted ? 0 : 1;
+        do {
+            const Task &task = from.itsTasks.back();
+            batch.insert(batch.end(), task.itsUnits.begin(), task.itsUnits.end());
+            batchCost += task.itsCost;
+            ++nTasks;
+            from.itsTasks.pop_back();
+        } while ((from.itsTasks.size() > keep) && (batchCost < maxCost));
+        from.itsCost -= batchCost;
+        ASKAPLOG_INFO_STR(logger, "Worker " << worker + 1 << " steals " << nTasks <<
+                          " channel(s) from worker " << victim + 1 << ", " << from.itsTasks.size() << " left");
+    }
+    itsTotalCost -= batchCost;
+    return batch;
+}
+
+/// @brief number of channels which have not been handed out yet
+size_t ContinuumScheduler::nChannels() const
+{
+    size_t result = 0;
+    for (size_t worker = 0; worker < itsQueues.size(); ++worker) {
+        result += itsQueues[worker].itsTasks.size();
+    }
+    return result;
+}
+
+/// @brief find the worker to steal from
+/// @param[in] thief worker number (rank - 1) of the worker stealing
+/// @return worker number of the victim, negative if there is nothing to steal
+int ContinuumScheduler::findVictim(const unsigned int thief) const
+{
+    // writers only take channels they write themselves
+    const unsigned int thiefRank = thief + 1;
+    const bool thiefIsWriter = itsWriters.find(thiefRank) != itsWriters.end();
+    int victim = -1;
+    for (size_t worker = 0; worker < itsQueues.size(); ++worker) {
+        const Queue &queue = itsQueues[worker];
+        const size_t keep = queue.itsStarted ? 0 : 1;
+        if ((worker == thief) || (queue.itsTasks.size() <= keep)) {
+            continue;
+        }
+        if (thiefIsWriter && (queue.itsWriter != thiefRank)) {
+            continue;
+        }
+        if ((victim < 0) || (queue.itsCost > itsQueues[victim].itsCost)) {
+            victim = static_cast<int>(worker);
+        }
+    }
+    return victim;
+}
@@ -0,0 +1,124 @@
+/// @file ContinuumScheduler.h
+///
+/// Dynamic allocation of channels to the workers of the spectral-line imager
+///
+///
+/// @copyright (c) 2013 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_CP_SIMAGER_CONTINUUMSCHEDULER_H
+#define ASKAP_CP_SIMAGER_CONTINUUMSCHEDULER_H
+
+// System includes
+#include <deque>
+#include <set>
+#include <vector>
+
+// ASKAPsoft includes
+#include <Common/ParameterSet.h>
+
+// Local includes
+#include "messages/ContinuumWorkUnit.h"
+
+namespace askap {
+namespace cp {
+
+/// @brief dynamic allocation of channels to workers
+/// @details This class is used by the master if scheduler=dynamic. The static
+/// allocation produced by AdviseDI (a contiguous block of channels per worker)
+/// becomes a queue of channels for each worker. Each channel is a task comprising
+/// the work units of all datasets (epochs) for that channel. A worker asking for
+/// work gets a batch of channels from the front of its own queue. When its own
+/// queue is empty, it steals from the back of the queue with the largest remaining
+/// cost, i.e. from the high frequency end of the most loaded worker. Batches are
+/// sized by the cost left overall (guided self-scheduling), so early batches are
+/// large and the last ones are single channels. The cost of a work unit is taken
+/// to scale with the square of the frequency, following the support of the
+/// w-term convolution functions; the w-range and beam are common to all channels
+/// and cancel out. Channels keep their global channel number and writer, so the
+/// cubes and the writer bookkeeping are the same as for the static allocation.
+/// Writers only steal channels they write themselves, so the results are never
+/// sent from one writer to another.
+class ContinuumScheduler {
+    public:
+        /// @brief check whether dynamic scheduling should be used
+        /// @details A warning is given and false is returned if dynamic
+        /// scheduling is requested but not supported for this configuration.
+        /// @param[in] parset parameter set
+        /// @param[in] nGroups number of worker groups
+        /// @return true if channels should be allocated dynamically
+        static bool isDynamic(const LOFAR::ParameterSet& parset, const size_t nGroups);
+
+        /// @brief Constructor
+        /// @param[in] allocations static allocation of work units for each worker (rank - 1)
+        explicit ContinuumScheduler(const std::vector<std::vector<ContinuumWorkUnit> >& allocations);
+
+        /// @brief work units for the next batch of the given worker
+        /// @param[in] worker worker number (rank - 1)
+        /// @return work units of whole channels, empty if there is no work left for this worker
+        std::vector<ContinuumWorkUnit> nextBatch(const unsigned int worker);
+
+        /// @brief number of channels which have not been handed out yet
+        size_t nChannels() const;
+
+    private:
+        /// @brief all work units of a single channel
+        struct Task {
+            /// @brief global channel
+            unsigned int itsGlobalChannel;
+            /// @brief relative cost
+            double itsCost;
+            /// @brief work units (one per dataset)
+            std::vector<ContinuumWorkUnit> itsUnits;
+        };
+
+        /// @brief channels of the static allocation of a worker
+        struct Queue {
+            /// @brief channels not handed out yet, in increasing global channel order
+            std::deque<Task> itsTasks;
+            /// @brief total cost of the tasks in the queue
+            double itsCost;
+            /// @brief writer rank for the channels of this worker
+            unsigned int itsWriter;
+            /// @brief true once the worker has asked for work
+            bool itsStarted;
+        };
+
+        /// @brief find the worker to steal from
+        /// @param[in] thief worker number (rank - 1) of the worker stealing
+        /// @return worker number of the victim, negative if there is nothing to steal
+        int findVictim(const unsigned int thief) const;
+
+        /// @brief queues of all workers
+        std::vector<Queue> itsQueues;
+
+        /// @brief total cost of all tasks not handed out yet
+        double itsTotalCost;
+
+        /// @brief ranks of the writers
+        std::set<unsigned int> itsWriters;
+};
+
+}
+}
+
+#endif
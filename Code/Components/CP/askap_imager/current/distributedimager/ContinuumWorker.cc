@@ -71,6 +71,7 @@
 #include "messages/ContinuumWorkRequest.h"
 #include "distributedimager/CubeBuilder.h"
 #include "distributedimager/CubeComms.h"
+#include "distributedimager/ContinuumScheduler.h"
 
 using namespace std;
 using namespace askap::cp;
@@ -83,7 +84,7 @@ ASKAP_LOGGER(logger, ".ContinuumWorker");
 
 ContinuumWorker::ContinuumWorker(LOFAR::ParameterSet& parset,
                                        CubeComms& comms)
-    : itsParset(parset), itsComms(comms)
+    : itsParset(parset), itsComms(comms), itsNoMoreWork(false)
 {
     itsAdvisor = boost::shared_ptr<synthesis::AdviseDI> (new synthesis::AdviseDI(itsComms,itsParset));
     itsAdvisor->prepare();
@@ -120,6 +121,19 @@ ContinuumWorker::ContinuumWorker(LOFAR::ParameterSet& parset,
         }
     }
 
+    itsDynamicScheduling = ContinuumScheduler::isDynamic(itsParset, itsComms.nGroups());
+
+    if (itsParset.getBool("channelcache", false)) {
+        const int uvwMachineCacheSize = itsParset.getInt32("nUVWMachines", 1);
+        ASKAPCHECK(uvwMachineCacheSize > 0 ,
+                   "Cache size is supposed to be a positive number, you have "
+                   << uvwMachineCacheSize);
+        const double uvwMachineCacheTolerance = SynthesisParamsHelper::convertQuantity(
+                    itsParset.getString("uvwMachineDirTolerance", "1e-6rad"), "rad");
+        ASKAPLOG_INFO_STR(logger, "Allocated channels will be read into memory once (channelcache=true)");
+        itsChannelCache.reset(new ChannelDataCache(uvwMachineCacheSize, uvwMachineCacheTolerance));
+    }
+
 }
 
 ContinuumWorker::~ContinuumWorker()
@@ -149,6 +163,7 @@ void ContinuumWorker::run(void)
         wu.receiveUnitFrom(itsMaster,itsComms);
         if (wu.get_payloadType() == ContinuumWorkUnit::DONE) {
             ASKAPLOG_INFO_STR(logger,"Worker has received complete allocation");
+            itsNoMoreWork = true;
             break;
         }
         else if (wu.get_payloadType() == ContinuumWorkUnit::NA) {
@@ -273,6 +288,8 @@ void ContinuumWorker::run(void)
 
     itsComms.barrier(itsComms.theWorkers());
     ASKAPLOG_INFO_STR(logger,"Rank " << itsComms.rank() << " passed final barrier");
+    ASKAPCHECK(itsCubeWriteError.empty(), "Rank " << itsComms.rank() <<
+               " failed to write the output cubes: " << itsCubeWriteError);
 }
 void ContinuumWorker::processWorkUnit(ContinuumWorkUnit& wu)
 {
@@ -297,6 +314,15 @@ void ContinuumWorker::processWorkUnit(ContinuumWorkUnit& wu)
 
     bool usetmpfs = unitParset.getBool("usetmpfs",false);
 
+    if (itsChannelCache) {
+        if (usetmpfs) {
+            ASKAPLOG_WARN_STR(logger, "usetmpfs is ignored as channelcache is in use");
+            unitParset.replace("usetmpfs", "false");
+            usetmpfs = false;
+        }
+        itsChannelCache->addChannel(wu.get_dataset(), wu.get_beam(), wu.get_localChannel());
+    }
+
     if (usetmpfs)
     {
         const string ms = wu.get_dataset();
@@ -533,7 +559,11 @@ void ContinuumWorker::buildSpectralCube() {
 
 
 
-    for (int workUnitCount=0; workUnitCount < workUnits.size(); ) { // not all of these will have work
+    // maximum number of results in transit to the writers
+    const size_t maxPendingResults = 2;
+
+    // with the dynamic scheduler more work units are requested when these are done
+    for (int workUnitCount=0; (workUnitCount < workUnits.size()) || requestWork(); ) { // not all of these will have work
 
         try {
 
@@ -560,6 +590,7 @@ void ContinuumWorker::buildSpectralCube() {
 
 
             CalcCore rootImager(itsParsets[workUnitCount],itsComms,ds,workUnits[workUnitCount].get_localChannel());
+            useCachedData(rootImager, workUnitCount);
             /// set up the image for this channel
             setupImage(rootImager.params(), frequency);
 
@@ -595,6 +626,7 @@ void ContinuumWorker::buildSpectralCube() {
                     try {
 
                         CalcCore workingImager(itsParsets[tempWorkUnitCount],itsComms,ds,workUnits[tempWorkUnitCount].get_localChannel());
+                        useCachedData(workingImager, tempWorkUnitCount);
 
                     /// this loop does the calcNE and the merge of the residual images
 
@@ -667,6 +699,14 @@ void ContinuumWorker::buildSpectralCube() {
 
             rootImager.check();
 
+            if (itsChannelCache) {
+                // this channel is not going to be read again, the memory is freed with the imager
+                for (int unit = initialChannelWorkUnit - 1; unit < workUnitCount; ++unit) {
+                    itsChannelCache->release(workUnits[unit].get_dataset(), workUnits[unit].get_beam(),
+                                             workUnits[unit].get_localChannel());
+                }
+            }
+
 
             if (itsParsets[0].getBool("restore", false)) {
                 ASKAPLOG_INFO_STR(logger,"Running restore");
@@ -694,6 +734,16 @@ void ContinuumWorker::buildSpectralCube() {
 
                 /// write everyone elses
 
+                if (itsDynamicScheduling) {
+                    /// the channels which remain to be done are not known in advance,
+                    /// so just write what has already arrived
+                    while ((itsComms.getOutstanding() > 0) &&
+                           itsComms.probeAnySrc(IMessage::SPECTRALLINE_WORKREQUEST)) {
+                        receiveAndWriteChannel();
+                    }
+                    continue;
+                }
+
                 /// one per client ... I dont care what order they come in at
 
                 int targetOutstanding = itsComms.getOutstanding() - itsComms.getClients().size();
@@ -710,28 +760,8 @@ void ContinuumWorker::buildSpectralCube() {
                         break;
                     }
 
-
-                    ContinuumWorkRequest result;
-                    int id;
                     /// this is a blocking receive
-                    result.receiveRequest(id,itsComms);
-                    ASKAPLOG_INFO_STR(logger,"Received a request to write from rank " << id);
-                    int cubeChannel = result.get_globalChannel()-this->baseCubeGlobalChannel;
-
-                    try {
-                        ASKAPLOG_INFO_STR(logger,"Attempting to write channel " << cubeChannel << " of " << this->nchanCube);
-                        ASKAPCHECK( (cubeChannel >= 0 || cubeChannel < this->nchanCube), "cubeChannel outside range of cube slice");
-
-                        handleImageParams(result.get_params(),cubeChannel);
-
-                        ASKAPLOG_INFO_STR(logger,"Written the slice from rank" << id);
-                    }
-
-                    catch (const askap::AskapError& e) {
-                        ASKAPLOG_WARN_STR(logger, "Failed to write a channel to the cube: " << e.what());
-                    }
-
-                    itsComms.removeChannelFromWriter(itsComms.rank());
+                    receiveAndWriteChannel();
                     ASKAPLOG_INFO_STR(logger,"this iteration target is " << targetOutstanding);
                     ASKAPLOG_INFO_STR(logger,"iteration count is " << itsComms.getOutstanding());
                 }
@@ -739,11 +769,18 @@ void ContinuumWorker::buildSpectralCube() {
             }
             else {
 
-                ContinuumWorkRequest result;
-                result.set_params(rootImager.params());
-                result.set_globalChannel(workUnits[workUnitCount-1].get_globalChannel());
-                /// send the work to the writer with a blocking send
-                result.sendRequest(workUnits[workUnitCount-1].get_writer(),itsComms);
+                /// the transfer overlaps with the processing of the next channel,
+                /// but the number of results in memory is limited
+                if (itsPendingResults.size() >= maxPendingResults) {
+                    itsComms.waitSends();
+                    itsPendingResults.clear();
+                }
+                boost::shared_ptr<ContinuumWorkRequest> result(new ContinuumWorkRequest);
+                result->set_params(rootImager.params());
+                result->set_globalChannel(workUnits[workUnitCount-1].get_globalChannel());
+                /// send the work to the writer with a non-blocking send
+                result->sendRequestNonBlocking(workUnits[workUnitCount-1].get_writer(),itsComms);
+                itsPendingResults.push_back(result);
                 itsComms.removeChannelFromWorker(itsComms.rank());
 
             }
@@ -818,29 +855,34 @@ void ContinuumWorker::buildSpectralCube() {
 
     }
     // cleanup
+    ASKAPLOG_DEBUG_STR(logger,"Waiting for " << itsPendingResults.size() << " results to be received");
+    itsComms.waitSends();
+    itsPendingResults.clear();
+
     if (itsComms.isWriter()) {
 
         while (itsComms.getOutstanding()>0) {
             ASKAPLOG_INFO_STR(logger,"I have " << itsComms.getOutstanding() << "outstanding work units");
-            ContinuumWorkRequest result;
-            int id;
-            result.receiveRequest(id,itsComms);
-            ASKAPLOG_INFO_STR(logger,"Received a request to write from rank " << id);
-            int cubeChannel = result.get_globalChannel()-this->baseCubeGlobalChannel;
-            try {
-
-
-                ASKAPLOG_INFO_STR(logger,"Attempting to write channel " << cubeChannel << " of " << this->nchanCube);
-                ASKAPCHECK((cubeChannel >= 0 || cubeChannel < this->nchanCube), "cubeChannel outside range of cube slice");
-                handleImageParams(result.get_params(),cubeChannel);
-                ASKAPLOG_INFO_STR(logger,"Written the slice from rank" << id);
+            receiveAndWriteChannel();
+        }
 
+        // write out the channels still buffered by the cube builders (writebehind=true)
+        boost::shared_ptr<CubeBuilder> cubes[] = {itsImageCube, itsPSFCube, itsResidualCube,
+                                                  itsWeightsCube, itsPSFimageCube, itsRestoredCube};
+        for (size_t i = 0; i < sizeof(cubes) / sizeof(cubes[0]); ++i) {
+            if (cubes[i]) {
+                // carry on with the other cubes, the error is raised at the end of run
+                try {
+                    cubes[i]->flush();
+                }
+                catch (const askap::AskapError& e) {
+                    ASKAPLOG_ERROR_STR(logger, "Failed to write buffered channels to " <<
+                                       cubes[i]->filename() << ": " << e.what());
+                    if (itsCubeWriteError.empty()) {
+                        itsCubeWriteError = e.what();
+                    }
+                }
             }
-            catch (const askap::AskapError& e) {
-                ASKAPLOG_WARN_STR(logger, "Failed to write a channel to the cube: " << e.what());
-            }
-
-            itsComms.removeChannelFromWriter(itsComms.rank());
         }
     }
 
@@ -851,6 +893,61 @@ void ContinuumWorker::buildSpectralCube() {
     }
 
 }
+void ContinuumWorker::receiveAndWriteChannel()
+{
+    ContinuumWorkRequest result;
+    int id;
+    result.receiveRequest(id,itsComms);
+    ASKAPLOG_INFO_STR(logger,"Received a request to write from rank " << id);
+    int cubeChannel = result.get_globalChannel()-this->baseCubeGlobalChannel;
+    try {
+        ASKAPLOG_INFO_STR(logger,"Attempting to write channel " << cubeChannel << " of " << this->nchanCube);
+        ASKAPCHECK((cubeChannel >= 0 || cubeChannel < this->nchanCube), "cubeChannel outside range of cube slice");
+        handleImageParams(result.get_params(),cubeChannel);
+        ASKAPLOG_INFO_STR(logger,"Written the slice from rank" << id);
+    }
+    catch (const askap::AskapError& e) {
+        ASKAPLOG_WARN_STR(logger, "Failed to write a channel to the cube: " << e.what());
+    }
+
+    itsComms.removeChannelFromWriter(itsComms.rank());
+}
+
+bool ContinuumWorker::requestWork()
+{
+    if (!itsDynamicScheduling) {
+        return false;
+    }
+    const size_t nUnits = workUnits.size();
+    // units which can't be processed are dropped, so ask until something is received
+    while (!itsNoMoreWork && (workUnits.size() == nUnits)) {
+        ContinuumWorkRequest wrequest;
+        ASKAPLOG_DEBUG_STR(logger,"Worker is sending request for more work");
+        wrequest.sendRequest(itsMaster,itsComms);
+        while (true) {
+            ContinuumWorkUnit wu;
+            wu.receiveUnitFrom(itsMaster,itsComms);
+            if (wu.get_payloadType() == ContinuumWorkUnit::DONE) {
+                ASKAPLOG_INFO_STR(logger,"Master has no more work for this worker");
+                itsNoMoreWork = true;
+                break;
+            }
+            try {
+                processWorkUnit(wu);
+            }
+            catch (AskapError& e) {
+                ASKAPLOG_WARN_STR(logger, "Failure processing workUnit");
+                ASKAPLOG_WARN_STR(logger, "Exception detail: " << e.what());
+            }
+            if (wu.get_payloadType() == ContinuumWorkUnit::LAST) {
+                break;
+            }
+        }
+    }
+    ASKAPLOG_INFO_STR(logger,"Received " << workUnits.size() - nUnits << " more work units");
+    return workUnits.size() > nUnits;
+}
+
 void ContinuumWorker::handleImageParams(askap::scimath::Params::ShPtr params,
         unsigned int chan)
 {
@@ -1059,6 +1156,7 @@ void ContinuumWorker::processChannels()
 
     ASKAPLOG_INFO_STR(logger,"Building imager for channel " << localChannel);
     CalcCore rootImager(itsParsets[0],itsComms,ds0,localChannel);
+    useCachedData(rootImager, 0);
 
 
     if (nCycles == 0) {
@@ -1087,6 +1185,7 @@ void ContinuumWorker::processChannels()
 
 
             CalcCore workingImager(itsParsets[i],itsComms,ds,localChannel);
+            useCachedData(workingImager, i);
 
             workingImager.replaceModel(rootImager.params());
 
@@ -1177,6 +1276,7 @@ void ContinuumWorker::processChannels()
 
 
                 CalcCore workingImager(itsParsets[i],itsComms,ds,localChannel);
+                useCachedData(workingImager, i);
 
                 workingImager.replaceModel(rootImager.params());
                 ASKAPLOG_DEBUG_STR(logger, "workingImager Model" << workingImager.params());
@@ -1204,6 +1304,16 @@ void ContinuumWorker::processChannels()
 }
 
 
+void ContinuumWorker::useCachedData(CalcCore& imager, const size_t workUnit)
+{
+    if (itsChannelCache) {
+        ASKAPDEBUGASSERT(workUnit < workUnits.size());
+        const ContinuumWorkUnit& wu = workUnits[workUnit];
+        imager.setDataIterator(itsChannelCache->createIterator(wu.get_dataset(), wu.get_beam(),
+                               wu.get_localChannel(), itsParsets[workUnit]));
+    }
+}
+
 void ContinuumWorker::setupImage(const askap::scimath::Params::ShPtr& params,
                                     double channelFrequency)
 {
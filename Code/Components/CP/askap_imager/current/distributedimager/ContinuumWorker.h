@@ -30,6 +30,7 @@
 
 // System includes
 #include <string>
+#include <list>
 
 // ASKAPsoft includes
 #include "boost/shared_ptr.hpp"
@@ -43,7 +44,9 @@
 #include "distributedimager/AdviseDI.h"
 #include "distributedimager/MSSplitter.h"
 #include "distributedimager/CalcCore.h"
+#include "distributedimager/ChannelDataCache.h"
 #include "messages/ContinuumWorkUnit.h"
+#include "messages/ContinuumWorkRequest.h"
 #include "distributedimager/CubeBuilder.h"
 #include "distributedimager/CubeComms.h"
 namespace askap {
@@ -91,6 +94,29 @@ class ContinuumWorker
 
         void buildSpectralCube();
 
+        // Attach the in-memory data of the given work unit to the imager
+        // (does nothing unless the channel cache is in use)
+        void useCachedData(CalcCore& imager, const size_t workUnit);
+
+        // In-memory per-channel data, shared by all work units (channelcache=true)
+        boost::shared_ptr<ChannelDataCache> itsChannelCache;
+
+        // Ask the master for another batch of work units (scheduler=dynamic)
+        // returns true if new work units have been added
+        bool requestWork();
+
+        // Receive a channel from another worker and write it to the cubes
+        void receiveAndWriteChannel();
+
+        // Whether the channels are allocated dynamically (scheduler=dynamic)
+        bool itsDynamicScheduling;
+
+        // Whether the master has no more work for this worker
+        bool itsNoMoreWork;
+
+        // Results sent to the writers which may still be in transit
+        std::list<boost::shared_ptr<ContinuumWorkRequest> > itsPendingResults;
+
         // Root Parameter set good for information common to all workUnits
         LOFAR::ParameterSet& itsParset;
 
@@ -131,6 +157,10 @@ class ContinuumWorker
         boost::shared_ptr<CubeBuilder> itsPSFimageCube;
         boost::shared_ptr<CubeBuilder> itsRestoredCube;
 
+        // errors writing the buffered channels of the cubes, the job fails
+        // after all workers have reached the final barrier if it is not empty
+        std::string itsCubeWriteError;
+
         void handleImageParams(askap::scimath::Params::ShPtr params, unsigned int chan);
         void recordBeam(const askap::scimath::Axes &axes, const unsigned int globalChannel);
         void storeBeam(const unsigned int cubeChannel);
@@ -35,15 +35,18 @@
 #include <iomanip>
 #include <string>
 #include <vector>
+#include <algorithm>
 
 // ASKAPsoft includes
 #include <askap/AskapError.h>
 #include <askap/AskapLogging.h>
+#include <boost/bind.hpp>
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <imageaccess/ImageAccessFactory.h>
 #include <Common/ParameterSet.h>
 #include <utils/PolConverter.h>
 #include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/lattices/Lattices/TiledShape.h>
 #include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
 #include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
 #include <casacore/coordinates/Coordinates/StokesCoordinate.h>
@@ -59,7 +62,18 @@ using namespace askap::cp;
 using namespace casa;
 using namespace std;
 using namespace askap::synthesis;
-CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,const std::string& name) {
+
+namespace {
+/// @brief serialises image I/O of all cube builders
+/// @details Background writers of different cubes and the calls made from the
+/// main thread (e.g. setting the beam) never access casacore images concurrently.
+boost::mutex theImageIOMutex;
+}
+
+CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,const std::string& name) :
+    itsSlabChannels(1), itsBufferSize(0), itsBufferedBytes(0), itsWriting(false),
+    itsStopRequested(false)
+{
     // as long as the cube exists all should be fine
     ASKAPLOG_INFO_STR(logger, "Instantiating Cube Builder with existing cube ");
     itsCube = accessors::imageAccessFactory(parset);
@@ -90,13 +104,22 @@ CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,const std::string& na
         }
     }
     
+    casa::IPosition cubeShape;
+    {
+        boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
+        cubeShape = itsCube->shape(itsFilename);
+    }
+    setupWriter(parset, cubeShape);
+
     ASKAPLOG_INFO_STR(logger, "Instantiated Cube Builder with existing cube " << itsFilename);
 }
 CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,
                          const casa::uInt nchan,
                          const casa::Quantity& f0,
                          const casa::Quantity& inc,
-                         const std::string& name)
+                         const std::string& name) :
+    itsSlabChannels(1), itsBufferSize(0), itsBufferedBytes(0), itsWriting(false),
+    itsStopRequested(false)
 {
     ASKAPLOG_INFO_STR(logger, "Instantiating Cube Builder by creating cube ");
     itsCube = accessors::imageAccessFactory(parset);
@@ -153,11 +176,6 @@ CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,
     const casa::uInt ny = imageShapeVector[1];
     const casa::IPosition cubeShape(4, nx, ny, npol, nchan);
 
-    // Use a tile shape appropriate for plane-by-plane access
-    casa::IPosition tileShape(cubeShape.nelements(), 1);
-    tileShape(0) = 256;
-    tileShape(1) = 256;
-
     const casa::CoordinateSystem csys = createCoordinateSystem(parset, nx, ny, f0, inc);
 
     ASKAPLOG_INFO_STR(logger, "Creating Cube " << itsFilename <<
@@ -166,23 +184,215 @@ CubeBuilder::CubeBuilder(const LOFAR::ParameterSet& parset,
                        "], f0: " << f0.getValue("MHz") << " MHz, finc: " <<
                        inc.getValue("kHz") << " kHz");
 
-    itsCube->create(itsFilename, cubeShape, csys);
+    {
+        boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
+        itsCube->create(itsFilename, cubeShape, csys);
 
-    // default flux units are Jy/pixel. If we set the restoring beam
-    // later on, can set to Jy/beam
-    itsCube->setUnits(itsFilename,"Jy/pixel");
+        // default flux units are Jy/pixel. If we set the restoring beam
+        // later on, can set to Jy/beam
+        itsCube->setUnits(itsFilename,"Jy/pixel");
+    }
+    setupWriter(parset, cubeShape);
 
     ASKAPLOG_INFO_STR(logger, "Instantiated Cube Builder by creating cube " << itsFilename);
 }
 
 CubeBuilder::~CubeBuilder()
 {
+    if (itsThread) {
+        try {
+            flush();
+        }
+        catch (const askap::AskapError& e) {
+            ASKAPLOG_ERROR_STR(logger, "Failed to write buffered channels of " << itsFilename <<
+                               ": " << e.what());
+        }
+        {
+            boost::lock_guard<boost::mutex> lock(itsMutex);
+            itsStopRequested = true;
+        }
+        itsCondVar.notify_all();
+        itsThread->join();
+    }
+}
+
+void CubeBuilder::setupWriter(const LOFAR::ParameterSet& parset, const casa::IPosition& cubeShape)
+{
+    itsCubeShape = cubeShape;
+    if (!parset.getBool("writebehind", false)) {
+        return;
+    }
+    ASKAPCHECK(itsCubeShape.nelements() == 4, "Write-behind requires a 4-dimensional cube, " <<
+               itsFilename << " has the shape " << itsCubeShape);
+    // the default tile shape, as used to create casa images; consecutive channels
+    // sharing the same tiles are written together
+    const casa::IPosition tileShape = casa::TiledShape(itsCubeShape).tileShape();
+    itsSlabChannels = tileShape(3) > 1 ? casa::uInt(tileShape(3)) : 1u;
+    const int bufferSizeMB = parset.getInt32("writebehind.buffersize", 256);
+    ASKAPCHECK(bufferSizeMB > 0, "writebehind.buffersize is supposed to be positive, you have " <<
+               bufferSizeMB);
+    itsBufferSize = static_cast<size_t>(bufferSizeMB) * 1024 * 1024;
+    ASKAPLOG_INFO_STR(logger, "Channels of " << itsFilename << " will be written from a background thread in slabs of " <<
+                      itsSlabChannels << " channel(s), tile shape is " << tileShape <<
+                      ", buffer size is " << bufferSizeMB << " MB");
+    itsThread.reset(new boost::thread(boost::bind(&CubeBuilder::writeBehind, this)));
 }
 
 void CubeBuilder::writeSlice(const casa::Array<float>& arr, const casa::uInt chan)
 {
-    casa::IPosition where(4, 0, 0, 0, chan);
-    itsCube->write(itsFilename,arr, where);
+    if (!itsThread) {
+        boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
+        casa::IPosition where(4, 0, 0, 0, chan);
+        itsCube->write(itsFilename,arr, where);
+        return;
+    }
+
+    const casa::IPosition planeShape(4, itsCubeShape(0), itsCubeShape(1), itsCubeShape(2), 1);
+    ASKAPCHECK(chan < static_cast<casa::uInt>(itsCubeShape(3)), "Channel " << chan <<
+               " is outside the cube " << itsFilename << " with the shape " << itsCubeShape);
+    ASKAPCHECK(arr.nelements() == static_cast<size_t>(planeShape.product()), "Slice of the shape " <<
+               arr.shape() << " doesn't match the shape of the cube " << itsFilename << ": " << itsCubeShape);
+
+    const casa::uInt slabNumber = chan / itsSlabChannels;
+    boost::shared_ptr<Slab> slab;
+    {
+        boost::unique_lock<boost::mutex> lock(itsMutex);
+        checkWriterError();
+        const std::map<casa::uInt, boost::shared_ptr<Slab> >::const_iterator ci = itsSlabs.find(slabNumber);
+        if (ci != itsSlabs.end()) {
+            slab = ci->second;
+        } else {
+            const casa::uInt firstChannel = slabNumber * itsSlabChannels;
+            const casa::uInt nChan = std::min(itsSlabChannels, casa::uInt(itsCubeShape(3)) - firstChannel);
+            const casa::IPosition slabShape(4, itsCubeShape(0), itsCubeShape(1), itsCubeShape(2), nChan);
+            const size_t slabBytes = slabShape.product() * sizeof(float);
+            // stay within the buffer size, at least one slab is always allowed
+            while ((itsBufferedBytes > 0) && (itsBufferedBytes + slabBytes > itsBufferSize)) {
+                if (itsQueue.empty() && !itsWriting) {
+                    // nothing will be freed unless some partially filled slab is written
+                    std::map<casa::uInt, boost::shared_ptr<Slab> >::iterator fullest = itsSlabs.begin();
+                    for (std::map<casa::uInt, boost::shared_ptr<Slab> >::iterator it = itsSlabs.begin();
+                         it != itsSlabs.end(); ++it) {
+                         if (it->second->itsNFilled > fullest->second->itsNFilled) {
+                             fullest = it;
+                         }
+                    }
+                    queueSlab(fullest);
+                }
+                itsCondVar.wait(lock);
+                checkWriterError();
+            }
+            slab.reset(new Slab);
+            slab->itsFirstChannel = firstChannel;
+            slab->itsData.resize(slabShape);
+            slab->itsFilled.assign(nChan, false);
+            slab->itsNFilled = 0;
+            itsSlabs[slabNumber] = slab;
+            itsBufferedBytes += slabBytes;
+        }
+    }
+
+    // slabs being filled are only accessed from this thread, copy without the lock
+    const casa::uInt offset = chan - slab->itsFirstChannel;
+    const casa::IPosition blc(4, 0, 0, 0, offset);
+    const casa::IPosition trc(4, itsCubeShape(0) - 1, itsCubeShape(1) - 1, itsCubeShape(2) - 1, offset);
+    casa::Array<float> plane = slab->itsData(blc, trc);
+    plane = arr.reform(planeShape);
+
+    if (!slab->itsFilled[offset]) {
+        slab->itsFilled[offset] = true;
+        ++slab->itsNFilled;
+    }
+    if (slab->itsNFilled == slab->itsFilled.size()) {
+        boost::lock_guard<boost::mutex> lock(itsMutex);
+        queueSlab(itsSlabs.find(slabNumber));
+    }
+}
+
+void CubeBuilder::flush()
+{
+    if (!itsThread) {
+        return;
+    }
+    boost::unique_lock<boost::mutex> lock(itsMutex);
+    while (!itsSlabs.empty()) {
+        queueSlab(itsSlabs.begin());
+    }
+    while (!itsQueue.empty() || itsWriting) {
+        itsCondVar.wait(lock);
+    }
+    checkWriterError();
+}
+
+void CubeBuilder::queueSlab(const std::map<casa::uInt, boost::shared_ptr<Slab> >::iterator& slab)
+{
+    ASKAPDEBUGASSERT(slab != itsSlabs.end());
+    itsQueue.push_back(slab->second);
+    itsSlabs.erase(slab);
+    itsCondVar.notify_all();
+}
+
+void CubeBuilder::checkWriterError() const
+{
+    ASKAPCHECK(itsWriterError.empty(), "Failed to write " << itsFilename << ": " << itsWriterError);
+}
+
+void CubeBuilder::writeBehind()
+{
+    boost::unique_lock<boost::mutex> lock(itsMutex);
+    while (true) {
+        while (itsQueue.empty() && !itsStopRequested) {
+            itsCondVar.wait(lock);
+        }
+        if (itsQueue.empty()) {
+            // stop requested and everything is written
+            break;
+        }
+        const boost::shared_ptr<Slab> slab = itsQueue.front();
+        itsQueue.pop_front();
+        itsWriting = true;
+        lock.unlock();
+        std::string error;
+        try {
+            writeSlab(*slab);
+        }
+        catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        itsWriting = false;
+        itsBufferedBytes -= slab->itsData.nelements() * sizeof(float);
+        if (!error.empty() && itsWriterError.empty()) {
+            itsWriterError = error;
+        }
+        itsCondVar.notify_all();
+    }
+}
+
+void CubeBuilder::writeSlab(const Slab& slab)
+{
+    const casa::uInt nChan = slab.itsFilled.size();
+    const casa::IPosition &shape = slab.itsData.shape();
+    boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
+    for (casa::uInt start = 0; start < nChan; ) {
+        if (!slab.itsFilled[start]) {
+            ++start;
+            continue;
+        }
+        casa::uInt end = start;
+        while ((end + 1 < nChan) && slab.itsFilled[end + 1]) {
+            ++end;
+        }
+        const casa::IPosition blc(4, 0, 0, 0, start);
+        const casa::IPosition trc(4, shape(0) - 1, shape(1) - 1, shape(2) - 1, end);
+        const casa::IPosition where(4, 0, 0, 0, slab.itsFirstChannel + start);
+        if ((start == 0) && (end + 1 == nChan)) {
+            itsCube->write(itsFilename, slab.itsData, where);
+        } else {
+            itsCube->write(itsFilename, slab.itsData(blc, trc), where);
+        }
+        start = end + 1;
+    }
 }
 
 casa::CoordinateSystem
@@ -265,11 +475,13 @@ CubeBuilder::createCoordinateSystem(const LOFAR::ParameterSet& parset,
 
 void CubeBuilder::addBeam(casa::Vector<casa::Quantum<double> > &beam)
 {
+        boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
         itsCube->setBeamInfo(itsFilename,beam[0].getValue("rad"),beam[1].getValue("rad"),beam[2].getValue("rad"));
-        setUnits("Jy/beam");
+        itsCube->setUnits(itsFilename,"Jy/beam");
 }
 
 void CubeBuilder::setUnits(const std::string &units)
 {
+    boost::lock_guard<boost::mutex> ioLock(theImageIOMutex);
     itsCube->setUnits(itsFilename,units);
 }
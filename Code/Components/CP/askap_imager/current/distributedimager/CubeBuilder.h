@@ -31,9 +31,16 @@
 
 // System includes
 #include <string>
+#include <map>
+#include <deque>
+#include <vector>
 
 // ASKAPsoft includes
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <Common/ParameterSet.h>
 #include <imageaccess/ImageAccessFactory.h>
 
@@ -59,10 +66,23 @@ class CubeBuilder {
         CubeBuilder(const LOFAR::ParameterSet& parset,const std:: string& name);            
 
         /// Destructor
+        /// @details Flushes the buffered channels (if write-behind is used)
         ~CubeBuilder();
 
+        /// @brief write a single channel to the cube
+        /// @details If write-behind is enabled (parameter writebehind), the channel
+        /// is copied into a buffer holding a slab of consecutive channels aligned
+        /// to the tile shape of the cube and the method returns straight away.
+        /// Complete slabs are written by a background thread.
+        /// @param[in] arr channel image (nx, ny, npol, 1)
+        /// @param[in] chan channel in the cube
         void writeSlice(const casa::Array<float>& arr, const casa::uInt chan);
 
+        /// @brief write all buffered channels and wait until they are written
+        /// @details This does nothing if write-behind is not used. Any error raised
+        /// by the background thread is rethrown here or by the next writeSlice.
+        void flush();
+
         casa::CoordinateSystem
         createCoordinateSystem(const LOFAR::ParameterSet& parset,
                                const casa::uInt nx,
@@ -76,8 +96,79 @@ class CubeBuilder {
     std::string filename() const{return itsFilename;};
 
     private:
+        /// @brief consecutive channels buffered for writing
+        struct Slab {
+            /// @brief first channel of the slab in the cube
+            casa::uInt itsFirstChannel;
+            /// @brief pixel values (nx, ny, npol, nchan in the slab)
+            casa::Array<float> itsData;
+            /// @brief true for channels which have been filled
+            std::vector<bool> itsFilled;
+            /// @brief number of channels filled so far
+            casa::uInt itsNFilled;
+        };
+
+        /// @brief setup write-behind buffering
+        /// @details Called from both constructors.
+        /// @param[in] parset parameter set
+        /// @param[in] cubeShape shape of the cube
+        void setupWriter(const LOFAR::ParameterSet& parset, const casa::IPosition& cubeShape);
+
+        /// @brief body of the background thread
+        void writeBehind();
+
+        /// @brief write filled channels of the slab
+        /// @details Each contiguous run of filled channels is written with a single call.
+        /// @param[in] slab slab to write
+        void writeSlab(const Slab& slab);
+
+        /// @brief move a buffered slab to the write queue
+        /// @details The lock on itsMutex should be held by the caller
+        /// @param[in] slab iterator to the slab in itsSlabs
+        void queueSlab(const std::map<casa::uInt, boost::shared_ptr<Slab> >::iterator& slab);
+
+        /// @brief throw an exception if the background thread has failed
+        /// @details The lock on itsMutex should be held by the caller
+        void checkWriterError() const;
+
         boost::shared_ptr<accessors::IImageAccess> itsCube;
 
+        /// @brief shape of the cube
+        casa::IPosition itsCubeShape;
+
+        /// @brief number of channels per slab (the channel depth of a tile)
+        casa::uInt itsSlabChannels;
+
+        /// @brief maximum size in bytes of the buffered and queued slabs
+        size_t itsBufferSize;
+
+        /// @brief size in bytes of the buffered and queued slabs
+        size_t itsBufferedBytes;
+
+        /// @brief slabs being filled, the key is the slab number (channel / itsSlabChannels)
+        std::map<casa::uInt, boost::shared_ptr<Slab> > itsSlabs;
+
+        /// @brief slabs waiting to be written
+        std::deque<boost::shared_ptr<Slab> > itsQueue;
+
+        /// @brief true while the background thread writes a slab
+        bool itsWriting;
+
+        /// @brief true if the background thread has been asked to stop
+        bool itsStopRequested;
+
+        /// @brief error message if writing has failed, empty otherwise
+        std::string itsWriterError;
+
+        /// @brief synchronisation of the state between threads
+        boost::mutex itsMutex;
+
+        /// @brief condition variable signalling changes in the state
+        boost::condition_variable itsCondVar;
+
+        /// @brief background thread, not running unless write-behind is used
+        boost::scoped_ptr<boost::thread> itsThread;
+
 
     /// Image name from parset - must start with "image."
         std::string itsFilename;
@@ -50,7 +50,7 @@ const unsigned int ContinuumWorkRequest::CHANNEL_UNINITIALISED
     = std::numeric_limits<unsigned int>::max();
 
 ContinuumWorkRequest::ContinuumWorkRequest()
-    : itsGlobalChannel(CHANNEL_UNINITIALISED)
+    : itsGlobalChannel(CHANNEL_UNINITIALISED), itsSendSize(0)
 {
 }
 
@@ -140,6 +140,24 @@ void ContinuumWorkRequest::sendRequest(int master, askapparallel::AskapParallel&
 
 
 }
+void ContinuumWorkRequest::sendRequestNonBlocking(int dest, askapparallel::AskapParallel& comm)
+{
+    size_t communicator = 0; //default
+    itsSendBuffer.clear();
+    LOFAR::BlobOBufVector<int8_t> bv(itsSendBuffer);
+    LOFAR::BlobOStream out(bv);
+    out.putStart("Message", 1);
+    this->writeToBlob(out);
+    out.putEnd();
+
+    int messageType = this->getMessageType();
+
+    // Same sequence as sendRequest, so the request is received by receiveRequest
+    itsSendSize = itsSendBuffer.size();
+    comm.sendNonBlocking(&itsSendSize, sizeof(long), dest, messageType, communicator);
+    comm.sendNonBlocking(&itsSendBuffer[0], itsSendSize * sizeof(int8_t), dest, messageType, communicator);
+}
+
 void ContinuumWorkRequest::receiveRequest(int& id, askapparallel::AskapParallel& comm) {
 
     unsigned long size = 0;
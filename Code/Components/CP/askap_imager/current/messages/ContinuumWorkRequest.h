@@ -27,6 +27,10 @@
 #ifndef ASKAP_CP_SIMAGER_CONTINUUMWORKREQUEST_H
 #define ASKAP_CP_SIMAGER_CONTINUUMWORKREQUEST_H
 
+// System includes
+#include <vector>
+#include <stdint.h>
+
 // ASKAPsoft includes
 #include <messages/IMessage.h>
 #include <Blob/BlobOStream.h>
@@ -82,6 +86,13 @@ namespace askap {
                 /// @param[in] comm is the communicator to be used
                 void sendRequest(int master, askap::askapparallel::AskapParallel& comm);
 
+                /// @brief Send this request without waiting for it to be received
+                /// @details The serialised request is kept in this object, which must
+                /// not be destroyed until comm.waitSends() returns.
+                /// @param[in] dest is the id of the node to which the request is sent
+                /// @param[in] comm is the communicator to be used
+                void sendRequestNonBlocking(int dest, askap::askapparallel::AskapParallel& comm);
+
                 /// @brief Receive this request from anyone
                 /// @param[out] id becomes the id of the node sending the request
                 /// @param[in] comm is the communicator to be used
@@ -93,6 +104,10 @@ namespace askap {
                 unsigned int itsGlobalChannel;
                 askap::scimath::Params::ShPtr itsParams;
 
+                // Buffers for the non-blocking send
+                std::vector<int8_t> itsSendBuffer;
+                unsigned long itsSendSize;
+
 
             };
 
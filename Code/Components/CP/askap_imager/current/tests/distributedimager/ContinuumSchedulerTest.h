@@ -0,0 +1,198 @@
+/// @file ContinuumSchedulerTest.h
+///
+/// @copyright (c) 2013 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_SIMAGER_CONTINUUMSCHEDULERTEST_H
+#define ASKAP_CP_SIMAGER_CONTINUUMSCHEDULERTEST_H
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// System includes
+#include <vector>
+
+// Classes to test
+#include <distributedimager/ContinuumScheduler.h>
+#include <messages/ContinuumWorkUnit.h>
+
+namespace askap {
+namespace cp {
+
+class ContinuumSchedulerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ContinuumSchedulerTest);
+        CPPUNIT_TEST(testSingleWorker);
+        CPPUNIT_TEST(testStealing);
+        CPPUNIT_TEST(testWriters);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsHandedOut.clear();
+        }
+
+        // batches shrink as the work runs out and every channel is handed out once
+        void testSingleWorker() {
+            ContinuumScheduler scheduler(allocate(1, 16, 2, 0));
+            CPPUNIT_ASSERT_EQUAL(size_t(16), scheduler.nChannels());
+            size_t previous = 16;
+            size_t nBatches = 0;
+            for (std::vector<unsigned int> batch = next(scheduler, 0, 2); !batch.empty();
+                 batch = next(scheduler, 0, 2), ++nBatches) {
+                 CPPUNIT_ASSERT(batch.size() <= previous);
+                 previous = batch.size();
+            }
+            CPPUNIT_ASSERT(nBatches > 1);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), previous);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.nChannels());
+            // no more work
+            CPPUNIT_ASSERT(scheduler.nextBatch(0).empty());
+            checkAllHandedOut(16);
+        }
+
+        // a worker which has run out of its own channels steals from the others,
+        // but leaves at least one channel to the workers which haven't started
+        void testStealing() {
+            const unsigned int nChan = 8;
+            ContinuumScheduler scheduler(allocate(3, nChan, 1, 0));
+            std::vector<unsigned int> batch = next(scheduler, 1, 1);
+            // own channels come first, from the low frequency end
+            CPPUNIT_ASSERT(!batch.empty());
+            CPPUNIT_ASSERT_EQUAL(nChan, batch.front());
+            while (!batch.empty() && (batch.back() < 2 * nChan) && (batch.back() >= nChan)) {
+                 batch = next(scheduler, 1, 1);
+            }
+            // the first stolen batch comes from the high frequency end of a victim
+            CPPUNIT_ASSERT(!batch.empty());
+            CPPUNIT_ASSERT((batch.front() == 3 * nChan - 1) || (batch.front() == nChan - 1));
+            while (!next(scheduler, 1, 1).empty()) {}
+            CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.nChannels());
+            batch = next(scheduler, 0, 1);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), batch.size());
+            CPPUNIT_ASSERT_EQUAL(0u, batch[0]);
+            batch = next(scheduler, 2, 1);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), batch.size());
+            CPPUNIT_ASSERT_EQUAL(2 * nChan, batch[0]);
+            for (unsigned int worker = 0; worker < 3; ++worker) {
+                 CPPUNIT_ASSERT(next(scheduler, worker, 1).empty());
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.nChannels());
+            checkAllHandedOut(3 * nChan);
+        }
+
+        // writers only steal channels they write themselves
+        void testWriters() {
+            const unsigned int nChan = 8;
+            // workers 0 and 1 are written by rank 1, workers 2 and 3 by rank 3
+            ContinuumScheduler scheduler(allocate(4, nChan, 1, 2));
+            for (std::vector<unsigned int> batch = next(scheduler, 0, 1); !batch.empty();
+                 batch = next(scheduler, 0, 1)) {
+                 for (size_t i = 0; i < batch.size(); ++i) {
+                      CPPUNIT_ASSERT(batch[i] < 2 * nChan);
+                 }
+            }
+            // worker 1 keeps a channel as it hasn't started, workers 2 and 3 are untouched
+            CPPUNIT_ASSERT_EQUAL(size_t(2 * nChan + 1), scheduler.nChannels());
+            // a worker which isn't a writer can steal from anyone
+            while (!next(scheduler, 1, 1).empty()) {}
+            CPPUNIT_ASSERT_EQUAL(size_t(2), scheduler.nChannels());
+            while (!next(scheduler, 2, 1).empty()) {}
+            while (!next(scheduler, 3, 1).empty()) {}
+            CPPUNIT_ASSERT_EQUAL(size_t(0), scheduler.nChannels());
+            checkAllHandedOut(4 * nChan);
+        }
+
+    private:
+        /// @brief make the static allocation
+        /// @details Each worker gets a contiguous block of channels, frequency increases with
+        /// the channel number. Units of the same channel are next to each other.
+        /// @param[in] nWorkers number of workers
+        /// @param[in] nChan number of channels per worker
+        /// @param[in] nDatasets number of datasets (units per channel)
+        /// @param[in] workersPerWriter number of workers sharing a writer, 0 means a single writer
+        /// @return work units for each worker
+        static std::vector<std::vector<ContinuumWorkUnit> > allocate(const unsigned int nWorkers,
+                        const unsigned int nChan, const unsigned int nDatasets,
+                        const unsigned int workersPerWriter) {
+            std::vector<std::vector<ContinuumWorkUnit> > result(nWorkers);
+            for (unsigned int worker = 0; worker < nWorkers; ++worker) {
+                 const unsigned int writer = workersPerWriter > 0 ?
+                       (worker / workersPerWriter) * workersPerWriter + 1 : 1;
+                 for (unsigned int chan = worker * nChan; chan < (worker + 1) * nChan; ++chan) {
+                      for (unsigned int dataset = 0; dataset < nDatasets; ++dataset) {
+                           ContinuumWorkUnit wu;
+                           wu.set_payloadType(ContinuumWorkUnit::WORK);
+                           wu.set_globalChannel(chan);
+                           wu.set_localChannel(chan - worker * nChan);
+                           wu.set_channelFrequency(1.0e9 + 1.0e6 * chan);
+                           wu.set_writer(writer);
+                           result[worker].push_back(wu);
+                      }
+                 }
+            }
+            return result;
+        }
+
+        /// @brief get the next batch and record the channels handed out
+        /// @param[in] scheduler scheduler to use
+        /// @param[in] worker worker number (rank - 1)
+        /// @param[in] nDatasets expected number of units per channel
+        /// @return channels of the batch, in the order they are given
+        std::vector<unsigned int> next(ContinuumScheduler &scheduler, const unsigned int worker,
+                                       const unsigned int nDatasets) {
+            const std::vector<ContinuumWorkUnit> units = scheduler.nextBatch(worker);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), units.size() % nDatasets);
+            std::vector<unsigned int> channels;
+            for (size_t i = 0; i < units.size(); i += nDatasets) {
+                 // channels are not split between batches
+                 for (size_t j = i; j < i + nDatasets; ++j) {
+                      CPPUNIT_ASSERT_EQUAL(units[i].get_globalChannel(), units[j].get_globalChannel());
+                      CPPUNIT_ASSERT(units[j].get_payloadType() == ContinuumWorkUnit::WORK);
+                 }
+                 const unsigned int chan = units[i].get_globalChannel();
+                 channels.push_back(chan);
+                 if (itsHandedOut.size() <= chan) {
+                     itsHandedOut.resize(chan + 1, 0);
+                 }
+                 ++itsHandedOut[chan];
+            }
+            return channels;
+        }
+
+        /// @brief check that every channel has been handed out exactly once
+        /// @param[in] nChan total number of channels
+        void checkAllHandedOut(const unsigned int nChan) const {
+            CPPUNIT_ASSERT_EQUAL(size_t(nChan), itsHandedOut.size());
+            for (size_t chan = 0; chan < itsHandedOut.size(); ++chan) {
+                 CPPUNIT_ASSERT_EQUAL(1, itsHandedOut[chan]);
+            }
+        }
+
+        /// @brief number of times each global channel has been handed out
+        std::vector<int> itsHandedOut;
+};
+
+}   // End namespace cp
+}   // End namespace askap
+
+#endif
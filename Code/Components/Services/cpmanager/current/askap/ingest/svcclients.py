@@ -62,7 +62,9 @@ class IceMonitoringServiceClient(object):
     'cp.ingest.obs.Interval', 'cp.ingest.obs.StartFreq', 'cp.ingest.obs.nChan', 'cp.ingest.obs.ChanWidth', \
     'cp.ingest.obs.SourceStartFreq', 'cp.ingest.obs.SourceNChan', 'cp.ingest.obs.SourceChanWidth', \
     'cp.ingest.dUTC', 'cp.ingest.dUT1', 'cp.ingest.MeasuresTableMJD', 'cp.ingest.MeasuresTableVersion', \
-    'cp.ingest.SoftwareVersion', 'cp.ingest.obs.DataRate', 'cp.ingest.PacketsBuffered', 'cp.ingest.BufferUsagePercent']
+    'cp.ingest.SoftwareVersion', 'cp.ingest.obs.DataRate', 'cp.ingest.PacketsBuffered', 'cp.ingest.BufferUsagePercent', \
+    'cp.ingest.PacketsDroppedSocket', 'cp.ingest.PacketsDroppedBuffer', 'cp.ingest.ReceiveBatchSize', \
+    'cp.ingest.PacketsBufferedMax']
 
         self.data_service = DataServiceClient(comm)
 
@@ -36,6 +36,7 @@
 #include <map>
 #include <limits>
 #include <utility>
+#include <algorithm>
 #include <stdint.h>
 
 // ASKAPsoft includes
@@ -216,6 +217,30 @@ void Configuration::buildTasks(void)
     for (it = names.begin(); it != names.end(); ++it) {
         itsTasks.push_back(taskByName(*it));
     }
+
+    // Split into stages for the threaded execution, if requested
+    const vector<string> stageNames = itsParset.getStringVector("tasks.stages", vector<string>());
+    for (it = stageNames.begin(); it != stageNames.end(); ++it) {
+        const vector<string>::const_iterator taskIt = std::find(names.begin(), names.end(), *it);
+        ASKAPCHECK(taskIt != names.end(), "Task "<<*it<<" listed in tasks.stages is not present in tasks.tasklist");
+        ASKAPCHECK(std::count(names.begin(), names.end(), *it) == 1, "Task "<<*it<<
+                   " listed in tasks.stages should appear in tasks.tasklist only once");
+        const size_t index = static_cast<size_t>(taskIt - names.begin());
+        ASKAPCHECK(index > 0, "The source task always belongs to the first stage, it can't be listed in tasks.stages");
+        ASKAPCHECK(itsStages.size() == 0 || itsStages.back() < index,
+                   "Tasks listed in tasks.stages should follow the order of tasks.tasklist without duplicates");
+        itsStages.push_back(index);
+    }
+}
+
+const std::vector<size_t>& Configuration::stages(void) const
+{
+    return itsStages;
+}
+
+casa::uInt Configuration::stageQueueSize(void) const
+{
+    return itsParset.getUint32("tasks.stagequeue", 2);
 }
 
 /// @brief task description by logical name
@@ -92,6 +92,18 @@ class Configuration {
         /// @brief A sequence of tasks configuration.
         const std::vector<TaskDesc>& tasks(void) const;
 
+        /// @brief Task chain split into stages.
+        /// @details Tasks starting a new stage of the staged (threaded) execution
+        /// are listed in the tasks.stages parameter. The first stage always begins with
+        /// the source task and runs in the main thread, every other stage gets its own thread.
+        /// @return indices into the vector returned by tasks() of the first task of every stage
+        /// except the first one (empty vector means sequential execution of the whole chain)
+        const std::vector<size_t>& stages(void) const;
+
+        /// @brief Capacity of the queue connecting adjacent stages
+        /// @return the maximum number of chunks waiting to be processed by a stage
+        casa::uInt stageQueueSize(void) const;
+
         /// @brief task description by logical name
         /// @param[in] name logical name of the task
         /// @return task descriptor
@@ -170,6 +182,9 @@ class Configuration {
 
         std::vector<TaskDesc> itsTasks;
 
+        /// Indices of tasks starting a new stage of execution
+        std::vector<size_t> itsStages;
+
         std::map<std::string, CorrelatorMode> itsCorrelatorModes;
 
         boost::shared_ptr<BaselineMap> itsBaselineMap;
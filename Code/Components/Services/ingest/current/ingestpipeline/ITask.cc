@@ -56,4 +56,17 @@ bool askap::cp::ingest::ITask::isAlwaysActive() const
 {
   return false;
 }
+
+/// @brief does this task call MPI routines?
+/// @details MPI is initialised without thread support, so tasks calling MPI
+/// routines from the process method should run in the main thread, i.e. they
+/// should belong to the first stage if the task chain is split into stages. This is
+/// checked after the first cycle (which is always executed in the main thread), so
+/// tasks using MPI for initialisation only may return false from then on.
+/// @return true, if subsequent calls to process method may call MPI routines
+/// @note default action is to return false
+bool askap::cp::ingest::ITask::usesMPI() const
+{
+  return false;
+}
         
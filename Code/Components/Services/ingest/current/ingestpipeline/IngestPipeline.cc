@@ -59,7 +59,8 @@ using namespace askap::cp::ingest;
 
 IngestPipeline::IngestPipeline(const LOFAR::ParameterSet& parset,
                                int rank, int ntasks)
-    : itsConfig(parset, rank, ntasks), itsRunning(false)
+    : itsConfig(parset, rank, ntasks), itsRunning(false), itsFirstCycle(true),
+      itsDownstreamAlwaysActive(false)
 {
 }
 
@@ -114,6 +115,7 @@ void IngestPipeline::ingest(void)
         ITask::ShPtr task = factory.createTask(tasks[i]);
         itsTasks.push_back(task);
     }
+    setupStages();
 
     // 6) Process correlator integrations, one at a time
     casa::Timer timer;
@@ -132,6 +134,7 @@ void IngestPipeline::ingest(void)
     }
 
     // 7) Clean up
+    finishStages();
     itsSource.reset();
     MonitoringSingleton::invalidatePoint("SourceTaskDuration");
     MonitoringSingleton::invalidatePoint("ProcessingDuration");
@@ -169,22 +172,40 @@ bool IngestPipeline::ingestOne(void)
     } 
 
     // For each task call process on the VisChunk as long as this rank stays active
-    double processingTime = 0.;
     // the following flag is used as a safeguard against no processing at all for
     // service ranks with a non-blocking source
     bool wasProcessed = false;
-    for (unsigned int i = 0; i < itsTasks.size(); ++i) {
-         if (chunk || itsTasks[i]->isAlwaysActive()) {
-             timer.mark();
-             itsTasks[i]->process(chunk);
-             if ((itsConfig.receiverId() == 0) || (!itsConfig.receivingRank())) {
-                 ASKAPLOG_DEBUG_STR(logger, itsTasks[i]->getName() << " execution time "
-                       << timer.real() << "s");
+    timer.mark();
+    ASKAPDEBUGASSERT(itsStages.size() > 0);
+    if (itsFirstCycle || (itsStages.size() == 1)) {
+        // the first cycle is always processed sequentially in the main thread - this locks in
+        // the data distribution pattern and helps with lack of thread-safety in some casacore routines
+        for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+             if (itsStages[stage]->process(chunk)) {
+                 wasProcessed = true;
              }
-             wasProcessed = true;
-             processingTime += timer.real();
-         }
+        }
+        if (itsFirstCycle && (itsStages.size() > 1)) {
+            for (size_t stage = 1; stage < itsStages.size(); ++stage) {
+                 if (itsStages[stage]->hasAlwaysActiveTasks()) {
+                     itsDownstreamAlwaysActive = true;
+                 }
+            }
+            startStages();
+        }
+        itsFirstCycle = false;
+    } else {
+        ASKAPCHECK(!itsStages[1]->failed(), "Staged execution of the task chain has failed: "<<
+                   itsStages[1]->error());
+        wasProcessed = itsStages[0]->process(chunk);
+        // hand over to the next stage, this blocks if the next stage doesn't keep up
+        // and its queue is full
+        if (chunk || itsDownstreamAlwaysActive) {
+            itsStages[1]->push(chunk);
+            wasProcessed = true;
+        }
     }
+    const double processingTime = timer.real();
     
     MonitoringSingleton::update<double>("ProcessingDuration",processingTime, MonitorPointStatus::OK, "s");
 
@@ -200,3 +221,56 @@ bool IngestPipeline::ingestOne(void)
 
     return false; // Not finished
 }
+
+void IngestPipeline::setupStages(void)
+{
+    // indices in the configuration include the source task which is not in itsTasks
+    const std::vector<size_t>& stages = itsConfig.stages();
+    const casa::uInt queueSize = itsConfig.stageQueueSize();
+    const bool verbose = (itsConfig.receiverId() == 0) || !itsConfig.receivingRank();
+    size_t first = 0;
+    for (size_t stage = 0; stage <= stages.size(); ++stage) {
+         const size_t last = stage < stages.size() ? stages[stage] - 1 : itsTasks.size();
+         ASKAPDEBUGASSERT(last <= itsTasks.size());
+         ASKAPDEBUGASSERT(first <= last);
+         const std::vector<ITask::ShPtr> tasks(itsTasks.begin() + first, itsTasks.begin() + last);
+         itsStages.push_back(PipelineStage::ShPtr(new PipelineStage(tasks, stage, queueSize, verbose)));
+         first = last;
+    }
+    if (stages.size() > 0) {
+        ASKAPLOG_INFO_STR(logger, "Task chain is split into "<<itsStages.size()<<
+                          " stages, queue size: "<<queueSize);
+    }
+}
+
+void IngestPipeline::startStages(void)
+{
+    // MPI is initialised without thread support and the source task calls MPI
+    // routines in the main thread, so no other thread can do MPI communication.
+    // Some tasks use MPI for initialisation only, hence the check after the first cycle.
+    for (size_t stage = 1; stage < itsStages.size(); ++stage) {
+         const std::string task = itsStages[stage]->taskUsingMPI();
+         ASKAPCHECK(task.empty(), "Task "<<task<<" does MPI communication and has to belong to the first stage "
+                    "(before any task listed in tasks.stages), it is in stage "<<stage);
+    }
+    // the first stage is processed in the main thread
+    for (size_t stage = 1; stage < itsStages.size(); ++stage) {
+         const PipelineStage::ShPtr next = stage + 1 < itsStages.size() ?
+                   itsStages[stage + 1] : PipelineStage::ShPtr();
+         itsStages[stage]->start(next);
+    }
+}
+
+void IngestPipeline::finishStages(void)
+{
+    if (itsStages.size() > 1) {
+        itsStages[1]->finish();
+        if (itsStages[1]->failed()) {
+            ASKAPLOG_ERROR_STR(logger, "Staged execution of the task chain has failed: "<<
+                               itsStages[1]->error());
+        }
+    }
+    for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+         itsStages[stage]->invalidateMonitoringPoints();
+    }
+}
@@ -37,6 +37,7 @@
 // Local package includes
 #include "ingestpipeline/sourcetask/ISource.h"
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/PipelineStage.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -72,6 +73,18 @@ class IngestPipeline {
 
         bool ingestOne(void);
 
+        /// @brief split the task chain into stages
+        /// @details The first stage contains tasks executed in the main thread
+        /// (right after the source task), other stages get their own threads. If
+        /// staged execution is not configured, the only stage contains all tasks.
+        void setupStages(void);
+
+        /// @brief start threads for all stages except the first one
+        void startStages(void);
+
+        /// @brief flush data through all stages and stop the threads
+        void finishStages(void);
+
         const Configuration itsConfig;
 
         bool itsRunning;
@@ -80,6 +93,15 @@ class IngestPipeline {
 
         std::vector<ITask::ShPtr> itsTasks;
 
+        /// Stages of execution, the first one is processed in the main thread
+        std::vector<PipelineStage::ShPtr> itsStages;
+
+        /// True until the first integration has passed through the whole chain
+        bool itsFirstCycle;
+
+        /// True if some task beyond the first stage is active for all ranks
+        bool itsDownstreamAlwaysActive;
+
         // No support for assignment
         IngestPipeline& operator=(const IngestPipeline& rhs);
 
@@ -0,0 +1,254 @@
+/// @file PipelineStage.cc
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "PipelineStage.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <exception>
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "askap/AskapUtil.h"
+#include "cpcommon/VisChunk.h"
+
+// boost includes
+#include "boost/bind.hpp"
+
+// Local package includes
+#include "monitoring/MonitoringSingleton.h"
+
+ASKAP_LOGGER(logger, ".PipelineStage");
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+/// @brief constructor
+/// @param[in] tasks tasks of this stage in the order of execution
+/// @param[in] index stage number (used for logging and monitoring)
+/// @param[in] queueSize the maximum number of chunks waiting to be processed
+/// @param[in] verbose if true, execution time of each task is logged
+PipelineStage::PipelineStage(const std::vector<ITask::ShPtr> &tasks, size_t index,
+                             casa::uInt queueSize, bool verbose) :
+     itsTasks(tasks), itsIndex(index), itsVerbose(verbose), itsQueue(queueSize),
+     itsFailed(false)
+{
+}
+
+/// @brief destructor
+/// @details Stops the service thread (if running) after the queued data are processed
+PipelineStage::~PipelineStage()
+{
+    if (itsThread) {
+        // this is normally done via finish(), but do it here too in case of an exception
+        try {
+            itsQueue.addWhenThereIsSpace(boost::shared_ptr<QueueItem>(new QueueItem(VisChunk::ShPtr(), true)));
+            itsThread->join();
+        } catch (...) {
+            ASKAPLOG_ERROR_STR(logger, "Exception caught while stopping the thread for stage "<<itsIndex);
+        }
+    }
+}
+
+/// @brief process chunk in the calling thread
+/// @details Each task of this stage is executed as long as the rank stays active
+/// or the task is active for all ranks.
+/// @param[in,out] chunk the instance of VisChunk to work with
+/// @return true, if any task has been executed
+bool PipelineStage::process(VisChunk::ShPtr &chunk)
+{
+    casa::Timer timer;
+    double processingTime = 0.;
+    bool wasProcessed = false;
+    for (size_t i = 0; i < itsTasks.size(); ++i) {
+         if (chunk || itsTasks[i]->isAlwaysActive()) {
+             timer.mark();
+             itsTasks[i]->process(chunk);
+             if (itsVerbose) {
+                 ASKAPLOG_DEBUG_STR(logger, itsTasks[i]->getName() << " execution time "
+                       << timer.real() << "s");
+             }
+             wasProcessed = true;
+             processingTime += timer.real();
+         }
+    }
+    MonitoringSingleton::update<double>(pointName("Duration"), processingTime, MonitorPointStatus::OK, "s");
+    return wasProcessed;
+}
+
+/// @brief start the service thread
+/// @details After this call, chunks are expected to be passed to this stage via
+/// the push method. The result of processing is passed to the next stage, if defined.
+/// @param[in] next next stage, empty pointer if this is the last stage
+void PipelineStage::start(const PipelineStage::ShPtr &next)
+{
+    ASKAPCHECK(!itsThread, "Thread for stage "<<itsIndex<<" has already been started");
+    itsNext = next;
+    ASKAPLOG_DEBUG_STR(logger, "Starting thread for stage "<<itsIndex<<" with "<<itsTasks.size()<<
+                      " task(s), queue size: "<<itsQueue.capacity());
+    itsThread.reset(new boost::thread(boost::bind(&PipelineStage::parallelThread, this)));
+}
+
+/// @brief queue chunk for processing in the service thread
+/// @details This method blocks until there is space in the queue.
+/// @param[in] chunk chunk to process (empty pointer for deactivated rank)
+void PipelineStage::push(const VisChunk::ShPtr &chunk)
+{
+    ASKAPDEBUGASSERT(itsThread);
+    itsQueue.addWhenThereIsSpace(boost::shared_ptr<QueueItem>(new QueueItem(chunk, false)));
+}
+
+/// @brief finish processing
+/// @details Processes all queued data, stops the service thread and
+/// then finishes the next stage (if any), so data are flushed through
+/// the remaining part of the chain.
+void PipelineStage::finish()
+{
+    if (itsThread) {
+        itsQueue.addWhenThereIsSpace(boost::shared_ptr<QueueItem>(new QueueItem(VisChunk::ShPtr(), true)));
+        itsThread->join();
+        itsThread.reset();
+        ASKAPLOG_DEBUG_STR(logger, "Thread for stage "<<itsIndex<<" has finished");
+    }
+    if (itsNext) {
+        itsNext->finish();
+    }
+}
+
+/// @brief check whether processing in the service thread has failed
+/// @details If a task throws an exception in the service thread, the error
+/// is logged, the remaining data are discarded and this method returns true.
+/// @return true if processing in the service thread has failed
+bool PipelineStage::failed() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsFailed || (itsNext && itsNext->failed());
+}
+
+/// @brief error message corresponding to the failure
+/// @return message of the exception thrown in the service thread
+std::string PipelineStage::error() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    if (!itsFailed && itsNext) {
+        lock.unlock();
+        return itsNext->error();
+    }
+    return itsError;
+}
+
+/// @brief check whether any task of this stage is active for all ranks
+/// @return true, if at least one task of this stage requires execution for inactive ranks
+bool PipelineStage::hasAlwaysActiveTasks() const
+{
+    for (size_t i = 0; i < itsTasks.size(); ++i) {
+         if (itsTasks[i]->isAlwaysActive()) {
+             return true;
+         }
+    }
+    return false;
+}
+
+/// @brief find a task of this stage calling MPI routines
+/// @return name of the first task of this stage which may call MPI routines
+/// in subsequent cycles, an empty string if there is no such task
+std::string PipelineStage::taskUsingMPI() const
+{
+    for (size_t i = 0; i < itsTasks.size(); ++i) {
+         if (itsTasks[i]->usesMPI()) {
+             return itsTasks[i]->getName();
+         }
+    }
+    return "";
+}
+
+/// @brief invalidate monitoring points published by this stage
+void PipelineStage::invalidateMonitoringPoints() const
+{
+    MonitoringSingleton::invalidatePoint(pointName("Duration"));
+    MonitoringSingleton::invalidatePoint(pointName("Latency"));
+    MonitoringSingleton::invalidatePoint(pointName("QueueDepth"));
+    MonitoringSingleton::invalidatePoint(pointName("QueuePeak"));
+}
+
+/// @brief service thread entry point
+void PipelineStage::parallelThread()
+{
+    ASKAPLOG_DEBUG_STR(logger, "Running thread for stage "<<itsIndex);
+    bool failed = false;
+    while (true) {
+        // blocking call, the end of stream marker is always queued eventually
+        boost::shared_ptr<QueueItem> item = itsQueue.next();
+        ASKAPDEBUGASSERT(item);
+        if (item->itsEndOfStream) {
+            break;
+        }
+        if (failed) {
+            // just drain the queue, so upstream stages are not blocked
+            continue;
+        }
+        const double waitTime = item->itsTimer.real();
+        MonitoringSingleton::update<int32_t>(pointName("QueueDepth"), static_cast<int32_t>(itsQueue.size()));
+        MonitoringSingleton::update<int32_t>(pointName("QueuePeak"), static_cast<int32_t>(itsQueue.highWaterMark()));
+        itsQueue.resetHighWaterMark();
+        try {
+            casa::Timer timer;
+            timer.mark();
+            process(item->itsChunk);
+            const double latency = waitTime + timer.real();
+            MonitoringSingleton::update<double>(pointName("Latency"), latency, MonitorPointStatus::OK, "s");
+            if (itsVerbose) {
+                ASKAPLOG_DEBUG_STR(logger, "Stage "<<itsIndex<<" latency "<<latency<<"s, including "<<
+                                  waitTime<<"s in the queue");
+            }
+            if (itsNext) {
+                itsNext->push(item->itsChunk);
+            }
+        } catch (const std::exception &ex) {
+            ASKAPLOG_ERROR_STR(logger, "Stage "<<itsIndex<<" failed: "<<ex.what()<<
+                              "; the remaining data will be discarded");
+            failed = true;
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsFailed = true;
+            itsError = ex.what();
+        }
+    }
+    ASKAPLOG_DEBUG_STR(logger, "Thread for stage "<<itsIndex<<" is finishing");
+}
+
+/// @brief name of the monitoring point for this stage
+/// @param[in] suffix name of the quantity
+/// @return full name of the monitoring point
+std::string PipelineStage::pointName(const std::string &suffix) const
+{
+    return "Stage" + utility::toString<size_t>(itsIndex) + suffix;
+}
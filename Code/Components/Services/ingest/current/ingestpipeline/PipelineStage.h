@@ -0,0 +1,190 @@
+/// @file PipelineStage.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_PIPELINESTAGE_H
+#define ASKAP_CP_INGEST_PIPELINESTAGE_H
+
+// System includes
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "cpcommon/VisChunk.h"
+#include "casacore/casa/OS/Timer.h"
+
+// boost includes
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+
+// Local package includes
+#include "ingestpipeline/ITask.h"
+#include "ingestpipeline/sourcetask/CircularBuffer.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief group of tasks executed together
+/// @details The task chain of the ingest pipeline can be split into stages. Tasks within
+/// one stage are executed sequentially, like the whole chain is executed in the default mode.
+/// The first stage (starting with the source task) runs in the main thread, the other stages
+/// run in their own threads and receive data from the previous stage via a bounded queue.
+/// Each stage is handled by a single thread and queues are first in first out, so the order
+/// of chunks is preserved. Adding to the queue blocks if it is full, so the data are not lost
+/// if some stage temporarily does not keep up (e.g. due to MSSink flushing data to disk), as
+/// long as the queue is deep enough to absorb the stall.
+///
+/// Execution time of the stage, latency (time since the chunk was queued until it has been
+/// processed) and the queue depth are published as monitoring points with the StageN prefix
+/// where N is the stage number.
+class PipelineStage {
+    public:
+        /// @brief shared pointer type
+        typedef boost::shared_ptr<PipelineStage> ShPtr;
+
+        /// @brief constructor
+        /// @param[in] tasks tasks of this stage in the order of execution
+        /// @param[in] index stage number (used for logging and monitoring)
+        /// @param[in] queueSize the maximum number of chunks waiting to be processed
+        /// @param[in] verbose if true, execution time of each task is logged
+        PipelineStage(const std::vector<ITask::ShPtr> &tasks, size_t index,
+                      casa::uInt queueSize, bool verbose);
+
+        /// @brief destructor
+        /// @details Stops the service thread (if running) after the queued data are processed
+        ~PipelineStage();
+
+        /// @brief process chunk in the calling thread
+        /// @details Each task of this stage is executed as long as the rank stays active
+        /// or the task is active for all ranks.
+        /// @param[in,out] chunk the instance of VisChunk to work with
+        /// @return true, if any task has been executed
+        bool process(askap::cp::common::VisChunk::ShPtr &chunk);
+
+        /// @brief start the service thread
+        /// @details After this call, chunks are expected to be passed to this stage via
+        /// the push method. The result of processing is passed to the next stage, if defined.
+        /// @param[in] next next stage, empty pointer if this is the last stage
+        void start(const ShPtr &next);
+
+        /// @brief queue chunk for processing in the service thread
+        /// @details This method blocks until there is space in the queue.
+        /// @param[in] chunk chunk to process (empty pointer for deactivated rank)
+        void push(const askap::cp::common::VisChunk::ShPtr &chunk);
+
+        /// @brief finish processing
+        /// @details Processes all queued data, stops the service thread and
+        /// then finishes the next stage (if any), so data are flushed through
+        /// the remaining part of the chain.
+        void finish();
+
+        /// @brief check whether processing in the service thread has failed
+        /// @details If a task throws an exception in the service thread, the error
+        /// is logged, the remaining data are discarded and this method returns true.
+        /// @return true if processing in the service thread has failed
+        bool failed() const;
+
+        /// @brief error message corresponding to the failure
+        /// @return message of the exception thrown in the service thread
+        std::string error() const;
+
+        /// @brief check whether any task of this stage is active for all ranks
+        /// @return true, if at least one task of this stage requires execution for inactive ranks
+        bool hasAlwaysActiveTasks() const;
+
+        /// @brief find a task of this stage calling MPI routines
+        /// @return name of the first task of this stage which may call MPI routines
+        /// in subsequent cycles, an empty string if there is no such task
+        std::string taskUsingMPI() const;
+
+        /// @brief invalidate monitoring points published by this stage
+        void invalidateMonitoringPoints() const;
+
+    private:
+        /// @brief element of the queue
+        struct QueueItem {
+            /// @brief constructor
+            /// @param[in] chunk data chunk (empty pointer for deactivated rank)
+            /// @param[in] endOfStream true for the marker requesting the thread to finish
+            QueueItem(const askap::cp::common::VisChunk::ShPtr &chunk, bool endOfStream) :
+                      itsChunk(chunk), itsEndOfStream(endOfStream) {}
+
+            /// @brief data chunk
+            askap::cp::common::VisChunk::ShPtr itsChunk;
+
+            /// @brief end of stream marker
+            bool itsEndOfStream;
+
+            /// @brief timer marked when the item is queued
+            casa::Timer itsTimer;
+        };
+
+        /// @brief service thread entry point
+        void parallelThread();
+
+        /// @brief name of the monitoring point for this stage
+        /// @param[in] suffix name of the quantity
+        /// @return full name of the monitoring point
+        std::string pointName(const std::string &suffix) const;
+
+        /// @brief tasks of this stage
+        std::vector<ITask::ShPtr> itsTasks;
+
+        /// @brief stage number
+        size_t itsIndex;
+
+        /// @brief true if execution time of each task is logged
+        bool itsVerbose;
+
+        /// @brief queue of chunks to process
+        CircularBuffer<QueueItem> itsQueue;
+
+        /// @brief next stage
+        ShPtr itsNext;
+
+        /// @brief service thread
+        boost::shared_ptr<boost::thread> itsThread;
+
+        /// @brief mutex protecting error state
+        mutable boost::mutex itsMutex;
+
+        /// @brief true if processing has failed
+        bool itsFailed;
+
+        /// @brief error message
+        std::string itsError;
+
+        // No support for assignment
+        PipelineStage& operator=(const PipelineStage& rhs);
+
+        // No support for copy constructor
+        PipelineStage(const PipelineStage& src);
+};
+
+}
+}
+}
+
+#endif
@@ -152,8 +152,9 @@ boost::shared_ptr< ISource > TaskFactory::createMergedSource(void)
         const std::string mdTopic = itsConfig.metadataTopic().topic();
         const unsigned int mdBufSz = 12; // TODO: Make this a tunable
         const std::string mdAdapterName = "IngestPipeline";
+        const std::string mdBufType = itsConfig.tasks().at(0).params().getString("metadata_buffer_type", "circular");
         metadataSrc.reset(new MetadataSource(mdLocatorHost,
-                 mdLocatorPort, mdTopicManager, mdTopic, mdAdapterName, mdBufSz));
+                 mdLocatorPort, mdTopicManager, mdTopic, mdAdapterName, mdBufSz, mdBufType));
     }
     if (numProcs > 1) {
         // parallel case - wrap metadata source in an adapter
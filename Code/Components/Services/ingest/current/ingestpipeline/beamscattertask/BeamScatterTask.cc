@@ -192,6 +192,18 @@ bool BeamScatterTask::isAlwaysActive() const
    return (itsCommunicator == NULL) || (itsStreamNumber >= 0);
 }
 
+/// @brief does this task call MPI routines?
+/// @details MPI is initialised without thread support, so tasks calling MPI
+/// routines from the process method should run in the main thread, i.e. they
+/// should belong to the first stage if the task chain is split into stages. This is
+/// checked after the first cycle (which is always executed in the main thread), so
+/// tasks using MPI for initialisation only may return false from then on.
+/// @return true, if subsequent calls to process method may call MPI routines
+bool BeamScatterTask::usesMPI() const
+{
+   return true;
+}
+
 
 /// @brief local rank in the group
 /// @details Returns the rank against the local communicator, i.e.
@@ -51,6 +51,7 @@
 #include "casacore/scimath/Mathematics/RigidVector.h"
 #include "cpcommon/VisChunk.h"
 #include "casacore/measures/Measures/UVWMachine.h"
+#include "casacore/casa/Quanta/MVDirection.h"
 
 // Local package includes
 #include "configuration/Configuration.h" // Includes all configuration attributes too
@@ -78,11 +79,65 @@ CalcUVWTask::~CalcUVWTask()
 
 void CalcUVWTask::process(VisChunk::ShPtr& chunk)
 {
+    // Quantities which depend on time only are computed once per chunk
+    const double gast = calcGAST(chunk->time()); 
+    const casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
+    const casa::uInt nAnt = nAntennas();
+
+    // Per-antenna uvw for each distinct combination of beam and dish pointing.
+    // Rows usually share a small number of such combinations (one per beam), so a linear
+    // search is sufficient. The uvw of a baseline is then just a difference of two columns.
+    std::vector<casa::uInt> beams;
+    std::vector<casa::MVDirection> pointings;
+    std::vector<casa::Matrix<double> > antUVWs;
+
+    const casa::Vector<casa::uInt>& ant1 = chunk->antenna1();
+    const casa::Vector<casa::uInt>& ant2 = chunk->antenna2();
+    const casa::Vector<casa::uInt>& beam1 = chunk->beam1();
+    const casa::Vector<casa::MVDirection>& dishPointing = chunk->phaseCentre();
+    casa::Vector<casa::RigidVector<casa::Double, 3> >& uvw = chunk->uvw();
+
+    size_t current = 0;
     for (casa::uInt row = 0; row < chunk->nRow(); ++row) {
-        calcForRow(chunk, row);
+        ASKAPCHECK(ant1(row) < nAnt, "Antenna index (" << ant1(row) << ") is invalid");
+        ASKAPCHECK(ant2(row) < nAnt, "Antenna index (" << ant2(row) << ") is invalid");
+
+        // consecutive rows are likely to correspond to the same beam, check the last match first
+        if ((current >= beams.size()) || (beams[current] != beam1(row)) ||
+            !samePointing(pointings[current], dishPointing(row))) {
+            for (current = 0; current < beams.size(); ++current) {
+                 if ((beams[current] == beam1(row)) && samePointing(pointings[current], dishPointing(row))) {
+                     break;
+                 }
+            }
+            if (current == beams.size()) {
+                beams.push_back(beam1(row));
+                pointings.push_back(dishPointing(row));
+                antUVWs.push_back(casa::Matrix<double>(3, nAnt));
+                calcAntennaUVW(dishPointing(row), beam1(row), frame, gast, antUVWs.back());
+            }
+        }
+
+        const casa::Matrix<double>& antUVW = antUVWs[current];
+        uvw(row) = casa::RigidVector<casa::Double, 3>(antUVW(0, ant2(row)) - antUVW(0, ant1(row)),
+                                                      antUVW(1, ant2(row)) - antUVW(1, ant1(row)),
+                                                      antUVW(2, ant2(row)) - antUVW(2, ant1(row)));
     }
 }
 
+/// @brief check whether two directions are the same
+/// @details Dish pointing directions are copied from the same metadata, so
+/// directions corresponding to the same pointing are exactly equal.
+/// @param[in] dir1 first direction
+/// @param[in] dir2 second direction
+/// @return true, if directions are the same
+bool CalcUVWTask::samePointing(const casa::MVDirection &dir1, const casa::MVDirection &dir2)
+{
+    const casa::Vector<casa::Double>& v1 = dir1.getValue();
+    const casa::Vector<casa::Double>& v2 = dir2.getValue();
+    return (v1(0) == v2(0)) && (v1(1) == v2(1)) && (v1(2) == v2(2));
+}
+
 /// @brief obtain phase centre for a given beam
 /// @details This method encapsulates common operations to obtain the direction
 /// of the phase centre for an (off-axis) beam by shifting dish pointing centre
@@ -115,27 +170,30 @@ double CalcUVWTask::calcGAST(const casa::MVEpoch &epoch)
     return (gast - Int(gast)) * C::_2pi; // Into Radians
 }
 
-void CalcUVWTask::calcForRow(VisChunk::ShPtr chunk, const casa::uInt row)
+/// @brief calculate uvw for all antennas
+/// @details The uvw of a baseline is the difference between uvw's of individual antennas,
+/// so it is enough to do the expensive calculation once per antenna for the given
+/// dish pointing and beam.
+/// @param[in] dishPointing pointing centre for the whole dish
+/// @param[in] beam beam index to work with
+/// @param[in] frame measures frame for the current time
+/// @param[in] gast Greenwich apparent sidereal time in radians
+/// @param[out] antUVW matrix with uvw (rows) for every antenna (columns), should be already
+///             sized to 3 x nAntennas
+void CalcUVWTask::calcAntennaUVW(const casa::MVDirection &dishPointing, const casa::uInt beam,
+                                 const casa::MeasFrame &frame, const double gast,
+                                 casa::Matrix<double> &antUVW) const
 {
-    const casa::uInt ant1 = chunk->antenna1()(row);
-    const casa::uInt ant2 = chunk->antenna2()(row);
-
-    const casa::uInt nAnt = nAntennas();
-
-    ASKAPCHECK(ant1 < nAnt, "Antenna index (" << ant1 << ") is invalid");
-    ASKAPCHECK(ant2 < nAnt, "Antenna index (" << ant2 << ") is invalid");
-
-    // Determine Greenwich Mean Sidereal Time
-    const double gast = calcGAST(chunk->time()); 
-    casa::MeasFrame frame(casa::MEpoch(chunk->time(), casa::MEpoch::UTC));
+    ASKAPDEBUGASSERT(antUVW.nrow() == 3);
+    ASKAPDEBUGASSERT(antUVW.ncolumn() == nAntennas());
 
     // phase center for a given beam
-    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(chunk->phaseCentre()(row),chunk->beam1()(row)),
+    const casa::MDirection fpc = casa::MDirection::Convert(phaseCentre(dishPointing, beam),
                                     casa::MDirection::Ref(casa::MDirection::TOPO, frame))();
     const double ra = fpc.getAngle().getValue()(0);
     const double dec = fpc.getAngle().getValue()(1);
 
-    // Transformation from antenna position difference (ant2-ant1) to uvw
+    // Transformation from antenna position to uvw
     const double H0 = gast - ra;
     const double sH0 = sin(H0);
     const double cH0 = cos(H0);
@@ -146,40 +204,18 @@ void CalcUVWTask::calcForRow(VisChunk::ShPtr chunk, const casa::uInt row)
     trans(1, 0) = sd * cH0; trans(1, 1) = -sd * sH0; trans(1, 2) = -cd;
     trans(2, 0) = -cd * cH0; trans(2, 1) = cd * sH0; trans(2, 2) = -sd;
 
-    // Rotate antennas to correct frame
-
-    /*
-    // there is no need to calculate uvw per antenna here as we recalculate it per row
-    // caching it per row and beam would be the optimal approach in terms of the number of
-    // operations, but we leave such implementation for some time in the future
-
-    Matrix<double> antUVW(3, nAnt);
-    
-    for (uInt i = 0; i < nAnt; ++i) {
-        antUVW.column(i) = casa::product(trans, antXYZ(i));
-    }
-
-    double x1 = antUVW(0, ant1), y1 = antUVW(1, ant1), z1 = antUVW(2, ant1);
-    double x2 = antUVW(0, ant2), y2 = antUVW(1, ant2), z2 = antUVW(2, ant2);
-    Vector<double> uvwvec(3);
-    uvwvec(0) = x2 - x1;
-    uvwvec(1) = y2 - y1;
-    uvwvec(2) = z2 - z1;
-    */
-
-    const Vector<double> baseline = antXYZ(ant2) - antXYZ(ant1);
-    ASKAPDEBUGASSERT(baseline.nelements() == 3);
-    Vector<double> uvwvec = casa::product(trans,baseline);
-    ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
     // do the conversion to J2000 in a quick and dirty way for now
-    // some optimisation and caching of rotation matrix are definitely possible here
-    // but cache class in accessors needs to be adapted first.
+    // the conversion is linear, so it can be applied to individual antennas
     casa::UVWMachine uvm(casa::MDirection::Ref(casa::MDirection::J2000), fpc);
-    uvm.convertUVW(uvwvec);
-    ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
 
-    // Finally set the uvwvec in the VisChunk
-    chunk->uvw()(row) = uvwvec;
+    // Rotate antennas to correct frame
+    for (casa::uInt ant = 0; ant < antUVW.ncolumn(); ++ant) {
+         Vector<double> uvwvec = casa::product(trans, antXYZ(ant));
+         ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
+         uvm.convertUVW(uvwvec);
+         ASKAPDEBUGASSERT(uvwvec.nelements() == 3);
+         antUVW.column(ant) = uvwvec;
+    }
 }
 
 /// @brief obtain ITRF coordinates of a given antenna
@@ -32,6 +32,9 @@
 #include "Common/ParameterSet.h"
 #include "casacore/scimath/Mathematics/RigidVector.h"
 #include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/measures/Measures/MeasFrame.h"
 #include "cpcommon/VisChunk.h"
 
 // Local package includes
@@ -103,8 +106,27 @@ class CalcUVWTask : public askap::cp::ingest::ITask {
         static double calcGAST(const casa::MVEpoch &epoch);
  
     private:
-        // Calculates UVW coordinates for the specified "row" in the "chunk"
-        void calcForRow(askap::cp::common::VisChunk::ShPtr chunk, const casa::uInt row);
+        /// @brief calculate uvw for all antennas
+        /// @details The uvw of a baseline is the difference between uvw's of individual antennas,
+        /// so it is enough to do the expensive calculation once per antenna for the given
+        /// dish pointing and beam.
+        /// @param[in] dishPointing pointing centre for the whole dish
+        /// @param[in] beam beam index to work with
+        /// @param[in] frame measures frame for the current time
+        /// @param[in] gast Greenwich apparent sidereal time in radians
+        /// @param[out] antUVW matrix with uvw (rows) for every antenna (columns), should be already
+        ///             sized to 3 x nAntennas
+        void calcAntennaUVW(const casa::MVDirection &dishPointing, const casa::uInt beam,
+                            const casa::MeasFrame &frame, const double gast,
+                            casa::Matrix<double> &antUVW) const;
+
+        /// @brief check whether two directions are the same
+        /// @details Dish pointing directions are copied from the same metadata, so
+        /// directions corresponding to the same pointing are exactly equal.
+        /// @param[in] dir1 first direction
+        /// @param[in] dir2 second direction
+        /// @return true, if directions are the same
+        static bool samePointing(const casa::MVDirection &dir1, const casa::MVDirection &dir2);
 
         // Populates the antenna Position Matrix
         void createPositionMatrix(const Configuration& config);
@@ -30,6 +30,10 @@
 // Include package level header file
 #include "askap_cpingest.h"
 
+// System includes
+#include <vector>
+#include <algorithm>
+
 // ASKAPsoft includes
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
@@ -97,34 +101,52 @@ void ChannelAvgTask::process(VisChunk::ShPtr& chunk)
     casa::Cube<casa::Complex> newVis(nRow, nChanNew, nPol);
     casa::Cube<casa::Bool> newFlag(nRow, nChanNew, nPol);
 
-    for (casa::uInt row = 0; row < nRow; ++row) {
+    // The row index changes fastest in the cube, so the innermost loops below run
+    // along rows. This gives unit stride access to both input and output and allows
+    // the compiler to vectorise the accumulation. The sums are accumulated directly in
+    // the output cube in the same order as the channels are stored, so the result is
+    // the same as the straightforward averaging of each spectrum.
+    ASKAPASSERT(origVis.contiguousStorage());
+    ASKAPASSERT(origFlag.contiguousStorage());
+    ASKAPDEBUGASSERT(newVis.contiguousStorage());
+    ASKAPDEBUGASSERT(newFlag.contiguousStorage());
+
+    // Track the samples added, since those flagged are not
+    std::vector<casa::uInt> numGoodSamples(nRow);
+
+    for (casa::uInt pol = 0; pol < nPol; ++pol) {
         for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
-            for (casa::uInt pol = 0; pol < nPol; ++pol) {
-
-                // Track the samples added, since those flagged are not
-                casa::uInt numGoodSamples = 0;
-
-                // Calculate the average over the number of samples to
-                // be averaged together (itsAveraging)
-                const casa::uInt origIdx = itsAveraging * newIdx;
-                casa::Complex sum(0.0, 0.0);
-                for (casa::uInt i = 0; i < itsAveraging; ++i) {
-                    // Only sum if not flagged
-                    if (!origFlag(row, origIdx + i, pol)) {
-                        sum += origVis(row, origIdx + i, pol);
-                        numGoodSamples++;
-                    }
+            const size_t newOffset = (static_cast<size_t>(pol) * nChanNew + newIdx) * nRow;
+            casa::Complex* sum = newVis.data() + newOffset;
+            casa::Bool* flag = newFlag.data() + newOffset;
+            std::fill(sum, sum + nRow, casa::Complex(0.0, 0.0));
+            std::fill(numGoodSamples.begin(), numGoodSamples.end(), 0u);
+
+            // Calculate the sum over the number of samples to
+            // be averaged together (itsAveraging)
+            for (casa::uInt i = 0; i < itsAveraging; ++i) {
+                const size_t origOffset = (static_cast<size_t>(pol) * nChanOriginal +
+                                           itsAveraging * newIdx + i) * nRow;
+                const casa::Complex* vis = origVis.data() + origOffset;
+                const casa::Bool* origFlagPtr = origFlag.data() + origOffset;
+                for (casa::uInt row = 0; row < nRow; ++row) {
+                    // Only sum if not flagged (selection rather than branch, 
+                    // flagged samples may contain garbage)
+                    const bool good = !origFlagPtr[row];
+                    sum[row] += good ? vis[row] : casa::Complex(0.0, 0.0);
+                    numGoodSamples[row] += good ? 1u : 0u;
                 }
+            }
 
-                if (numGoodSamples > 0) {
-                    newVis(row, newIdx, pol) = casa::Complex(sum.real() / numGoodSamples,
-                                                             sum.imag() / numGoodSamples);
-                    newFlag(row, newIdx, pol) = false;
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                if (numGoodSamples[row] > 0) {
+                    sum[row] = casa::Complex(sum[row].real() / numGoodSamples[row],
+                                             sum[row].imag() / numGoodSamples[row]);
+                    flag[row] = false;
                 } else {
-                    newVis(row, newIdx, pol) = casa::Complex(0.0, 0.0);
-                    newFlag(row, newIdx, pol) = true;
+                    sum[row] = casa::Complex(0.0, 0.0);
+                    flag[row] = true;
                 }
-
             }
         }
     }
@@ -49,6 +49,9 @@
 #include "utils/CasaBlobUtils.h"
 #include "casacore/casa/OS/Timer.h"
 
+// std includes
+#include <algorithm>
+
 
 // boost includes
 #include "boost/shared_array.hpp"
@@ -69,16 +72,25 @@ ChannelMergeTask::ChannelMergeTask(const LOFAR::ParameterSet& parset,
         const Configuration& config) : itsConfig(config),
     itsRanksToMerge(static_cast<int>(parset.getUint32("ranks2merge", config.nprocs() + 1))),
     itsCommunicator(MPI_COMM_NULL), itsRankInUse(false), itsGroupWithActivatedRank(true), 
-    itsUseInactiveRanks(parset.getBool("spare_ranks",false))
+    itsUseInactiveRanks(parset.getBool("spare_ranks",false)),
+    itsNonBlocking(parset.getBool("nonblocking",false))
 {
     ASKAPLOG_DEBUG_STR(logger, "Constructor");
     ASKAPCHECK(config.nprocs() > 1,
             "This task is intended to be used in parallel mode only");
+#if MPI_VERSION < 3
+    ASKAPCHECK(!itsNonBlocking, "Non-blocking mode of the channel merge task requires MPI-3");
+#endif
+    if (itsNonBlocking) {
+        ASKAPLOG_INFO_STR(logger, "Channel merge will use non-blocking collectives");
+    }
 }
 
 ChannelMergeTask::~ChannelMergeTask()
 {
     ASKAPLOG_DEBUG_STR(logger, "Destructor");
+    // transfers started in the last cycle should be completed before the communicator is freed
+    waitForPendingSends();
     if (itsCommunicator != MPI_COMM_NULL) {
         const int response = MPI_Comm_free(&itsCommunicator);
         ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Comm_free = "<<response);
@@ -97,18 +109,29 @@ void ChannelMergeTask::process(VisChunk::ShPtr& chunk)
         ASKAPASSERT(itsRankInUse);
     }
 
+    // complete transfer of the chunk sent in the previous cycle (if any) before new collectives
+    waitForPendingSends();
+
     // the following should create chunk of the correct dimensions
     checkChunkForConsistencyOrCreateNew(chunk);
     ASKAPDEBUGASSERT(chunk);
 
     if (localRank() > 0) {
         // these ranks just send VisChunks they handle to the master (rank 0)
-        sendVisChunk(chunk);
+        if (itsNonBlocking) {
+            sendVisChunkNonBlocking(chunk);
+        } else {
+            sendVisChunk(chunk);
+        }
         // reset chunk as this rank now becomes inactive
         chunk.reset();
     } else {
         // this is the master process which receives the data
-        receiveVisChunks(chunk);
+        if (itsNonBlocking) {
+            receiveVisChunksNonBlocking(chunk);
+        } else {
+            receiveVisChunks(chunk);
+        }
     }
 }
 
@@ -163,76 +186,15 @@ void ChannelMergeTask::receiveVisChunks(askap::cp::common::VisChunk::ShPtr chunk
    timer.mark();
 
    // 3) find the best time for merged chunk - we ignore all chunks which are from other times
-   // The best time corresponds to the largest chunk of data to retain
-
-   casa::MVEpoch timeWithMostData;
-
-
-   // as nLocalRanks > 1, zero means it is uninitialised
-   unsigned int largestNumberOfChunks = 0;
-   for (int rank = rankOffset; rank < nLocalRanks; ++rank) {
-        const casa::MVEpoch currentTime(timeRecvBuf[2 * rank], timeRecvBuf[2 *  rank + 1]);
-        // compare how many matches currentTime gives. It is possible to implement the same with less comparisons
-        // but straight forward approach sounds preferable for now
-        unsigned int numberOfMatches = 0;
-        for (int testRank = rankOffset; testRank < nLocalRanks; ++testRank) {
-             const casa::MVEpoch testTime(timeRecvBuf[2 * testRank], timeRecvBuf[2 *  testRank + 1]);
-             if (currentTime.nearAbs(testTime)) {
-                 ++numberOfMatches;
-             }
-        }
-        ASKAPDEBUGASSERT(numberOfMatches > 0);
-       
-        if (largestNumberOfChunks < numberOfMatches) {
-            largestNumberOfChunks = numberOfMatches;
-            timeWithMostData = currentTime;
-        }
-   }
-   ASKAPASSERT(largestNumberOfChunks > 0);
-   if (timeWithMostData.nearAbs(casa::MVEpoch())) {
-       ASKAPLOG_ERROR_STR(logger, "The majority ("<<largestNumberOfChunks<<") of the data streams are likely to be idle, check correlator.");
-   }
+   // invalid chunk flag per rank, zero length array means that all chunks are valid
+   std::vector<bool> invalidFlags;
+   const casa::MVEpoch timeWithMostData = selectTime(timeRecvBuf.get(), 2, invalidFlags);
 
    if (itsGroupWithActivatedRank) {
        ASKAPDEBUGASSERT(localRank() == 0);
-       //chunk->time() = latestTime;
        chunk->time() = timeWithMostData;
    }
 
-   // invalid chunk flag per rank, zero length array means that all chunks are valid
-   // (could've stored validity flags as opposed to invalidity flags, but it makes the
-   //  code a bit less readable).
-   std::vector<bool> invalidFlags;
-
-   if (static_cast<int>(largestNumberOfChunks) != itsRanksToMerge) {
-       ASKAPLOG_DEBUG_STR(logger, "VisChunks being merged correspond to different times, keeping time with most data = "<<timeWithMostData);
-
-       // there is something to flag, initialise the flag vector
-       invalidFlags.resize(itsRanksToMerge, true);
-
-       int counter = 0;
-       for (size_t rank = 0; rank < invalidFlags.size(); ++rank) {
-            const casa::MVEpoch currentTime(timeRecvBuf[2 * (rank + rankOffset)], timeRecvBuf[2 *  (rank + rankOffset) + 1]);
-            if (timeWithMostData.nearAbs(currentTime)) {
-                invalidFlags[rank] = false;
-                ++counter;
-            }
-       }
-       ASKAPCHECK(counter != 0, "It looks like comparison of time stamps failed due to floating point precision, this shouldn't have happened!");
-       // case of counter == itsRanksToMerge is not supposed to be inside this if-statement
-       ASKAPDEBUGASSERT(counter < itsRanksToMerge);
-       ASKAPDEBUGASSERT(counter == static_cast<int>(largestNumberOfChunks));
-       ASKAPLOG_DEBUG_STR(logger, "      - keeping "<<counter<<" chunks out of "<<itsRanksToMerge<<
-                                  " merged");
-       const int32_t misalignedStreamsNumber = itsRanksToMerge - counter;
-       MonitoringSingleton::update<int32_t>("MisalignedStreamsCount", misalignedStreamsNumber);
-       ASKAPDEBUGASSERT(itsRanksToMerge > 0);
-       MonitoringSingleton::update<float>("MisalignedStreamsPercent", static_cast<float>(misalignedStreamsNumber) / itsRanksToMerge * 100.);
-   } else {
-       MonitoringSingleton::update<int32_t>("MisalignedStreamsCount", 0);
-       MonitoringSingleton::update<float>("MisalignedStreamsPercent", 0.);
-   }
-   
    // 4) receive and merge frequency axis
    {
       boost::shared_array<double> freqRecvBuf(new double[nChanOriginal * nLocalRanks]);
@@ -287,21 +249,332 @@ void ChannelMergeTask::receiveVisChunks(askap::cp::common::VisChunk::ShPtr chunk
    }
 
    // 8) check that the resulting frequency axis is contiguous
-   if (newFreq.nelements() > 1) {
-       const double resolution = (newFreq[newFreq.nelements() - 1] - newFreq[0]) / (newFreq.nelements() - 1);
-       for (casa::uInt chan = 0; chan < newFreq.nelements(); ++chan) {
-            const double expected = newFreq[0] + resolution * chan;
+   checkFrequencies(newFreq);
+
+   ASKAPLOG_DEBUG_STR(logger, "Time it takes to receive and merge data: "<<timer.real()<<" seconds");
+}
+
+/// @brief receive chunks in the rank 0 process without intermediate buffers
+/// @details This is the version of receiveVisChunks used if the non-blocking
+/// mode is selected. Times and frequencies are gathered with a single collective, visibilities
+/// and flags are gathered straight into the merged cubes using derived datatypes (so there is no
+/// staging buffer and no reordering pass) and all three transfers are in flight at the same time.
+/// Slices which turn out to correspond to a different time are flagged afterwards.
+/// @param[in,out] chunk the instance of VisChunk to work with
+void ChannelMergeTask::receiveVisChunksNonBlocking(askap::cp::common::VisChunk::ShPtr chunk) const
+{
+#if MPI_VERSION >= 3
+   const int rankOffset = itsGroupWithActivatedRank ? 1 : 0;
+   const int nLocalRanks = itsRanksToMerge + rankOffset;
+
+   // 1) create new frequency vector, visibilities and flags (no need to initialise
+   // the cubes as every slice is either received or explicitly flagged below)
+
+   const casa::uInt nChanOriginal = 
+           itsGroupWithActivatedRank ? chunk->nChannel() / itsRanksToMerge : chunk->nChannel();
+   casa::Vector<casa::Double> newFreq;
+   casa::Cube<casa::Complex> newVis;
+   casa::Cube<casa::Bool> newFlag;
+   if (itsGroupWithActivatedRank) {
+       ASKAPDEBUGASSERT(nChanOriginal * itsRanksToMerge == chunk->nChannel());
+       newFreq.reference(chunk->frequency());
+       newVis.reference(chunk->visibility());
+       newFlag.reference(chunk->flag());
+   } else {
+       newFreq.reference(casa::Vector<casa::Double>(nChanOriginal * itsRanksToMerge));
+       newVis.reference(casa::Cube<casa::Complex>(chunk->nRow(), nChanOriginal * itsRanksToMerge, chunk->nPol()));
+       newFlag.reference(casa::Cube<casa::Bool>(chunk->nRow(), nChanOriginal * itsRanksToMerge, chunk->nPol()));
+   }
+   ASKAPASSERT(newVis.contiguousStorage());
+   ASKAPASSERT(newFlag.contiguousStorage());
+   ASKAPDEBUGASSERT(sizeof(casa::Bool) == sizeof(char));
+
+   // 2) start gathering metadata: time (two doubles) followed by frequencies of each rank
+
+   ASKAPDEBUGASSERT(itsRanksToMerge > 1);
+   const int metadataSize = 2 + static_cast<int>(nChanOriginal);
+   std::vector<double> metadataRecvBuf(metadataSize * nLocalRanks);
+   // not really necessary to set values for the master rank, but handy for consistency
+   metadataRecvBuf[0] = chunk->time().getDay();
+   metadataRecvBuf[1] = chunk->time().getDayFraction();
+   if (!itsGroupWithActivatedRank) {
+       ASKAPASSERT(chunk->frequency().contiguousStorage());
+       std::copy(chunk->frequency().data(), chunk->frequency().data() + nChanOriginal, metadataRecvBuf.begin() + 2);
+   }
+
+   casa::Timer timer;
+   timer.mark();
+
+   MPI_Request requests[3];
+   int response = MPI_Igather(MPI_IN_PLACE, metadataSize, MPI_DOUBLE, &metadataRecvBuf[0],
+                metadataSize, MPI_DOUBLE, 0, itsCommunicator, &requests[0]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering metadata, response from MPI_Igather = "<<response);
+
+   // 3) start gathering visibilities and flags directly into the merged cubes. The slice from
+   // every rank is described by a derived datatype, the local rank 0 contributes its own slice
+   // unless it has been activated (and therefore has no data).
+
+   std::vector<int> recvCounts(nLocalRanks, 1);
+   std::vector<int> displacements(nLocalRanks, 0);
+   for (int rank = 0; rank < nLocalRanks; ++rank) {
+        displacements[rank] = rank - rankOffset;
+   }
+   if (itsGroupWithActivatedRank) {
+       recvCounts[0] = 0;
+       displacements[0] = 0;
+   }
+   const int sendCount = itsGroupWithActivatedRank ? 0 : static_cast<int>(chunk->visibility().nelements());
+
+   MPI_Datatype visSliceType = sliceDatatype(MPI_C_FLOAT_COMPLEX, chunk->nRow(), nChanOriginal, chunk->nPol());
+   // for the local rank 0 the slice is sent in place, it is contiguous in the input chunk
+   // (MPI_IN_PLACE would require the data to be already at the right location in the output cube)
+   response = MPI_Igatherv(sendCount > 0 ? chunk->visibility().data() : NULL, sendCount, MPI_C_FLOAT_COMPLEX,
+                newVis.data(), &recvCounts[0], &displacements[0], visSliceType, 0, itsCommunicator, &requests[1]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering visibilities, response from MPI_Igatherv = "<<response);
+
+   MPI_Datatype flagSliceType = sliceDatatype(MPI_CHAR, chunk->nRow(), nChanOriginal, chunk->nPol());
+   response = MPI_Igatherv(sendCount > 0 ? (char*)chunk->flag().data() : NULL, sendCount, MPI_CHAR,
+                (char*)newFlag.data(), &recvCounts[0], &displacements[0], flagSliceType, 0, itsCommunicator, &requests[2]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering flags, response from MPI_Igatherv = "<<response);
+
+   // derived types are reference counted by MPI, it is safe to free them while the operations are pending
+   MPI_Type_free(&visSliceType);
+   MPI_Type_free(&flagSliceType);
+
+   // 4) while visibilities and flags are in transit, process times and frequencies
+
+   response = MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error waiting for metadata, response from MPI_Wait = "<<response);
+
+   std::vector<bool> invalidFlags;
+   const casa::MVEpoch timeWithMostData = selectTime(&metadataRecvBuf[0], metadataSize, invalidFlags);
+
+   if (itsGroupWithActivatedRank) {
+       ASKAPDEBUGASSERT(localRank() == 0);
+       chunk->time() = timeWithMostData;
+   }
+
+   for (int rank = 0; rank < itsRanksToMerge; ++rank) {
+        // always merge frequencies, even if the data are not valid
+        const double *thisFreq = &metadataRecvBuf[(rank + rankOffset) * metadataSize + 2];
+        std::copy(thisFreq, thisFreq + nChanOriginal, newFreq.data() + rank * nChanOriginal);
+   }
+
+   // 5) complete transfer of visibilities and flags, then flag slices from other times
+
+   response = MPI_Waitall(2, requests + 1, MPI_STATUSES_IGNORE);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error waiting for visibilities and flags, response from MPI_Waitall = "<<response);
+
+   for (size_t rank = 0; rank < invalidFlags.size(); ++rank) {
+        if (invalidFlags[rank]) {
+            const casa::Slicer slicer(casa::IPosition(3, 0, rank * nChanOriginal, 0),
+                     casa::IPosition(3, chunk->nRow(), nChanOriginal, chunk->nPol()));
+            newVis(slicer) = casa::Complex(0.,0.);
+            newFlag(slicer) = true;
+        }
+   }
+
+   // 6) update the chunk, unless this is a brand new chunk
+   if (!itsGroupWithActivatedRank) {
+       chunk->resize(newVis, newFlag, newFreq);
+   }
+
+   // 7) check that the resulting frequency axis is contiguous
+   checkFrequencies(newFreq);
+
+   ASKAPLOG_DEBUG_STR(logger, "Time it takes to receive and merge data: "<<timer.real()<<" seconds");
+#else
+   ASKAPTHROW(AskapError, "Non-blocking channel merge requires MPI-3");
+#endif
+}
+
+/// @brief send chunk to the rank 0 process without waiting for completion
+/// @details This is the version of sendVisChunk used if the non-blocking
+/// mode is selected. The transfer is started and the chunk is retained until
+/// the next call to process (or destruction of this task), so the transfer overlaps
+/// with processing of the next cycle upstream of this task.
+/// @param[in] chunk the instance of VisChunk to work with
+void ChannelMergeTask::sendVisChunkNonBlocking(const askap::cp::common::VisChunk::ShPtr& chunk)
+{
+#if MPI_VERSION >= 3
+   ASKAPDEBUGASSERT(itsPendingRequests.size() == 0);
+   ASKAPASSERT(chunk->frequency().contiguousStorage());
+   ASKAPASSERT(chunk->visibility().contiguousStorage());
+   ASKAPASSERT(chunk->flag().contiguousStorage());
+   ASKAPDEBUGASSERT(sizeof(casa::Bool) == sizeof(char));
+
+   // 1) fused metadata: time followed by frequencies
+   itsMetadataSendBuf.resize(2 + chunk->nChannel());
+   itsMetadataSendBuf[0] = chunk->time().getDay();
+   itsMetadataSendBuf[1] = chunk->time().getDayFraction();
+   std::copy(chunk->frequency().data(), chunk->frequency().data() + chunk->nChannel(), itsMetadataSendBuf.begin() + 2);
+
+   itsPendingRequests.resize(3, MPI_REQUEST_NULL);
+   const int metadataSize = static_cast<int>(itsMetadataSendBuf.size());
+   int response = MPI_Igather(&itsMetadataSendBuf[0], metadataSize, MPI_DOUBLE, NULL, 
+            metadataSize, MPI_DOUBLE, 0, itsCommunicator, &itsPendingRequests[0]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering metadata, response from MPI_Igather = "<<response);
+
+   // 2) visibilities and flags, receive parameters are only significant in the local rank 0
+   const int count = static_cast<int>(chunk->visibility().nelements());
+   response = MPI_Igatherv(chunk->visibility().data(), count, MPI_C_FLOAT_COMPLEX, NULL, NULL, NULL,
+            MPI_C_FLOAT_COMPLEX, 0, itsCommunicator, &itsPendingRequests[1]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering visibilities, response from MPI_Igatherv = "<<response);
+
+   response = MPI_Igatherv((char*)chunk->flag().data(), count, MPI_CHAR, NULL, NULL, NULL,
+            MPI_CHAR, 0, itsCommunicator, &itsPendingRequests[2]);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error gathering flags, response from MPI_Igatherv = "<<response);
+
+   // 3) keep the chunk (and therefore send buffers) alive until transfer is completed
+   itsChunkInTransit = chunk;
+#else
+   ASKAPTHROW(AskapError, "Non-blocking channel merge requires MPI-3");
+#endif
+}
+
+/// @brief complete outstanding send operations
+/// @details This method waits until non-blocking transfers started by
+/// sendVisChunkNonBlocking are complete and releases the chunk kept for them.
+/// It does nothing if there are no outstanding transfers.
+void ChannelMergeTask::waitForPendingSends()
+{
+   if (itsPendingRequests.size() > 0) {
+       const int response = MPI_Waitall(static_cast<int>(itsPendingRequests.size()), &itsPendingRequests[0], MPI_STATUSES_IGNORE);
+       ASKAPCHECK(response == MPI_SUCCESS, "Error completing transfer of the previous chunk, response from MPI_Waitall = "<<response);
+       itsPendingRequests.clear();
+   }
+   itsChunkInTransit.reset();
+}
+
+/// @brief make datatype describing one slice of the merged cube
+/// @details The slice received from one rank occupies nRow*nChan contiguous elements
+/// in every polarisation plane of the merged cube (which has itsRanksToMerge times more channels).
+/// The extent of the resulting type is set to the size of one such block, so slices from consecutive
+/// ranks are placed side by side by using the displacements in units of this type.
+/// @param[in] elementType MPI type of a single element of the cube
+/// @param[in] nRow number of rows
+/// @param[in] nChan number of channels in the slice
+/// @param[in] nPol number of polarisations
+/// @return committed datatype, the caller is responsible for freeing it
+MPI_Datatype ChannelMergeTask::sliceDatatype(MPI_Datatype elementType, casa::uInt nRow, 
+                  casa::uInt nChan, casa::uInt nPol) const
+{
+   const int blockLength = static_cast<int>(nRow * nChan);
+   MPI_Datatype vectorType;
+   int response = MPI_Type_vector(static_cast<int>(nPol), blockLength, blockLength * itsRanksToMerge, 
+                  elementType, &vectorType);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error creating vector datatype, response from MPI_Type_vector = "<<response);
+   MPI_Aint lowerBound = 0;
+   MPI_Aint elementExtent = 0;
+   response = MPI_Type_get_extent(elementType, &lowerBound, &elementExtent);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error obtaining extent, response from MPI_Type_get_extent = "<<response);
+   MPI_Datatype result;
+   response = MPI_Type_create_resized(vectorType, 0, elementExtent * blockLength, &result);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error resizing datatype, response from MPI_Type_create_resized = "<<response);
+   MPI_Type_free(&vectorType);
+   response = MPI_Type_commit(&result);
+   ASKAPCHECK(response == MPI_SUCCESS, "Error committing datatype, response from MPI_Type_commit = "<<response);
+   return result;
+}
+
+/// @brief find the time with the most data
+/// @details Chunks received from different ranks may correspond to different times.
+/// This method finds the time shared by the largest number of chunks, sets up flags
+/// for chunks which should be ignored and updates the monitoring points.
+/// @param[in] times pointer to the buffer with times of all local ranks, each time is 
+///                  given by day and day fraction
+/// @param[in] stride offset (in doubles) between times of consecutive local ranks
+/// @param[out] invalidFlags invalid chunk flag per rank (excluding activated rank), zero length 
+///                  array means that all chunks are valid
+/// @return time with the most data
+casa::MVEpoch ChannelMergeTask::selectTime(const double *times, int stride, 
+                  std::vector<bool> &invalidFlags) const
+{
+   const int rankOffset = itsGroupWithActivatedRank ? 1 : 0;
+   const int nLocalRanks = itsRanksToMerge + rankOffset;
+
+   // The best time corresponds to the largest chunk of data to retain
+   casa::MVEpoch timeWithMostData;
+
+   // as nLocalRanks > 1, zero means it is uninitialised
+   unsigned int largestNumberOfChunks = 0;
+   for (int rank = rankOffset; rank < nLocalRanks; ++rank) {
+        const casa::MVEpoch currentTime(times[stride * rank], times[stride * rank + 1]);
+        // compare how many matches currentTime gives. It is possible to implement the same with less comparisons
+        // but straight forward approach sounds preferable for now
+        unsigned int numberOfMatches = 0;
+        for (int testRank = rankOffset; testRank < nLocalRanks; ++testRank) {
+             const casa::MVEpoch testTime(times[stride * testRank], times[stride * testRank + 1]);
+             if (currentTime.nearAbs(testTime)) {
+                 ++numberOfMatches;
+             }
+        }
+        ASKAPDEBUGASSERT(numberOfMatches > 0);
+       
+        if (largestNumberOfChunks < numberOfMatches) {
+            largestNumberOfChunks = numberOfMatches;
+            timeWithMostData = currentTime;
+        }
+   }
+   ASKAPASSERT(largestNumberOfChunks > 0);
+   if (timeWithMostData.nearAbs(casa::MVEpoch())) {
+       ASKAPLOG_ERROR_STR(logger, "The majority ("<<largestNumberOfChunks<<") of the data streams are likely to be idle, check correlator.");
+   }
+
+   // (could've stored validity flags as opposed to invalidity flags, but it makes the
+   //  code a bit less readable).
+   invalidFlags.clear();
+
+   if (static_cast<int>(largestNumberOfChunks) != itsRanksToMerge) {
+       ASKAPLOG_DEBUG_STR(logger, "VisChunks being merged correspond to different times, keeping time with most data = "<<timeWithMostData);
+
+       // there is something to flag, initialise the flag vector
+       invalidFlags.resize(itsRanksToMerge, true);
+
+       int counter = 0;
+       for (size_t rank = 0; rank < invalidFlags.size(); ++rank) {
+            const casa::MVEpoch currentTime(times[stride * (rank + rankOffset)], times[stride * (rank + rankOffset) + 1]);
+            if (timeWithMostData.nearAbs(currentTime)) {
+                invalidFlags[rank] = false;
+                ++counter;
+            }
+       }
+       ASKAPCHECK(counter != 0, "It looks like comparison of time stamps failed due to floating point precision, this shouldn't have happened!");
+       // case of counter == itsRanksToMerge is not supposed to be inside this if-statement
+       ASKAPDEBUGASSERT(counter < itsRanksToMerge);
+       ASKAPDEBUGASSERT(counter == static_cast<int>(largestNumberOfChunks));
+       ASKAPLOG_DEBUG_STR(logger, "      - keeping "<<counter<<" chunks out of "<<itsRanksToMerge<<
+                                  " merged");
+       const int32_t misalignedStreamsNumber = itsRanksToMerge - counter;
+       MonitoringSingleton::update<int32_t>("MisalignedStreamsCount", misalignedStreamsNumber);
+       ASKAPDEBUGASSERT(itsRanksToMerge > 0);
+       MonitoringSingleton::update<float>("MisalignedStreamsPercent", static_cast<float>(misalignedStreamsNumber) / itsRanksToMerge * 100.);
+   } else {
+       MonitoringSingleton::update<int32_t>("MisalignedStreamsCount", 0);
+       MonitoringSingleton::update<float>("MisalignedStreamsPercent", 0.);
+   }
+   return timeWithMostData;
+}
+
+/// @brief check that the frequency axis is contiguous
+/// @details A warning is given if the merged frequency axis is not contiguous
+/// (i.e. some chunk has been received out of order or has unexpected resolution).
+/// @param[in] freq frequency axis to check
+void ChannelMergeTask::checkFrequencies(const casa::Vector<casa::Double> &freq)
+{
+   if (freq.nelements() > 1) {
+       const double resolution = (freq[freq.nelements() - 1] - freq[0]) / (freq.nelements() - 1);
+       for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+            const double expected = freq[0] + resolution * chan;
             // 1 kHz tolerance should be sufficient for practical purposes
-            if (fabs(expected - newFreq[chan]) > 1e3) {
+            if (fabs(expected - freq[chan]) > 1e3) {
                 ASKAPLOG_WARN_STR(logger, "Frequencies in the merged chunks seem to be non-contiguous, "<<
-                "for resulting channel = "<<chan<<" got "<<newFreq[chan]/1e6<<" MHz, expected "<<
+                "for resulting channel = "<<chan<<" got "<<freq[chan]/1e6<<" MHz, expected "<<
                 expected / 1e6<<" MHz, estimated resolution "<<resolution / 1e3<<" kHz");
                 break;
             }
        }
    }
-
-   ASKAPLOG_DEBUG_STR(logger, "Time it takes to receive and merge data: "<<timer.real()<<" seconds");
 }
 
 /// @brief helper method to copy data from flat buffer
@@ -471,6 +744,18 @@ bool ChannelMergeTask::isAlwaysActive() const
    return itsGroupWithActivatedRank;
 }
 
+/// @brief does this task call MPI routines?
+/// @details MPI is initialised without thread support, so tasks calling MPI
+/// routines from the process method should run in the main thread, i.e. they
+/// should belong to the first stage if the task chain is split into stages. This is
+/// checked after the first cycle (which is always executed in the main thread), so
+/// tasks using MPI for initialisation only may return false from then on.
+/// @return true, if subsequent calls to process method may call MPI routines
+bool ChannelMergeTask::usesMPI() const
+{
+   return true;
+}
+
 
 /// @brief local rank in the group
 /// @details Returns the rank against the local communicator, i.e.
@@ -43,6 +43,8 @@
 // hide MPI for now.
 #include <mpi.h>
 
+// std includes
+#include <vector>
 
 namespace askap {
 namespace cp {
@@ -61,6 +63,14 @@ namespace ingest {
 /// @endverbatim
 /// The above results in 12 chunks handled by consecutive ranks to be merged. The
 /// total number of processes should then be an integral multiple of 12.
+///
+/// Optionally, non-blocking collectives (requires MPI-3) can be used to merge the data:
+/// @verbatim
+///    nonblocking        = true
+/// @endverbatim
+/// In this mode, visibilities and flags are gathered directly into the merged cubes and
+/// the ranks sending data do not wait for the transfer to complete before returning, so
+/// the transfer overlaps with processing of the next cycle.
 class ChannelMergeTask : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -95,6 +105,15 @@ class ChannelMergeTask : public askap::cp::ingest::ITask {
         /// setting up MPI communicators dynamcally, rather than in the constructor)
         virtual bool isAlwaysActive() const;
 
+        /// @brief does this task call MPI routines?
+        /// @details MPI is initialised without thread support, so tasks calling MPI
+        /// routines from the process method should run in the main thread, i.e. they
+        /// should belong to the first stage if the task chain is split into stages. This is
+        /// checked after the first cycle (which is always executed in the main thread), so
+        /// tasks using MPI for initialisation only may return false from then on.
+        /// @return true, if subsequent calls to process method may call MPI routines
+        virtual bool usesMPI() const;
+
     private:
         /// @brief helper method to copy data from flat buffer
         /// @details MPI routines work with raw pointers. This method encasulates
@@ -120,6 +139,60 @@ class ChannelMergeTask : public askap::cp::ingest::ITask {
         /// @param[in,out] chunk the instance of VisChunk to work with
         void receiveVisChunks(askap::cp::common::VisChunk::ShPtr chunk) const;
 
+        /// @brief send chunk to the rank 0 process without waiting for completion
+        /// @details This is the version of sendVisChunk used if the non-blocking
+        /// mode is selected. The transfer is started and the chunk is retained until
+        /// the next call to process (or destruction of this task), so the transfer overlaps
+        /// with processing of the next cycle upstream of this task.
+        /// @param[in] chunk the instance of VisChunk to work with
+        void sendVisChunkNonBlocking(const askap::cp::common::VisChunk::ShPtr& chunk);
+
+        /// @brief receive chunks in the rank 0 process without intermediate buffers
+        /// @details This is the version of receiveVisChunks used if the non-blocking
+        /// mode is selected. Times and frequencies are gathered with a single collective, visibilities
+        /// and flags are gathered straight into the merged cubes using derived datatypes (so there is no
+        /// staging buffer and no reordering pass) and all three transfers are in flight at the same time.
+        /// Slices which turn out to correspond to a different time are flagged afterwards.
+        /// @param[in,out] chunk the instance of VisChunk to work with
+        void receiveVisChunksNonBlocking(askap::cp::common::VisChunk::ShPtr chunk) const;
+
+        /// @brief complete outstanding send operations
+        /// @details This method waits until non-blocking transfers started by
+        /// sendVisChunkNonBlocking are complete and releases the chunk kept for them.
+        /// It does nothing if there are no outstanding transfers.
+        void waitForPendingSends();
+
+        /// @brief make datatype describing one slice of the merged cube
+        /// @details The slice received from one rank occupies nRow*nChan contiguous elements
+        /// in every polarisation plane of the merged cube (which has itsRanksToMerge times more channels).
+        /// The extent of the resulting type is set to the size of one such block, so slices from consecutive
+        /// ranks are placed side by side by using the displacements in units of this type.
+        /// @param[in] elementType MPI type of a single element of the cube
+        /// @param[in] nRow number of rows
+        /// @param[in] nChan number of channels in the slice
+        /// @param[in] nPol number of polarisations
+        /// @return committed datatype, the caller is responsible for freeing it
+        MPI_Datatype sliceDatatype(MPI_Datatype elementType, casa::uInt nRow, 
+                                   casa::uInt nChan, casa::uInt nPol) const;
+
+        /// @brief find the time with the most data
+        /// @details Chunks received from different ranks may correspond to different times.
+        /// This method finds the time shared by the largest number of chunks, sets up flags
+        /// for chunks which should be ignored and updates the monitoring points.
+        /// @param[in] times pointer to the buffer with times of all local ranks, each time is 
+        ///                  given by day and day fraction
+        /// @param[in] stride offset (in doubles) between times of consecutive local ranks
+        /// @param[out] invalidFlags invalid chunk flag per rank (excluding activated rank), zero length 
+        ///                  array means that all chunks are valid
+        /// @return time with the most data
+        casa::MVEpoch selectTime(const double *times, int stride, std::vector<bool> &invalidFlags) const;
+
+        /// @brief check that the frequency axis is contiguous
+        /// @details A warning is given if the merged frequency axis is not contiguous
+        /// (i.e. some chunk has been received out of order or has unexpected resolution).
+        /// @param[in] freq frequency axis to check
+        static void checkFrequencies(const casa::Vector<casa::Double> &freq);
+
         /// @brief checks chunks presented to different ranks for consistency
         /// @details To limit complexity, only a limited number of merging
         /// options is supported. This method checks chunks for the basic consistency
@@ -210,6 +283,20 @@ class ChannelMergeTask : public askap::cp::ingest::ITask {
         /// @brief output rank distribution mode
         /// @details If true, inavtive ranks will be activated as much as possible
         bool itsUseInactiveRanks;
+
+        /// @brief true if non-blocking collectives are used to merge the data
+        bool itsNonBlocking;
+
+        /// @brief outstanding requests for the chunk sent in the previous cycle
+        /// @details Only used in the non-blocking mode by ranks sending the data.
+        std::vector<MPI_Request> itsPendingRequests;
+
+        /// @brief chunk which is being sent
+        /// @details It is kept to ensure send buffers stay valid until the transfer is complete
+        askap::cp::common::VisChunk::ShPtr itsChunkInTransit;
+
+        /// @brief send buffer for time and frequencies in the non-blocking mode
+        std::vector<double> itsMetadataSendBuf;
 };
 
 }
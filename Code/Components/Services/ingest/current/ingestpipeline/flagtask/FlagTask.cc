@@ -32,6 +32,7 @@
 
 // System includes
 #include <limits>
+#include <vector>
 
 // ASKAPsoft includes
 #include "askap/AskapLogging.h"
@@ -93,23 +94,36 @@ void FlagTask::process(askap::cp::common::VisChunk::ShPtr& chunk)
     const casa::Vector<casa::uInt>& ant1 = chunk->antenna1();
     const casa::Vector<casa::uInt>& ant2 = chunk->antenna2();
 
+    // Threshold is set per row, so the loop over the data doesn't need to check
+    // the type of correlation. The squared amplitude is compared against the squared
+    // threshold to avoid square root. Rows which are not checked get an infinite threshold,
+    // a negative threshold flags everything (as amplitude is always above it).
+    std::vector<float> threshold2(nRow);
+    for (casa::uInt row = 0; row < nRow; ++row) {
+        const bool isAuto = ant1(row) == ant2(row);
+        const bool isSet = isAuto ? itsAutoCorrThresholdSet : itsCrossCorrThresholdSet;
+        const float threshold = isAuto ? itsAutoCorrThreshold : itsCrossCorrThreshold;
+        if (!isSet) {
+            threshold2[row] = numeric_limits<float>::infinity();
+        } else {
+            threshold2[row] = threshold < 0 ? -1.f : threshold * threshold;
+        }
+    }
+
+    // The row index changes fastest in the cube, so the inner loop has unit stride
+    ASKAPASSERT(vis.contiguousStorage());
+    ASKAPASSERT(flag.contiguousStorage());
     for (casa::uInt pol = 0; pol < nPol; ++pol) {
         for (casa::uInt chan = 0; chan < nChannel; ++chan) {
+            const size_t offset = (static_cast<size_t>(pol) * nChannel + chan) * nRow;
+            casa::Complex* visPtr = vis.data() + offset;
+            casa::Bool* flagPtr = flag.data() + offset;
             for (casa::uInt row = 0; row < nRow; ++row) {
-                const bool isAuto = ant1(row) == ant2(row);
-                if (isAuto && !itsAutoCorrThresholdSet) continue;
-                if (!isAuto && !itsCrossCorrThresholdSet) continue;
-
-                if (flag(row, chan, pol)) continue;
-                const float amp = abs(vis(row, chan, pol));
-
-                if ((isAuto && amp > itsAutoCorrThreshold)
-                        || (!isAuto && amp > itsCrossCorrThreshold)) {
-                    flag(row, chan, pol) = true;
-                    if (itsZeroFlagged) vis(row, chan, pol) = 0.0;
+                if (!flagPtr[row] && (norm(visPtr[row]) > threshold2[row])) {
+                    flagPtr[row] = true;
+                    if (itsZeroFlagged) visPtr[row] = 0.0;
                 }
             }
         }
-
     }
 }
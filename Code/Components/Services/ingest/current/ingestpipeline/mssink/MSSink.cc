@@ -123,6 +123,19 @@ bool MSSink::isAlwaysActive() const
    return !itsMs && (itsStreamNumber >= 0);
 }
 
+/// @brief does this task call MPI routines?
+/// @details MPI is initialised without thread support, so tasks calling MPI
+/// routines from the process method should run in the main thread, i.e. they
+/// should belong to the first stage if the task chain is split into stages. This is
+/// checked after the first cycle (which is always executed in the main thread), so
+/// tasks using MPI for initialisation only may return false from then on.
+/// @return true, if subsequent calls to process method may call MPI routines
+bool MSSink::usesMPI() const
+{
+   // collective calls are only done in the delayed initialisation on active ranks
+   return !itsMs && (itsStreamNumber >= 0);
+}
+
 
 void MSSink::process(VisChunk::ShPtr& chunk)
 {
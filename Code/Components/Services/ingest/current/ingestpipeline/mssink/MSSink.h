@@ -91,6 +91,15 @@ class MSSink : public askap::cp::ingest::ITask,
         /// will be passed to process method).
         virtual bool isAlwaysActive() const;
 
+        /// @brief does this task call MPI routines?
+        /// @details MPI is initialised without thread support, so tasks calling MPI
+        /// routines from the process method should run in the main thread, i.e. they
+        /// should belong to the first stage if the task chain is split into stages. This is
+        /// checked after the first cycle (which is always executed in the main thread), so
+        /// tasks using MPI for initialisation only may return false from then on.
+        /// @return true, if subsequent calls to process method may call MPI routines
+        virtual bool usesMPI() const;
+
     private:
         /// @brief initialise the measurement set
         /// @details In the serial mode we run initialisation in the constructor.
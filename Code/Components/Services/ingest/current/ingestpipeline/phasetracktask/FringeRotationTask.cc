@@ -117,6 +117,19 @@ bool FringeRotationTask::isAlwaysActive() const
   return itsToBeInitialised;
 }
 
+/// @brief does this task call MPI routines?
+/// @details MPI is initialised without thread support, so tasks calling MPI
+/// routines from the process method should run in the main thread, i.e. they
+/// should belong to the first stage if the task chain is split into stages. This is
+/// checked after the first cycle (which is always executed in the main thread), so
+/// tasks using MPI for initialisation only may return false from then on.
+/// @return true, if subsequent calls to process method may call MPI routines
+bool FringeRotationTask::usesMPI() const
+{
+  // collective calls are only done during initialisation
+  return itsToBeInitialised;
+}
+
 /// @brief initialise fringe rotation approach
 /// @details This method uses the factory method to initialise 
 /// the fringe rotation approach on the rank which has data. It is
@@ -0,0 +1,67 @@
+/// @file BufferFactory.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_BUFFERFACTORY_H
+#define ASKAP_CP_INGEST_BUFFERFACTORY_H
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "askap/AskapError.h"
+
+// Local package includes
+#include "ingestpipeline/sourcetask/IBuffer.h"
+#include "ingestpipeline/sourcetask/CircularBuffer.h"
+#include "ingestpipeline/sourcetask/SPSCRingBuffer.h"
+
+// std includes
+#include <string>
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief create a buffer of the given type
+/// @param[in] type either "circular" (mutex-based CircularBuffer which discards
+///                 the oldest element on overflow) or "spsc" (lock-free
+///                 SPSCRingBuffer which rejects new elements on overflow and
+///                 requires a single producer and a single consumer thread)
+/// @param[in] bufSize the maximum number of elements in the buffer
+/// @return shared pointer to the buffer
+template<class T>
+boost::shared_ptr<IBuffer<T> > createBuffer(const std::string &type, const unsigned int bufSize)
+{
+    if (type == "circular") {
+        return boost::shared_ptr<IBuffer<T> >(new CircularBuffer<T>(bufSize));
+    } else if (type == "spsc") {
+        return boost::shared_ptr<IBuffer<T> >(new SPSCRingBuffer<T>(bufSize));
+    }
+    ASKAPTHROW(AskapError, "Unknown buffer type '" << type << "', supported types are circular and spsc");
+}
+
+}
+}
+}
+
+#endif
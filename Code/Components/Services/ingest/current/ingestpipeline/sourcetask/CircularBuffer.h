@@ -34,19 +34,22 @@
 #include "boost/date_time/posix_time/posix_time.hpp"
 #include "boost/circular_buffer.hpp"
 
+// Local package includes
+#include "ingestpipeline/sourcetask/IBuffer.h"
+
 namespace askap {
 namespace cp {
 namespace ingest {
 
 /// @brief A simple thread safe circular buffer.
 template<class T>
-class CircularBuffer {
+class CircularBuffer : public IBuffer<T> {
     public:
 
         /// @brief Constructor.
         /// @param[in] bufSize  the maximum number of elements (of type T)
         ///                     that the circular buffer can contain.
-        CircularBuffer(const unsigned int bufSize) {
+        CircularBuffer(const unsigned int bufSize) : itsHighWaterMark(0) {
             if (bufSize > 0) {
                 itsBuffer.set_capacity(bufSize);
             } else {
@@ -61,14 +64,21 @@ class CircularBuffer {
         /// @param[in]  obj a pointer to be added to the circular
         ///                 buffer. The pointer is added to the "back"
         ///                 of the buffer.
-        void add(const boost::shared_ptr<T> obj) {
+        /// @return true, if the buffer was full and the oldest element has
+        ///         been discarded to make room for the new one
+        bool add(const boost::shared_ptr<T> obj) {
             // Add a pointer to the message to the back of the circular burrer
             boost::mutex::scoped_lock lock(itsMutex);
+            const bool overwritten = itsBuffer.full();
             itsBuffer.push_back(obj);
+            if (itsBuffer.size() > itsHighWaterMark) {
+                itsHighWaterMark = itsBuffer.size();
+            }
 
             // Notify any waiters
             lock.unlock();
             itsCondVar.notify_all();
+            return overwritten;
         };
 
         /// @brief Get the next object from the "front" of the circular
@@ -139,6 +149,9 @@ class CircularBuffer {
                 }
             }
             itsBuffer.push_back(obj);
+            if (itsBuffer.size() > itsHighWaterMark) {
+                itsHighWaterMark = itsBuffer.size();
+            }
 
             // Notify any waiters
             lock.unlock();
@@ -195,6 +208,19 @@ class CircularBuffer {
             return itsBuffer.capacity();
         }
 
+        /// @brief Returns the maximum number of items in the circular buffer
+        /// since the last call to resetHighWaterMark
+        size_t highWaterMark(void) const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsHighWaterMark;
+        }
+
+        /// @brief Reset the high water mark to the current occupancy
+        void resetHighWaterMark(void) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsHighWaterMark = itsBuffer.size();
+        }
+
     private:
         /// The circular buffer this class wraps
         boost::circular_buffer< boost::shared_ptr<T> > itsBuffer;
@@ -205,6 +231,9 @@ class CircularBuffer {
 
         // Condition variable user for synchronisation between threads
         mutable boost::condition itsCondVar;
+
+        // Maximum occupancy since the last reset
+        size_t itsHighWaterMark;
 };
 
 }
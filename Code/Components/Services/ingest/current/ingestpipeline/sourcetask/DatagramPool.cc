@@ -0,0 +1,114 @@
+/// @file DatagramPool.cc
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "DatagramPool.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "boost/pool/pool_alloc.hpp"
+
+// Using
+using namespace askap;
+using namespace askap::cp;
+using namespace askap::cp::ingest;
+
+/// @brief constructor
+/// @param[in] size number of preallocated slots
+DatagramPool::DatagramPool(const size_t size) : itsSize(size),
+    itsStorage(new VisDatagram[size]), itsHeapAllocations(0u)
+{
+    itsFree.reserve(itsSize);
+    // fill the stack in the reverse order, so the slots are used sequentially
+    for (size_t slot = itsSize; slot > 0; --slot) {
+        itsFree.push_back(itsStorage.get() + slot - 1);
+    }
+}
+
+/// @brief obtain free slots
+/// @details This method never fails, extra datagrams are allocated on the
+/// heap if there is not enough free slots in the pool.
+/// @param[out] slots vector to be filled with pointers to the slots
+/// @param[in] n number of slots required
+void DatagramPool::acquire(std::vector<VisDatagram*> &slots, const size_t n)
+{
+    slots.resize(n);
+    size_t nPooled = 0;
+    {
+        boost::mutex::scoped_lock lock(itsMutex);
+        for (; (nPooled < n) && !itsFree.empty(); ++nPooled) {
+            slots[nPooled] = itsFree.back();
+            itsFree.pop_back();
+        }
+        itsHeapAllocations += n - nPooled;
+    }
+    for (size_t i = nPooled; i < n; ++i) {
+        slots[i] = new VisDatagram;
+    }
+}
+
+/// @brief return an unused slot to the pool
+/// @details This is intended for slots obtained with acquire which
+/// have not been shared (e.g. rejected datagrams)
+/// @param[in] slot pointer to the slot
+void DatagramPool::release(VisDatagram* slot)
+{
+    if (isPooled(slot)) {
+        boost::mutex::scoped_lock lock(itsMutex);
+        ASKAPDEBUGASSERT(itsFree.size() < itsSize);
+        itsFree.push_back(slot);
+    } else {
+        delete slot;
+    }
+}
+
+/// @brief wrap a slot into a shared pointer
+/// @details The slot is returned to the pool when the last copy of the
+/// shared pointer is destroyed.
+/// @param[in] slot pointer to the slot obtained with acquire
+/// @return shared pointer to the datagram
+boost::shared_ptr<VisDatagram> DatagramPool::share(VisDatagram* slot)
+{
+    // the reference counter is allocated from the pool too to avoid a heap allocation per datagram
+    return boost::shared_ptr<VisDatagram>(slot, Recycler(shared_from_this()),
+                                          boost::fast_pool_allocator<VisDatagram>());
+}
+
+/// @brief number of free slots
+size_t DatagramPool::nFree() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsFree.size();
+}
+
+/// @brief number of datagrams allocated on the heap because the pool was exhausted
+uint64_t DatagramPool::nHeapAllocations() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsHeapAllocations;
+}
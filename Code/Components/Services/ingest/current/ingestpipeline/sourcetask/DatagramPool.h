@@ -0,0 +1,128 @@
+/// @file DatagramPool.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_DATAGRAMPOOL_H
+#define ASKAP_CP_INGEST_DATAGRAMPOOL_H
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/scoped_array.hpp"
+#include "boost/enable_shared_from_this.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "cpcommon/VisDatagram.h"
+
+// std includes
+#include <vector>
+#include <stdint.h>
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief preallocated pool of visibility datagrams
+/// @details The receiver used to allocate a new datagram for every packet and
+/// the consumer deleted it after unpacking. This class keeps a fixed set of
+/// datagram slots instead. Slots are handed out to the receiving thread, wrapped
+/// into shared pointers when the datagram is buffered and returned to the pool
+/// automatically when the last reference is released (i.e. after the datagram is
+/// processed or overwritten in the circular buffer). If the pool is exhausted,
+/// datagrams are allocated on the heap as before, so the pool never causes data loss.
+/// The object should always be held by a shared pointer because the shared
+/// pointers it creates keep the pool alive.
+class DatagramPool : public boost::enable_shared_from_this<DatagramPool>,
+                     public boost::noncopyable {
+    public:
+        /// @brief shared pointer type
+        typedef boost::shared_ptr<DatagramPool> ShPtr;
+
+        /// @brief constructor
+        /// @param[in] size number of preallocated slots
+        explicit DatagramPool(const size_t size);
+
+        /// @brief obtain free slots
+        /// @details This method never fails, extra datagrams are allocated on the
+        /// heap if there is not enough free slots in the pool.
+        /// @param[out] slots vector to be filled with pointers to the slots
+        /// @param[in] n number of slots required
+        void acquire(std::vector<VisDatagram*> &slots, const size_t n);
+
+        /// @brief return an unused slot to the pool
+        /// @details This is intended for slots obtained with acquire which
+        /// have not been shared (e.g. rejected datagrams)
+        /// @param[in] slot pointer to the slot
+        void release(VisDatagram* slot);
+
+        /// @brief wrap a slot into a shared pointer
+        /// @details The slot is returned to the pool when the last copy of the
+        /// shared pointer is destroyed.
+        /// @param[in] slot pointer to the slot obtained with acquire
+        /// @return shared pointer to the datagram
+        boost::shared_ptr<VisDatagram> share(VisDatagram* slot);
+
+        /// @brief number of free slots
+        size_t nFree() const;
+
+        /// @brief total number of preallocated slots
+        size_t size() const { return itsSize; }
+
+        /// @brief number of datagrams allocated on the heap because the pool was exhausted
+        uint64_t nHeapAllocations() const;
+
+    private:
+        /// @brief functor returning the slot to the pool, used as the shared pointer deleter
+        struct Recycler {
+            explicit Recycler(const ShPtr &pool) : itsPool(pool) {}
+            void operator()(VisDatagram* slot) const { itsPool->release(slot); }
+            ShPtr itsPool;
+        };
+
+        /// @brief check whether the slot belongs to the preallocated storage
+        bool isPooled(const VisDatagram* slot) const
+        { return (slot >= itsStorage.get()) && (slot < itsStorage.get() + itsSize); }
+
+        /// @brief number of preallocated slots
+        const size_t itsSize;
+
+        /// @brief preallocated storage
+        /// @details Datagrams are plain structures, so the memory is not touched
+        /// until the slot is actually used.
+        boost::scoped_array<VisDatagram> itsStorage;
+
+        /// @brief stack of free slots
+        std::vector<VisDatagram*> itsFree;
+
+        /// @brief number of heap allocations due to pool exhaustion
+        uint64_t itsHeapAllocations;
+
+        /// @brief synchronisation between the receiving and the consuming threads
+        mutable boost::mutex itsMutex;
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,81 @@
+/// @file IBuffer.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_IBUFFER_H
+#define ASKAP_CP_INGEST_IBUFFER_H
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+
+// std includes
+#include <cstddef>
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief An interface to the bounded buffer between a receiving thread
+/// and the thread consuming the data
+/// @details This allows sources to select between the mutex-based
+/// CircularBuffer and the lock-free SPSCRingBuffer.
+template<class T>
+class IBuffer {
+    public:
+        /// @brief Destructor.
+        virtual ~IBuffer() {};
+
+        /// @brief Add an element to the buffer.
+        /// @param[in]  obj a pointer to be added to the "back" of the buffer.
+        /// @return true, if the buffer was full and an element has been lost
+        virtual bool add(const boost::shared_ptr<T> obj) = 0;
+
+        /// @brief Get the next object from the "front" of the buffer.
+        /// @param[in] timeout how long to wait for data before returning
+        ///         a null pointer, in the case where the
+        ///         buffer is empty. The timeout is in microseconds,
+        ///         and anything less than zero will result in no
+        ///         timeout (i.e. blocking functionality). A timeout of zero
+        ///         will result in a non-blocking call.
+        virtual boost::shared_ptr<T> next(const long timeout = -1) = 0;
+
+        /// @brief Returns the number of items in the buffer
+        virtual size_t size(void) const = 0;
+
+        /// @brief Returns the capacity of the buffer
+        virtual size_t capacity(void) const = 0;
+
+        /// @brief Returns the maximum number of items in the buffer
+        /// since the last call to resetHighWaterMark
+        virtual size_t highWaterMark(void) const = 0;
+
+        /// @brief Reset the high water mark to the current occupancy
+        virtual void resetHighWaterMark(void) = 0;
+};
+
+}
+}
+}
+
+#endif
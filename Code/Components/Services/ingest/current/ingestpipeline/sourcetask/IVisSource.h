@@ -58,6 +58,36 @@ class IVisSource {
         /// @return a shared pointer to a VisDatagram object.
         virtual boost::shared_ptr<VisDatagram> next(const long timeout = -1) = 0;
 
+        /// @brief receive statistics
+        /// @details All counters cover the period since the previous call to receiveStats
+        struct ReceiveStats {
+            ReceiveStats() : itsDatagramsReceived(0u), itsReceiveCalls(0u),
+                     itsSocketDrops(0u), itsBufferOverruns(0u), itsBufferHighWaterMark(0u) {}
+
+            /// @brief number of datagrams received from the socket
+            uint64_t itsDatagramsReceived;
+
+            /// @brief number of system calls used to receive them
+            uint64_t itsReceiveCalls;
+
+            /// @brief number of datagrams dropped by the kernel due to socket buffer overflow
+            /// @details This is only available for the batched receive mode
+            uint64_t itsSocketDrops;
+
+            /// @brief number of buffered datagrams discarded due to circular buffer overflow
+            uint64_t itsBufferOverruns;
+
+            /// @brief maximum number of datagrams held in the buffer
+            uint64_t itsBufferHighWaterMark;
+        };
+
+        /// @brief query receive statistics
+        /// @details This method is intended for monitoring packet loss at the
+        /// receiver side. The counters are reset by each call. Sources which don't
+        /// collect statistics return zeros.
+        /// @return statistics since the previous call
+        virtual ReceiveStats receiveStats() { return ReceiveStats(); }
+
         /// @brief query buffer status
         /// @details Typical implementation involves buffering of data. 
         /// Exceeding the buffer capacity will cause data loss. This method
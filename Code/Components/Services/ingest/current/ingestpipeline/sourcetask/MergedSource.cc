@@ -318,6 +318,8 @@ VisChunk::ShPtr MergedSource::next(void)
     itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.first);
     itsMonitoringPointManager.submitPoint<float>("BufferUsagePercent", bufferUsagePercent);
 
+    itsMonitoringPointManager.submitReceiveStats(itsVisSrc->receiveStats());
+
     itsMonitoringPointManager.submitPoint<float>("VisCornerTurnDuration", decodingTime);
 
     const int32_t datagramsLost =  itsVisConverter.datagramsExpected() - 
@@ -40,6 +40,9 @@
 #include "boost/shared_ptr.hpp"
 #include "cpcommon/TosMetadata.h"
 
+// Local package includes
+#include "ingestpipeline/sourcetask/BufferFactory.h"
+
 ASKAP_LOGGER(logger, ".MetadataSource");
 
 using namespace askap;
@@ -51,9 +54,10 @@ MetadataSource::MetadataSource(const std::string& locatorHost,
         const std::string& topicManager,
         const std::string& topic,
         const std::string& adapterName,
-        const unsigned int bufSize) :
+        const unsigned int bufSize,
+        const std::string& bufType) :
     MetadataReceiver(locatorHost, locatorPort, topicManager, topic, adapterName),
-    itsBuffer(bufSize)
+    itsBuffer(createBuffer<TosMetadata>(bufType, bufSize))
 {
 }
 
@@ -73,12 +77,12 @@ void MetadataSource::receive(const TosMetadata& msg)
 
     // Add a pointer to the message to the back of the circular buffer.
     // Waiters are notified.
-    itsBuffer.add(metadata);
+    itsBuffer->add(metadata);
 }
 
 // Blocking
 boost::shared_ptr<TosMetadata> MetadataSource::next(const long timeout)
 {
-    return itsBuffer.next(timeout);
+    return itsBuffer->next(timeout);
 }
 
@@ -38,7 +38,7 @@
 
 // Local package includes
 #include "ingestpipeline/sourcetask/IMetadataSource.h"
-#include "ingestpipeline/sourcetask/CircularBuffer.h"
+#include "ingestpipeline/sourcetask/IBuffer.h"
 
 namespace askap {
 namespace cp {
@@ -67,12 +67,18 @@ class MetadataSource :
         ///                         than they are being consumed, and if this buffer
         ///                         becomes full then the older objects are discarded
         ///                         to make room for the newer incoming objects.
+        /// @param[in] bufType      buffer type, "circular" or "spsc" (lock-free,
+        ///                         discards the newest objects if full). The
+        ///                         lock-free buffer relies on Ice dispatching
+        ///                         the callbacks from a single thread, which is
+        ///                         the default thread pool configuration.
         MetadataSource(const std::string& locatorHost,
                        const std::string& locatorPort,
                        const std::string& topicManager,
                        const std::string& topic,
                        const std::string& adapterName,
-                       const unsigned int bufSize);
+                       const unsigned int bufSize,
+                       const std::string& bufType = "circular");
 
         /// @brief Destructor.
         ~MetadataSource();
@@ -87,8 +93,8 @@ class MetadataSource :
         boost::shared_ptr<askap::cp::TosMetadata> next(const long timeout = -1);
 
     private:
-        // Circular buffer of metadata objects
-        askap::cp::ingest::CircularBuffer< askap::cp::TosMetadata > itsBuffer;
+        // Buffer of metadata objects
+        boost::shared_ptr<IBuffer<askap::cp::TosMetadata> > itsBuffer;
 
 };
 
@@ -35,12 +35,15 @@
 
 // ASKAPsoft includes
 #include "askap/AskapError.h"
+#include "askap/AskapLogging.h"
 #include "askap/AskapUtil.h"
 #include "cpcommon/VisChunk.h"
 #include "monitoring/MonitoringSingleton.h"
 #include "casacore/measures/Measures/MDirection.h"
 #include "casacore/measures/Measures/MeasTable.h"
 
+ASKAP_LOGGER(logger, ".MonitoringPointManager");
+
 using namespace askap::cp::ingest;
 
 MonitoringPointManager::MonitoringPointManager()
@@ -68,6 +71,11 @@ MonitoringPointManager::~MonitoringPointManager()
     submitPointNull("PacketsBuffered");
     submitPointNull("BufferUsagePercent");
 
+    submitPointNull("PacketsDroppedSocket");
+    submitPointNull("PacketsDroppedBuffer");
+    submitPointNull("ReceiveBatchSize");
+    submitPointNull("PacketsBufferedMax");
+
     submitPointNull("dUTC");
     submitPointNull("dUT1");
 
@@ -108,6 +116,22 @@ void MonitoringPointManager::submitMonitoringPoints(const askap::cp::common::Vis
     submitPoint<float>("dUT1", casa::MeasTable::dUT1(mjd));
 }
 
+void MonitoringPointManager::submitReceiveStats(const IVisSource::ReceiveStats& stats) const
+{
+    if (stats.itsSocketDrops + stats.itsBufferOverruns > 0) {
+        ASKAPLOG_WARN_STR(logger, "VisSource dropped "<<stats.itsSocketDrops<<
+                " datagrams at the socket and "<<stats.itsBufferOverruns<<
+                " datagrams due to the circular buffer overflow");
+    }
+    submitPoint<int32_t>("PacketsDroppedSocket", static_cast<int32_t>(stats.itsSocketDrops));
+    submitPoint<int32_t>("PacketsDroppedBuffer", static_cast<int32_t>(stats.itsBufferOverruns));
+    submitPoint<uint32_t>("PacketsBufferedMax", static_cast<uint32_t>(stats.itsBufferHighWaterMark));
+    if (stats.itsReceiveCalls != 0) {
+        submitPoint<float>("ReceiveBatchSize",
+            static_cast<float>(stats.itsDatagramsReceived) / stats.itsReceiveCalls);
+    }
+}
+
 void MonitoringPointManager::submitPointNull(const std::string& key) const
 {
     MonitoringSingleton::invalidatePoint(key);
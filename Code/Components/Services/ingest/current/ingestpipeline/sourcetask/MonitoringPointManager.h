@@ -36,6 +36,7 @@
 // Local package includes
 #include "configuration/Configuration.h"
 #include "monitoring/MonitoringSingleton.h"
+#include "ingestpipeline/sourcetask/IVisSource.h"
 
 namespace askap {
 namespace cp {
@@ -61,6 +62,12 @@ class MonitoringPointManager {
         /// The source data is a valid VisChunk
         void submitMonitoringPoints(const askap::cp::common::VisChunk& chunk) const;
 
+        /// Submit receiver-side statistics of the visibility source
+        /// (datagrams dropped before buffering, the average batch size and
+        /// the buffer high water mark). A warning is logged if any datagrams
+        /// have been dropped.
+        void submitReceiveStats(const IVisSource::ReceiveStats& stats) const;
+
         // Submit a valid for a single monitoring point
         template <typename T>
         void submitPoint(const std::string& key, const T& val) const
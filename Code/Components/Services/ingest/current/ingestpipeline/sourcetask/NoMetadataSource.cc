@@ -196,6 +196,8 @@ VisChunk::ShPtr NoMetadataSource::next(void)
     itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.first);
     itsMonitoringPointManager.submitPoint<float>("BufferUsagePercent", bufferUsagePercent);
 
+    itsMonitoringPointManager.submitReceiveStats(itsVisSrc->receiveStats());
+
     itsMonitoringPointManager.submitPoint<int32_t>("PacketsLostCount",
             itsVisConverter.datagramsExpected() - itsVisConverter.datagramsCount());
     if (itsVisConverter.datagramsExpected() != 0) {
@@ -0,0 +1,244 @@
+/// @file SPSCRingBuffer.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_SPSCRINGBUFFER_H
+#define ASKAP_CP_INGEST_SPSCRINGBUFFER_H
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/scoped_array.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/atomic.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/thread/thread_time.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+
+// Local package includes
+#include "ingestpipeline/sourcetask/IBuffer.h"
+
+// std includes
+#include <stdint.h>
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief A lock-free single producer single consumer ring buffer.
+/// @details This is an alternative to CircularBuffer for the case of exactly
+/// one thread calling add and exactly one thread calling next (e.g. the UDP
+/// receive thread and the merging thread). Neither side takes a lock while
+/// data are flowing. The consumer spins for a bounded number of iterations
+/// when the buffer is empty and then blocks on a condition variable; the
+/// producer only touches the mutex if the consumer is actually blocked.
+///
+/// Unlike CircularBuffer, the oldest element can't be discarded by the producer
+/// without synchronising with the consumer, so a new element is rejected if the
+/// buffer is full. Either way, add returns true if an element has been lost.
+template<class T>
+class SPSCRingBuffer : public IBuffer<T>, public boost::noncopyable {
+    public:
+
+        /// @brief Constructor.
+        /// @param[in] bufSize  the maximum number of elements (of type T)
+        ///                     that the buffer can contain.
+        /// @param[in] spinCount number of polling iterations before the
+        ///                     consumer blocks waiting for data
+        SPSCRingBuffer(const unsigned int bufSize, const unsigned int spinCount = 1000) :
+            itsCapacity(bufSize > 0 ? bufSize : 1), itsSlots(new boost::shared_ptr<T>[itsCapacity]),
+            itsSpinCount(spinCount), itsHead(0), itsTail(0), itsConsumerWaiting(false),
+            itsHighWaterMark(0) {}
+
+        /// @brief Add an element to the buffer (producer side only).
+        /// @param[in]  obj a pointer to be added to the "back" of the buffer.
+        /// @return true, if the buffer was full and the element has been rejected
+        bool add(const boost::shared_ptr<T> obj) {
+            const uint64_t tail = itsTail.load(boost::memory_order_relaxed);
+            const uint64_t head = itsHead.load(boost::memory_order_acquire);
+            if (tail - head >= itsCapacity) {
+                return true;
+            }
+            itsSlots[tail % itsCapacity] = obj;
+            // the sequentially consistent store pairs with the consumer's
+            // store of itsConsumerWaiting to avoid the lost wake up
+            itsTail.store(tail + 1, boost::memory_order_seq_cst);
+
+            // compare and swap, so a concurrent reset is not overwritten by
+            // the mark read before it
+            const size_t occupancy = static_cast<size_t>(tail + 1 - head);
+            size_t mark = itsHighWaterMark.load(boost::memory_order_relaxed);
+            while ((occupancy > mark) &&
+                   !itsHighWaterMark.compare_exchange_weak(mark, occupancy, boost::memory_order_relaxed)) {}
+
+            if (itsConsumerWaiting.load(boost::memory_order_seq_cst)) {
+                boost::mutex::scoped_lock lock(itsMutex);
+                itsCondVar.notify_all();
+            }
+            return false;
+        }
+
+        /// @brief Get the next object from the "front" of the buffer
+        /// (consumer side only).
+        /// @param[in] timeout how long to wait for data before returning
+        ///         a null pointer, in the case where the
+        ///         buffer is empty. The timeout is in microseconds,
+        ///         and anything less than zero will result in no
+        ///         timeout (i.e. blocking functionality). A timeout of zero
+        ///         will result in a non-blocking call.
+        boost::shared_ptr<T> next(const long timeout = -1) {
+            const uint64_t head = itsHead.load(boost::memory_order_relaxed);
+            if (!waitForData(head, timeout)) {
+                return boost::shared_ptr<T>(); // Null pointer
+            }
+            boost::shared_ptr<T> obj;
+            // release the reference held by the slot
+            obj.swap(itsSlots[head % itsCapacity]);
+            itsHead.store(head + 1, boost::memory_order_release);
+            return obj;
+        }
+
+        /// @brief Remove all elements (consumer side only).
+        void clear(void) {
+            while (next(0)) {}
+        }
+
+        /// @brief Returns the number of items in the buffer
+        /// @details The value is approximate if other threads are accessing
+        /// the buffer at the same time.
+        size_t size(void) const {
+            const uint64_t head = itsHead.load(boost::memory_order_acquire);
+            const uint64_t tail = itsTail.load(boost::memory_order_acquire);
+            return tail > head ? static_cast<size_t>(tail - head) : 0;
+        }
+
+        /// @brief Returns the capacity of the buffer
+        size_t capacity(void) const {
+            return itsCapacity;
+        }
+
+        /// @brief Returns the maximum number of items in the buffer
+        /// since the last call to resetHighWaterMark
+        size_t highWaterMark(void) const {
+            return itsHighWaterMark.load(boost::memory_order_relaxed);
+        }
+
+        /// @brief Reset the high water mark to the current occupancy
+        /// @details This can be called from any thread. Both this method and the
+        /// producer update the mark with compare and swap, so neither overwrites a
+        /// value it hasn't seen: if the producer raises the mark after the occupancy
+        /// is read here, the occupancy is read again.
+        void resetHighWaterMark(void) {
+            size_t mark = itsHighWaterMark.load(boost::memory_order_relaxed);
+            while (!itsHighWaterMark.compare_exchange_weak(mark, size(), boost::memory_order_relaxed)) {}
+        }
+
+    private:
+        /// @brief check whether an element beyond head is available
+        /// @details Sequentially consistent load is required for the check done
+        /// after itsConsumerWaiting is set (it is a plain load on x86 anyway).
+        bool hasData(const uint64_t head) const {
+            return itsTail.load(boost::memory_order_seq_cst) != head;
+        }
+
+        /// @brief wait until data are available or the timeout expires
+        /// @param[in] head current head position
+        /// @param[in] timeout timeout in microseconds, see next
+        /// @return true if data are available
+        bool waitForData(const uint64_t head, const long timeout) {
+            if (hasData(head)) {
+                return true;
+            }
+            if (timeout == 0) {
+                return false;
+            }
+            for (unsigned int spin = 0; spin < itsSpinCount; ++spin) {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#endif
+                if (hasData(head)) {
+                    return true;
+                }
+            }
+
+            const boost::system_time deadline = boost::get_system_time() +
+                    boost::posix_time::microseconds(timeout > 0 ? timeout : 0);
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsConsumerWaiting.store(true, boost::memory_order_seq_cst);
+            while (!hasData(head)) {
+                if (timeout > 0) {
+                    if (!itsCondVar.timed_wait(lock, deadline) && !hasData(head)) {
+                        itsConsumerWaiting.store(false, boost::memory_order_relaxed);
+                        return false;
+                    }
+                } else {
+                    itsCondVar.wait(lock);
+                }
+            }
+            itsConsumerWaiting.store(false, boost::memory_order_relaxed);
+            return true;
+        }
+
+        /// @brief number of slots
+        const uint64_t itsCapacity;
+
+        /// @brief storage, element i is at position i % itsCapacity
+        boost::scoped_array< boost::shared_ptr<T> > itsSlots;
+
+        /// @brief number of polling iterations before blocking
+        const unsigned int itsSpinCount;
+
+        /// @brief padding to keep the counters in separate cache lines
+        char itsPad0[64];
+
+        /// @brief number of elements taken so far (written by the consumer)
+        boost::atomic<uint64_t> itsHead;
+
+        /// @brief padding to keep the counters in separate cache lines
+        char itsPad1[64];
+
+        /// @brief number of elements added so far (written by the producer)
+        boost::atomic<uint64_t> itsTail;
+
+        /// @brief padding to keep the counters in separate cache lines
+        char itsPad2[64];
+
+        /// @brief true if the consumer is (about to be) blocked on the condition variable
+        boost::atomic<bool> itsConsumerWaiting;
+
+        /// @brief maximum occupancy since the last reset (raised by the producer)
+        boost::atomic<size_t> itsHighWaterMark;
+
+        /// @brief mutex used only to block the consumer
+        boost::mutex itsMutex;
+
+        /// @brief condition variable used only to block the consumer
+        boost::condition itsCondVar;
+};
+
+}
+}
+}
+
+#endif
@@ -36,7 +36,17 @@
 #include "boost/scoped_ptr.hpp"
 #include "boost/thread.hpp"
 
+// Local package includes
+#include "ingestpipeline/sourcetask/BufferFactory.h"
+
 #include <iomanip>
+#include <cstring>
+
+// System includes
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <errno.h>
 
 // Using
 using namespace askap;
@@ -77,8 +87,10 @@ uint32_t VisSource::getMaxSlice(const LOFAR::ParameterSet &parset)
 ///            given in the parset (to allow parallel processes
 ///            to listen different ports)
 VisSource::VisSource(const LOFAR::ParameterSet &parset, const unsigned int portOffset) :
-    itsBuffer(parset.getUint32("buffer_size", 78 * 36 * 16 * 2)),  // default is tuned for BETA
-    itsStopRequested(false), 
+    itsBuffer(createBuffer<VisDatagram>(parset.getString("buffer_type", "circular"),
+              parset.getUint32("buffer_size", 78 * 36 * 16 * 2))),  // default is tuned for BETA
+    itsStopRequested(false), itsRecvBuffer(NULL),
+    itsBatchSize(parset.getUint32("vis_source.batch_size", 1)),
     itsMaxBeamId(getMaxBeamId(parset)), itsMaxSlice(getMaxSlice(parset)), 
     itsOldTimestamp(0ul)
 #ifdef ASKAP_DEBUG
@@ -90,11 +102,26 @@ VisSource::VisSource(const LOFAR::ParameterSet &parset, const unsigned int portO
                                                      1024 * 1024 * 16); // BETA value is the default
     const unsigned int port = parset.getUint32("vis_source.port") + portOffset;
 
+    ASKAPCHECK(itsBatchSize > 0, "vis_source.batch_size should be positive");
+#ifndef __linux__
+    if (itsBatchSize > 1) {
+        ASKAPLOG_WARN_STR(logger, "Batched receive requires recvmmsg which is only available on Linux, "
+                "vis_source.batch_size is ignored");
+        itsBatchSize = 1;
+    }
+#endif
+    // extra slots cover the batch being received and datagrams held by the consumer
+    itsPool.reset(new DatagramPool(itsBuffer->capacity() + itsBatchSize + 64));
+
     ASKAPLOG_INFO_STR(logger, "Setting up VisSource to listen up port "<<port);
     ASKAPLOG_INFO_STR(logger, "     - receive  buffer size: "<<recvBufferSize / 1024 / 1024 <<" Mb");
-    ASKAPLOG_INFO_STR(logger, "     - circular buffer size: "<<itsBuffer.capacity()<<" datagrams");    
+    ASKAPLOG_INFO_STR(logger, "     - "<<parset.getString("buffer_type", "circular")<<" buffer size: "<<
+                      itsBuffer->capacity()<<" datagrams");    
     ASKAPLOG_INFO_STR(logger, "     - beams with Id > "<<itsMaxBeamId<<" will be ignored"); 
     ASKAPLOG_INFO_STR(logger, "     - slices > "<<itsMaxSlice<<" will be ignored"); 
+    if (itsBatchSize > 1) {
+        ASKAPLOG_INFO_STR(logger, "     - up to "<<itsBatchSize<<" datagrams will be received per system call");
+    }
 
     bat2epoch(4943907678000000ul);
 
@@ -113,10 +140,21 @@ VisSource::VisSource(const LOFAR::ParameterSet &parset, const unsigned int portO
     }
     //
 
-    start_receive();
+    if (itsBatchSize > 1) {
+#ifdef SO_RXQ_OVFL
+        // ask the kernel to report the number of datagrams dropped due to socket buffer overflow
+        const int enable = 1;
+        if (setsockopt(itsSocket->native_handle(), SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0) {
+            ASKAPLOG_WARN_STR(logger, "Unable to enable SO_RXQ_OVFL, socket drops will not be reported");
+        }
+#endif
+        itsThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&VisSource::runBatched, this)));
+    } else {
+        start_receive();
 
-    // Start the thread
-    itsThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&VisSource::run, this)));
+        // Start the thread
+        itsThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&VisSource::run, this)));
+    }
 }
 
 VisSource::~VisSource()
@@ -135,6 +173,10 @@ VisSource::~VisSource()
 
     // Finally close the socket
     itsSocket->close();
+
+    if (itsRecvBuffer != NULL) {
+        itsPool->release(itsRecvBuffer);
+    }
 }
 
 /// @brief query buffer status
@@ -144,14 +186,29 @@ VisSource::~VisSource()
 /// @return a pair with number of datagrams in the queue and the buffer size
 std::pair<uint32_t, uint32_t> VisSource::bufferUsage() const
 {
-   return std::pair<uint32_t, uint32_t>(itsBuffer.size(),itsBuffer.capacity());
+   return std::pair<uint32_t, uint32_t>(itsBuffer->size(),itsBuffer->capacity());
+}
+
+/// @brief query receive statistics
+/// @details The counters are reset by each call.
+/// @return statistics since the previous call
+IVisSource::ReceiveStats VisSource::receiveStats()
+{
+   boost::mutex::scoped_lock lock(itsStatsMutex);
+   ReceiveStats result = itsStats;
+   itsStats = ReceiveStats();
+   result.itsBufferHighWaterMark = itsBuffer->highWaterMark();
+   itsBuffer->resetHighWaterMark();
+   return result;
 }
 
 void VisSource::start_receive(void)
 {
-    itsRecvBuffer.reset(new VisDatagram);
+    std::vector<VisDatagram*> slots;
+    itsPool->acquire(slots, 1);
+    itsRecvBuffer = slots[0];
     itsSocket->async_receive_from(
-            boost::asio::buffer(boost::asio::buffer(itsRecvBuffer.get(), sizeof(VisDatagram))),
+            boost::asio::buffer(boost::asio::buffer(itsRecvBuffer, sizeof(VisDatagram))),
             itsRemoteEndpoint,
             boost::bind(&VisSource::handle_receive, this,
                 boost::asio::placeholders::error,
@@ -162,45 +219,66 @@ void VisSource::handle_receive(const boost::system::error_code& error,
         std::size_t bytes)
 {
     if (!error || error == boost::asio::error::message_size) {
-        if (bytes != sizeof(VisDatagram)) {
-            ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
-        }
-        if (itsRecvBuffer->version != VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION) {
-            ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
-                    << VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION
-                    << " got " << itsRecvBuffer->version);
+        const bool overrun = bufferDatagram(itsRecvBuffer, bytes);
+        itsRecvBuffer = NULL;
+
+        boost::mutex::scoped_lock lock(itsStatsMutex);
+        ++itsStats.itsDatagramsReceived;
+        ++itsStats.itsReceiveCalls;
+        if (overrun) {
+            ++itsStats.itsBufferOverruns;
         }
+    } else {
+        ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. Error Code: "
+                << error);
+        itsPool->release(itsRecvBuffer);
+        itsRecvBuffer = NULL;
+    }
+
+    if (!itsStopRequested) {
+        start_receive();
+    }
+}
+
+/// @brief check the datagram and add it to the circular buffer
+/// @details Datagrams rejected by the beam or slice criteria are returned
+/// to the pool.
+/// @param[in] slot datagram to process (obtained from the pool)
+/// @param[in] bytes number of bytes received
+/// @return true if a buffered datagram has been overwritten
+bool VisSource::bufferDatagram(VisDatagram* slot, const std::size_t bytes)
+{
+    if (bytes != sizeof(VisDatagram)) {
+        ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
+    }
+    if (slot->version != VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION) {
+        ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
+                << VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION
+                << " got " << slot->version);
+    }
 
-        // message for debugging
-        if (itsOldTimestamp != itsRecvBuffer->timestamp) {
-            itsOldTimestamp = itsRecvBuffer->timestamp;
+    // message for debugging
+    if (itsOldTimestamp != slot->timestamp) {
+        itsOldTimestamp = slot->timestamp;
 /*
 // for debugging, temporary commented out due to performance issues in the logger
 #ifdef ASKAP_DEBUG
-            ASKAPLOG_DEBUG_STR(logger, "VisSource("<<itsCard<<"): queuing new timestamp :"<<bat2epoch(itsOldTimestamp)<<" BAT=0x"<<std::hex<<itsOldTimestamp);
+        ASKAPLOG_DEBUG_STR(logger, "VisSource("<<itsCard<<"): queuing new timestamp :"<<bat2epoch(itsOldTimestamp)<<" BAT=0x"<<std::hex<<itsOldTimestamp);
 #else
-            ASKAPLOG_DEBUG_STR(logger, "VisSource: queuing new timestamp :"<<bat2epoch(itsOldTimestamp)<<" BAT=0x"<<std::hex<<itsOldTimestamp);
+        ASKAPLOG_DEBUG_STR(logger, "VisSource: queuing new timestamp :"<<bat2epoch(itsOldTimestamp)<<" BAT=0x"<<std::hex<<itsOldTimestamp);
 #endif
 */
-        }
-        //
-
-        if (itsRecvBuffer->beamid <= itsMaxBeamId) {
-            if (itsRecvBuffer->slice <= itsMaxSlice) {
-                // Add a pointer to the message to the back of the circular buffer.
-                // Waiters are notified.
-                itsBuffer.add(itsRecvBuffer);
-            }
-        }
-        itsRecvBuffer.reset();
-    } else {
-        ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. Error Code: "
-                << error);
     }
+    //
 
-    if (!itsStopRequested) {
-        start_receive();
+    if ((slot->beamid <= itsMaxBeamId) && (slot->slice <= itsMaxSlice)) {
+        // Add a pointer to the message to the back of the circular buffer.
+        // Waiters are notified. The slot returns to the pool when the
+        // datagram is released by the consumer or overwritten.
+        return itsBuffer->add(itsPool->share(slot));
     }
+    itsPool->release(slot);
+    return false;
 }
 
 void VisSource::run(void)
@@ -208,7 +286,93 @@ void VisSource::run(void)
     itsIOService.run();    
 }
 
+void VisSource::runBatched(void)
+{
+#ifdef __linux__
+    const int fd = itsSocket->native_handle();
+    std::vector<VisDatagram*> slots;
+    std::vector<struct mmsghdr> msgs(itsBatchSize);
+    std::vector<struct iovec> iovecs(itsBatchSize);
+#ifdef SO_RXQ_OVFL
+    const size_t controlSize = CMSG_SPACE(sizeof(uint32_t));
+    std::vector<char> control(itsBatchSize * controlSize);
+    // the kernel reports the total number of drops since the socket was created
+    uint32_t lastDropCount = 0u;
+#endif
+
+    while (!itsStopRequested) {
+        // wait for data with a timeout, so the stop request is noticed
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int pollResult = poll(&pfd, 1, 100);
+        if (pollResult <= 0) {
+            if ((pollResult < 0) && (errno != EINTR)) {
+                ASKAPLOG_WARN_STR(logger, "Error polling UDP socket. Errno: " << errno);
+            }
+            continue;
+        }
+
+        itsPool->acquire(slots, itsBatchSize);
+        for (uint32_t i = 0; i < itsBatchSize; ++i) {
+            iovecs[i].iov_base = slots[i];
+            iovecs[i].iov_len = sizeof(VisDatagram);
+            memset(&msgs[i], 0, sizeof(struct mmsghdr));
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+#ifdef SO_RXQ_OVFL
+            msgs[i].msg_hdr.msg_control = &control[i * controlSize];
+            msgs[i].msg_hdr.msg_controllen = controlSize;
+#endif
+        }
+
+        // non-blocking, returns whatever is already queued up to the batch size
+        const int nReceived = recvmmsg(fd, &msgs[0], itsBatchSize, MSG_DONTWAIT, NULL);
+        if (nReceived < 0) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. Errno: " << errno);
+            }
+        }
+
+        const uint32_t nGood = nReceived > 0 ? static_cast<uint32_t>(nReceived) : 0u;
+        uint64_t overruns = 0;
+        uint64_t socketDrops = 0;
+        for (uint32_t i = 0; i < nGood; ++i) {
+#ifdef SO_RXQ_OVFL
+            for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL;
+                    cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg)) {
+                if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL)) {
+                    uint32_t dropCount;
+                    memcpy(&dropCount, CMSG_DATA(cmsg), sizeof(dropCount));
+                    socketDrops += dropCount - lastDropCount;
+                    lastDropCount = dropCount;
+                }
+            }
+#endif
+            if (bufferDatagram(slots[i], msgs[i].msg_len)) {
+                ++overruns;
+            }
+        }
+        // return the slots not filled by this call
+        for (uint32_t i = nGood; i < itsBatchSize; ++i) {
+            itsPool->release(slots[i]);
+        }
+
+        if (nGood > 0) {
+            boost::mutex::scoped_lock lock(itsStatsMutex);
+            itsStats.itsDatagramsReceived += nGood;
+            ++itsStats.itsReceiveCalls;
+            itsStats.itsBufferOverruns += overruns;
+            itsStats.itsSocketDrops += socketDrops;
+        }
+    }
+#else
+    ASKAPTHROW(AskapError, "Batched receive is not supported on this platform");
+#endif
+}
+
 boost::shared_ptr<VisDatagram> VisSource::next(const long timeout)
 {
-    return itsBuffer.next(timeout);
+    return itsBuffer->next(timeout);
 }
@@ -40,7 +40,8 @@
 
 // Local package includes
 #include "ingestpipeline/sourcetask/IVisSource.h"
-#include "ingestpipeline/sourcetask/CircularBuffer.h"
+#include "ingestpipeline/sourcetask/IBuffer.h"
+#include "ingestpipeline/sourcetask/DatagramPool.h"
 
 namespace askap {
 namespace cp {
@@ -68,6 +69,11 @@ class VisSource : public IVisSource, public boost::noncopyable {
         /// @return a pair with number of datagrams in the queue and the buffer size
         virtual std::pair<uint32_t, uint32_t> bufferUsage() const;
 
+        /// @brief query receive statistics
+        /// @details The counters are reset by each call.
+        /// @return statistics since the previous call
+        virtual ReceiveStats receiveStats();
+
         /// @brief access to beam rejection criterion
         /// @details This method encapsulates access to parset parameter defining 
         /// beam rejection at the receiver side (i.e. before the datagram is even 
@@ -93,8 +99,21 @@ class VisSource : public IVisSource, public boost::noncopyable {
 
         void run(void);
 
-        // Circular buffer of VisDatagram objects
-        askap::cp::ingest::CircularBuffer< VisDatagram > itsBuffer;
+        /// @brief service thread body for the batched receive mode
+        /// @details Datagrams are received in batches of up to itsBatchSize
+        /// with a single recvmmsg call directly into the pool slots.
+        void runBatched(void);
+
+        /// @brief check the datagram and add it to the circular buffer
+        /// @details Datagrams rejected by the beam or slice criteria are returned
+        /// to the pool.
+        /// @param[in] slot datagram to process (obtained from the pool)
+        /// @param[in] bytes number of bytes received
+        /// @return true if a buffered datagram has been overwritten
+        bool bufferDatagram(VisDatagram* slot, const std::size_t bytes);
+
+        // Buffer of VisDatagram objects (circular or lock-free, see buffer_type)
+        boost::shared_ptr<IBuffer<VisDatagram> > itsBuffer;
 
         // Service thread
         boost::shared_ptr<boost::thread> itsThread;
@@ -110,7 +129,21 @@ class VisSource : public IVisSource, public boost::noncopyable {
 
         boost::asio::ip::udp::endpoint itsRemoteEndpoint;
 
-        boost::shared_ptr<VisDatagram> itsRecvBuffer;
+        /// @brief pool of preallocated datagrams
+        DatagramPool::ShPtr itsPool;
+
+        /// @brief slot for the outstanding asynchronous receive
+        VisDatagram* itsRecvBuffer;
+
+        /// @brief maximum number of datagrams received with a single system call
+        /// @details 1 means the asio-based receive of one datagram at a time
+        uint32_t itsBatchSize;
+
+        /// @brief receive statistics since the last call to receiveStats
+        ReceiveStats itsStats;
+
+        /// @brief protects itsStats, which is updated by the service thread
+        mutable boost::mutex itsStatsMutex;
 
         /// @brief maximum beam number
         /// @details datagrams with beamid greater than this number 
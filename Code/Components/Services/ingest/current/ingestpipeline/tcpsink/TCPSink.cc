@@ -32,6 +32,8 @@
 
 // System includes
 #include <string>
+#include <vector>
+#include <complex>
 #include <stdint.h>
 
 #include <set>
@@ -66,9 +68,12 @@ using boost::asio::ip::tcp;
 
 TCPSink::TCPSink(const LOFAR::ParameterSet& parset,
                  const Configuration& config)
-    : itsParset(parset), itsSocket(itsIOService)
+    : itsParset(parset), itsZeroCopy(parset.getBool("zerocopy", false)), itsSocket(itsIOService)
 {
     ASKAPLOG_DEBUG_STR(logger, "Constructor");
+    if (itsZeroCopy) {
+        ASKAPLOG_INFO_STR(logger, "Visibilities and flags will be sent directly from the chunk without copying");
+    }
     //itsThread.reset(new boost::thread(boost::bind(&TCPSink::runSender, this)));
 }
 
@@ -102,14 +107,15 @@ void TCPSink::process(VisChunk::ShPtr& chunk)
     ASKAPASSERT(itsThread);
 
 
-    // 1: Try to acquire the mutex protecting the buffer. Don't wait because we
-    // don't want to block the main thread
-    boost::mutex::scoped_lock lock(itsMutex, boost::try_to_lock);
-    if (!lock) return;
+    // 1: Acquire the mutex protecting the pending buffer. The sender thread only
+    // holds it to swap buffers (never while sending), so this doesn't block the main thread
+    boost::mutex::scoped_lock lock(itsMutex);
+    if (itsPending.itsValid) {
+        ASKAPLOG_DEBUG_STR(logger, "Sender thread is busy, replacing pending data with the latest integration");
+    }
 
-    // 2: Serialise the VisChunk to a byte-array
-    itsBuf.clear();
-    serialiseVisChunk(*chunk, itsBuf);
+    // 2: Fill the pending buffer (buffers are reused between integrations)
+    fillMessage(*chunk, itsPending);
 
     // 3: Release the lock and signal the network sender thread
     lock.unlock();
@@ -147,7 +153,7 @@ void TCPSink::pushBackVector(const std::vector<T>& src, std::vector<uint8_t>& de
     memcpy(&dest[idx], src.data(), nbytes);
 }
 
-void TCPSink::serialiseVisChunk(const askap::cp::common::VisChunk& chunk, std::vector<uint8_t>& v)
+void TCPSink::serialiseMetadata(const askap::cp::common::VisChunk& chunk, std::vector<uint8_t>& v)
 {
     pushBack<uint32_t>(chunk.nRow(), v);
     pushBack<uint32_t>(chunk.nChannel(), v);
@@ -169,51 +175,96 @@ void TCPSink::serialiseVisChunk(const askap::cp::common::VisChunk& chunk, std::v
         stokesvec.push_back(mapStokes(casaStokes[i]));
     }
     pushBackVector<uint32_t>(stokesvec, v);
+}
 
-    // Visibilities
-    pushBackArray< std::complex<float> >(chunk.visibility(), v);
+void TCPSink::fillMessage(const askap::cp::common::VisChunk& chunk, VisMessage& msg) const
+{
+    // Metadata are small, serialise them into the reused header buffer
+    msg.itsHeader.clear();
+    serialiseMetadata(chunk, msg.itsHeader);
+
+    // Visibilities and flags go directly from the cube storage. The cubes of the message
+    // either reference the chunk or hold a snapshot (assign reuses the storage if the
+    // shape is unchanged, and is a plain copy otherwise)
+    ASKAPASSERT(chunk.visibility().contiguousStorage());
+    ASKAPASSERT(chunk.flag().contiguousStorage());
+    if (itsZeroCopy) {
+        msg.itsVisibility.reference(chunk.visibility());
+        msg.itsFlag.reference(chunk.flag());
+    } else {
+        msg.itsVisibility.assign(chunk.visibility());
+        msg.itsFlag.assign(chunk.flag());
+    }
 
     // Treat bool more specifically because there is no guarantee how they are
-    // represented in memory
-    const casa::Bool* data = chunk.flag().data();
-    vector<uint8_t> flagvec(chunk.flag().size(), 0);
-    for (size_t i = 0; i < flagvec.size(); ++i) {
-        if (data[i]) flagvec[i] = 1;
+    // represented in memory. Any sensible compiler uses a single byte
+    // with values of 0 and 1, so the conversion is normally not needed.
+    if (sizeof(casa::Bool) != sizeof(uint8_t)) {
+        const casa::Bool* data = msg.itsFlag.data();
+        msg.itsFlagBytes.resize(msg.itsFlag.nelements());
+        for (size_t i = 0; i < msg.itsFlagBytes.size(); ++i) {
+            msg.itsFlagBytes[i] = data[i] ? 1 : 0;
+        }
     }
-    pushBackVector<uint8_t>(flagvec, v);
+    msg.itsValid = true;
+}
+
+void TCPSink::send(const VisMessage& msg, boost::system::error_code& error)
+{
+    ASKAPDEBUGASSERT(msg.itsValid);
+    // the wire format is the same as if all fields were serialised one after another
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(3);
+    buffers.push_back(boost::asio::buffer(msg.itsHeader));
+    buffers.push_back(boost::asio::buffer(static_cast<const void*>(msg.itsVisibility.data()),
+                      msg.itsVisibility.nelements() * sizeof(std::complex<float>)));
+    if (sizeof(casa::Bool) == sizeof(uint8_t)) {
+        buffers.push_back(boost::asio::buffer(static_cast<const void*>(msg.itsFlag.data()),
+                          msg.itsFlag.nelements()));
+    } else {
+        buffers.push_back(boost::asio::buffer(msg.itsFlagBytes));
+    }
+    boost::asio::write(itsSocket, buffers, error);
 }
 
 void TCPSink::runSender()
 {
     while (!boost::this_thread::interruption_requested()) {
+        // Take the pending message, the lock is only held while buffers are swapped
         boost::mutex::scoped_lock lock(itsMutex);
-        while (itsBuf.empty()) {
+        while (!itsPending.itsValid) {
             itsCondVar.wait(lock);
         }
+        itsInFlight.swap(itsPending);
+        itsPending.itsValid = false;
+        lock.unlock();
 
         if (boost::this_thread::interruption_requested()) break;
 
         bool connected = itsSocket.is_open();
         if (!connected) {
-            lock.unlock();
             connected = connect();
-            lock.lock();
         }
 
         if (boost::this_thread::interruption_requested()) break;
 
         if (connected) {
             boost::system::error_code error;
-            boost::asio::write(itsSocket, boost::asio::buffer(itsBuf), error);
+            send(itsInFlight, error);
             if (error) {
                 ASKAPLOG_WARN_STR(logger, "Send failed: " << error.message());
                 itsSocket.close();
             }
         }
 
-        // Reset the buffer, even if the connect/send failed so the loop will not try
-        // to reconnect/resend until the next integration cycle
-        itsBuf.clear();
+        // Invalidate the message, even if the connect/send failed so the loop will not try
+        // to reconnect/resend until the next integration cycle. In the zero copy mode
+        // this also releases the reference to the chunk data.
+        itsInFlight.itsValid = false;
+        if (itsZeroCopy) {
+            itsInFlight.itsVisibility.resize();
+            itsInFlight.itsFlag.resize();
+        }
     }
     ASKAPLOG_DEBUG_STR(logger, "TCP sender thread exiting");
 }
@@ -29,6 +29,7 @@
 
 // Std includes
 #include <vector>
+#include <algorithm>
 #include <string>
 #include <stdint.h>
 
@@ -41,6 +42,7 @@
 #include "Common/ParameterSet.h"
 #include "cpcommon/VisChunk.h"
 #include "casacore/measures/Measures/Stokes.h"
+#include "casacore/casa/Arrays/Cube.h"
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
@@ -52,6 +54,18 @@ namespace ingest {
 
 /// @brief A sink task for the central processor ingest pipeline which writes
 /// the VisChunk to a TCP network port.
+/// @details The data are handed over to a separate sender thread via two
+/// buffers: the one being filled by the main thread and the one being sent.
+/// The main thread never waits for the network, if the sender is still busy
+/// with the previous integration the pending data are replaced by the latest ones.
+/// The message is sent with a single vectored (scatter-gather) write, directly
+/// from the storage of the visibility and flag cubes. By default, these cubes are
+/// a snapshot of the chunk, so the following tasks are free to modify the data.
+/// If no task following this one changes the data in place, the copy can be
+/// avoided altogether:
+/// @verbatim
+///    zerocopy        = true
+/// @endverbatim
 class TCPSink : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -86,11 +100,61 @@ class TCPSink : public askap::cp::ingest::ITask {
         /// @return true if connection succeeded, otherwise false
         bool connect(void);
 
-        /// Serialise a "VisChunk" to a byte-array for asynchronous sending to
-        /// the specified destination
-        static void serialiseVisChunk(const askap::cp::common::VisChunk& chunk,
+        /// @brief message ready to be sent
+        /// @details The metadata are serialised into a byte array while visibilities
+        /// and flags are sent directly from the cube storage.
+        struct VisMessage {
+            /// @brief constructor, creates an empty message
+            VisMessage() : itsValid(false) {}
+
+            /// @brief swap content with another message without copying the data
+            /// @details std::swap can't be used as assignment of casa arrays copies values
+            /// @param[in,out] other message to swap with
+            void swap(VisMessage& other) {
+                itsHeader.swap(other.itsHeader);
+                itsFlagBytes.swap(other.itsFlagBytes);
+                std::swap(itsValid, other.itsValid);
+                casa::Cube<casa::Complex> tmpVis;
+                tmpVis.reference(itsVisibility);
+                itsVisibility.reference(other.itsVisibility);
+                other.itsVisibility.reference(tmpVis);
+                casa::Cube<casa::Bool> tmpFlag;
+                tmpFlag.reference(itsFlag);
+                itsFlag.reference(other.itsFlag);
+                other.itsFlag.reference(tmpFlag);
+            }
+
+            /// Serialised metadata preceding visibilities and flags
+            std::vector<uint8_t> itsHeader;
+
+            /// Visibilities (either a snapshot or a reference to the chunk data)
+            casa::Cube<casa::Complex> itsVisibility;
+
+            /// Flags (either a snapshot or a reference to the chunk data)
+            casa::Cube<casa::Bool> itsFlag;
+
+            /// Flags converted to bytes if casa::Bool is not represented by one byte
+            std::vector<uint8_t> itsFlagBytes;
+
+            /// True if the message contains data to send
+            bool itsValid;
+        };
+
+        /// Fill the message with the data of the given VisChunk
+        /// @param[in] chunk VisChunk to send
+        /// @param[in,out] msg message to fill, buffers are reused
+        void fillMessage(const askap::cp::common::VisChunk& chunk, VisMessage& msg) const;
+
+        /// Serialise metadata of a "VisChunk" (everything except visibilities
+        /// and flags) to a byte-array
+        static void serialiseMetadata(const askap::cp::common::VisChunk& chunk,
                                       std::vector<uint8_t>& v);
 
+        /// Send the message with a single vectored write
+        /// @param[in] msg message to send
+        /// @param[out] error error code
+        void send(const VisMessage& msg, boost::system::error_code& error);
+
         /// Is used to append the bytes for a primative type to the
         /// byte vector
         template <typename T>
@@ -111,12 +175,19 @@ class TCPSink : public askap::cp::ingest::ITask {
         /// Parameter set
         const LOFAR::ParameterSet itsParset;
 
-        /// Buffer to send - This is shared between the producer (main thread)
-        /// and the consumer (sender thread) so no double buffering. Only the owner
-        /// of "itsMutex" should read/write this buffer.
-        std::vector<uint8_t> itsBuf;
+        /// True if visibilities and flags are sent directly from the chunk
+        /// (no task following this one should modify the data in place)
+        const bool itsZeroCopy;
+
+        /// Message to send next - This is filled by the producer (main thread)
+        /// and swapped with "itsInFlight" by the consumer (sender thread).
+        /// Only the owner of "itsMutex" should read/write this buffer.
+        VisMessage itsPending;
+
+        /// Message being sent - only accessed by the sender thread
+        VisMessage itsInFlight;
 
-        /// Mutex used to synchronise access to "itsBuf"
+        /// Mutex used to synchronise access to "itsPending"
         boost::mutex itsMutex;
 
         /// Condition variable used for signalling between the main thread and
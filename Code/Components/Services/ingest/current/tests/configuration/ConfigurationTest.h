@@ -45,6 +45,8 @@ class ConfigurationTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testArrayName);
         CPPUNIT_TEST(testSchedulingBlockID);
         CPPUNIT_TEST(testTasks);
+        CPPUNIT_TEST(testStages);
+        CPPUNIT_TEST_EXCEPTION(testStagesOutOfOrder, AskapError);
         CPPUNIT_TEST(testAntennas);
         CPPUNIT_TEST(testFeed);
         CPPUNIT_TEST(testServiceConfig);
@@ -166,6 +168,26 @@ class ConfigurationTest : public CppUnit::TestFixture {
            Configuration conf(itsParset, 4, 12);
         }
 
+        void testStages() {
+            Configuration conf(itsParset);
+            CPPUNIT_ASSERT_EQUAL(0ul, conf.stages().size());
+            CPPUNIT_ASSERT_EQUAL(2u, conf.stageQueueSize());
+
+            itsParset.add("tasks.stages", "[CalcUVWTask, MSSink]");
+            itsParset.add("tasks.stagequeue", "5");
+            Configuration conf1(itsParset);
+            CPPUNIT_ASSERT_EQUAL(2ul, conf1.stages().size());
+            CPPUNIT_ASSERT_EQUAL(1ul, conf1.stages()[0]);
+            CPPUNIT_ASSERT_EQUAL(3ul, conf1.stages()[1]);
+            CPPUNIT_ASSERT_EQUAL(5u, conf1.stageQueueSize());
+        }
+
+        void testStagesOutOfOrder() {
+            itsParset.add("tasks.stages", "[MSSink, CalcUVWTask]");
+            // this should throw an exception
+            Configuration conf(itsParset);
+        }
+
         void testArrayName() {
             Configuration conf(itsParset);
             CPPUNIT_ASSERT_EQUAL(casa::String("ASKAP"), conf.arrayName());
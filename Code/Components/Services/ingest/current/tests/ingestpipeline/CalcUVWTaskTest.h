@@ -53,6 +53,7 @@ class CalcUVWTaskTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(CalcUVWTaskTest);
         CPPUNIT_TEST(testOffset);
         CPPUNIT_TEST(testAutoCorrelation);
+        CPPUNIT_TEST(testMultipleRows);
         CPPUNIT_TEST(testInvalidAntenna);
         CPPUNIT_TEST(testInvalidBeam);
         CPPUNIT_TEST_SUITE_END();
@@ -78,6 +79,41 @@ class CalcUVWTaskTest : public CppUnit::TestFixture {
             testDriver(0,    0,    0,    0.0, 0.0, 0.0);
         }
 
+        void testMultipleRows() {
+            // the same baselines as in testOffset, but processed in a single chunk
+            // with beams interleaved (uvw's are cached per beam)
+            const unsigned int nRow = 5;
+            const unsigned int antenna1[nRow] = {0, 0, 0, 0, 0};
+            const unsigned int antenna2[nRow] = {1, 1, 2, 2, 0};
+            const unsigned int beam[nRow] = {0, 1, 1, 0, 1};
+            const double expected[nRow][3] = {{-411.4, -838.4, 294.1}, {-411.9, -843.1, 279.8},
+                    {-120.7, -879.4, 310.4}, {-120.2, -874.0, 325.5}, {0., 0., 0.}};
+
+            MDirection fieldCenter(Quantity(187.5, "deg"),
+                                   Quantity(-45, "deg"),
+                                   MDirection::Ref(MDirection::J2000));
+            VisChunk::ShPtr chunk(new VisChunk(nRow, 1, 1, 6));
+            chunk->time() = MVEpoch(Quantity(54165.73871, "d"));
+            for (unsigned int row = 0; row < nRow; ++row) {
+                 chunk->antenna1()(row) = antenna1[row];
+                 chunk->antenna2()(row) = antenna2[row];
+                 chunk->beam1()(row) = beam[row];
+                 chunk->beam2()(row) = beam[row];
+                 chunk->phaseCentre()(row) = fieldCenter.getAngle();
+            }
+
+            CalcUVWTask task(itsParset, ConfigurationHelper::createDummyConfig());
+            task.process(chunk);
+
+            const double tol = 1.0E-1;
+            for (unsigned int row = 0; row < nRow; ++row) {
+                 const casa::RigidVector<casa::Double, 3> uvw = chunk->uvw()(row);
+                 for (unsigned int dim = 0; dim < 3; ++dim) {
+                      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected[row][dim], uvw(dim), tol);
+                 }
+            }
+        }
+
         void testInvalidAntenna() {
             CPPUNIT_ASSERT_THROW(
                 //       ant1, ant2, beam,    u,   v,   w
@@ -30,6 +30,7 @@
 // Support classes
 #include <sstream>
 #include <cmath>
+#include <limits>
 #include "askap/AskapError.h"
 #include "Common/ParameterSet.h"
 #include "cpcommon/VisChunk.h"
@@ -60,6 +61,7 @@ class ChannelAvgTaskTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testNoAveraging);
         CPPUNIT_TEST(testInvalid);
         CPPUNIT_TEST(testAllFlagged);
+        CPPUNIT_TEST(testPartiallyFlagged);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -98,6 +100,52 @@ class ChannelAvgTaskTest : public CppUnit::TestFixture {
             averageTest(304 * 54, 304, true);
         }
 
+        // Test with several rows and polarisations where some samples are
+        // flagged, flagged samples should not contribute to the average
+        void testPartiallyFlagged() {
+            itsParset.add("averaging", "4");
+            const unsigned int nRow = 3;
+            const unsigned int nChan = 8;
+            const unsigned int nPol = 2;
+            VisChunk::ShPtr chunk(new VisChunk(nRow, nChan, nPol, 6));
+            for (unsigned int chan = 0; chan < nChan; ++chan) {
+                 chunk->frequency()(chan) = 1.4e9 + chan * 1e6;
+                 for (unsigned int row = 0; row < nRow; ++row) {
+                      for (unsigned int pol = 0; pol < nPol; ++pol) {
+                           chunk->visibility()(row, chan, pol) = casa::Complex(row + 10 * pol + chan, -1.);
+                           // flag the first channel of each group for row 1,
+                           // the whole second group for row 2
+                           chunk->flag()(row, chan, pol) = (row == 1 && chan % 4 == 0) ||
+                                                           (row == 2 && chan >= 4);
+                      }
+                 }
+            }
+            // garbage in flagged samples should be ignored
+            chunk->visibility()(1, 0, 0) = casa::Complex(std::numeric_limits<float>::quiet_NaN(), 0.);
+
+            ChannelAvgTask task(itsParset, ConfigurationHelper::createDummyConfig());
+            task.process(chunk);
+
+            CPPUNIT_ASSERT_EQUAL(nRow, chunk->nRow());
+            CPPUNIT_ASSERT_EQUAL(2u, chunk->nChannel());
+            CPPUNIT_ASSERT_EQUAL(nPol, chunk->nPol());
+            const double tol = 1e-6;
+            for (unsigned int row = 0; row < nRow; ++row) {
+                 for (unsigned int pol = 0; pol < nPol; ++pol) {
+                      // mean channel of the group is 1.5 or 5.5, or 2 or 6 if the first channel is flagged
+                      const double offset = (row == 1) ? 2. : 1.5;
+                      for (unsigned int chan = 0; chan < 2; ++chan) {
+                           const bool flagged = (row == 2) && (chan == 1);
+                           CPPUNIT_ASSERT_EQUAL(flagged, bool(chunk->flag()(row, chan, pol)));
+                           const casa::Complex expected = flagged ? casa::Complex(0., 0.) :
+                                   casa::Complex(row + 10 * pol + 4 * chan + offset, -1.);
+                           CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.real(), chunk->visibility()(row, chan, pol).real(), tol);
+                           CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.imag(), chunk->visibility()(row, chan, pol).imag(), tol);
+                      }
+                 }
+            }
+        }
+
         void testInvalid() {
             // This is an invalid configuraion, so should throw an exception
             CPPUNIT_ASSERT_THROW(averageTest(4, 3), askap::AskapError);
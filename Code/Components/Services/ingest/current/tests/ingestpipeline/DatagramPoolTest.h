@@ -0,0 +1,107 @@
+/// @file DatagramPoolTest.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include "boost/shared_ptr.hpp"
+#include <vector>
+
+// Classes to test
+#include "ingestpipeline/sourcetask/DatagramPool.h"
+#include "ingestpipeline/sourcetask/CircularBuffer.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class DatagramPoolTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(DatagramPoolTest);
+        CPPUNIT_TEST(testRecycle);
+        CPPUNIT_TEST(testExhaustion);
+        CPPUNIT_TEST(testBufferOverrun);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        // Slots return to the pool when the last shared pointer is released
+        void testRecycle() {
+            DatagramPool::ShPtr pool(new DatagramPool(4));
+            CPPUNIT_ASSERT_EQUAL(size_t(4), pool->nFree());
+            std::vector<VisDatagram*> slots;
+            pool->acquire(slots, 3);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), slots.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), pool->nFree());
+
+            pool->release(slots[2]);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), pool->nFree());
+            {
+                boost::shared_ptr<VisDatagram> first = pool->share(slots[0]);
+                boost::shared_ptr<VisDatagram> copy = first;
+                first->beamid = 5;
+                boost::shared_ptr<VisDatagram> second = pool->share(slots[1]);
+                first.reset();
+                CPPUNIT_ASSERT_EQUAL(size_t(2), pool->nFree());
+                CPPUNIT_ASSERT_EQUAL(5u, copy->beamid);
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(4), pool->nFree());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), pool->nHeapAllocations());
+        };
+
+        // Exhausted pool falls back to heap allocation
+        void testExhaustion() {
+            DatagramPool::ShPtr pool(new DatagramPool(2));
+            std::vector<VisDatagram*> slots;
+            pool->acquire(slots, 5);
+            CPPUNIT_ASSERT_EQUAL(size_t(5), slots.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), pool->nFree());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(3), pool->nHeapAllocations());
+            for (size_t i = 0; i < slots.size(); ++i) {
+                CPPUNIT_ASSERT(slots[i] != 0);
+                pool->share(slots[i]);
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(2), pool->nFree());
+        };
+
+        // Datagrams overwritten in the circular buffer go back to the pool
+        void testBufferOverrun() {
+            DatagramPool::ShPtr pool(new DatagramPool(8));
+            CircularBuffer<VisDatagram> buffer(4);
+            std::vector<VisDatagram*> slots;
+            for (size_t i = 0; i < 6; ++i) {
+                pool->acquire(slots, 1);
+                const bool overwritten = buffer.add(pool->share(slots[0]));
+                CPPUNIT_ASSERT_EQUAL(i >= 4, overwritten);
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(4), buffer.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(4), pool->nFree());
+            buffer.clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(8), pool->nFree());
+        };
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,170 @@
+/// @file PipelineStageTest.h
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <vector>
+#include <string>
+#include "askap/AskapError.h"
+#include "cpcommon/VisChunk.h"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "ingestpipeline/ITask.h"
+
+// Classes to test
+#include "ingestpipeline/PipelineStage.h"
+
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief task recording the order of chunks, optionally failing on some chunk
+class RecordingTask : public ITask {
+    public:
+        /// @param[in] failAt number of the chunk to throw an exception for, negative to never fail
+        explicit RecordingTask(int failAt = -1) : itsFailAt(failAt), itsCounter(0) {}
+
+        virtual void process(VisChunk::ShPtr& chunk) {
+            // give the producer a chance to fill the queue
+            boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+            boost::mutex::scoped_lock lock(itsMutex);
+            if (itsCounter++ == itsFailAt) {
+                ASKAPTHROW(AskapError, "Simulated failure");
+            }
+            itsChunks.push_back(chunk.get());
+        }
+
+        /// @return chunks processed so far, in the order of processing
+        std::vector<VisChunk*> chunks() const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsChunks;
+        }
+
+    private:
+        int itsFailAt;
+        int itsCounter;
+        std::vector<VisChunk*> itsChunks;
+        mutable boost::mutex itsMutex;
+};
+
+class PipelineStageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PipelineStageTest);
+        CPPUNIT_TEST(testOrder);
+        CPPUNIT_TEST(testDrainAfterFailure);
+        CPPUNIT_TEST(testFailureDownstream);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsChunks.clear();
+            for (size_t i = 0; i < 20; ++i) {
+                 itsChunks.push_back(VisChunk::ShPtr(new VisChunk(1, 1, 1, 1)));
+            }
+        }
+
+        void tearDown() {
+            itsChunks.clear();
+        }
+
+        // chunks should pass through all stages in the order they are pushed
+        void testOrder() {
+            boost::shared_ptr<RecordingTask> first(new RecordingTask);
+            boost::shared_ptr<RecordingTask> second(new RecordingTask);
+            PipelineStage::ShPtr stage1 = makeStage(first, 1);
+            PipelineStage::ShPtr stage2 = makeStage(second, 2);
+            stage2->start(PipelineStage::ShPtr());
+            stage1->start(stage2);
+            for (size_t i = 0; i < itsChunks.size(); ++i) {
+                 stage1->push(itsChunks[i]);
+            }
+            // this flushes the whole chain
+            stage1->finish();
+            CPPUNIT_ASSERT(!stage1->failed());
+            checkOrder(first->chunks(), itsChunks.size());
+            checkOrder(second->chunks(), itsChunks.size());
+        }
+
+        // push should not block after the failure, remaining data are discarded
+        void testDrainAfterFailure() {
+            boost::shared_ptr<RecordingTask> first(new RecordingTask(3));
+            boost::shared_ptr<RecordingTask> second(new RecordingTask);
+            PipelineStage::ShPtr stage1 = makeStage(first, 1);
+            PipelineStage::ShPtr stage2 = makeStage(second, 2);
+            stage2->start(PipelineStage::ShPtr());
+            stage1->start(stage2);
+            for (size_t i = 0; i < itsChunks.size(); ++i) {
+                 stage1->push(itsChunks[i]);
+            }
+            stage1->finish();
+            CPPUNIT_ASSERT(stage1->failed());
+            CPPUNIT_ASSERT(stage1->error().find("Simulated failure") != std::string::npos);
+            CPPUNIT_ASSERT(!stage2->failed());
+            checkOrder(first->chunks(), 3);
+            checkOrder(second->chunks(), 3);
+        }
+
+        // failure in a downstream stage should be visible via the first threaded stage
+        void testFailureDownstream() {
+            boost::shared_ptr<RecordingTask> first(new RecordingTask);
+            boost::shared_ptr<RecordingTask> second(new RecordingTask(5));
+            PipelineStage::ShPtr stage1 = makeStage(first, 1);
+            PipelineStage::ShPtr stage2 = makeStage(second, 2);
+            stage2->start(PipelineStage::ShPtr());
+            stage1->start(stage2);
+            for (size_t i = 0; i < itsChunks.size(); ++i) {
+                 stage1->push(itsChunks[i]);
+            }
+            stage1->finish();
+            CPPUNIT_ASSERT(stage1->failed());
+            CPPUNIT_ASSERT(stage1->error().find("Simulated failure") != std::string::npos);
+            checkOrder(first->chunks(), itsChunks.size());
+            checkOrder(second->chunks(), 5);
+        }
+
+    private:
+        /// @brief make a stage with a single task and the shortest queue
+        static PipelineStage::ShPtr makeStage(const boost::shared_ptr<RecordingTask> &task, size_t index) {
+            const std::vector<ITask::ShPtr> tasks(1, task);
+            return PipelineStage::ShPtr(new PipelineStage(tasks, index, 1, false));
+        }
+
+        /// @brief check that the first n chunks have been processed in order
+        void checkOrder(const std::vector<VisChunk*> &processed, size_t n) const {
+            CPPUNIT_ASSERT_EQUAL(n, processed.size());
+            for (size_t i = 0; i < n; ++i) {
+                 CPPUNIT_ASSERT(processed[i] == itsChunks[i].get());
+            }
+        }
+
+        std::vector<VisChunk::ShPtr> itsChunks;
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,142 @@
+/// @file CircularBufferTest.cc
+///
+/// @copyright (c) 2010 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "boost/bind.hpp"
+
+// Classes to test
+#include "ingestpipeline/sourcetask/SPSCRingBuffer.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class SPSCRingBufferTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SPSCRingBufferTest);
+        CPPUNIT_TEST(testSingle);
+        CPPUNIT_TEST(testWrapAround);
+        CPPUNIT_TEST(testOverflow);
+        CPPUNIT_TEST(testTimeout);
+        CPPUNIT_TEST(testThreaded);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        // Test the addition and retrieval of a single pointer
+        void testSingle() {
+            SPSCRingBuffer<int> instance(2);
+            boost::shared_ptr<int> inPtr(new int(1));
+            CPPUNIT_ASSERT(!instance.add(inPtr));
+            CPPUNIT_ASSERT_EQUAL(size_t(1), instance.size());
+
+            boost::shared_ptr<int> outPtr(instance.next());
+            CPPUNIT_ASSERT_EQUAL(*inPtr, *outPtr);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.size());
+            // the buffer should not hold a reference any more
+            CPPUNIT_ASSERT_EQUAL(2l, inPtr.use_count());
+        };
+
+        // Test that the order is preserved when indices wrap around
+        void testWrapAround() {
+            SPSCRingBuffer<int> instance(3);
+            int expected = 0;
+            for (int i = 0; i < 20; ++i) {
+                CPPUNIT_ASSERT(!instance.add(boost::shared_ptr<int>(new int(i))));
+                if (i % 2 == 1) {
+                    CPPUNIT_ASSERT_EQUAL(expected++, *instance.next());
+                    CPPUNIT_ASSERT_EQUAL(expected++, *instance.next());
+                }
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.size());
+            CPPUNIT_ASSERT_EQUAL(size_t(2), instance.highWaterMark());
+        };
+
+        // Test the addition of more pointers than the buffer has capacity
+        // to handle, the new elements are rejected
+        void testOverflow() {
+            const size_t count = 1024;
+            const size_t maxcapacity = 10;
+            SPSCRingBuffer<size_t> instance(maxcapacity);
+
+            for (size_t i = 0; i < count; ++i) {
+                CPPUNIT_ASSERT_EQUAL((i < maxcapacity) ? i : maxcapacity,
+                        instance.size());
+                const bool lost = instance.add(boost::shared_ptr<size_t>(new size_t(i)));
+                CPPUNIT_ASSERT_EQUAL(i >= maxcapacity, lost);
+            }
+            CPPUNIT_ASSERT_EQUAL(maxcapacity, instance.highWaterMark());
+            CPPUNIT_ASSERT_EQUAL(size_t(0), *instance.next());
+            instance.resetHighWaterMark();
+            CPPUNIT_ASSERT_EQUAL(maxcapacity - 1, instance.highWaterMark());
+            instance.clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), instance.size());
+        };
+
+        // Test the timeout parameter. Just make sure this does not block
+        // forever.
+        void testTimeout() {
+            const long timeout = 10; // microseconds
+            SPSCRingBuffer<int> instance(2);
+
+            boost::shared_ptr<int> outPtr(instance.next(timeout));
+            CPPUNIT_ASSERT(outPtr.get() == 0);
+            outPtr = instance.next(0);
+            CPPUNIT_ASSERT(outPtr.get() == 0);
+        };
+
+        // Test a producer thread and a consumer thread, including the
+        // blocking wait of the consumer
+        void testThreaded() {
+            const int count = 100000;
+            SPSCRingBuffer<int> instance(count, 10);
+            boost::thread producer(boost::bind(&SPSCRingBufferTest::produce, &instance, count));
+            for (int i = 0; i < count; ++i) {
+                boost::shared_ptr<int> outPtr(instance.next(10000000));
+                CPPUNIT_ASSERT(outPtr);
+                CPPUNIT_ASSERT_EQUAL(i, *outPtr);
+            }
+            producer.join();
+            CPPUNIT_ASSERT(!instance.next(0));
+        };
+
+    private:
+        static void produce(SPSCRingBuffer<int>* buffer, const int count) {
+            for (int i = 0; i < count; ++i) {
+                if (i % 1000 == 0) {
+                    // let the consumer go to sleep on the condition variable
+                    boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                }
+                buffer->add(boost::shared_ptr<int>(new int(i)));
+            }
+        }
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -29,6 +29,8 @@
 
 // Test includes
 #include "CircularBufferTest.h"
+#include "DatagramPoolTest.h"
+#include "SPSCRingBufferTest.h"
 #include "VisChunkTest.h"
 #include "ScanManagerTest.h"
 #include "ChannelManagerTest.h"
@@ -39,11 +41,14 @@
 #include "ChannelAvgTaskTest.h"
 #include "CalTaskTest.h"
 #include "CasaArrayAssumptionsTest.h"
+#include "PipelineStageTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::cp::ingest::CircularBufferTest::suite());
+    runner.addTest(askap::cp::ingest::DatagramPoolTest::suite());
+    runner.addTest(askap::cp::ingest::SPSCRingBufferTest::suite());
     runner.addTest(askap::cp::ingest::VisChunkTest::suite());
     runner.addTest(askap::cp::ingest::ScanManagerTest::suite());
     runner.addTest(askap::cp::ingest::ChannelManagerTest::suite());
@@ -54,6 +59,7 @@ int main(int argc, char *argv[])
     runner.addTest(askap::cp::ingest::ChannelAvgTaskTest::suite());
     runner.addTest(askap::cp::ingest::CalTaskTest::suite());
     runner.addTest(askap::cp::ingest::CasaArrayAssumptionsTest::suite());
+    runner.addTest(askap::cp::ingest::PipelineStageTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;
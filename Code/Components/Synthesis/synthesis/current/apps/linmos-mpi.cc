@@ -19,6 +19,9 @@
 /// 3rd party
 #include <Common/ParameterSet.h>
 
+// std includes
+#include <algorithm>
+
 
 ASKAP_LOGGER(logger, ".linmos");
 
@@ -27,6 +30,41 @@ using namespace askap;
 using namespace askap::synthesis;
 
 
+/// @brief tag of the message sent by the master when all output images are created
+static const int LINMOS_CREATED_TAG = 1;
+
+/// @brief tag of the message sent to the neighbouring ranks when the slab is written
+static const int LINMOS_WRITTEN_TAG = 2;
+
+/// @brief create an output image and set its metadata
+/// @details This is done by the master only, before any slab is written.
+/// The last pixel of the cube is written here as well, so the file is extended to
+/// its full size. FITSImageRW::create writes the header only, and each cfitsio writer
+/// would otherwise zero-fill the data unit from the end of file it saw when the file
+/// was opened, overwriting slabs already written by other ranks. The last pixel is
+/// overwritten later by the rank holding the last channel.
+/// @param[in] iacc image accessor
+/// @param[in] name image name
+/// @param[in] shape shape of the whole output cube
+/// @param[in] csys coordinate system of the output cube
+/// @param[in] units brightness units
+/// @param[in] psf restoring beam, not written if it has less than 3 elements
+static void createOutputImage(accessors::IImageAccess& iacc, const string &name,
+                              const casa::IPosition &shape, const casa::CoordinateSystem &csys,
+                              const string &units, const Vector<Quantum<double> > &psf) {
+    iacc.create(name, shape, csys);
+    casa::IPosition last(shape);
+    for (casa::uInt dim = 0; dim < last.nelements(); ++dim) {
+         last[dim] -= 1;
+    }
+    iacc.write(name, casa::Array<float>(casa::IPosition(shape.nelements(), 1), 0.f), last);
+    iacc.makeDefaultMask(name);
+    iacc.setUnits(name, units);
+    if (psf.nelements()>=3) {
+        iacc.setBeamInfo(name, psf[0].getValue("rad"), psf[1].getValue("rad"), psf[2].getValue("rad"));
+    }
+}
+
 // @brief do the merge
 /// @param[in] parset subset with parameters
 static void mergeMPI(const LOFAR::ParameterSet &parset, askap::askapparallel::AskapParallel &comms) {
@@ -467,64 +505,70 @@ static void mergeMPI(const LOFAR::ParameterSet &parset, askap::askapparallel::As
             psf = psftmp;
         }
         // write accumulated images and weight images
-        ASKAPLOG_INFO_STR(logger, "Writing accumulated image to " << outImgName);
         casa::IPosition outShape = accumulator.outShape();
+        outShape[3] = originalNchan;
+        // ranks beyond the number of channels have returned early and take no part in writing
+        const int nWriters = std::min(comms.nProcs(), originalNchan);
+        int buf = 0;
 
         if (comms.isMaster()) {
-            outShape[3] = originalNchan;
-
+            // the master creates all output images and sets their metadata before
+            // any pixels are written, so other ranks only need to write their slabs
             ASKAPLOG_INFO_STR(logger, " Creating output file - Shape " << outShape << " OriginalNchan " << originalNchan);
-            iacc.create(outImgName, outShape, accumulator.outCoordSys());
-            iacc.makeDefaultMask(outImgName);
-
+            createOutputImage(iacc, outImgName, outShape, accumulator.outCoordSys(), units, psf);
+            if (!accumulator.outWgtDuplicates()[outImgName]) {
+                createOutputImage(iacc, outWgtName, outShape, accumulator.outCoordSys(), units, psf);
+            }
+            if (accumulator.doSensitivity()) {
+                createOutputImage(iacc, outSenName, outShape, accumulator.outCoordSys(), units, psf);
+            }
+            for (int rank = 1; rank < nWriters; ++rank) {
+                comms.send((void *) &buf, sizeof(int), rank, LINMOS_CREATED_TAG);
+            }
+        } else {
+            comms.receive((void *) &buf, sizeof(int), 0, LINMOS_CREATED_TAG);
         }
-        else {
-            int buf;
-            int from = comms.rank() - 1;
-            comms.receive((void *) &buf,sizeof(int),from);
+
+        // The output files have been extended to their full size by the master, so no writer
+        // appends to them. Slabs of adjacent ranks may still share a FITS record or a casa tile
+        // which is read, modified and written back as a whole, so even ranks write first and
+        // odd ranks write as soon as both their neighbours are done.
+        // The wait doesn't grow with the number of ranks.
+        const int rank = comms.rank();
+        if (rank % 2 == 1) {
+            comms.receive((void *) &buf, sizeof(int), rank - 1, LINMOS_WRITTEN_TAG);
+            if (rank + 1 < nWriters) {
+                comms.receive((void *) &buf, sizeof(int), rank + 1, LINMOS_WRITTEN_TAG);
+            }
         }
+
         casa::IPosition loc(outShape.nelements(),0);
         loc[3] = myAllocationStart;
-        ASKAPLOG_INFO_STR(logger, " - location " << loc);
+        ASKAPLOG_INFO_STR(logger, "Writing accumulated image to " << outImgName << " - location " << loc);
         iacc.write(outImgName,outPix,loc);
         iacc.writeMask(outImgName,outMask,loc);
-        iacc.setUnits(outImgName,units);
-
-        if (psf.nelements()>=3)
-            iacc.setBeamInfo(outImgName, psf[0].getValue("rad"), psf[1].getValue("rad"), psf[2].getValue("rad"));
 
         if (accumulator.outWgtDuplicates()[outImgName]) {
             ASKAPLOG_INFO_STR(logger, "Accumulated weight image " << outWgtName << " already written");
         } else {
-            if (comms.isMaster()) {
-                ASKAPLOG_INFO_STR(logger, "Writing accumulated weight image to " << outWgtName);
-                iacc.create(outWgtName, outShape, accumulator.outCoordSys());
-                iacc.makeDefaultMask(outWgtName);
-            }
+            ASKAPLOG_INFO_STR(logger, "Writing accumulated weight image to " << outWgtName);
             iacc.write(outWgtName,outWgtPix,loc);
             iacc.writeMask(outWgtName,outMask,loc);
-            iacc.setUnits(outWgtName,units);
-            if (psf.nelements()>=3)
-                iacc.setBeamInfo(outWgtName, psf[0].getValue("rad"), psf[1].getValue("rad"), psf[2].getValue("rad"));
         }
 
         if (accumulator.doSensitivity()) {
-            if (comms.isMaster()) {
-                ASKAPLOG_INFO_STR(logger, "Writing accumulated sensitivity image to " << outSenName);
-                iacc.create(outSenName, outShape, accumulator.outCoordSys());
-                iacc.makeDefaultMask(outSenName);
-            }
+            ASKAPLOG_INFO_STR(logger, "Writing accumulated sensitivity image to " << outSenName);
             iacc.write(outSenName,outSenPix,loc);
             iacc.writeMask(outSenName,outMask,loc);
-            iacc.setUnits(outSenName,units);
-            if (psf.nelements()>=3)
-                iacc.setBeamInfo(outSenName, psf[0].getValue("rad"), psf[1].getValue("rad"), psf[2].getValue("rad"));
         }
 
-        if (comms.rank() < comms.nProcs()-1) {
-            int buf;
-            int to = comms.rank()+1;
-            comms.send((void *) &buf,sizeof(int),to);
+        if (rank % 2 == 0) {
+            if (rank > 0) {
+                comms.send((void *) &buf, sizeof(int), rank - 1, LINMOS_WRITTEN_TAG);
+            }
+            if (rank + 1 < nWriters) {
+                comms.send((void *) &buf, sizeof(int), rank + 1, LINMOS_WRITTEN_TAG);
+            }
         }
 
     }
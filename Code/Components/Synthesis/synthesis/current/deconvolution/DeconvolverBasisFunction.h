@@ -34,6 +34,7 @@
 #define ASKAP_SYNTHESIS_DECONVOLVERBASISFUNCTION_H
 
 #include <string>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <casacore/casa/aips.h>
@@ -44,6 +45,7 @@
 #include <deconvolution/DeconvolverControl.h>
 #include <deconvolution/DeconvolverMonitor.h>
 #include <deconvolution/BasisFunction.h>
+#include <deconvolution/TiledPeakFinder.h>
 
 namespace askap {
 
@@ -142,6 +144,19 @@ namespace askap {
 
                 void gramSchmidt(casa::Array<T>& bf);
 
+                /// @brief Add a scaled patch of one image plane to another
+                /// @details The planes are stored with x varying fastest.
+                /// @param[in] target first pixel of the patch to update
+                /// @param[in] targetStride distance between rows of the target
+                /// @param[in] source first pixel of the patch to add
+                /// @param[in] sourceStride distance between rows of the source
+                /// @param[in] nx patch width
+                /// @param[in] ny patch height
+                /// @param[in] scale factor applied to the source
+                static void addScaledPatch(T* target, const casa::uInt targetStride,
+                                           const T* source, const casa::uInt sourceStride,
+                                           const casa::uInt nx, const casa::uInt ny, const T scale);
+
                 /// Residual images convolved with basis functions
                 casa::Array<T> itsResidualBasisFunction;
 
@@ -167,6 +182,9 @@ namespace askap {
 
                 casa::String itsDecouplingAlgorithm;
 
+                /// Number of threads used to process the scales
+                casa::uInt itsNumberOfThreads;
+
                 /// Basis function used in the deconvolution
                 boost::shared_ptr<BasisFunction<T> > itsBasisFunction;
 
@@ -181,6 +199,10 @@ namespace askap {
 
                 /// The peak of the convolved PSF as a function of scale
                 casa::Vector<T> itsPSFScales;
+
+                /// @brief Peak search for each scale of the residual, updated
+                /// only where the PSF has been subtracted
+                std::vector<TiledPeakFinder<T> > itsPeakFinders;
         };
 
     } // namespace synthesis
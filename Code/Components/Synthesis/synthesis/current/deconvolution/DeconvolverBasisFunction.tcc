@@ -63,7 +63,7 @@ namespace askap {
                                                                   Vector<Array<T> >& psf)
                 : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf),
                 itsUseCrossTerms(true), itsDecouple(true),
-                itsDecouplingAlgorithm("diagonal")
+                itsDecouplingAlgorithm("diagonal"), itsNumberOfThreads(1)
         {
         };
 
@@ -72,7 +72,7 @@ namespace askap {
                                                                   Array<T>& psf)
                 : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf),
                 itsUseCrossTerms(true), itsDecouple(true),
-                itsDecouplingAlgorithm("diagonal")
+                itsDecouplingAlgorithm("diagonal"), itsNumberOfThreads(1)
         {
         };
 
@@ -123,6 +123,19 @@ namespace askap {
             }
 
             itsDecouplingAlgorithm = parset.getString("decouplingalgorithm", "diagonal");
+
+            itsNumberOfThreads = parset.getUint("nthreads", 1);
+            ASKAPCHECK(itsNumberOfThreads > 0, "Number of threads should be positive");
+            #ifdef _OPENMP
+            if (itsNumberOfThreads > 1) {
+                ASKAPLOG_INFO_STR(decbflogger, "Scales will be processed with up to " << itsNumberOfThreads << " threads");
+            }
+            #else
+            if (itsNumberOfThreads > 1) {
+                ASKAPLOG_WARN_STR(decbflogger, "nthreads = " << itsNumberOfThreads <<
+                                  " is ignored as the code is built without OpenMP");
+            }
+            #endif
         }
 
         template<class T, class FT>
@@ -226,6 +239,9 @@ namespace askap {
             this->itsL1image.resize(this->itsNumberTerms);
             this->itsL1image(0).resize(l1Shape);
             this->itsL1image(0).set(0.0);
+
+            // The residuals have been recalculated
+            this->itsPeakFinders.clear();
         }
 
         template<class T, class FT>
@@ -254,14 +270,19 @@ namespace askap {
             casa::setReal(residualFFT, this->dirty().nonDegenerate());
             scimath::fft2d(residualFFT, true);
 
-            Array<FT> work(this->model().nonDegenerate().shape());
             ASKAPLOG_DEBUG_STR(decbflogger,
                                "Calculating convolutions of residual image with basis functions");
 
-            for (uInt term = 0; term < this->itsBasisFunction->numberBases(); term++) {
-
-                ASKAPASSERT(basisFunctionFFT.xyPlane(term).nonDegenerate().shape().conform(residualFFT.nonDegenerate().shape()));
-                work = conj(basisFunctionFFT.xyPlane(term).nonDegenerate()) * residualFFT.nonDegenerate();
+            // Each basis function is done by one thread with its own work array.
+            // All planes have the same shape, so the check is done up front
+            // (exceptions can't leave the parallel region)
+            ASKAPASSERT(basisFunctionFFT.xyPlane(0).nonDegenerate().shape().conform(residualFFT.nonDegenerate().shape()));
+            const int nBases(this->itsBasisFunction->numberBases());
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+            #endif
+            for (int term = 0; term < nBases; term++) {
+                Array<FT> work(conj(basisFunctionFFT.xyPlane(term).nonDegenerate()) * residualFFT.nonDegenerate());
                 scimath::fft2d(work, false);
 
                 // basis function * residual
@@ -290,8 +311,6 @@ namespace askap {
 
             IPosition subPsfShape(2, psfWidth, psfWidth);
 
-            Array<FT> work(subPsfShape);
-
             ASKAPLOG_DEBUG_STR(decbflogger, "Shape of basis functions "
                                    << this->itsBasisFunction->basisFunction().shape());
 
@@ -340,10 +359,14 @@ namespace askap {
             ASKAPLOG_DEBUG_STR(decbflogger, "Calculating convolutions of Psfs with basis functions");
             itsPSFScales.resize(this->itsBasisFunction->numberBases());
 
-            for (uInt term = 0; term < this->itsBasisFunction->numberBases(); term++) {
+            ASKAPASSERT(basisFunctionFFT.xyPlane(0).nonDegenerate().shape().conform(subXFR.shape()));
+            const int nBases(this->itsBasisFunction->numberBases());
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+            #endif
+            for (int term = 0; term < nBases; term++) {
                 // basis function * psf
-                ASKAPASSERT(basisFunctionFFT.xyPlane(term).nonDegenerate().shape().conform(subXFR.shape()));
-                work = conj(basisFunctionFFT.xyPlane(term).nonDegenerate()) * subXFR;
+                Array<FT> work(conj(basisFunctionFFT.xyPlane(term).nonDegenerate()) * subXFR);
                 scimath::fft2d(work, false);
                 Cube<T>(this->itsPSFBasisFunction).xyPlane(term) = real(work);
 
@@ -365,14 +388,18 @@ namespace askap {
             Array<FT> crossTermsPSFFFT(crossTermsShape);
             crossTermsPSFFFT.set(T(0));
 
-            for (uInt term = 0; term < this->itsBasisFunction->numberBases(); term++) {
-                crossTermsStart(2) = term;
-                crossTermsEnd(2) = term;
-
-                for (uInt term1 = 0; term1 < this->itsBasisFunction->numberBases(); term1++) {
-                    crossTermsStart(3) = term1;
-                    crossTermsEnd(3) = term1;
-                    casa::Slicer crossTermsSlicer(crossTermsStart, crossTermsEnd, crossTermsStride, Slicer::endIsLast);
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+            #endif
+            for (int term = 0; term < nBases; term++) {
+                IPosition termStart(crossTermsStart), termEnd(crossTermsEnd);
+                termStart(2) = term;
+                termEnd(2) = term;
+
+                for (int term1 = 0; term1 < nBases; term1++) {
+                    termStart(3) = term1;
+                    termEnd(3) = term1;
+                    casa::Slicer crossTermsSlicer(termStart, termEnd, crossTermsStride, Slicer::endIsLast);
                     crossTermsPSFFFT(crossTermsSlicer).nonDegenerate() =
                         basisFunctionFFT.xyPlane(term).nonDegenerate() *
                         conj(basisFunctionFFT.xyPlane(term1)).nonDegenerate() * subXFR;
@@ -590,7 +617,16 @@ namespace askap {
                 modelEnd(dim) = residualEnd(dim);
             }
 
-            casa::Slicer modelSlicer(modelStart, modelEnd, modelStride, Slicer::endIsLast);
+            // The patches are updated in place through raw pointers rather than
+            // with array expressions, so no temporaries are made here and the
+            // terms can be updated in parallel below
+            for (uInt dim = 0; dim < 2; dim++) {
+                ASKAPCHECK(psfEnd(dim) - psfStart(dim) == residualEnd(dim) - residualStart(dim),
+                           "PSF patch does not conform to the residual patch");
+            }
+            const uInt patchWidth(residualEnd(0) - residualStart(0) + 1);
+            const uInt patchHeight(residualEnd(1) - residualStart(1) + 1);
+            const T gain(this->control()->gain());
 
             // Add to model
             // Note that the model is only two dimensional. We could make it three dimensional
@@ -598,13 +634,17 @@ namespace askap {
             // We loop over all terms and ignore those with no flux
             const casa::uInt nterms(this->itsResidualBasisFunction.shape()(2));
 
+            ASKAPDEBUGASSERT(this->model().contiguousStorage());
+            ASKAPDEBUGASSERT(this->itsBasisFunction->basisFunction().contiguousStorage());
+            const IPosition bfShape(this->itsBasisFunction->basisFunction().shape());
+            T* modelPatch = this->model().data() + modelStart(0) + modelShape(0) * modelStart(1);
+
             for (uInt term = 0; term < nterms; term++) {
                 if (abs(peakValues(term)) > 0.0) {
-                    psfStart(2) = psfEnd(2) = term;
-                    casa::Slicer psfSlicer(psfStart, psfEnd, psfStride, Slicer::endIsLast);
-                    typename casa::Array<T> modelSlice = this->model()(modelSlicer).nonDegenerate();
-                    modelSlice += this->control()->gain() * peakValues(term) *
-                                  this->itsBasisFunction->basisFunction()(psfSlicer).nonDegenerate();
+                    const T* bfPatch = this->itsBasisFunction->basisFunction().data() + psfStart(0) +
+                                       bfShape(0) * (psfStart(1) + bfShape(1) * term);
+                    addScaledPatch(modelPatch, modelShape(0), bfPatch, bfShape(0), patchWidth, patchHeight,
+                                   gain * peakValues(term));
                 }
             }
 
@@ -612,50 +652,68 @@ namespace askap {
             for (uInt term = 0; term < nterms; term++) {
                 if (abs(peakValues(term)) > 0.0) {
                     IPosition l1PeakPos(3, absPeakPos(0), absPeakPos(1), term);
-                    casa::Slicer modelSlicer(modelStart, modelEnd, modelStride, Slicer::endIsLast);
                     this->itsL1image(0)(l1PeakPos) += this->control()->gain() * abs(peakValues(term));
                     this->itsScaleFlux(term) += this->control()->gain() * peakValues(term);
                 }
             }
 
-            // Subtract PSFs
-            for (uInt term = 0; term < nterms; term++) {
+            // Subtract PSFs, including the cross terms. Each residual plane is
+            // owned by one thread and the contributions to it are always added
+            // in the same order, so the result doesn't depend on the number of threads
+            ASKAPDEBUGASSERT(this->itsResidualBasisFunction.contiguousStorage());
+            ASKAPDEBUGASSERT(this->itsPSFBasisFunction.contiguousStorage());
+            ASKAPDEBUGASSERT(this->itsPSFCrossTerms.contiguousStorage() || !itsUseCrossTerms);
+            T* residualData = this->itsResidualBasisFunction.data();
+            const T* psfData = this->itsPSFBasisFunction.data();
+            const T* crossTermsData = this->itsPSFCrossTerms.data();
+            const IPosition crossTermsShape(this->itsPSFCrossTerms.shape());
+
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+            #endif
+            for (int term = 0; term < int(nterms); term++) {
+                T* residualPatch = residualData + residualStart(0) +
+                                   residualShape(0) * (residualStart(1) + residualShape(1) * term);
                 if (abs(peakValues(term)) > 0.0) {
-                    psfStart(2) = psfEnd(2) = term;
-                    casa::Slicer psfSlicer(psfStart, psfEnd, psfStride, Slicer::endIsLast);
-                    residualStart(2) = residualEnd(2) = term;
-                    casa::Slicer residualSlicer(residualStart, residualEnd, residualStride, Slicer::endIsLast);
-                    typename casa::Array<T> residualBFSlice = this->itsResidualBasisFunction(residualSlicer).nonDegenerate();
-                    residualBFSlice -= this->control()->gain() * peakValues(term) * this->itsPSFBasisFunction(psfSlicer).nonDegenerate();
+                    const T* psfPatch = psfData + psfStart(0) + psfShape(0) * (psfStart(1) + psfShape(1) * term);
+                    addScaledPatch(residualPatch, residualShape(0), psfPatch, psfShape(0),
+                                   patchWidth, patchHeight, -gain * peakValues(term));
                 }
-            }
-
-            if (itsUseCrossTerms) {
-                for (uInt term1 = 0; term1 < nterms; term1++) {
-                    if (abs(peakValues(term1)) > 0.0) {
-                        for (uInt term = 0; term < nterms; term++) {
-                            if (term != term1) {
-                                residualStart(2) = term;
-                                residualEnd(2) = term;
-                                casa::Slicer residualSlicer(residualStart, residualEnd, residualStride, Slicer::endIsLast);
-
-                                psfCrossTermsStart(2) = term1;
-                                psfCrossTermsEnd(2) = term1;
-                                psfCrossTermsStart(3) = term;
-                                psfCrossTermsEnd(3) = term;
-                                casa::Slicer psfCrossTermsSlicer(psfCrossTermsStart, psfCrossTermsEnd, psfCrossTermsStride, Slicer::endIsLast);
-                                typename casa::Array<T> residualBFSlice = this->itsResidualBasisFunction(residualSlicer).nonDegenerate();
-                                residualBFSlice -= this->control()->gain() * peakValues(term1) *
-                                                   this->itsPSFCrossTerms(psfCrossTermsSlicer).nonDegenerate();
-                            }
+                if (itsUseCrossTerms) {
+                    for (int term1 = 0; term1 < int(nterms); term1++) {
+                        if ((term1 != term) && (abs(peakValues(term1)) > 0.0)) {
+                            const T* crossTermsPatch = crossTermsData + psfStart(0) + crossTermsShape(0) *
+                                                       (psfStart(1) + crossTermsShape(1) *
+                                                        (term1 + crossTermsShape(2) * term));
+                            addScaledPatch(residualPatch, residualShape(0), crossTermsPatch, crossTermsShape(0),
+                                           patchWidth, patchHeight, -gain * peakValues(term1));
                         }
                     }
                 }
             }
 
+            for (uInt scale = 0; scale < this->itsPeakFinders.size(); scale++) {
+                this->itsPeakFinders[scale].invalidate(residualStart, residualEnd);
+            }
+
             return True;
         }
 
+        template<class T, class FT>
+        void DeconvolverBasisFunction<T, FT>::addScaledPatch(T* target, const casa::uInt targetStride,
+                const T* source, const casa::uInt sourceStride,
+                const casa::uInt nx, const casa::uInt ny, const T scale)
+        {
+            for (uInt y = 0; y < ny; y++) {
+                T* targetRow = target + size_t(y) * targetStride;
+                const T* sourceRow = source + size_t(y) * sourceStride;
+
+                for (uInt x = 0; x < nx; x++) {
+                    targetRow[x] += scale * sourceRow[x];
+                }
+            }
+        }
+
         template<class T, class FT>
         void DeconvolverBasisFunction<T, FT>::minMaxMaskedScales(T& minVal, T& maxVal,
                 IPosition& minPos, IPosition& maxPos,
@@ -671,16 +729,19 @@ namespace askap {
             Vector<T> sMinVal(nScales);
             Vector<IPosition> sMinPos(nScales);
             Vector<IPosition> sMaxPos(nScales);
+            if (itsPeakFinders.size() != nScales) {
+                itsPeakFinders.assign(nScales, TiledPeakFinder<T>());
+            }
             {
                 if (isWeighted) {
                     for (uInt scale = 0; scale < nScales; scale++) {
-                        casa::minMaxMasked(sMinVal(scale), sMaxVal(scale), sMinPos(scale), sMaxPos(scale),
-                                           Cube<T>(dataArray).xyPlane(scale), weightArray.nonDegenerate());
+                        itsPeakFinders[scale].minMaxMasked(sMinVal(scale), sMaxVal(scale), sMinPos(scale), sMaxPos(scale),
+                                                           Cube<T>(dataArray).xyPlane(scale), weightArray.nonDegenerate());
                     }
                 } else {
                     for (uInt scale = 0; scale < nScales; scale++) {
-                        casa::minMax(sMinVal(scale), sMaxVal(scale), sMinPos(scale), sMaxPos(scale),
-                                     Cube<T>(dataArray).xyPlane(scale));
+                        itsPeakFinders[scale].minMax(sMinVal(scale), sMaxVal(scale), sMinPos(scale), sMaxPos(scale),
+                                                     Cube<T>(dataArray).xyPlane(scale));
                     }
                 }
             }
@@ -42,6 +42,7 @@
 #include <deconvolution/DeconvolverState.h>
 #include <deconvolution/DeconvolverControl.h>
 #include <deconvolution/DeconvolverMonitor.h>
+#include <deconvolution/TiledPeakFinder.h>
 
 namespace askap {
 
@@ -98,6 +99,10 @@ namespace askap {
                 /// @brief Perform the deconvolution
                 /// @detail This is the main deconvolution method.
                 bool oneIteration();
+
+                /// @brief Search for the peak of the residual image, updated
+                /// only where the PSF has been subtracted
+                TiledPeakFinder<T> itsPeakFinder;
         };
 
     } // namespace synthesis
@@ -75,6 +75,8 @@ namespace askap {
         void DeconvolverHogbom<T, FT>::initialise()
         {
             DeconvolverBase<T, FT>::initialise();
+            // The residual image may have been replaced in place
+            itsPeakFinder.invalidate();
         }
 
         template<class T, class FT>
@@ -115,11 +117,11 @@ namespace askap {
             casa::IPosition maxPos;
             T minVal, maxVal;
             if (isMasked) {
-                casa::minMaxMasked(minVal, maxVal, minPos, maxPos, this->dirty(0), this->weight(0));
+                itsPeakFinder.minMaxMasked(minVal, maxVal, minPos, maxPos, this->dirty(0), this->weight(0));
                 minVal = this->dirty(0)(minPos);
                 maxVal = this->dirty(0)(maxPos);
             } else {
-                casa::minMax(minVal, maxVal, minPos, maxPos, this->dirty(0));
+                itsPeakFinder.minMax(minVal, maxVal, minPos, maxPos, this->dirty(0));
             }
             //
             ASKAPLOG_INFO_STR(dechogbomlogger, "Maximum = " << maxVal << " at location " << maxPos);
@@ -166,9 +168,11 @@ namespace askap {
             casa::IPosition modelStart(2, 0), modelEnd(2, 0), modelStride(2, 1);
 
             // Wrangle the start, end, and shape into consistent form.
+            // Only the central subPsfShape part of the PSF is subtracted (this is the
+            // whole PSF unless psfwidth is given)
             for (uInt dim = 0; dim < 2; dim++) {
-                residualStart(dim) = max(0, Int(absPeakPos(dim) - psfShape(dim) / 2));
-                residualEnd(dim) = min(Int(absPeakPos(dim) + psfShape(dim) / 2 - 1), Int(residualShape(dim) - 1));
+                residualStart(dim) = max(0, Int(absPeakPos(dim) - subPsfShape(dim) / 2));
+                residualEnd(dim) = min(Int(absPeakPos(dim) + subPsfShape(dim) / 2 - 1), Int(residualShape(dim) - 1));
                 // Now we have to deal with the PSF. Here we want to use enough of the
                 // PSF to clean the residual image.
                 psfStart(dim) = max(0, Int(this->itsPeakPSFPos(dim) - (absPeakPos(dim) - residualStart(dim))));
@@ -196,10 +200,11 @@ namespace askap {
             // Add to model
             this->model()(absPeakPos) = this->model()(absPeakPos) + this->control()->gain() * absPeakVal;
 
-            // Subtract entire PSF from residual image
+            // Subtract the PSF from residual image
 
             this->dirty()(residualSlicer) = this->dirty()(residualSlicer)
                                             - this->control()->gain() * absPeakVal * this->psf()(psfSlicer);
+            itsPeakFinder.invalidate(residualStart, residualEnd);
 
             return True;
         }
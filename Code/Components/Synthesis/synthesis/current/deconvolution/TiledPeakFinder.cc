@@ -0,0 +1,164 @@
+/// @file TiledPeakFinder.cc
+///
+/// Row kernels of the tiled peak finder
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <deconvolution/TiledPeakFinder.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(ASKAP_DECONVOLVER_NO_SIMD)
+#define ASKAP_PEAKFINDER_WITH_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace askap {
+
+    namespace synthesis {
+
+        namespace {
+
+            /// @brief scalar row kernel
+            template<class T>
+            void findRowMinMaxScalar(const T *data, const T *weight, const size_t n,
+                                     T &minVal, T &maxVal, size_t &minIdx, size_t &maxIdx)
+            {
+                minVal = maxVal = weight ? data[0] * weight[0] : data[0];
+                minIdx = maxIdx = 0;
+                for (size_t i = 1; i < n; ++i) {
+                    const T value = weight ? data[i] * weight[i] : data[i];
+                    if (value < minVal) {
+                        minVal = value;
+                        minIdx = i;
+                    }
+                    if (value > maxVal) {
+                        maxVal = value;
+                        maxIdx = i;
+                    }
+                }
+            }
+
+#ifdef ASKAP_PEAKFINDER_WITH_SIMD
+
+            /// @brief AVX row kernel
+            /// @details Each of the 8 lanes keeps its own extrema and their indices
+            /// (as floats, exact for rows shorter than 2^24 pixels); lanes are combined
+            /// at the end resolving equal values in favour of the smaller index.
+            __attribute__((target("avx")))
+            void findRowMinMaxAVX(const casa::Float *data, const casa::Float *weight, const size_t n,
+                                  casa::Float &minVal, casa::Float &maxVal, size_t &minIdx, size_t &maxIdx)
+            {
+                if (n < 16) {
+                    findRowMinMaxScalar(data, weight, n, minVal, maxVal, minIdx, maxIdx);
+                    return;
+                }
+                const __m256 step = _mm256_set1_ps(8.f);
+                __m256 index = _mm256_set_ps(7.f, 6.f, 5.f, 4.f, 3.f, 2.f, 1.f, 0.f);
+                __m256 value = _mm256_loadu_ps(data);
+                if (weight) {
+                    value = _mm256_mul_ps(value, _mm256_loadu_ps(weight));
+                }
+                __m256 laneMin = value;
+                __m256 laneMax = value;
+                __m256 laneMinIdx = index;
+                __m256 laneMaxIdx = index;
+                size_t i = 8;
+                for (; i + 8 <= n; i += 8) {
+                    index = _mm256_add_ps(index, step);
+                    value = _mm256_loadu_ps(data + i);
+                    if (weight) {
+                        value = _mm256_mul_ps(value, _mm256_loadu_ps(weight + i));
+                    }
+                    const __m256 less = _mm256_cmp_ps(value, laneMin, _CMP_LT_OQ);
+                    const __m256 greater = _mm256_cmp_ps(value, laneMax, _CMP_GT_OQ);
+                    laneMin = _mm256_blendv_ps(laneMin, value, less);
+                    laneMinIdx = _mm256_blendv_ps(laneMinIdx, index, less);
+                    laneMax = _mm256_blendv_ps(laneMax, value, greater);
+                    laneMaxIdx = _mm256_blendv_ps(laneMaxIdx, index, greater);
+                }
+                float mins[8], maxs[8], minIdxs[8], maxIdxs[8];
+                _mm256_storeu_ps(mins, laneMin);
+                _mm256_storeu_ps(maxs, laneMax);
+                _mm256_storeu_ps(minIdxs, laneMinIdx);
+                _mm256_storeu_ps(maxIdxs, laneMaxIdx);
+                minVal = mins[0];
+                maxVal = maxs[0];
+                minIdx = size_t(minIdxs[0]);
+                maxIdx = size_t(maxIdxs[0]);
+                for (int lane = 1; lane < 8; ++lane) {
+                    if ((mins[lane] < minVal) || ((mins[lane] == minVal) && (size_t(minIdxs[lane]) < minIdx))) {
+                        minVal = mins[lane];
+                        minIdx = size_t(minIdxs[lane]);
+                    }
+                    if ((maxs[lane] > maxVal) || ((maxs[lane] == maxVal) && (size_t(maxIdxs[lane]) < maxIdx))) {
+                        maxVal = maxs[lane];
+                        maxIdx = size_t(maxIdxs[lane]);
+                    }
+                }
+                for (; i < n; ++i) {
+                    const casa::Float tail = weight ? data[i] * weight[i] : data[i];
+                    if (tail < minVal) {
+                        minVal = tail;
+                        minIdx = i;
+                    }
+                    if (tail > maxVal) {
+                        maxVal = tail;
+                        maxIdx = i;
+                    }
+                }
+            }
+
+            /// @brief true if the AVX kernel can be used
+            bool selectAVX()
+            {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx");
+            }
+
+            const bool theUseAVX = selectAVX();
+
+#endif
+
+        } // anonymous namespace
+
+        void findRowMinMax(const casa::Float *data, const casa::Float *weight, const size_t n,
+                           casa::Float &minVal, casa::Float &maxVal, size_t &minIdx, size_t &maxIdx)
+        {
+#ifdef ASKAP_PEAKFINDER_WITH_SIMD
+            if (theUseAVX) {
+                findRowMinMaxAVX(data, weight, n, minVal, maxVal, minIdx, maxIdx);
+                return;
+            }
+#endif
+            findRowMinMaxScalar(data, weight, n, minVal, maxVal, minIdx, maxIdx);
+        }
+
+        void findRowMinMax(const casa::Double *data, const casa::Double *weight, const size_t n,
+                           casa::Double &minVal, casa::Double &maxVal, size_t &minIdx, size_t &maxIdx)
+        {
+            findRowMinMaxScalar(data, weight, n, minVal, maxVal, minIdx, maxIdx);
+        }
+
+    } // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,155 @@
+/// @file TiledPeakFinder.h
+///
+/// TiledPeakFinder: search for the extrema of a residual image with per-tile caching
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_SYNTHESIS_TILEDPEAKFINDER_H
+#define ASKAP_SYNTHESIS_TILEDPEAKFINDER_H
+
+#include <vector>
+
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+
+namespace askap {
+
+    namespace synthesis {
+
+        /// @brief Find the extrema of a row of pixels
+        /// @details Finds the first occurrence of the minimum and the maximum of
+        /// data[i]*weight[i] (or of data[i] if weight is null) for 0 <= i < n, as
+        /// casa::minMax and casa::minMaxMasked do. The single precision version uses
+        /// AVX if the CPU supports it.
+        /// @param[in] data pointer to the first pixel
+        /// @param[in] weight pointer to the first weight or null
+        /// @param[in] n number of pixels (should be positive)
+        /// @param[out] minVal minimum value
+        /// @param[out] maxVal maximum value
+        /// @param[out] minIdx index of the minimum
+        /// @param[out] maxIdx index of the maximum
+        void findRowMinMax(const casa::Float *data, const casa::Float *weight, const size_t n,
+                           casa::Float &minVal, casa::Float &maxVal, size_t &minIdx, size_t &maxIdx);
+
+        /// @brief Find the extrema of a row of pixels (double precision)
+        /// @details See the single precision version.
+        void findRowMinMax(const casa::Double *data, const casa::Double *weight, const size_t n,
+                           casa::Double &minVal, casa::Double &maxVal, size_t &minIdx, size_t &maxIdx);
+
+        /// @brief Search for the extrema of an image which changes locally
+        /// @details The minor cycle of the CLEAN-like deconvolvers locates the
+        /// extrema of the residual image in every iteration, but a component
+        /// subtraction only changes a PSF-sized patch of it. This class splits the
+        /// image plane into square tiles and caches the extrema of each tile. Only the
+        /// tiles touched by the region passed to invalidate are rescanned, so the cost
+        /// of the search scales with the PSF support rather than the image size.
+        ///
+        /// The results are identical to casa::minMax and casa::minMaxMasked including
+        /// the choice between equal extrema (the first in the storage order). The
+        /// image is expected to be contiguous with the plane spanned by the first two
+        /// axes (other axes should be degenerate). Whenever the image or the weight is
+        /// changed other than through the invalidated region, invalidate() should be
+        /// called (changes in the data pointer or the shape are detected automatically).
+        /// @ingroup deconvolution
+        template<class T>
+        class TiledPeakFinder {
+            public:
+                /// @brief Constructor
+                /// @param[in] tileSize size of the square tiles in pixels
+                explicit TiledPeakFinder(const casa::uInt tileSize = 64);
+
+                /// @brief Mark the whole image as changed
+                void invalidate();
+
+                /// @brief Mark a region of the image as changed
+                /// @details Only the first two elements of the corners are used.
+                /// @param[in] blc bottom left corner of the region
+                /// @param[in] trc top right corner of the region (inclusive)
+                void invalidate(const casa::IPosition &blc, const casa::IPosition &trc);
+
+                /// @brief Find the extrema of an image
+                /// @details Equivalent to casa::minMax.
+                void minMax(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                            const casa::Array<T>& image);
+
+                /// @brief Find the extrema of a weighted image
+                /// @details Equivalent to casa::minMaxMasked, the values returned are
+                /// those of image*weight.
+                void minMaxMasked(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                                  const casa::Array<T>& image, const casa::Array<T>& weight);
+
+            private:
+                /// @brief cached extrema of a tile, indices are into the whole plane
+                struct TileExtrema {
+                    T itsMinVal;
+                    T itsMaxVal;
+                    size_t itsMinIdx;
+                    size_t itsMaxIdx;
+                };
+
+                /// @brief common part of minMax and minMaxMasked
+                /// @param[in] weight pointer to the weights or null
+                void search(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                            const casa::Array<T>& image, const T* weight);
+
+                /// @brief set up the tiles for a new image
+                void reset(const T* data, const T* weight, const casa::uInt nx, const casa::uInt ny);
+
+                /// @brief rescan a tile
+                void scanTile(const size_t tile);
+
+                /// @brief size of the tiles
+                casa::uInt itsTileSize;
+
+                /// @brief size of the image plane
+                casa::uInt itsNx;
+                casa::uInt itsNy;
+
+                /// @brief number of tiles along each axis
+                casa::uInt itsNTilesX;
+                casa::uInt itsNTilesY;
+
+                /// @brief image data the tiles refer to
+                const T* itsData;
+
+                /// @brief weights the tiles refer to (null if not weighted)
+                const T* itsWeight;
+
+                /// @brief cached extrema for each tile
+                std::vector<TileExtrema> itsTiles;
+
+                /// @brief flags of tiles to be rescanned
+                std::vector<bool> itsDirty;
+
+                /// @brief true if any tile is to be rescanned
+                bool itsAnyDirty;
+        };
+
+    } // namespace synthesis
+
+} // namespace askap
+
+#include <deconvolution/TiledPeakFinder.tcc>
+
+#endif
@@ -0,0 +1,188 @@
+/// @file TiledPeakFinder.tcc
+///
+/// TiledPeakFinder: search for the extrema of a residual image with per-tile caching
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <algorithm>
+
+#include <askap/AskapError.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/MaskArrMath.h>
+
+namespace askap {
+
+    namespace synthesis {
+
+        template<class T>
+        TiledPeakFinder<T>::TiledPeakFinder(const casa::uInt tileSize) :
+                itsTileSize(tileSize), itsNx(0), itsNy(0), itsNTilesX(0), itsNTilesY(0),
+                itsData(0), itsWeight(0), itsAnyDirty(false)
+        {
+            ASKAPCHECK(tileSize > 0, "Tile size of the peak finder should be positive");
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::invalidate()
+        {
+            std::fill(itsDirty.begin(), itsDirty.end(), true);
+            itsAnyDirty = true;
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::invalidate(const casa::IPosition &blc, const casa::IPosition &trc)
+        {
+            if (itsTiles.size() == 0) {
+                return;
+            }
+            const casa::Int startX = std::max(0, casa::Int(blc(0)));
+            const casa::Int startY = std::max(0, casa::Int(blc(1)));
+            const casa::Int endX = std::min(casa::Int(itsNx) - 1, casa::Int(trc(0)));
+            const casa::Int endY = std::min(casa::Int(itsNy) - 1, casa::Int(trc(1)));
+            for (casa::Int ty = startY / casa::Int(itsTileSize); ty <= endY / casa::Int(itsTileSize); ++ty) {
+                for (casa::Int tx = startX / casa::Int(itsTileSize); tx <= endX / casa::Int(itsTileSize); ++tx) {
+                    itsDirty[ty * itsNTilesX + tx] = true;
+                    itsAnyDirty = true;
+                }
+            }
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::minMax(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                                        const casa::Array<T>& image)
+        {
+            if (!image.contiguousStorage()) {
+                casa::minMax(minVal, maxVal, minPos, maxPos, image);
+                return;
+            }
+            search(minVal, maxVal, minPos, maxPos, image, 0);
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::minMaxMasked(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                                              const casa::Array<T>& image, const casa::Array<T>& weight)
+        {
+            ASKAPCHECK(image.nelements() == weight.nelements(),
+                       "Image and weight shapes differ: " << image.shape() << " " << weight.shape());
+            if (!image.contiguousStorage() || !weight.contiguousStorage()) {
+                casa::minMaxMasked(minVal, maxVal, minPos, maxPos, image, weight);
+                return;
+            }
+            search(minVal, maxVal, minPos, maxPos, image, weight.data());
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::search(T& minVal, T& maxVal, casa::IPosition& minPos, casa::IPosition& maxPos,
+                                        const casa::Array<T>& image, const T* weight)
+        {
+            const casa::IPosition shape(image.shape());
+            ASKAPCHECK(shape.nelements() >= 2, "Peak finder requires at least two dimensions, shape = " << shape);
+            const casa::uInt nx = shape(0);
+            const casa::uInt ny = shape(1);
+            ASKAPCHECK(shape.product() == casa::Int64(nx) * ny,
+                       "Peak finder works with a single plane only, shape = " << shape);
+            ASKAPCHECK(nx * ny > 0, "Peak finder requires a non-empty image");
+
+            if ((image.data() != itsData) || (weight != itsWeight) || (nx != itsNx) || (ny != itsNy)) {
+                reset(image.data(), weight, nx, ny);
+            }
+            if (itsAnyDirty) {
+                for (size_t tile = 0; tile < itsTiles.size(); ++tile) {
+                    if (itsDirty[tile]) {
+                        scanTile(tile);
+                        itsDirty[tile] = false;
+                    }
+                }
+                itsAnyDirty = false;
+            }
+
+            // reduce over tiles, equal values are resolved in favour of the
+            // first one in the storage order
+            typename std::vector<TileExtrema>::const_iterator it = itsTiles.begin();
+            minVal = it->itsMinVal;
+            maxVal = it->itsMaxVal;
+            size_t minIdx = it->itsMinIdx;
+            size_t maxIdx = it->itsMaxIdx;
+            for (++it; it != itsTiles.end(); ++it) {
+                if ((it->itsMinVal < minVal) || ((it->itsMinVal == minVal) && (it->itsMinIdx < minIdx))) {
+                    minVal = it->itsMinVal;
+                    minIdx = it->itsMinIdx;
+                }
+                if ((it->itsMaxVal > maxVal) || ((it->itsMaxVal == maxVal) && (it->itsMaxIdx < maxIdx))) {
+                    maxVal = it->itsMaxVal;
+                    maxIdx = it->itsMaxIdx;
+                }
+            }
+            minPos = casa::IPosition(shape.nelements(), 0);
+            maxPos = casa::IPosition(shape.nelements(), 0);
+            minPos(0) = minIdx % nx;
+            minPos(1) = minIdx / nx;
+            maxPos(0) = maxIdx % nx;
+            maxPos(1) = maxIdx / nx;
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::reset(const T* data, const T* weight, const casa::uInt nx, const casa::uInt ny)
+        {
+            itsData = data;
+            itsWeight = weight;
+            itsNx = nx;
+            itsNy = ny;
+            itsNTilesX = (nx + itsTileSize - 1) / itsTileSize;
+            itsNTilesY = (ny + itsTileSize - 1) / itsTileSize;
+            itsTiles.resize(size_t(itsNTilesX) * itsNTilesY);
+            itsDirty.assign(itsTiles.size(), true);
+            itsAnyDirty = true;
+        }
+
+        template<class T>
+        void TiledPeakFinder<T>::scanTile(const size_t tile)
+        {
+            const casa::uInt startX = (tile % itsNTilesX) * itsTileSize;
+            const casa::uInt startY = (tile / itsNTilesX) * itsTileSize;
+            const casa::uInt width = std::min(itsTileSize, itsNx - startX);
+            const casa::uInt endY = std::min(startY + itsTileSize, itsNy);
+            TileExtrema &extrema = itsTiles[tile];
+            for (casa::uInt y = startY; y < endY; ++y) {
+                const size_t offset = size_t(y) * itsNx + startX;
+                T rowMin, rowMax;
+                size_t rowMinIdx, rowMaxIdx;
+                findRowMinMax(itsData + offset, itsWeight ? itsWeight + offset : 0, width,
+                              rowMin, rowMax, rowMinIdx, rowMaxIdx);
+                // rows are scanned in the storage order, so only a strictly
+                // smaller (larger) value replaces the current extremum
+                if ((y == startY) || (rowMin < extrema.itsMinVal)) {
+                    extrema.itsMinVal = rowMin;
+                    extrema.itsMinIdx = offset + rowMinIdx;
+                }
+                if ((y == startY) || (rowMax > extrema.itsMaxVal)) {
+                    extrema.itsMaxVal = rowMax;
+                    extrema.itsMaxIdx = offset + rowMaxIdx;
+                }
+            }
+        }
+
+    } // namespace synthesis
+
+} // namespace askap
@@ -302,18 +302,41 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
             for (int chan = 0; chan < nChan; ++chan) {
 
-                /// Extract illumination pattern for this channel
-                itsIllumination->getPattern(acc.frequency()[chan], pattern,
-                                            rwSlopes()(0, feed, currentField()),
-                                            rwSlopes()(1, feed, currentField()), parallacticAngle);
-
-                scimath::fft2d(pattern.pattern(), false);
-
+                // the illumination pattern is only required if some w-planes are not cached
+                bool patternReady = false;
 
                 /// Calculate the total convolution function including
                 /// the w term and the antenna convolution function
 
                 for (int iw = 0; iw < nWPlanes(); ++iw) {
+                    const int zIndex = iw + nWPlanes() * (chan + nChan * (feed + itsMaxFeeds * currentField()));
+
+                    // the common support is determined by the first plane
+                    const int commonSupport = isSupportPlaneDependent() ? -1 : itsSupport;
+                    casa::uInt64 key = 0;
+                    boost::shared_ptr<const ConvFuncCacheEntry> entry;
+                    if (itsCFCache) {
+                        const double cfParams[4] = {acc.frequency()[chan], rwSlopes()(0, feed, currentField()),
+                                                    rwSlopes()(1, feed, currentField()), parallacticAngle};
+                        key = GriddingPlanCache::hash(cfCacheKey(getWTerm(iw), commonSupport),
+                                                      cfParams, sizeof(cfParams));
+                        entry = itsCFCache->find(key);
+                    }
+                    if (entry) {
+                        useCFCacheEntry(*entry, zIndex);
+                        continue;
+                    }
+
+                    if (!patternReady) {
+                        /// Extract illumination pattern for this channel
+                        itsIllumination->getPattern(acc.frequency()[chan], pattern,
+                                                    rwSlopes()(0, feed, currentField()),
+                                                    rwSlopes()(1, feed, currentField()), parallacticAngle);
+
+                        scimath::fft2d(pattern.pattern(), false);
+                        patternReady = true;
+                    }
+
                     thisPlane.set(0.0);
 
 
@@ -360,8 +383,6 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
                     const double thisPlaneNorm = sum(real(thisPlane));
                     ASKAPDEBUGASSERT(thisPlaneNorm > 0.);
 
-                    const int zIndex = iw + nWPlanes() * (chan + nChan * (feed + itsMaxFeeds * currentField()));
-
                     // If the support is not yet set, find it and size the
                     // convolution function appropriately
 
@@ -380,17 +401,6 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
                         cfSupport.itsSize = limitSupportIfNecessary(support);
 
-                        if (itsSupport == 0) {
-                            itsSupport = cfSupport.itsSize;
-                            ASKAPLOG_DEBUG_STR(logger, "Number of planes in convolution function = "
-                                                   << itsConvFunc.size() << " or " << itsConvFunc.size() / itsOverSample / itsOverSample <<
-                                               " before oversampling with factor " << itsOverSample);
-                        }
-
-                        if (isOffsetSupportAllowed()) {
-                            setConvFuncOffset(zIndex, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
-                        }
-
                         // just for log output
                         const double cell = std::abs(itsUVCellSize(0) * (casa::C::c
                                                      / acc.frequency()[chan]));
@@ -401,54 +411,57 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
                     // use either support determined for this particular plane or a generic one,
                     // determined from the first plane (largest support as we have the largest w-term)
-                    const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
+                    const int support = cfSupport.itsSize;
 
                     // Since we are decimating, we need to rescale by the
                     // decimation factor
                     const double rescale = double(itsOverSample * itsOverSample);
                     const int cSize = 2 * support + 1;
 
+                    boost::shared_ptr<ConvFuncCacheEntry> newEntry(new ConvFuncCacheEntry);
+                    newEntry->itsSupport = support;
+                    newEntry->itsOffsetU = cfSupport.itsOffsetU;
+                    newEntry->itsOffsetV = cfSupport.itsOffsetV;
+                    newEntry->itsPlanes.resize(itsOverSample * itsOverSample);
+
                     for (int fracu = 0; fracu < itsOverSample; fracu++) {
                         for (int fracv = 0; fracv < itsOverSample; fracv++) {
-                            const int plane = fracu + itsOverSample * (fracv + itsOverSample
-                                              * zIndex);
-                            ASKAPDEBUGASSERT(plane >= 0 && plane < int(itsConvFunc.size()));
-                            itsConvFunc[plane].resize(cSize, cSize);
-                            itsConvFunc[plane].set(0.0);
+                            casa::Matrix<casa::Complex> &thisCF = newEntry->itsPlanes[fracu + itsOverSample * fracv];
+                            thisCF.resize(cSize, cSize);
+                            thisCF.set(0.0);
 
                             // Now cut out the inner part of the convolution function and
                             // insert it into the convolution function
                             for (int iy = -support; iy < support; iy++) {
                                 for (int ix = -support; ix < support; ix++) {
                                     ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                                    ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                                    ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
+                                    ASKAPDEBUGASSERT(ix + support < int(thisCF.nrow()));
+                                    ASKAPDEBUGASSERT(iy + support < int(thisCF.ncolumn()));
                                     ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 >= 0);
                                     ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 >= 0);
                                     ASKAPDEBUGASSERT((ix + cfSupport.itsOffsetU)*itsOverSample + fracu + int(nx) / 2 < int(thisPlane.nrow()));
                                     ASKAPDEBUGASSERT((iy + cfSupport.itsOffsetV)*itsOverSample + fracv + int(ny) / 2 < int(thisPlane.ncolumn()));
 
-                                    itsConvFunc[plane](ix + support, iy + support)
+                                    thisCF(ix + support, iy + support)
                                     = rescale * thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
                                                           (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2);
                                 } // for ix
                             } // for iy
 
-
-                            /*
-                            // force normalization for all fractional offsets (or planes)
-                            const double norm = sum(real(itsConvFunc[plane]));
-                            //    ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm<<" for plane "<<plane<<
-                            //       " full buffer has sum="<<thisPlaneNorm<<" ratio="<<norm/thisPlaneNorm);
-                            ASKAPDEBUGASSERT(norm>0.);
-                            if (norm>0.) {
-                                //itsConvFunc[plane]*=casa::Complex(norm/thisPlaneNorm);
-                            }
-                            */
-
                         } // for fracv
                     } // for fracu
 
+                    if (itsCFCache) {
+                        itsCFCache->add(key, newEntry);
+                    }
+                    const bool firstPlane = (itsSupport == 0);
+                    useCFCacheEntry(*newEntry, zIndex);
+                    if (firstPlane) {
+                        ASKAPLOG_DEBUG_STR(logger, "Number of planes in convolution function = "
+                                               << itsConvFunc.size() << " or " << itsConvFunc.size() / itsOverSample / itsOverSample <<
+                                           " before oversampling with factor " << itsOverSample);
+                    }
+
                 } // w loop
             } // chan loop
 
@@ -0,0 +1,283 @@
+/// @file 
+/// @brief Cache of convolution functions shared between gridders
+/// @details Convolution functions of the w-projection family of gridders depend only on
+/// the gridder parameters, the grid geometry and, for A-projection, the frequency, the
+/// pointing offset and the parallactic angle. The image, PSF and preconditioner gridders
+/// (and their clones for every Taylor term) would otherwise compute identical stacks of
+/// convolution functions. This class holds the oversampled planes of individual w-planes
+/// indexed by a fingerprint of everything they depend on. The least recently used entries
+/// are dropped when the memory budget is exceeded. Entries can also be stored on disk and
+/// picked up by subsequent runs.
+///
+/// @copyright (c) 2018 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/ConvFuncCache.h>
+#include <askap_synthesis.h>
+#include <askap/AskapLogging.h>
+ASKAP_LOGGER(logger, ".gridding.convfunccache");
+
+#include <askap/AskapError.h>
+
+#include <boost/thread/locks.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <unistd.h>
+
+namespace askap {
+
+namespace synthesis {
+
+namespace {
+
+/// @brief version of the file format, files with a different version are ignored
+const casa::Int theFileVersion = 1;
+
+/// @brief protects creation of the process-wide cache
+boost::mutex theProcessCacheMutex;
+
+/// @brief the process-wide cache
+ConvFuncCache::ShPtr theProcessCache;
+
+} // anonymous namespace
+
+/// @brief default constructor, makes an empty entry
+ConvFuncCacheEntry::ConvFuncCacheEntry() : itsSupport(0), itsOffsetU(0), itsOffsetV(0) {}
+
+/// @brief approximate number of bytes used by this entry
+size_t ConvFuncCacheEntry::memoryUsed() const
+{
+   size_t result = sizeof(ConvFuncCacheEntry);
+   for (size_t plane = 0; plane < itsPlanes.size(); ++plane) {
+        result += sizeof(casa::Matrix<casa::Complex>) + itsPlanes[plane].nelements() * sizeof(casa::Complex);
+   }
+   return result;
+}
+
+/// @brief write the entry into a binary stream
+/// @param[in] os output stream
+void ConvFuncCacheEntry::write(std::ostream &os) const
+{
+   os.write(reinterpret_cast<const char*>(&theFileVersion), sizeof(theFileVersion));
+   os.write(reinterpret_cast<const char*>(&itsSupport), sizeof(itsSupport));
+   os.write(reinterpret_cast<const char*>(&itsOffsetU), sizeof(itsOffsetU));
+   os.write(reinterpret_cast<const char*>(&itsOffsetV), sizeof(itsOffsetV));
+   const casa::uInt64 nPlanes = itsPlanes.size();
+   os.write(reinterpret_cast<const char*>(&nPlanes), sizeof(nPlanes));
+   for (size_t plane = 0; plane < itsPlanes.size(); ++plane) {
+        const casa::uInt shape[2] = {itsPlanes[plane].nrow(), itsPlanes[plane].ncolumn()};
+        os.write(reinterpret_cast<const char*>(shape), sizeof(shape));
+        if (itsPlanes[plane].nelements() > 0) {
+            casa::Bool deleteIt;
+            const casa::Complex *data = itsPlanes[plane].getStorage(deleteIt);
+            os.write(reinterpret_cast<const char*>(data), itsPlanes[plane].nelements() * sizeof(casa::Complex));
+            itsPlanes[plane].freeStorage(data, deleteIt);
+        }
+   }
+}
+
+/// @brief read the entry from a binary stream
+/// @param[in] is input stream
+void ConvFuncCacheEntry::read(std::istream &is)
+{
+   casa::Int version = -1;
+   is.read(reinterpret_cast<char*>(&version), sizeof(version));
+   if (!is || (version != theFileVersion)) {
+       is.setstate(std::ios::failbit);
+       return;
+   }
+   is.read(reinterpret_cast<char*>(&itsSupport), sizeof(itsSupport));
+   is.read(reinterpret_cast<char*>(&itsOffsetU), sizeof(itsOffsetU));
+   is.read(reinterpret_cast<char*>(&itsOffsetV), sizeof(itsOffsetV));
+   casa::uInt64 nPlanes = 0;
+   is.read(reinterpret_cast<char*>(&nPlanes), sizeof(nPlanes));
+   if (!is) {
+       return;
+   }
+   itsPlanes.resize(nPlanes);
+   for (size_t plane = 0; (plane < itsPlanes.size()) && is; ++plane) {
+        casa::uInt shape[2] = {0, 0};
+        is.read(reinterpret_cast<char*>(shape), sizeof(shape));
+        itsPlanes[plane].resize(shape[0], shape[1]);
+        if (is && (itsPlanes[plane].nelements() > 0)) {
+            casa::Bool deleteIt;
+            casa::Complex *data = itsPlanes[plane].getStorage(deleteIt);
+            is.read(reinterpret_cast<char*>(data), itsPlanes[plane].nelements() * sizeof(casa::Complex));
+            itsPlanes[plane].putStorage(data, deleteIt);
+        }
+   }
+}
+
+/// @brief initialise the cache
+/// @param[in] budget memory budget in bytes
+/// @param[in] dir directory to keep convolution functions between runs (empty string means none)
+ConvFuncCache::ConvFuncCache(size_t budget, const std::string &dir) :
+   itsBudget(budget), itsMemoryUsed(0), itsDir(dir), itsHits(0), itsDiskHits(0), itsMisses(0),
+   itsEvictions(0) {}
+
+/// @brief destructor
+ConvFuncCache::~ConvFuncCache()
+{
+   if (itsHits + itsDiskHits + itsMisses > 0) {
+       ASKAPLOG_DEBUG_STR(logger, "Convolution function cache: "<<itsHits<<" hits in memory, "<<itsDiskHits<<
+                          " hits on disk, "<<itsMisses<<" misses, "<<itsEvictions<<" entries dropped, "<<
+                          itsEntries.size()<<" entries ("<<float(itsMemoryUsed)/1024/1024<<" Mb) in memory");
+   }
+}
+
+/// @brief obtain the process-wide cache
+/// @details The cache is created on the first call. Parameters of subsequent calls
+/// are ignored (a warning is given if they differ).
+/// @param[in] budget memory budget in bytes
+/// @param[in] dir directory to keep convolution functions between runs (empty string means none)
+/// @return shared pointer to the cache
+ConvFuncCache::ShPtr ConvFuncCache::processCache(size_t budget, const std::string &dir)
+{
+   boost::lock_guard<boost::mutex> lock(theProcessCacheMutex);
+   if (!theProcessCache) {
+       theProcessCache.reset(new ConvFuncCache(budget, dir));
+   } else if ((theProcessCache->itsBudget != budget) || (theProcessCache->itsDir != dir)) {
+       ASKAPLOG_WARN_STR(logger, "Convolution function cache has already been set up with budget = "<<
+                         float(theProcessCache->itsBudget)/1024/1024<<" Mb and directory '"<<
+                         theProcessCache->itsDir<<"', new parameters are ignored");
+   }
+   return theProcessCache;
+}
+
+/// @brief search for an entry
+/// @param[in] key fingerprint of the convolution function
+/// @return shared pointer to the entry, uninitialised if it is not in the cache
+boost::shared_ptr<const ConvFuncCacheEntry> ConvFuncCache::find(casa::uInt64 key)
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   const std::map<casa::uInt64, MemoryEntry>::iterator it = itsEntries.find(key);
+   if (it != itsEntries.end()) {
+       ++itsHits;
+       // move to the front of the usage list
+       itsUsage.splice(itsUsage.begin(), itsUsage, it->second.second);
+       return it->second.first;
+   }
+   if (itsDir != "") {
+       std::ifstream is(fileName(key).c_str(), std::ios::binary);
+       if (is) {
+           boost::shared_ptr<ConvFuncCacheEntry> entry(new ConvFuncCacheEntry);
+           entry->read(is);
+           if (is) {
+               ++itsDiskHits;
+               insert(key, entry);
+               return entry;
+           }
+           ASKAPLOG_WARN_STR(logger, "Unable to read convolution function from "<<fileName(key)<<
+                             ", it will be recomputed");
+       }
+   }
+   ++itsMisses;
+   return boost::shared_ptr<const ConvFuncCacheEntry>();
+}
+
+/// @brief add an entry to the cache
+/// @details Nothing is done if an entry with this key is already cached. The least
+/// recently used entries are dropped if the budget is exceeded.
+/// @param[in] key fingerprint of the convolution function
+/// @param[in] entry entry to add
+void ConvFuncCache::add(casa::uInt64 key, const boost::shared_ptr<const ConvFuncCacheEntry> &entry)
+{
+   ASKAPDEBUGASSERT(entry);
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   if (itsEntries.find(key) != itsEntries.end()) {
+       return;
+   }
+   insert(key, entry);
+   if (itsDir != "") {
+       // write to a temporary file first, so concurrent runs never see a partial file
+       const std::string name = fileName(key);
+       std::ostringstream os;
+       os<<name<<"."<<getpid();
+       std::ofstream ofs(os.str().c_str(), std::ios::binary);
+       entry->write(ofs);
+       ofs.close();
+       if (!ofs || (std::rename(os.str().c_str(), name.c_str()) != 0)) {
+           ASKAPLOG_WARN_STR(logger, "Unable to store convolution function in "<<name);
+           std::remove(os.str().c_str());
+       }
+   }
+}
+
+/// @brief number of searches satisfied from memory
+long ConvFuncCache::hits() const
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   return itsHits;
+}
+
+/// @brief number of searches satisfied from disk
+long ConvFuncCache::diskHits() const
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   return itsDiskHits;
+}
+
+/// @brief number of unsuccessful searches
+long ConvFuncCache::misses() const
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   return itsMisses;
+}
+
+/// @brief file name for the given key
+/// @param[in] key fingerprint of the convolution function
+/// @return full path to the file
+std::string ConvFuncCache::fileName(casa::uInt64 key) const
+{
+   std::ostringstream os;
+   os<<itsDir<<"/cf_"<<std::hex<<std::setw(16)<<std::setfill('0')<<key<<".dat";
+   return os.str();
+}
+
+/// @brief add an entry to memory and enforce the budget
+/// @details This method should be called with the mutex locked.
+/// @param[in] key fingerprint of the convolution function
+/// @param[in] entry entry to add
+void ConvFuncCache::insert(casa::uInt64 key, const boost::shared_ptr<const ConvFuncCacheEntry> &entry)
+{
+   itsUsage.push_front(key);
+   itsEntries[key] = MemoryEntry(entry, itsUsage.begin());
+   itsMemoryUsed += entry->memoryUsed();
+   // the entry just added is kept even if it alone exceeds the budget, gridders refer to it anyway
+   while ((itsMemoryUsed > itsBudget) && (itsUsage.size() > 1)) {
+       const casa::uInt64 oldest = itsUsage.back();
+       const std::map<casa::uInt64, MemoryEntry>::iterator it = itsEntries.find(oldest);
+       ASKAPDEBUGASSERT(it != itsEntries.end());
+       itsMemoryUsed -= it->second.first->memoryUsed();
+       itsEntries.erase(it);
+       itsUsage.pop_back();
+       ++itsEvictions;
+   }
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,189 @@
+/// @file 
+/// @brief Cache of convolution functions shared between gridders
+/// @details Convolution functions of the w-projection family of gridders depend only on
+/// the gridder parameters, the grid geometry and, for A-projection, the frequency, the
+/// pointing offset and the parallactic angle. The image, PSF and preconditioner gridders
+/// (and their clones for every Taylor term) would otherwise compute identical stacks of
+/// convolution functions. This class holds the oversampled planes of individual w-planes
+/// indexed by a fingerprint of everything they depend on. The least recently used entries
+/// are dropped when the memory budget is exceeded. Entries can also be stored on disk and
+/// picked up by subsequent runs.
+///
+/// @copyright (c) 2018 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef CONV_FUNC_CACHE_H
+#define CONV_FUNC_CACHE_H
+
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+#include <vector>
+#include <map>
+#include <list>
+#include <string>
+#include <iosfwd>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief convolution functions of a single w-plane
+/// @details All oversampled planes of one w-plane (and feed, field and channel for
+/// A-projection) are stored together with the support parameters they were cut with.
+/// @ingroup gridding
+struct ConvFuncCacheEntry {
+   /// @brief default constructor, makes an empty entry
+   ConvFuncCacheEntry();
+
+   /// @brief approximate number of bytes used by this entry
+   size_t memoryUsed() const;
+
+   /// @brief write the entry into a binary stream
+   /// @param[in] os output stream
+   void write(std::ostream &os) const;
+
+   /// @brief read the entry from a binary stream
+   /// @param[in] is input stream
+   void read(std::istream &is);
+
+   /// @brief support size determined for this plane
+   int itsSupport;
+
+   /// @brief offset of the support in u
+   int itsOffsetU;
+
+   /// @brief offset of the support in v
+   int itsOffsetV;
+
+   /// @brief oversampled planes (fracu + overSample * fracv)
+   std::vector<casa::Matrix<casa::Complex> > itsPlanes;
+};
+
+/// @brief Memory-budgeted cache of convolution functions
+/// @details Entries are indexed by a 64-bit fingerprint (see GriddingPlanCache::hash). Gridders
+/// reference the cached matrices rather than copying them, so the cached planes must never be
+/// modified in place. An entry dropped from the cache stays alive while any gridder still refers
+/// to it, so the budget limits what is kept for future use rather than the total memory used.
+/// If a directory is given, every new entry is also written to it and entries missing from memory
+/// are looked up there first. The files are kept, so a directory shared between runs with the
+/// same setup avoids generation of convolution functions altogether. All methods are thread-safe.
+/// @ingroup gridding
+class ConvFuncCache : private boost::noncopyable {
+public:
+   /// @brief shared pointer type
+   typedef boost::shared_ptr<ConvFuncCache> ShPtr;
+
+   /// @brief initialise the cache
+   /// @param[in] budget memory budget in bytes
+   /// @param[in] dir directory to keep convolution functions between runs (empty string means none)
+   explicit ConvFuncCache(size_t budget, const std::string &dir = "");
+
+   /// @brief destructor
+   ~ConvFuncCache();
+
+   /// @brief obtain the process-wide cache
+   /// @details The cache is created on the first call. Parameters of subsequent calls
+   /// are ignored (a warning is given if they differ).
+   /// @param[in] budget memory budget in bytes
+   /// @param[in] dir directory to keep convolution functions between runs (empty string means none)
+   /// @return shared pointer to the cache
+   static ShPtr processCache(size_t budget, const std::string &dir = "");
+
+   /// @brief search for an entry
+   /// @param[in] key fingerprint of the convolution function
+   /// @return shared pointer to the entry, uninitialised if it is not in the cache
+   boost::shared_ptr<const ConvFuncCacheEntry> find(casa::uInt64 key);
+
+   /// @brief add an entry to the cache
+   /// @details Nothing is done if an entry with this key is already cached. The least
+   /// recently used entries are dropped if the budget is exceeded.
+   /// @param[in] key fingerprint of the convolution function
+   /// @param[in] entry entry to add
+   void add(casa::uInt64 key, const boost::shared_ptr<const ConvFuncCacheEntry> &entry);
+
+   /// @brief number of searches satisfied from memory
+   long hits() const;
+
+   /// @brief number of searches satisfied from disk
+   long diskHits() const;
+
+   /// @brief number of unsuccessful searches
+   long misses() const;
+
+private:
+   /// @brief entry held in memory and its position in the usage list
+   typedef std::pair<boost::shared_ptr<const ConvFuncCacheEntry>, std::list<casa::uInt64>::iterator> MemoryEntry;
+
+   /// @brief file name for the given key
+   /// @param[in] key fingerprint of the convolution function
+   /// @return full path to the file
+   std::string fileName(casa::uInt64 key) const;
+
+   /// @brief add an entry to memory and enforce the budget
+   /// @details This method should be called with the mutex locked.
+   /// @param[in] key fingerprint of the convolution function
+   /// @param[in] entry entry to add
+   void insert(casa::uInt64 key, const boost::shared_ptr<const ConvFuncCacheEntry> &entry);
+
+   /// @brief entries held in memory
+   std::map<casa::uInt64, MemoryEntry> itsEntries;
+
+   /// @brief keys ordered by the last use, most recent first
+   std::list<casa::uInt64> itsUsage;
+
+   /// @brief memory budget in bytes
+   size_t itsBudget;
+
+   /// @brief memory used by entries held in memory
+   size_t itsMemoryUsed;
+
+   /// @brief directory to keep convolution functions between runs (empty string means none)
+   std::string itsDir;
+
+   /// @brief number of searches satisfied from memory
+   long itsHits;
+
+   /// @brief number of searches satisfied from disk
+   long itsDiskHits;
+
+   /// @brief number of unsuccessful searches
+   long itsMisses;
+
+   /// @brief number of entries dropped due to the budget
+   long itsEvictions;
+
+   /// @brief synchronisation mutex
+   mutable boost::mutex itsMutex;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef CONV_FUNC_CACHE_H
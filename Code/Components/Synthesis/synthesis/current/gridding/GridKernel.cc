@@ -38,21 +38,303 @@
 #endif
 #endif
 
+#include <cstdlib>
+#include <cstring>
+
+#include <askap/AskapError.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(ASKAP_GRID_NO_SIMD)
+#define ASKAP_GRID_WITH_SIMD 1
+#include <immintrin.h>
+#endif
+
 namespace askap {
 namespace synthesis {
 
+namespace {
+
+/// @brief scalar kernel gridding one row of the support
+/// @param[in] grid pointer to the first grid element of the row
+/// @param[in] cf pointer to the first convolution function element of the row
+/// @param[in] cVis visibility
+/// @param[in] n number of elements in the row
+void gridRowScalar(casa::Complex *grid, const casa::Complex *cf,
+                   const casa::Complex &cVis, const int n)
+{
+   for (int i = 0; i < n; ++i) {
+        grid[i] += cVis * cf[i];
+   }
+}
+
+/// @brief scalar kernel degridding one row of the support
+/// @param[in] cf pointer to the first convolution function element of the row
+/// @param[in] grid pointer to the first grid element of the row
+/// @param[in] n number of elements in the row
+/// @return sum of cf * conj(grid) over the row
+casa::Complex degridRowScalar(const casa::Complex *cf, const casa::Complex *grid, const int n)
+{
+   casa::Complex sum(0.,0.);
+   for (int i = 0; i < n; ++i) {
+        sum += cf[i] * conj(grid[i]);
+   }
+   return sum;
+}
+
+#ifdef ASKAP_GRID_WITH_SIMD
+
+// casa::Complex is std::complex<float>, i.e. interleaved (re,im) pairs of floats.
+// Complex products are done as fmaddsub(cf, re(vis), swap(cf) * im(vis)).
+
+/// @brief AVX2 kernel gridding one row of the support
+__attribute__((target("avx2,fma")))
+void gridRowAVX2(casa::Complex *grid, const casa::Complex *cf,
+                 const casa::Complex &cVis, const int n)
+{
+   const __m256 visRe = _mm256_set1_ps(casa::real(cVis));
+   const __m256 visIm = _mm256_set1_ps(casa::imag(cVis));
+   float *gPtr = reinterpret_cast<float*>(grid);
+   const float *cfPtr = reinterpret_cast<const float*>(cf);
+   int i = 0;
+   for (; i + 4 <= n; i += 4, gPtr += 8, cfPtr += 8) {
+        const __m256 w = _mm256_loadu_ps(cfPtr);
+        const __m256 wSwapped = _mm256_permute_ps(w, 0xB1);
+        const __m256 prod = _mm256_fmaddsub_ps(w, visRe, _mm256_mul_ps(wSwapped, visIm));
+        _mm256_storeu_ps(gPtr, _mm256_add_ps(_mm256_loadu_ps(gPtr), prod));
+   }
+   gridRowScalar(grid + i, cf + i, cVis, n - i);
+}
+
+/// @brief AVX2 kernel degridding one row of the support
+__attribute__((target("avx2,fma")))
+casa::Complex degridRowAVX2(const casa::Complex *cf, const casa::Complex *grid, const int n)
+{
+   // re(cf*conj(g)) = sum of cf*g over (re,im) pairs,
+   // im(cf*conj(g)) = difference of swap(cf)*g over (re,im) pairs
+   __m256 accRe = _mm256_setzero_ps();
+   __m256 accIm = _mm256_setzero_ps();
+   const float *gPtr = reinterpret_cast<const float*>(grid);
+   const float *cfPtr = reinterpret_cast<const float*>(cf);
+   int i = 0;
+   for (; i + 4 <= n; i += 4, gPtr += 8, cfPtr += 8) {
+        const __m256 w = _mm256_loadu_ps(cfPtr);
+        const __m256 g = _mm256_loadu_ps(gPtr);
+        accRe = _mm256_fmadd_ps(w, g, accRe);
+        accIm = _mm256_fmadd_ps(_mm256_permute_ps(w, 0xB1), g, accIm);
+   }
+   float bufRe[8], bufIm[8];
+   _mm256_storeu_ps(bufRe, accRe);
+   _mm256_storeu_ps(bufIm, accIm);
+   float sumRe = 0., sumIm = 0.;
+   for (int k = 0; k < 8; k += 2) {
+        sumRe += bufRe[k] + bufRe[k + 1];
+        sumIm += bufIm[k] - bufIm[k + 1];
+   }
+   return casa::Complex(sumRe, sumIm) + degridRowScalar(cf + i, grid + i, n - i);
+}
+
+/// @brief AVX-512 kernel gridding one row of the support
+__attribute__((target("avx512f")))
+void gridRowAVX512(casa::Complex *grid, const casa::Complex *cf,
+                   const casa::Complex &cVis, const int n)
+{
+   const __m512 visRe = _mm512_set1_ps(casa::real(cVis));
+   const __m512 visIm = _mm512_set1_ps(casa::imag(cVis));
+   float *gPtr = reinterpret_cast<float*>(grid);
+   const float *cfPtr = reinterpret_cast<const float*>(cf);
+   int i = 0;
+   for (; i + 8 <= n; i += 8, gPtr += 16, cfPtr += 16) {
+        const __m512 w = _mm512_loadu_ps(cfPtr);
+        const __m512 wSwapped = _mm512_shuffle_ps(w, w, 0xB1);
+        const __m512 prod = _mm512_fmaddsub_ps(w, visRe, _mm512_mul_ps(wSwapped, visIm));
+        _mm512_storeu_ps(gPtr, _mm512_add_ps(_mm512_loadu_ps(gPtr), prod));
+   }
+   gridRowScalar(grid + i, cf + i, cVis, n - i);
+}
+
+/// @brief AVX-512 kernel degridding one row of the support
+__attribute__((target("avx512f")))
+casa::Complex degridRowAVX512(const casa::Complex *cf, const casa::Complex *grid, const int n)
+{
+   __m512 accRe = _mm512_setzero_ps();
+   __m512 accIm = _mm512_setzero_ps();
+   const float *gPtr = reinterpret_cast<const float*>(grid);
+   const float *cfPtr = reinterpret_cast<const float*>(cf);
+   int i = 0;
+   for (; i + 8 <= n; i += 8, gPtr += 16, cfPtr += 16) {
+        const __m512 w = _mm512_loadu_ps(cfPtr);
+        const __m512 g = _mm512_loadu_ps(gPtr);
+        accRe = _mm512_fmadd_ps(w, g, accRe);
+        accIm = _mm512_fmadd_ps(_mm512_shuffle_ps(w, w, 0xB1), g, accIm);
+   }
+   float bufRe[16], bufIm[16];
+   _mm512_storeu_ps(bufRe, accRe);
+   _mm512_storeu_ps(bufIm, accIm);
+   float sumRe = 0., sumIm = 0.;
+   for (int k = 0; k < 16; k += 2) {
+        sumRe += bufRe[k] + bufRe[k + 1];
+        sumIm += bufIm[k] - bufIm[k + 1];
+   }
+   return casa::Complex(sumRe, sumIm) + degridRowScalar(cf + i, grid + i, n - i);
+}
+
+#endif // ASKAP_GRID_WITH_SIMD
+
+/// @brief type of the row gridding kernel
+typedef void (*GridRowFunc)(casa::Complex *, const casa::Complex *, const casa::Complex &, const int);
+
+/// @brief type of the row degridding kernel
+typedef casa::Complex (*DegridRowFunc)(const casa::Complex *, const casa::Complex *, const int);
+
+/// @brief check whether the CPU supports the given instruction set
+/// @param[in] isa instruction set
+/// @return true if the raw kernels can use this instruction set
+bool isSupported(const GridKernel::ISA isa)
+{
+#ifdef ASKAP_GRID_WITH_SIMD
+   __builtin_cpu_init();
+   if (isa == GridKernel::AVX512) {
+       return __builtin_cpu_supports("avx512f");
+   }
+   if (isa == GridKernel::AVX2) {
+       return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+   }
+#endif
+   return isa == GridKernel::SCALAR;
+}
+
+/// @brief default instruction set for the raw kernels
+/// @return the best instruction set supported by the CPU unless overridden
+/// by ASKAP_GRIDKERNEL_ISA environment variable
+GridKernel::ISA defaultISA()
+{
+   const char *request = std::getenv("ASKAP_GRIDKERNEL_ISA");
+   if (request != NULL) {
+       if (std::strcmp(request, "scalar") == 0) {
+           return GridKernel::SCALAR;
+       }
+       if ((std::strcmp(request, "avx2") == 0) && isSupported(GridKernel::AVX2)) {
+           return GridKernel::AVX2;
+       }
+       if ((std::strcmp(request, "avx512") == 0) && isSupported(GridKernel::AVX512)) {
+           return GridKernel::AVX512;
+       }
+   }
+   if (isSupported(GridKernel::AVX512)) {
+       return GridKernel::AVX512;
+   }
+   if (isSupported(GridKernel::AVX2)) {
+       return GridKernel::AVX2;
+   }
+   return GridKernel::SCALAR;
+}
+
+/// @brief row gridding kernel for the given instruction set
+/// @param[in] isa instruction set
+/// @return pointer to the kernel
+GridRowFunc gridRowFor(const GridKernel::ISA isa)
+{
+#ifdef ASKAP_GRID_WITH_SIMD
+   if (isa == GridKernel::AVX512) {
+       return gridRowAVX512;
+   }
+   if (isa == GridKernel::AVX2) {
+       return gridRowAVX2;
+   }
+#endif
+   return gridRowScalar;
+}
+
+/// @brief row degridding kernel for the given instruction set
+/// @param[in] isa instruction set
+/// @return pointer to the kernel
+DegridRowFunc degridRowFor(const GridKernel::ISA isa)
+{
+#ifdef ASKAP_GRID_WITH_SIMD
+   if (isa == GridKernel::AVX512) {
+       return degridRowAVX512;
+   }
+   if (isa == GridKernel::AVX2) {
+       return degridRowAVX2;
+   }
+#endif
+   return degridRowScalar;
+}
+
+/// @brief instruction set used by the raw kernels, selected at load time
+GridKernel::ISA theISA = defaultISA();
+
+/// @brief row gridding kernel corresponding to theISA
+GridRowFunc theGridRow = gridRowFor(theISA);
+
+/// @brief row degridding kernel corresponding to theISA
+DegridRowFunc theDegridRow = degridRowFor(theISA);
+
+} // anonymous namespace
+
+GridKernel::ISA GridKernel::isa() {
+   return theISA;
+}
+
+bool GridKernel::supports(const ISA isa) {
+   return isSupported(isa);
+}
+
+void GridKernel::selectISA(const ISA isa) {
+   ASKAPCHECK(isSupported(isa), "Instruction set "<<int(isa)<<" is not supported by this CPU");
+   theISA = isa;
+   theGridRow = gridRowFor(isa);
+   theDegridRow = degridRowFor(isa);
+}
+
 std::string GridKernel::info() {
+   std::string isaName("scalar");
+   if (theISA == AVX512) {
+       isaName = "AVX-512";
+   } else if (theISA == AVX2) {
+       isaName = "AVX2+FMA";
+   }
 #ifdef ASKAP_GRID_WITH_BLAS
-	return std::string("Gridding with BLAS");
+	return std::string("Gridding with BLAS, raw kernels use ") + isaName;
 #else 
 #ifdef ASKAP_GRID_WITH_POINTERS
-	return std::string("Gridding with casa::Matrix pointers");
+	return std::string("Gridding with casa::Matrix pointers, raw kernels use ") + isaName;
 #else
-	return std::string("Standard gridding/degridding with casa::Matrix");
+	return std::string("Standard gridding/degridding with casa::Matrix, raw kernels use ") + isaName;
 #endif
 #endif
 }
 
+/// Gridding into raw storage, no bounds checking
+void GridKernel::grid(casa::Complex *grid, const int gridStride,
+		const casa::Complex *convFunc, const int cfStride,
+		const casa::Complex& cVis, const int iu, const int iv, const int support) {
+	const GridRowFunc gridRow = theGridRow;
+	const casa::Complex *wtPtr = convFunc;
+	casa::Complex *gridPtr = grid + (iu - support) + (iv - support) * gridStride;
+	for (int suppv = -support; suppv < +support; suppv++) {
+		gridRow(gridPtr, wtPtr, cVis, 2 * support);
+		wtPtr += cfStride;
+		gridPtr += gridStride;
+	}
+}
+
+/// Degridding from raw storage, no bounds checking
+void GridKernel::degrid(casa::Complex& cVis,
+		const casa::Complex *convFunc, const int cfStride,
+		const casa::Complex *grid, const int gridStride,
+		const int iu, const int iv, const int support) {
+	const DegridRowFunc degridRow = theDegridRow;
+	cVis = 0.0;
+	const casa::Complex *wtPtr = convFunc;
+	const casa::Complex *gridPtr = grid + (iu - support) + (iv - support) * gridStride;
+	for (int suppv = -support; suppv < +support; suppv++) {
+		cVis += degridRow(wtPtr, gridPtr, 2 * support);
+		wtPtr += cfStride;
+		gridPtr += gridStride;
+	}
+}
+
+
 /// Totally selfcontained gridding
 void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
 		casa::Matrix<casa::Complex>& convFunc, const casa::Complex& cVis,
@@ -67,11 +349,7 @@ void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
 #ifdef ASKAP_GRID_WITH_BLAS
 		cblas_caxpy(2*support+1, &cVis, wtPtr, 1, gridPtr, 1);
 #else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			(*gridPtr) += cVis * (*wtPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
+		theGridRow(gridPtr, wtPtr, cVis, 2 * support);
 #endif
 	}
 #else
@@ -107,11 +385,7 @@ void GridKernel::degrid(casa::Complex& cVis,
 		cblas_cdotc_sub(2*support+1, gridPtr, 1, wtPtr, 1, &dot);
 		cVis+=dot;
 #else
-		for (int suppu = -support; suppu < +support; suppu++) {
-			cVis += (*wtPtr) * conj(*gridPtr);
-			wtPtr += 1;
-			gridPtr++;
-		}
+		cVis += theDegridRow(wtPtr, gridPtr, 2 * support);
 #endif
 	}
 #else
@@ -40,13 +40,46 @@
 namespace askap {
     namespace synthesis {
         /// @brief Holder for gridding kernels
+        /// @details Two flavours of kernels are provided. The first one works
+        /// with casa::Matrix objects and is kept for compatibility. The second one
+        /// works with raw pointers to contiguous column-major storage (u varies fastest)
+        /// and does no bounds checking. The inner loop over u of the raw kernels is
+        /// dispatched at run time to the best implementation supported by the CPU
+        /// (AVX-512, AVX2+FMA or plain scalar code).
         ///
         /// @ingroup gridding
         class GridKernel {
             public:
+                /// @brief instruction set used by the raw kernels
+                enum ISA {
+                   SCALAR = 0,
+                   AVX2,
+                   AVX512
+                };
+
                 /// Information about gridding options
                 static std::string info();
 
+                /// @brief instruction set selected for the raw kernels
+                /// @details The selection is done once, when the library is loaded.
+                /// It can be overridden by setting ASKAP_GRIDKERNEL_ISA environment variable
+                /// to "scalar", "avx2" or "avx512" (the latter two are ignored if not
+                /// supported by the CPU).
+                /// @return instruction set used by the raw kernels
+                static ISA isa();
+
+                /// @brief check whether the CPU supports the given instruction set
+                /// @param[in] isa instruction set
+                /// @return true if the raw kernels can use this instruction set
+                static bool supports(const ISA isa);
+
+                /// @brief select the instruction set for the raw kernels
+                /// @details This overrides the selection done at load time and is mainly
+                /// intended for testing. It is not thread-safe and should not be called
+                /// while any gridding is in progress.
+                /// @param[in] isa instruction set, an exception is thrown if it is not supported
+                static void selectISA(const ISA isa);
+
                 /// Gridding kernel
                 static void grid(casa::Matrix<casa::Complex>& grid,
                         casa::Matrix<casa::Complex>& convFunc,
@@ -60,6 +93,39 @@ namespace askap {
                         const int iu, const int iv,
                         const int support);
 
+                /// @brief gridding kernel working with raw storage
+                /// @details No bounds checking is done, the caller is responsible
+                /// to ensure that the whole support fits on the grid.
+                /// @param[in] grid pointer to the first element of the 2D grid plane
+                /// @param[in] gridStride number of elements between adjacent v-rows of the grid
+                /// @param[in] convFunc pointer to the first element of the convolution function
+                /// @param[in] cfStride number of elements between adjacent v-rows of the convolution function
+                /// @param[in] cVis visibility to grid
+                /// @param[in] iu u-pixel of the centre of the support
+                /// @param[in] iv v-pixel of the centre of the support
+                /// @param[in] support support size
+                static void grid(casa::Complex *grid, const int gridStride,
+                        const casa::Complex *convFunc, const int cfStride,
+                        const casa::Complex& cVis, const int iu,
+                        const int iv, const int support);
+
+                /// @brief degridding kernel working with raw storage
+                /// @details No bounds checking is done, the caller is responsible
+                /// to ensure that the whole support fits on the grid.
+                /// @param[out] cVis degridded visibility
+                /// @param[in] convFunc pointer to the first element of the convolution function
+                /// @param[in] cfStride number of elements between adjacent v-rows of the convolution function
+                /// @param[in] grid pointer to the first element of the 2D grid plane
+                /// @param[in] gridStride number of elements between adjacent v-rows of the grid
+                /// @param[in] iu u-pixel of the centre of the support
+                /// @param[in] iv v-pixel of the centre of the support
+                /// @param[in] support support size
+                static void degrid(casa::Complex& cVis,
+                        const casa::Complex *convFunc, const int cfStride,
+                        const casa::Complex *grid, const int gridStride,
+                        const int iu, const int iv,
+                        const int support);
+
         };
     }
 }
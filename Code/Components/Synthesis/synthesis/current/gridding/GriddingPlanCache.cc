@@ -0,0 +1,253 @@
+/// @file 
+/// @brief Cache of gridding plans reused between major cycles
+/// @details A gridding plan is a per-accessor list of visibility samples which survived
+/// flagging and data selection, together with everything TableVisGridder::generic derives
+/// from the metadata to grid them (grid offsets, convolution function and grid plane indices
+/// and the delay phasor). This metadata does not change between major cycles, so the plan
+/// can be computed on the first pass and replayed on subsequent gridding and degridding passes.
+/// This class holds such plans indexed by a fingerprint of the accessor, keeps them in memory
+/// up to a given budget and optionally spills the rest to disk.
+///
+/// @copyright (c) 2018 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/GriddingPlanCache.h>
+#include <askap_synthesis.h>
+#include <askap/AskapLogging.h>
+ASKAP_LOGGER(logger, ".gridding.griddingplancache");
+
+#include <askap/AskapError.h>
+
+#include <boost/thread/locks.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <unistd.h>
+
+namespace askap {
+
+namespace synthesis {
+
+namespace {
+
+/// @brief write a vector into a binary stream
+/// @param[in] os output stream
+/// @param[in] vec vector to write
+template<typename T>
+void writeVector(std::ostream &os, const std::vector<T> &vec)
+{
+   const casa::uInt64 size = vec.size();
+   os.write(reinterpret_cast<const char*>(&size), sizeof(size));
+   if (size > 0) {
+       os.write(reinterpret_cast<const char*>(&vec[0]), sizeof(T) * size);
+   }
+}
+
+/// @brief read a vector from a binary stream
+/// @param[in] is input stream
+/// @param[out] vec vector to fill (resized as necessary)
+template<typename T>
+void readVector(std::istream &is, std::vector<T> &vec)
+{
+   casa::uInt64 size = 0;
+   is.read(reinterpret_cast<char*>(&size), sizeof(size));
+   vec.resize(size);
+   if (size > 0) {
+       is.read(reinterpret_cast<char*>(&vec[0]), sizeof(T) * size);
+   }
+}
+
+} // anonymous namespace
+
+/// @brief default constructor, makes an empty plan
+GriddingPlan::GriddingPlan() : itsFirstRow(-1), itsRowsRejected(0), itsVectorsFlagged(0) {}
+
+/// @brief empty the plan keeping allocated memory
+void GriddingPlan::clear()
+{
+   itsFirstRow = -1;
+   itsRowsRejected = 0;
+   itsVectorsFlagged = 0;
+   itsSample.clear();
+   itsIU.clear();
+   itsIV.clear();
+   itsFrac.clear();
+}
+
+/// @brief reserve memory for the given number of entries
+/// @param[in] nEntries number of entries
+void GriddingPlan::reserve(size_t nEntries)
+{
+   itsSample.reserve(nEntries);
+   itsIU.reserve(nEntries);
+   itsIV.reserve(nEntries);
+   itsFrac.reserve(nEntries);
+}
+
+/// @brief approximate number of bytes used by this plan
+size_t GriddingPlan::memoryUsed() const
+{
+   return sizeof(GriddingPlan) + itsSample.capacity() * sizeof(casa::uInt) +
+          (itsIU.capacity() + itsIV.capacity() + itsFrac.capacity()) * sizeof(int);
+}
+
+/// @brief write the plan into a binary stream
+/// @param[in] os output stream
+void GriddingPlan::write(std::ostream &os) const
+{
+   os.write(reinterpret_cast<const char*>(&itsFirstRow), sizeof(itsFirstRow));
+   os.write(reinterpret_cast<const char*>(&itsRowsRejected), sizeof(itsRowsRejected));
+   os.write(reinterpret_cast<const char*>(&itsVectorsFlagged), sizeof(itsVectorsFlagged));
+   writeVector(os, itsSample);
+   writeVector(os, itsIU);
+   writeVector(os, itsIV);
+   writeVector(os, itsFrac);
+}
+
+/// @brief read the plan from a binary stream
+/// @param[in] is input stream
+void GriddingPlan::read(std::istream &is)
+{
+   is.read(reinterpret_cast<char*>(&itsFirstRow), sizeof(itsFirstRow));
+   is.read(reinterpret_cast<char*>(&itsRowsRejected), sizeof(itsRowsRejected));
+   is.read(reinterpret_cast<char*>(&itsVectorsFlagged), sizeof(itsVectorsFlagged));
+   readVector(is, itsSample);
+   readVector(is, itsIU);
+   readVector(is, itsIV);
+   readVector(is, itsFrac);
+}
+
+/// @brief initialise the cache
+/// @param[in] budget memory budget in bytes
+/// @param[in] spillDir directory to spill plans exceeding the budget to (empty string means no spilling)
+GriddingPlanCache::GriddingPlanCache(size_t budget, const std::string &spillDir) :
+   itsBudget(budget), itsMemoryUsed(0), itsSpillDir(spillDir), itsHits(0), itsMisses(0) {}
+
+/// @brief destructor, removes spilled files
+GriddingPlanCache::~GriddingPlanCache()
+{
+   if (itsHits + itsMisses > 0) {
+       ASKAPLOG_DEBUG_STR(logger, "Gridding plan cache: "<<itsHits<<" hits, "<<itsMisses<<" misses, "<<
+                          itsPlans.size()<<" plans ("<<float(itsMemoryUsed)/1024/1024<<" Mb) in memory, "<<
+                          itsSpilledPlans.size()<<" plans spilled to disk");
+   }
+   for (std::map<casa::uInt64, std::string>::const_iterator ci = itsSpilledPlans.begin();
+        ci != itsSpilledPlans.end(); ++ci) {
+        std::remove(ci->second.c_str());
+   }
+}
+
+/// @brief search for a plan
+/// @param[in] key fingerprint of the accessor
+/// @return shared pointer to the plan, uninitialised if the plan is not in the cache
+boost::shared_ptr<const GriddingPlan> GriddingPlanCache::find(casa::uInt64 key)
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   const std::map<casa::uInt64, boost::shared_ptr<const GriddingPlan> >::const_iterator ci = itsPlans.find(key);
+   if (ci != itsPlans.end()) {
+       ++itsHits;
+       return ci->second;
+   }
+   const std::map<casa::uInt64, std::string>::const_iterator spilledIt = itsSpilledPlans.find(key);
+   if (spilledIt != itsSpilledPlans.end()) {
+       std::ifstream is(spilledIt->second.c_str(), std::ios::binary);
+       if (is) {
+           boost::shared_ptr<GriddingPlan> plan(new GriddingPlan);
+           plan->read(is);
+           if (is) {
+               ++itsHits;
+               return plan;
+           }
+       }
+       ASKAPLOG_WARN_STR(logger, "Unable to read spilled gridding plan from "<<spilledIt->second<<
+                         ", it will be recomputed");
+   }
+   ++itsMisses;
+   return boost::shared_ptr<const GriddingPlan>();
+}
+
+/// @brief add a plan to the cache
+/// @param[in] key fingerprint of the accessor
+/// @param[in] plan plan to add
+void GriddingPlanCache::add(casa::uInt64 key, const boost::shared_ptr<const GriddingPlan> &plan)
+{
+   ASKAPDEBUGASSERT(plan);
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   if ((itsPlans.find(key) != itsPlans.end()) || (itsSpilledPlans.find(key) != itsSpilledPlans.end())) {
+       return;
+   }
+   const size_t planSize = plan->memoryUsed();
+   if (itsMemoryUsed + planSize <= itsBudget) {
+       itsPlans[key] = plan;
+       itsMemoryUsed += planSize;
+       return;
+   }
+   if (itsSpillDir != "") {
+       std::ostringstream os;
+       os<<itsSpillDir<<"/gridplan_"<<getpid()<<"_"<<this<<"_"<<std::hex<<key<<".dat";
+       std::ofstream ofs(os.str().c_str(), std::ios::binary);
+       plan->write(ofs);
+       if (ofs) {
+           itsSpilledPlans[key] = os.str();
+       } else {
+           ASKAPLOG_WARN_STR(logger, "Unable to spill gridding plan to "<<os.str());
+           ofs.close();
+           std::remove(os.str().c_str());
+       }
+   }
+}
+
+/// @brief number of successful searches
+long GriddingPlanCache::hits() const
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   return itsHits;
+}
+
+/// @brief number of unsuccessful searches
+long GriddingPlanCache::misses() const
+{
+   boost::lock_guard<boost::mutex> lock(itsMutex);
+   return itsMisses;
+}
+
+/// @brief update a fingerprint with an arbitrary block of memory
+/// @param[in] hash current value of the fingerprint
+/// @param[in] data pointer to the data
+/// @param[in] nBytes number of bytes
+/// @return updated value of the fingerprint
+casa::uInt64 GriddingPlanCache::hash(casa::uInt64 hash, const void *data, size_t nBytes)
+{
+   const unsigned char *ptr = static_cast<const unsigned char*>(data);
+   for (size_t i = 0; i < nBytes; ++i) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,187 @@
+/// @file 
+/// @brief Cache of gridding plans reused between major cycles
+/// @details A gridding plan is a per-accessor list of visibility samples which survived
+/// flagging and data selection, together with everything TableVisGridder::generic derives
+/// from the metadata to grid them (grid offsets, convolution function and grid plane indices
+/// and the delay phasor). This metadata does not change between major cycles, so the plan
+/// can be computed on the first pass and replayed on subsequent gridding and degridding passes.
+/// This class holds such plans indexed by a fingerprint of the accessor, keeps them in memory
+/// up to a given budget and optionally spills the rest to disk.
+///
+/// @copyright (c) 2018 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef GRIDDING_PLAN_CACHE_H
+#define GRIDDING_PLAN_CACHE_H
+
+#include <casacore/casa/aips.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/utility.hpp>
+
+#include <vector>
+#include <map>
+#include <string>
+#include <iosfwd>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief gridding plan for one accessor
+/// @details Each entry corresponds to an unflagged (row, channel) pair mapped to the image cube.
+/// Only the quantities which are expensive to derive are stored. Grid and convolution function
+/// indices, image channels and delay phasors are cheap to look up or compute from the accessor
+/// and the current gridder state, so the plan does not depend on the convolution functions.
+/// @ingroup gridding
+struct GriddingPlan {
+   /// @brief default constructor, makes an empty plan
+   GriddingPlan();
+
+   /// @brief number of entries
+   inline size_t size() const { return itsSample.size(); }
+
+   /// @brief empty the plan keeping allocated memory
+   void clear();
+
+   /// @brief reserve memory for the given number of entries
+   /// @param[in] nEntries number of entries
+   void reserve(size_t nEntries);
+
+   /// @brief approximate number of bytes used by this plan
+   size_t memoryUsed() const;
+
+   /// @brief write the plan into a binary stream
+   /// @param[in] os output stream
+   void write(std::ostream &os) const;
+
+   /// @brief read the plan from a binary stream
+   /// @param[in] is input stream
+   void read(std::istream &is);
+
+   /// @brief first accessor row which has not been rejected (negative if none)
+   /// @details It is used to find the representative feed and field for the PSF
+   int itsFirstRow;
+
+   /// @brief number of rows rejected due to the largest pointing separation
+   long itsRowsRejected;
+
+   /// @brief number of flagged visibility vectors
+   long itsVectorsFlagged;
+
+   /// @brief accessor sample for each entry (row * nChannel + channel)
+   std::vector<casa::uInt> itsSample;
+
+   /// @brief u-pixel of the sample for each entry (no convolution function offset applied)
+   std::vector<int> itsIU;
+
+   /// @brief v-pixel of the sample for each entry (no convolution function offset applied)
+   std::vector<int> itsIV;
+
+   /// @brief oversampling plane for each entry (fracu + overSample * fracv)
+   std::vector<int> itsFrac;
+};
+
+/// @brief Cache of gridding plans reused between major cycles
+/// @details Plans are indexed by a 64-bit fingerprint identifying the accessor (see
+/// TableVisGridder::planFingerprint).
+/// Plans are kept in memory until the memory budget is exhausted. After that, they are written
+/// to the spill directory (if given) and read back on demand, or not cached at all. Spilled files
+/// are removed when the cache is destroyed. The cache is intended to be shared between clones
+/// of the same gridder, all methods are thread-safe.
+/// @ingroup gridding
+class GriddingPlanCache : private boost::noncopyable {
+public:
+   /// @brief shared pointer type
+   typedef boost::shared_ptr<GriddingPlanCache> ShPtr;
+
+   /// @brief initialise the cache
+   /// @param[in] budget memory budget in bytes
+   /// @param[in] spillDir directory to spill plans exceeding the budget to (empty string means no spilling)
+   explicit GriddingPlanCache(size_t budget, const std::string &spillDir = "");
+
+   /// @brief destructor, removes spilled files
+   ~GriddingPlanCache();
+
+   /// @brief search for a plan
+   /// @param[in] key fingerprint of the accessor
+   /// @return shared pointer to the plan, uninitialised if the plan is not in the cache
+   boost::shared_ptr<const GriddingPlan> find(casa::uInt64 key);
+
+   /// @brief add a plan to the cache
+   /// @details Nothing is done if the plan with this key is already cached or if
+   /// it does not fit into the memory budget and spilling is not enabled.
+   /// @param[in] key fingerprint of the accessor
+   /// @param[in] plan plan to add
+   void add(casa::uInt64 key, const boost::shared_ptr<const GriddingPlan> &plan);
+
+   /// @brief number of successful searches
+   long hits() const;
+
+   /// @brief number of unsuccessful searches
+   long misses() const;
+
+   /// @brief update a fingerprint with an arbitrary block of memory
+   /// @details FNV-1a hash is used.
+   /// @param[in] hash current value of the fingerprint
+   /// @param[in] data pointer to the data
+   /// @param[in] nBytes number of bytes
+   /// @return updated value of the fingerprint
+   static casa::uInt64 hash(casa::uInt64 hash, const void *data, size_t nBytes);
+
+   /// @brief initial value of the fingerprint
+   static const casa::uInt64 theirInitialHash = 14695981039346656037ULL;
+
+private:
+   /// @brief plans held in memory
+   std::map<casa::uInt64, boost::shared_ptr<const GriddingPlan> > itsPlans;
+
+   /// @brief file names of the spilled plans
+   std::map<casa::uInt64, std::string> itsSpilledPlans;
+
+   /// @brief memory budget in bytes
+   size_t itsBudget;
+
+   /// @brief memory used by plans held in memory
+   size_t itsMemoryUsed;
+
+   /// @brief spill directory (empty string means no spilling)
+   std::string itsSpillDir;
+
+   /// @brief number of successful searches
+   long itsHits;
+
+   /// @brief number of unsuccessful searches
+   long itsMisses;
+
+   /// @brief synchronisation mutex
+   mutable boost::mutex itsMutex;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef GRIDDING_PLAN_CACHE_H
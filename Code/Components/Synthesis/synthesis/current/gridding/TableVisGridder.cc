@@ -59,6 +59,8 @@ using namespace askap;
 #include <ostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+#include <limits>
 
 #include <casacore/casa/OS/Timer.h>
 
@@ -94,7 +96,7 @@ TableVisGridder::TableVisGridder() : itsSumWeights(),
     itsTimeDegridded(0.0), itsDopsf(false), itsDopcf(false),
     itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false),
     itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-    itsTrackWeightPerOversamplePlane(false)
+    itsTrackWeightPerOversamplePlane(false), itsNumberOfThreads(1), itsAccessorIndex(0)
 {}
 
 TableVisGridder::TableVisGridder(const int overSample, const int support,
@@ -106,7 +108,7 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
     itsTimeDegridded(0.0), itsDopsf(false), itsDopcf(false),
     itsFirstGriddedVis(true), itsFeedUsedForPSF(0), itsUseAllDataForPSF(false),     
     itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
-    itsTrackWeightPerOversamplePlane(false)
+    itsTrackWeightPerOversamplePlane(false), itsNumberOfThreads(1), itsAccessorIndex(0)
 {
    ASKAPCHECK(overSample>0, "Oversampling must be greater than 0");
    ASKAPCHECK(support>0, "Maximum support must be greater than 0");
@@ -141,7 +143,9 @@ TableVisGridder::TableVisGridder(const TableVisGridder &other) :
      itsMaxPointingSeparation(other.itsMaxPointingSeparation),
      itsRowsRejectedDueToMaxPointingSeparation(other.itsRowsRejectedDueToMaxPointingSeparation),
      itsConvFuncOffsets(other.itsConvFuncOffsets), 
-     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane)
+     itsTrackWeightPerOversamplePlane(other.itsTrackWeightPerOversamplePlane),
+     itsNumberOfThreads(other.itsNumberOfThreads),
+     itsPlanCache(other.itsPlanCache), itsAccessorIndex(other.itsAccessorIndex)
 {
    deepCopyOfSTDVector(other.itsConvFunc,itsConvFunc);
    deepCopyOfSTDVector(other.itsGrid, itsGrid);   
@@ -434,6 +438,8 @@ void TableVisGridder::logCFCacheStats() const
 /// This is a generic grid/degrid
 void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    ASKAPDEBUGTRACE("TableVisGridder::generic");
+   // accessors skipped below still count to keep the position in the iteration
+   ++itsAccessorIndex;
    if (forward&&itsModelIsEmpty)
         return;
    
@@ -488,7 +494,6 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    
    const uint nSamples = acc.nRow();
    const uint nChan = acc.nChannel();
-   const uint nPol = acc.nPol();
    const casa::Vector<casa::Double>& frequencyList = acc.frequency();
    itsFreqMapper.setupMapping(frequencyList);
    
@@ -505,8 +510,10 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    #endif   
                   
    ASKAPDEBUGASSERT(itsShape.nelements()>=2);
-   const casa::IPosition onePlane4D(4, itsShape(0), itsShape(1), 1, 1);
-   const casa::IPosition onePlane(2, itsShape(0), itsShape(1));
+   // grid planes are accessed directly in the underlying storage, this is the number
+   // of elements in one plane and the number of polarisation planes in the grid cube
+   const size_t onePlaneSize = size_t(itsShape(0)) * size_t(itsShape(1));
+   const size_t nGridPols = itsShape.nelements()>=3 ? size_t(itsShape(2)) : 1;
    
    // Loop over all samples adding them to the grid
    // First scale to the correct pixel location
@@ -518,28 +525,272 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    ASKAPDEBUGASSERT(casa::uInt(nChan) <= frequencyList.nelements());
    ASKAPDEBUGASSERT(casa::uInt(nSamples) == acc.uvw().nelements());
    
+   // number of polarisation planes in the grid
+   const casa::uInt nImagePols = (shape().nelements()<=2) ? 1 : shape()[2];
+
+   // the list of samples to grid together with their coordinates and indices is either
+   // replayed from the cache (if enabled) or derived from the metadata
+   boost::shared_ptr<const GriddingPlan> plan;
+   casa::uInt64 planKey = 0;
+   if (itsPlanCache) {
+       planKey = planFingerprint(acc, outUVW, imageCentre, tangentPoint);
+       plan = itsPlanCache->find(planKey);
+   }
+   if (!plan) {
+       boost::shared_ptr<GriddingPlan> newPlan;
+       if (itsPlanCache) {
+           newPlan.reset(new GriddingPlan);
+       } else {
+           // reuse the buffer to avoid reallocation for every accessor
+           if (!itsScratchPlan) {
+               itsScratchPlan.reset(new GriddingPlan);
+           }
+           newPlan = itsScratchPlan;
+       }
+       buildGriddingPlan(*newPlan, acc, outUVW, imageCentre);
+       // plans are only cached if they are not larger than the visibility, noise and flag cubes
+       // of the accessor, otherwise they are rebuilt every pass
+       const size_t dataSize = size_t(nSamples) * nChan * acc.nPol() *
+                               (2 * sizeof(casa::Complex) + sizeof(casa::Bool));
+       if (itsPlanCache && (newPlan->memoryUsed() <= dataSize)) {
+           itsPlanCache->add(planKey, newPlan);
+       }
+       plan = newPlan;
+   }
+   itsRowsRejectedDueToMaxPointingSeparation += plan->itsRowsRejected;
+   if (!forward) {
+       itsVectorsFlagged += plan->itsVectorsFlagged;
+   }
+   
+   if (itsFirstGriddedVis && isPSFGridder() && (plan->itsFirstRow >= 0)) {
+       // data members related to representative feed and field are used for
+       // reverse problem only (from visibilities to image). 
+       if (itsUseAllDataForPSF) {
+           ASKAPLOG_DEBUG_STR(logger, "All data are used to estimate PSF");       
+       } else {
+           itsFeedUsedForPSF = acc.feed1()(plan->itsFirstRow);
+           itsPointingUsedForPSF = acc.dishPointing1()(plan->itsFirstRow);    
+           ASKAPLOG_DEBUG_STR(logger, "Using the data for feed "<<itsFeedUsedForPSF<<
+              " and field at "<<printDirection(itsPointingUsedForPSF)<<" to estimate the PSF");
+       }
+       itsFirstGriddedVis = false;
+   }
+   
+   // a buffer for the visibility vector in the polarisation frame used for the grid
+   casa::Vector<casa::Complex> imagePolFrameVis(nImagePols);
+   casa::Vector<casa::Complex> imagePolFrameNoise(nImagePols);
+
+   for (size_t entry = 0; entry < plan->size(); ++entry) {
+       const casa::uInt i = plan->itsSample[entry] / nChan;
+       const casa::uInt chan = plan->itsSample[entry] % nChan;
+       // image channel this accessor channel is mapped to
+       const int imageChan = itsFreqMapper(chan);
+       const int iu = plan->itsIU[entry];
+       const int iv = plan->itsIV[entry];
+       
+       // Calculate the delay phasor
+       const double phase=2.0f*casa::C::pi*frequencyList[chan]*delay(i)/(casa::C::c);
+       const casa::Complex phasor(cos(phase), sin(phase));
+       
+       imagePolFrameVis.set(casa::Complex(0.,0.));
+       if (!forward) {
+           if (!isPSFGridder() && !isPCFGridder()) {
+               imagePolFrameVis = gridPolConv(syncHelper.zVector(acc.visibility(),i,chan));                 
+           }
+           // we just don't need this quantity for the forward gridder, although there would be no
+           // harm to always compute it
+           imagePolFrameNoise = gridPolConv.noise(syncHelper.zVector(acc.noise(),i,chan));                 
+       }         
+       
+       // Now loop over all image polarizations
+       for (uint pol=0; pol<nImagePols; ++pol) {
+           // Lookup the portion of grid to be
+           // used for this row, polarisation and channel
+           const int gInd=gIndex(i, pol, chan);
+           ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
+           ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
+           
+           // Lookup the convolution function to be
+           // used for this row, polarisation and channel
+           // cIndex gives the index for this row, polarization and channel. On top of
+           // that, we need to adjust for the oversampling since each oversampled
+           // plane is kept as a separate matrix.
+           const int beforeOversamplePlaneIndex = cIndex(i,pol,chan);
+           const int cInd=plan->itsFrac[entry]+itsOverSample*itsOverSample*beforeOversamplePlaneIndex;
+           ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
+           ASKAPCHECK(cInd<int(itsConvFunc.size()),
+                   "Index into convolution functions exceeds number of planes");
+           
+           const casa::Matrix<casa::Complex> & convFunc(itsConvFunc[cInd]);
+           ASKAPDEBUGASSERT(convFunc.contiguousStorage());
+      
+           // support only square convolution functions at the moment
+           ASKAPDEBUGASSERT(convFunc.nrow() == convFunc.ncolumn());
+           ASKAPCHECK(convFunc.nrow() % 2 == 1, 
+                   "Expect convolution function with an odd number of pixels for each axis, CF["<<
+                   cInd<<"] has shape="<<convFunc.shape());
+           // we now use support size for this given plane in the CF cache; itsSupport is a maximum
+           // support across all CFs (this allows plane-dependent support size)      
+           const int support = (int(convFunc.nrow()) - 1) / 2;
+           ASKAPCHECK(support > 0, "Support must be greater than zero, CF["<<cInd<<"] has shape="<<
+                      convFunc.shape()<<" giving a support of "<<support);
+          
+           // pointer to the first element of the plane for this polarisation and image channel,
+           // the grid is contiguous and no bounds checking is required beyond the on-grid test below
+           casa::Array<casa::Complex> &thisGrid = itsGrid[gInd];
+           ASKAPDEBUGASSERT(thisGrid.contiguousStorage());
+           ASKAPDEBUGASSERT(thisGrid.nelements() >= onePlaneSize * (pol + nGridPols * imageChan + 1));
+           casa::Complex *grid = thisGrid.data() + onePlaneSize * (pol + nGridPols * imageChan);
+           const int gridStride = itsShape(0);
+           const int cfStride = int(convFunc.nrow());
+      
+           // the following accounts for a possible offset of the convolution function
+           const std::pair<int,int> cfOffset = getConvFuncOffset(beforeOversamplePlaneIndex);
+           const int iuOffset = iu + cfOffset.first;
+           const int ivOffset = iv + cfOffset.second;
+         
+           /// Need to check if this point lies on the grid (taking into 
+           /// account the support)
+           if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
+               ((iuOffset+support) <itsShape(0))&&((ivOffset+support)<itsShape(1))) {
+               if (forward) {
+                   casa::Complex cVis(0.,0.);
+                   GridKernel::degrid(cVis, convFunc.data(), cfStride, grid, gridStride,
+                                      iuOffset, ivOffset, support);
+                   itsSamplesDegridded+=1.0;
+                   itsNumberDegridded+=double((2*support+1)*(2*support+1));
+                   if (itsVisWeight) {
+                       cVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                   }
+                   imagePolFrameVis[pol] += cVis*phasor;
+               } else {
+                   const casa::Complex visComplexNoise = imagePolFrameNoise[pol];
+                    
+                   const float visNoise = casa::square(casa::real(visComplexNoise));
+                   //const float visNoise = casa::norm(visComplexNoise);
+                   const float visNoiseWt = (visNoise > 0.) ? 1./visNoise : 0.;
+                   ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
+                              visNoiseWt<<" visNoise="<<visNoise<<" visComplexNoise="<<visComplexNoise);
+                   
+                   // row in itsSumWeights to work with
+                   const int sumWeightsRow =
+                       itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
+      
+                   ASKAPCHECK(itsSumWeights.nelements()>0, "Sum of weights not yet initialised");
+                   ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
+                   ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
+                              "Index into itsSumWeights of " << sumWeightsRow <<
+                              " is greater than allowed " << int(itsSumWeights.shape()(0)));
+                   ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
+                   ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
+                            
+                   if (!isPSFGridder() && !isPCFGridder()) {
+                       /// Gridding visibility data onto grid
+                       casa::Complex rVis = phasor*conj(imagePolFrameVis[pol])*visNoiseWt;
+                       if (itsVisWeight) {
+                           rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                       }
+             
+                       gridSample(grid, convFunc.data(), cfStride, rVis, iuOffset, ivOffset, support);
+      
+                       itsSamplesGridded+=1.0;
+                       itsNumberGridded+=double((2*support+1)*(2*support+1));
+      
+                       itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;
+                   }
+                   /// Grid the PSF?
+                   if (isPSFGridder() &&
+                       (itsUseAllDataForPSF ||
+                        ((itsFeedUsedForPSF == acc.feed1()(i)) &&
+                         (itsPointingUsedForPSF.separation(acc.dishPointing1()(i))<1e-6)))) {
+                        casa::Complex uVis(1.,0.);
+                        uVis *= visNoiseWt;
+                        if (itsVisWeight) {
+                            uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                        }
+      
+                        gridSample(grid, convFunc.data(), cfStride, uVis, iuOffset, ivOffset, support);
+                
+                        itsSamplesGridded+=1.0;
+                        itsNumberGridded+=double((2*support+1)*(2*support+1));
+      
+                        itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
+                   } // end if psf needs to be done
+                   /// Grid the preconditioner function?
+                   if (isPCFGridder()) {
+                        casa::Complex uVis(1.,0.);
+                        uVis *= visNoiseWt;
+                        // We don't want different preconditioning for different Taylor terms.
+                        //if (itsVisWeight) {
+                        //    uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
+                        //}
+      
+                        // storing w information in the imaginary part of the PCF,
+                        // so make them add with conjugate symmetry.
+                        if ((ivOffset<itsShape(1)/2 && iuOffset>=itsShape(0)/2) ||
+                            (ivOffset<=itsShape(1)/2 && iuOffset<itsShape(0)/2)) {
+                        //if (isPCFGridder() && ivOffset<itsShape(1)/2) {
+                          const casa::Matrix<casa::Complex> conjFunc = conj(convFunc);
+                          GridKernel::grid(grid, gridStride, conjFunc.data(), cfStride, uVis,
+                                           iuOffset, ivOffset, support);
+                        } else {
+                          GridKernel::grid(grid, gridStride, convFunc.data(), cfStride, uVis,
+                                           iuOffset, ivOffset, support);
+                        }
+                
+                        itsSamplesGridded+=1.0;
+                        itsNumberGridded+=double((2*support+1)*(2*support+1));
+      
+                        // these aren't used. Can parobably also disable the PSF weights
+                        //itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
+                   } // end if pcf needs to be done
+      
+               } // end if forward (else case, reverse operation)
+           } // end of on-grid if statement
+       } // end of pol loop
+       // need to write back the result for degridding
+       if (forward) {
+           casa::Vector<casa::Complex> thisPolVector = acc.rwVisibility().yzPlane(i).row(chan);
+           thisPolVector += degridPolConv(imagePolFrameVis);
+       }
+   } // end of loop over plan entries
+   gridDeferredSamples();
+   if (forward) {
+       itsTimeDegridded+=timer.real();
+   } else {
+       itsTimeGridded+=timer.real();
+   }
+}
+
+/// @brief derive the gridding plan from the accessor metadata
+/// @param[out] plan plan to fill (previous content is discarded)
+/// @param[in] acc accessor to work with
+/// @param[in] outUVW uvw rotated to the tangent point
+/// @param[in] imageCentre direction of the image centre
+void TableVisGridder::buildGriddingPlan(GriddingPlan &plan, const accessors::IConstDataAccessor &acc,
+                 const casa::Vector<casa::RigidVector<double, 3> > &outUVW,
+                 const casa::MVDirection &imageCentre)
+{
+   plan.clear();
+   const uint nSamples = acc.nRow();
+   const uint nChan = acc.nChannel();
+   const uint nPol = acc.nPol();
+   const casa::Vector<casa::Double>& frequencyList = acc.frequency();
+   ASKAPCHECK(casa::uInt64(nSamples) * nChan <= casa::uInt64(std::numeric_limits<casa::uInt>::max()),
+              "Accessor with "<<nSamples<<" rows and "<<nChan<<" channels is too large for the gridding plan");
+   plan.reserve(size_t(nSamples) * nChan);
+
    for (uint i=0; i<nSamples; ++i) {
        if (itsMaxPointingSeparation > 0.) {
            // need to reject samples, if too far from the image centre
            const casa::MVDirection thisPointing  = acc.pointingDir1()(i);
            if (imageCentre.separation(thisPointing) > itsMaxPointingSeparation) {
-               ++itsRowsRejectedDueToMaxPointingSeparation;
+               ++plan.itsRowsRejected;
                continue;
            }
        }
-   
-       if (itsFirstGriddedVis && isPSFGridder()) {
-           // data members related to representative feed and field are used for
-           // reverse problem only (from visibilities to image). 
-           if (itsUseAllDataForPSF) {
-               ASKAPLOG_DEBUG_STR(logger, "All data are used to estimate PSF");       
-           } else {
-               itsFeedUsedForPSF = acc.feed1()(i);
-               itsPointingUsedForPSF = acc.dishPointing1()(i);    
-               ASKAPLOG_DEBUG_STR(logger, "Using the data for feed "<<itsFeedUsedForPSF<<
-                  " and field at "<<printDirection(itsPointingUsedForPSF)<<" to estimate the PSF");
-           }
-           itsFirstGriddedVis = false;
+       if (plan.itsFirstRow < 0) {
+           plan.itsFirstRow = int(i);
        }
        
        for (uint chan=0; chan<nChan; ++chan) {
@@ -554,6 +805,20 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
                   frequencyList[chan]/1e9<<" GHz");
            }
            
+           bool allPolGood=true;
+           for (uint pol=0; pol<nPol; ++pol) {
+               if (acc.flag()(i, chan, pol))
+                   allPolGood=false;
+           }
+           
+           // Ensure that we only use unflagged data, incomplete polarisation vectors are 
+           // ignored
+           // @todo Be more careful about matching polarizations
+           if (!allPolGood || !itsFreqMapper.isMapped(chan)) {
+               ++plan.itsVectorsFlagged;
+               continue;
+           }
+           
            /// Scale U,V to integer pixels plus fractional terms
            const double uScaled=frequencyList[chan]*outUVW(i)(0)/(casa::C::c *itsUVCellSize(0));
            int iu = askap::nint(uScaled);
@@ -591,213 +856,198 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
                    " iv="<<iv<<" oversample="<<itsOverSample<<" fracv="<<fracv);
            iv+=itsShape(1)/2;
            
-           // Calculate the delay phasor
-           const double phase=2.0f*casa::C::pi*frequencyList[chan]*delay(i)/(casa::C::c);
-                      
-           const casa::Complex phasor(cos(phase), sin(phase));
-           
-           bool allPolGood=true;
-           for (uint pol=0; pol<nPol; ++pol) {
-               if (acc.flag()(i, chan, pol))
-                   allPolGood=false;
-           }
-  
-           /*
-           // temporary for debugging
-           if (allPolGood && !itsFreqMapper.isMapped(chan)) {
-              ASKAPLOG_DEBUG_STR(logger, "Channel "<<chan<<" is not mapped to the image cube");       
-           }
-           */
-           
-           // Ensure that we only use unflagged data, incomplete polarisation vectors are 
-           // ignored
-           // @todo Be more careful about matching polarizations
-           if (allPolGood && itsFreqMapper.isMapped(chan)) {
-               // obtain which channel of the image this accessor channel is mapped to
-               const int imageChan = itsFreqMapper(chan);
-              
-               // number of polarisation planes in the grid
-               const casa::uInt nImagePols = (shape().nelements()<=2) ? 1 : shape()[2];
-               
-               // a buffer for the visibility vector in the polarisation frame used for the grid
-               casa::Vector<casa::Complex> imagePolFrameVis(nImagePols,casa::Complex(0.,0.));
-               casa::Vector<casa::Complex> imagePolFrameNoise(nImagePols);
-               
-               if (!forward) {
-                   if (!isPSFGridder() && !isPCFGridder()) {
-                       imagePolFrameVis = gridPolConv(syncHelper.zVector(acc.visibility(),i,chan));                 
-                   }
-                   // we just don't need this quantity for the forward gridder, although there would be no
-                   // harm to always compute it
-                   imagePolFrameNoise = gridPolConv.noise(syncHelper.zVector(acc.noise(),i,chan));                 
-               }         
-               
-               // Now loop over all image polarizations
-               for (uint pol=0; pol<nImagePols; ++pol) {
-                   // Lookup the portion of grid to be
-                   // used for this row, polarisation and channel
-                   const int gInd=gIndex(i, pol, chan);
-                   ASKAPCHECK(gInd>-1,"Index into image grid is less than zero");
-                   ASKAPCHECK(gInd<int(itsGrid.size()), "Index into image grid exceeds number of planes");
-                                
-                   /// Make a slicer to extract just this plane
-                   const casa::IPosition ipStart(4, 0, 0, pol, imageChan);
-                   const casa::Slicer slicer(ipStart, onePlane4D);
-                 
-                   // Lookup the convolution function to be
-                   // used for this row, polarisation and channel
-                   // cIndex gives the index for this row, polarization and channel. On top of
-                   // that, we need to adjust for the oversampling since each oversampled
-                   // plane is kept as a separate matrix.
-                   const int beforeOversamplePlaneIndex = cIndex(i,pol,chan);
-                   const int cInd=fracu+itsOverSample*(fracv+itsOverSample*beforeOversamplePlaneIndex);
-                   ASKAPCHECK(cInd>-1,"Index into convolution functions is less than zero");
-                   ASKAPCHECK(cInd<int(itsConvFunc.size()),
-                           "Index into convolution functions exceeds number of planes");
-                 
-                   casa::Matrix<casa::Complex> & convFunc(itsConvFunc[cInd]);
-              
-                   // support only square convolution functions at the moment
-                   ASKAPDEBUGASSERT(convFunc.nrow() == convFunc.ncolumn());
-                   ASKAPCHECK(convFunc.nrow() % 2 == 1, 
-                           "Expect convolution function with an odd number of pixels for each axis, CF["<<
-                           cInd<<"] has shape="<<convFunc.shape());
-                   // we now use support size for this given plane in the CF cache; itsSupport is a maximum
-                   // support across all CFs (this allows plane-dependent support size)      
-                   const int support = (int(convFunc.nrow()) - 1) / 2;
-                   ASKAPCHECK(support > 0, "Support must be greater than zero, CF["<<cInd<<"] has shape="<<
-                              convFunc.shape()<<" giving a support of "<<support);
-                  
-                   casa::Array<casa::Complex> aGrid(itsGrid[gInd](slicer));
-                   casa::Matrix<casa::Complex> grid(aGrid.nonDegenerate());
-              
-                   // the following accounts for a possible offset of the convolution function
-                   const std::pair<int,int> cfOffset = getConvFuncOffset(beforeOversamplePlaneIndex);
-                   const int iuOffset = iu + cfOffset.first;
-                   const int ivOffset = iv + cfOffset.second;
-                   
-                   /*
-                   if (isPSFGridder()) {
-                       if (i!=0) continue;
-                       std::cout<<"sample "<<i<<" iu="<<iu<<" uScaled="<<uScaled<<" fracu="<<fracu<<" "<<
-                              "iv="<<iv<<" vScaled="<<vScaled<<" fracv="<<fracv<<
-                              " wplane="<<beforeOversamplePlaneIndex<<std::endl;
-                   }
-                   */
-                 
-                   /// Need to check if this point lies on the grid (taking into 
-                   /// account the support)
-                   if (((iuOffset-support)>0)&&((ivOffset-support)>0)&&
-                       ((iuOffset+support) <itsShape(0))&&((ivOffset+support)<itsShape(1))) {
-                       if (forward) {
-                           casa::Complex cVis(0.,0.);
-                           GridKernel::degrid(cVis, convFunc, grid, iuOffset, ivOffset, support);
-                           itsSamplesDegridded+=1.0;
-                           itsNumberDegridded+=double((2*support+1)*(2*support+1));
-                           if (itsVisWeight) {
-                               cVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                           }
-                           imagePolFrameVis[pol] += cVis*phasor;
-                       } else {
-                           const casa::Complex visComplexNoise = imagePolFrameNoise[pol];
-                            
-                           const float visNoise = casa::square(casa::real(visComplexNoise));
-                           //const float visNoise = casa::norm(visComplexNoise);
-                           const float visNoiseWt = (visNoise > 0.) ? 1./visNoise : 0.;
-                           ASKAPCHECK(visNoiseWt>0., "Weight is supposed to be a positive number; visNoiseWt="<<
-                                      visNoiseWt<<" visNoise="<<visNoise<<" visComplexNoise="<<visComplexNoise);
-                           
-                           // row in itsSumWeights to work with
-                           const int sumWeightsRow =
-                               itsTrackWeightPerOversamplePlane ? cInd : beforeOversamplePlaneIndex;
-              
-                           ASKAPCHECK(itsSumWeights.nelements()>0, "Sum of weights not yet initialised");
-                           ASKAPDEBUGASSERT(itsSumWeights.shape().nelements() >= 3);
-                           ASKAPCHECK(sumWeightsRow < int(itsSumWeights.shape()(0)),
-                                      "Index into itsSumWeights of " << sumWeightsRow <<
-                                      " is greater than allowed " << int(itsSumWeights.shape()(0)));
-                           ASKAPDEBUGASSERT(pol < uint(itsSumWeights.shape()(1)));
-                           ASKAPDEBUGASSERT(imageChan < int(itsSumWeights.shape()(2)));
-                                    
-                           if (!isPSFGridder() && !isPCFGridder()) {
-                               /// Gridding visibility data onto grid
-                               casa::Complex rVis = phasor*conj(imagePolFrameVis[pol])*visNoiseWt;
-                               if (itsVisWeight) {
-                                   rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                               }
-                     
-                               GridKernel::grid(grid, convFunc, rVis, iuOffset, ivOffset, support);
-              
-                               itsSamplesGridded+=1.0;
-                               itsNumberGridded+=double((2*support+1)*(2*support+1));
-              
-                               itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;
-                           }
-                           /// Grid the PSF?
-                           if (isPSFGridder() &&
-                               (itsUseAllDataForPSF ||
-                                ((itsFeedUsedForPSF == acc.feed1()(i)) &&
-                                 (itsPointingUsedForPSF.separation(acc.dishPointing1()(i))<1e-6)))) {
-                                casa::Complex uVis(1.,0.);
-                                uVis *= visNoiseWt;
-                                if (itsVisWeight) {
-                                    uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                                }
-              
-                                GridKernel::grid(grid, convFunc, uVis, iuOffset, ivOffset, support);
-                        
-                                itsSamplesGridded+=1.0;
-                                itsNumberGridded+=double((2*support+1)*(2*support+1));
-              
-                                itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
-                           } // end if psf needs to be done
-                           /// Grid the preconditioner function?
-                           if (isPCFGridder()) {
-                                casa::Complex uVis(1.,0.);
-                                uVis *= visNoiseWt;
-                                // We don't want different preconditioning for different Taylor terms.
-                                //if (itsVisWeight) {
-                                //    uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
-                                //}
-              
-                                // storing w information in the imaginary part of the PCF,
-                                // so make them add with conjugate symmetry.
-                                if ((ivOffset<itsShape(1)/2 && iuOffset>=itsShape(0)/2) ||
-                                    (ivOffset<=itsShape(1)/2 && iuOffset<itsShape(0)/2)) {
-                                //if (isPCFGridder() && ivOffset<itsShape(1)/2) {
-                                  casa::Matrix<casa::Complex> conjFunc = conj(convFunc);
-                                  GridKernel::grid(grid, conjFunc, uVis, iuOffset, ivOffset, support);
-                                } else {
-                                  GridKernel::grid(grid, convFunc, uVis, iuOffset, ivOffset, support);
-                                }
-                        
-                                itsSamplesGridded+=1.0;
-                                itsNumberGridded+=double((2*support+1)*(2*support+1));
-              
-                                // these aren't used. Can parobably also disable the PSF weights
-                                //itsSumWeights(sumWeightsRow, pol, imageChan) += visNoiseWt; //1.0;               
-                           } // end if pcf needs to be done
-              
-                       } // end if forward (else case, reverse operation)
-                   } // end of on-grid if statement
-               } // end of pol loop
-               // need to write back the result for degridding
-               if (forward) {
-                   casa::Vector<casa::Complex> thisPolVector = acc.rwVisibility().yzPlane(i).row(chan);
-                   thisPolVector += degridPolConv(imagePolFrameVis);
-               }
-           } else { // if (allPolGood)
-               if (!forward) {
-                   itsVectorsFlagged+=1;
-               }
-           }
-       } //end of chan loop
-   } //end of i loop
-   if (forward) {
-       itsTimeDegridded+=timer.real();
-   } else {
-       itsTimeGridded+=timer.real();
+           plan.itsSample.push_back(i * nChan + chan);
+           plan.itsIU.push_back(iu);
+           plan.itsIV.push_back(iv);
+           plan.itsFrac.push_back(fracu + itsOverSample * fracv);
+       }
+   }
+}
+
+/// @brief compute the key of the gridding plan in the cache
+/// @details The accessor is identified by its position in the iteration together with a few
+/// cheap invariants: dimensions, time, frequencies and their mapping to image channels, the
+/// first and the last row, and the grid geometry. Flags and the remaining per-row metadata are
+/// assumed to stay the same for all passes over the same iteration, they are not examined.
+/// @param[in] acc accessor to work with
+/// @param[in] outUVW uvw rotated to the tangent point
+/// @param[in] imageCentre direction of the image centre
+/// @param[in] tangentPoint tangent point
+/// @return 64-bit fingerprint used as a key in the plan cache
+casa::uInt64 TableVisGridder::planFingerprint(const accessors::IConstDataAccessor &acc,
+                 const casa::Vector<casa::RigidVector<double, 3> > &outUVW,
+                 const casa::MVDirection &imageCentre, const casa::MVDirection &tangentPoint) const
+{
+   casa::uInt64 key = GriddingPlanCache::theirInitialHash;
+   const casa::uInt dims[4] = {itsAccessorIndex, acc.nRow(), acc.nChannel(), acc.nPol()};
+   key = GriddingPlanCache::hash(key, dims, sizeof(dims));
+   for (casa::uInt dim = 0; dim < itsShape.nelements(); ++dim) {
+        const casa::Int64 size = itsShape(dim);
+        key = GriddingPlanCache::hash(key, &size, sizeof(size));
+   }
+   const double geometry[9] = {itsUVCellSize(0), itsUVCellSize(1), double(itsOverSample), 
+                               itsMaxPointingSeparation, imageCentre.getLong(), imageCentre.getLat(),
+                               tangentPoint.getLong(), tangentPoint.getLat(), acc.time()};
+   key = GriddingPlanCache::hash(key, geometry, sizeof(geometry));
+   for (casa::uInt chan = 0; chan < acc.nChannel(); ++chan) {
+        const double freq = acc.frequency()[chan];
+        const int imageChan = itsFreqMapper.isMapped(chan) ? int(itsFreqMapper(chan)) : -1;
+        key = GriddingPlanCache::hash(key, &freq, sizeof(freq));
+        key = GriddingPlanCache::hash(key, &imageChan, sizeof(imageChan));
+   }
+   if (acc.nRow() > 0) {
+       const casa::uInt rows[2] = {0, acc.nRow() - 1};
+       for (int index = 0; index < 2; ++index) {
+            const casa::uInt row = rows[index];
+            const double rowData[7] = {outUVW(row)(0), outUVW(row)(1), outUVW(row)(2),
+                                       acc.pointingDir1()(row).getLong(), acc.pointingDir1()(row).getLat(),
+                                       double(acc.feed1()(row)), double(acc.antenna1()(row))};
+            key = GriddingPlanCache::hash(key, rowData, sizeof(rowData));
+       }
+   }
+   return key;
+}
+
+/// @brief set the number of threads used for gridding
+/// @param[in] nThreads number of threads (1 means no threading, default)
+void TableVisGridder::numberOfThreads(const int nThreads)
+{
+   ASKAPCHECK(nThreads > 0, "Number of gridding threads should be positive, you have "<<nThreads);
+   #ifndef _OPENMP
+   if (nThreads > 1) {
+       ASKAPLOG_WARN_STR(logger, "Threaded gridding requires OpenMP, "<<nThreads<<
+                         " threads requested but gridding will be done in a single thread");
+   }
+   #endif
+   itsNumberOfThreads = nThreads;
+}
+
+/// @brief grid or buffer one visibility sample
+/// @param[in] grid pointer to the first element of the grid plane
+/// @param[in] convFunc pointer to the first element of the convolution function
+/// @param[in] cfStride number of elements between adjacent v-rows of the convolution function
+/// @param[in] cVis visibility to grid
+/// @param[in] iu u-pixel of the centre of the support
+/// @param[in] iv v-pixel of the centre of the support
+/// @param[in] support support size
+void TableVisGridder::gridSample(casa::Complex *grid, const casa::Complex *convFunc, const int cfStride,
+                 const casa::Complex &cVis, const int iu, const int iv, const int support)
+{
+   #ifdef _OPENMP
+   if (itsNumberOfThreads > 1) {
+       DeferredSample sample;
+       sample.itsGrid = grid;
+       sample.itsConvFunc = convFunc;
+       sample.itsCFStride = cfStride;
+       sample.itsVis = cVis;
+       sample.itsIU = iu;
+       sample.itsIV = iv;
+       sample.itsSupport = support;
+       itsDeferredSamples.push_back(sample);
+       return;
+   }
+   #endif
+   GridKernel::grid(grid, itsShape(0), convFunc, cfStride, cVis, iu, iv, support);
+}
+
+/// @brief helper structure to sort buffered samples into uv-tiles
+struct GridTileKey {
+   /// @brief group of tiles which can be gridded concurrently (0..3)
+   int itsColour;
+   /// @brief grid plane
+   const casa::Complex *itsPlane;
+   /// @brief tile index along v
+   int itsTileV;
+   /// @brief tile index along u
+   int itsTileU;
+   /// @brief index of the sample in the buffer
+   size_t itsIndex;
+
+   /// @brief ordering by group, tile and then the original order of samples
+   /// @param[in] other another key
+   /// @return true if this key goes before the other one
+   bool operator<(const GridTileKey &other) const {
+      if (itsColour != other.itsColour) {
+          return itsColour < other.itsColour;
+      }
+      if (itsPlane != other.itsPlane) {
+          return itsPlane < other.itsPlane;
+      }
+      if (itsTileV != other.itsTileV) {
+          return itsTileV < other.itsTileV;
+      }
+      if (itsTileU != other.itsTileU) {
+          return itsTileU < other.itsTileU;
+      }
+      return itsIndex < other.itsIndex;
+   }
+
+   /// @brief check that two keys belong to the same tile
+   /// @param[in] other another key
+   /// @return true if both keys correspond to the same tile
+   bool sameTile(const GridTileKey &other) const {
+      return (itsPlane == other.itsPlane) && (itsTileV == other.itsTileV) && (itsTileU == other.itsTileU);
+   }
+};
+
+/// @brief grid all buffered samples using multiple threads
+/// @details Samples are sorted into uv-tiles which are gridded concurrently. The buffer
+/// is emptied on exit.
+void TableVisGridder::gridDeferredSamples()
+{
+   if (itsDeferredSamples.size() == 0) {
+       return;
+   }
+   // a sample with the support s centred in a tile of size 2*s or more never touches
+   // the tile two steps away, so tiles of the same colour can be gridded concurrently
+   int maxSupport = 1;
+   for (size_t index = 0; index < itsDeferredSamples.size(); ++index) {
+        maxSupport = std::max(maxSupport, itsDeferredSamples[index].itsSupport);
+   }
+   const int tileSize = 2 * maxSupport;
+   
+   std::vector<GridTileKey> keys(itsDeferredSamples.size());
+   for (size_t index = 0; index < keys.size(); ++index) {
+        const DeferredSample &sample = itsDeferredSamples[index];
+        GridTileKey &key = keys[index];
+        key.itsPlane = sample.itsGrid;
+        key.itsTileU = sample.itsIU / tileSize;
+        key.itsTileV = sample.itsIV / tileSize;
+        key.itsColour = (key.itsTileU % 2) + 2 * (key.itsTileV % 2);
+        key.itsIndex = index;
+   }
+   std::sort(keys.begin(), keys.end());
+   
+   // boundaries of tiles in the sorted sequence and of colour groups in the tile sequence
+   std::vector<size_t> tileStart;
+   std::vector<size_t> colourStart(5, 0);
+   for (size_t index = 0; index < keys.size(); ++index) {
+        if ((index == 0) || !keys[index].sameTile(keys[index - 1])) {
+            tileStart.push_back(index);
+        }
+        colourStart[keys[index].itsColour + 1] = tileStart.size();
+   }
+   tileStart.push_back(keys.size());
+   for (size_t colour = 1; colour < colourStart.size(); ++colour) {
+        colourStart[colour] = std::max(colourStart[colour], colourStart[colour - 1]);
+   }
+
+   const int gridStride = itsShape(0);
+   for (size_t colour = 0; colour < 4; ++colour) {
+        const int firstTile = int(colourStart[colour]);
+        const int lastTile = int(colourStart[colour + 1]);
+        #ifdef _OPENMP
+        #pragma omp parallel for schedule(dynamic) num_threads(itsNumberOfThreads)
+        #endif
+        for (int tile = firstTile; tile < lastTile; ++tile) {
+             for (size_t index = tileStart[tile]; index < tileStart[tile + 1]; ++index) {
+                  const DeferredSample &sample = itsDeferredSamples[keys[index].itsIndex];
+                  GridKernel::grid(sample.itsGrid, gridStride, sample.itsConvFunc, sample.itsCFStride,
+                                   sample.itsVis, sample.itsIU, sample.itsIV, sample.itsSupport);
+             }
+        }
    }
+   itsDeferredSamples.clear();
 }
 
 /// @brief correct visibilities, if necessary
@@ -1178,6 +1428,8 @@ void TableVisGridder::initialiseDegrid(const scimath::Axes& axes,
 /// method.
 void TableVisGridder::initialiseFreqMapping()
 {
+  // every initialisation starts a new pass over the data
+  itsAccessorIndex = 0;
   if (itsAxes.has("FREQUENCY") && itsShape.nelements()>=4) {
       itsFreqMapper.setupImage(itsAxes, itsShape(3));
   } else {
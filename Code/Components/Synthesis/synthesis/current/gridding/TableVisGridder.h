@@ -36,12 +36,20 @@
 #include <gridding/VisGridderWithPadding.h>
 #include <dataaccess/IDataAccessor.h>
 #include <gridding/FrequencyMapper.h>
+#include <gridding/GriddingPlanCache.h>
 
 // std includes
 #include <string>
+#include <vector>
 
 // casa includes
 #include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+#include <casacore/casa/Quanta/MVDirection.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
 
 #ifdef _OPENMP
 // boost includes
@@ -174,6 +182,31 @@ namespace askap
       /// @param[in] threshold largest allowed angular separation in radians, use negative value to select all data
       void inline maxPointingSeparation(double threshold = -1.) { itsMaxPointingSeparation = threshold; }
 
+      /// @brief set the number of threads used for gridding
+      /// @details If more than one thread is requested, visibilities are not gridded immediately
+      /// in the generic method. Instead, they are buffered for the whole accessor, sorted into
+      /// uv-tiles and tiles are gridded concurrently. Tiles are at least twice the largest support
+      /// wide and are processed in 4 groups (by parity of the tile index along each axis),
+      /// so concurrently gridded tiles never overlap and no atomic operations are required.
+      /// The result does not depend on the number of threads. Threading requires OpenMP, this
+      /// setting is ignored if the code is built without it. Degridding and the preconditioner
+      /// function gridding are always done in a single thread.
+      /// @param[in] nThreads number of threads (1 means no threading, default)
+      void numberOfThreads(const int nThreads);
+
+      /// @brief set the cache of gridding plans
+      /// @details If the cache is set, the plan of an accessor is computed once and replayed
+      /// when an accessor with identical metadata is gridded or degridded again (i.e. in
+      /// subsequent major cycles). The plan holds the list of unflagged samples (row and channel)
+      /// mapped to an image channel together with their integer uv-cell (iu, iv) and oversampling
+      /// offset, as well as the counts of rejected rows and flagged vectors. The image channel,
+      /// delay phasor, grid plane and convolution function plane (gIndex, cIndex), support and
+      /// the on-grid test are still evaluated for every sample on replay, so the plan doesn't
+      /// depend on the convolution functions or the grid.
+      /// The cache is shared between clones of this gridder.
+      /// @param[in] cache shared pointer to the cache, an empty pointer disables caching (default)
+      void inline setPlanCache(const GriddingPlanCache::ShPtr &cache) { itsPlanCache = cache; }
+
       /// @brief set table name to store the CFs to
       /// @details This method makes it possible to enable writing CFs to disk in destructor after the 
       /// gridder is created. The main use case is to allow a better control of this feature in the parallel
@@ -551,6 +584,88 @@ protected:
       /// @brief true, if itsSumWeights tracks weights per oversampling plane
       bool itsTrackWeightPerOversamplePlane;
 
+      /// @brief number of threads used for gridding
+      int itsNumberOfThreads;
+
+      /// @brief visibility sample buffered for the threaded gridding
+      struct DeferredSample {
+         /// @brief first element of the grid plane
+         casa::Complex *itsGrid;
+         /// @brief first element of the convolution function
+         const casa::Complex *itsConvFunc;
+         /// @brief number of elements between adjacent v-rows of the convolution function
+         int itsCFStride;
+         /// @brief visibility to grid (all weights applied)
+         casa::Complex itsVis;
+         /// @brief u-pixel of the centre of the support
+         int itsIU;
+         /// @brief v-pixel of the centre of the support
+         int itsIV;
+         /// @brief support size
+         int itsSupport;
+      };
+
+      /// @brief samples waiting to be gridded
+      /// @details This buffer is only used if itsNumberOfThreads is more than 1. It is filled
+      /// and emptied within a single call to generic, but kept as a data member to avoid
+      /// reallocation for every accessor.
+      std::vector<DeferredSample> itsDeferredSamples;
+
+      /// @brief grid or buffer one visibility sample
+      /// @details The sample is gridded immediately unless threaded gridding is requested,
+      /// in which case it is added to itsDeferredSamples.
+      /// @param[in] grid pointer to the first element of the grid plane
+      /// @param[in] convFunc pointer to the first element of the convolution function
+      /// @param[in] cfStride number of elements between adjacent v-rows of the convolution function
+      /// @param[in] cVis visibility to grid
+      /// @param[in] iu u-pixel of the centre of the support
+      /// @param[in] iv v-pixel of the centre of the support
+      /// @param[in] support support size
+      void gridSample(casa::Complex *grid, const casa::Complex *convFunc, const int cfStride,
+                      const casa::Complex &cVis, const int iu, const int iv, const int support);
+
+      /// @brief grid all buffered samples using multiple threads
+      /// @details Samples are sorted into uv-tiles which are gridded concurrently. The buffer
+      /// is emptied on exit.
+      void gridDeferredSamples();
+
+      /// @brief cache of gridding plans (shared between clones)
+      GriddingPlanCache::ShPtr itsPlanCache;
+
+      /// @brief gridding plan buffer used if no cache is set
+      /// @details It is kept as a data member to avoid reallocation for every accessor.
+      boost::shared_ptr<GriddingPlan> itsScratchPlan;
+
+      /// @brief number of accessors passed to generic since the last initialisation
+      /// @details It identifies the accessor within the iteration, as every pass of the
+      /// gridder over the data goes through the same sequence of accessors.
+      casa::uInt itsAccessorIndex;
+
+      /// @brief derive the gridding plan from the accessor metadata
+      /// @details This method does everything generic does before calling the gridding kernel,
+      /// except the index lookups, polarisation conversion and weighting.
+      /// @param[out] plan plan to fill (previous content is discarded)
+      /// @param[in] acc accessor to work with
+      /// @param[in] outUVW uvw rotated to the tangent point
+      /// @param[in] imageCentre direction of the image centre
+      void buildGriddingPlan(GriddingPlan &plan, const accessors::IConstDataAccessor &acc,
+                 const casa::Vector<casa::RigidVector<double, 3> > &outUVW,
+                 const casa::MVDirection &imageCentre);
+
+      /// @brief compute the key of the gridding plan in the cache
+      /// @details The accessor is identified by its position in the iteration together with a few
+      /// cheap invariants: dimensions, time, frequencies and their mapping to image channels, the
+      /// first and the last row, and the grid geometry. Flags and the remaining per-row metadata are
+      /// assumed to stay the same for all passes over the same iteration, they are not examined.
+      /// @param[in] acc accessor to work with
+      /// @param[in] outUVW uvw rotated to the tangent point
+      /// @param[in] imageCentre direction of the image centre
+      /// @param[in] tangentPoint tangent point
+      /// @return 64-bit fingerprint used as a key in the plan cache
+      casa::uInt64 planFingerprint(const accessors::IConstDataAccessor &acc,
+                 const casa::Vector<casa::RigidVector<double, 3> > &outUVW,
+                 const casa::MVDirection &imageCentre, const casa::MVDirection &tangentPoint) const;
+
       #ifdef _OPENMP
       /// @brief synchronisation mutex
       mutable boost::mutex itsMutex;
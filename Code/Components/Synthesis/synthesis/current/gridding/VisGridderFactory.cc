@@ -44,6 +44,9 @@ ASKAP_LOGGER(logger, ".gridding.visgridderfactory");
 #include <gridding/SnapShotImagingGridderAdapter.h>
 #include <gridding/SmearingGridderAdapter.h>
 #include <gridding/VisWeightsMultiFrequency.h>
+#include <gridding/GriddingPlanCache.h>
+#include <gridding/ConvFuncCache.h>
+#include <fft/FFTWrapper.h>
 #include <measurementequation/SynthesisParamsHelper.h>
 
 namespace askap {
@@ -182,6 +185,60 @@ IVisGridder::ShPtr VisGridderFactory::make(const LOFAR::ParameterSet &parset) {
         }
     }	
 
+    if (parset.isDefined("gridder.nthreads")) {
+        const int nThreads = parset.getInt32("gridder.nthreads");
+        ASKAPLOG_INFO_STR(logger, "Gridding will be done with "<<nThreads<<" thread(s)");
+        boost::shared_ptr<TableVisGridder> tvg = 
+            boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+        ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+                ") is incompatible with the nthreads option");
+        tvg->numberOfThreads(nThreads);
+    }
+
+    if (parset.getBool("gridder.plancache", false)) {
+        const float budget = parset.getFloat("gridder.plancache.budget", 1024.);
+        const std::string spillDir = parset.getString("gridder.plancache.spilldir", "");
+        ASKAPLOG_INFO_STR(logger, "Gridding plans will be cached between major cycles, memory budget = "<<
+                          budget<<" Mb"<<(spillDir == "" ? std::string(", no spilling") : 
+                          ", plans exceeding the budget will be spilled to "+spillDir));
+        ASKAPCHECK(budget >= 0., "gridder.plancache.budget should be non-negative, you have "<<budget);
+        boost::shared_ptr<TableVisGridder> tvg = 
+            boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+        ASKAPCHECK(tvg, "Gridder type ("<<parset.getString("gridder")<<
+                ") is incompatible with the plancache option");
+        tvg->setPlanCache(GriddingPlanCache::ShPtr(new GriddingPlanCache(size_t(budget * 1024. * 1024.), spillDir)));
+    }
+
+    if (parset.getBool("gridder.cfcache", false)) {
+        const float budget = parset.getFloat("gridder.cfcache.budget", 1024.);
+        const std::string dir = parset.getString("gridder.cfcache.dir", "");
+        ASKAPCHECK(budget >= 0., "gridder.cfcache.budget should be non-negative, you have "<<budget);
+        ASKAPLOG_INFO_STR(logger, "Convolution functions will be shared between gridders, memory budget = "<<
+                          budget<<" Mb"<<(dir == "" ? std::string("") : ", convolution functions will be kept in "+dir));
+        boost::shared_ptr<WProjectVisGridder> wpg = 
+            boost::dynamic_pointer_cast<WProjectVisGridder>(gridder);
+        ASKAPCHECK(wpg, "Gridder type ("<<parset.getString("gridder")<<
+                ") is incompatible with the cfcache option");
+        // all gridder parameters go into the fingerprint, this covers e.g. the illumination model
+        const LOFAR::ParameterSet gridderParset = parset.makeSubset(prefix);
+        casa::uInt64 configKey = GriddingPlanCache::hash(GriddingPlanCache::theirInitialHash,
+                                                         gridderName.data(), gridderName.size());
+        for (LOFAR::ParameterSet::const_iterator ci = gridderParset.begin(); ci != gridderParset.end(); ++ci) {
+             const std::string item = ci->first + "=" + gridderParset.getString(ci->first);
+             configKey = GriddingPlanCache::hash(configKey, item.data(), item.size());
+        }
+        wpg->setCFCache(ConvFuncCache::processCache(size_t(budget * 1024. * 1024.), dir), configKey);
+    }
+
+    if (parset.isDefined("gridder.fft.nthreads") || parset.isDefined("gridder.fft.plan") ||
+        parset.isDefined("gridder.fft.wisdom")) {
+        // this is a process-wide setting used by all subsequent transforms
+        const int nThreads = parset.getInt32("gridder.fft.nthreads", 1);
+        const std::string effort = parset.getString("gridder.fft.plan", "estimate");
+        const std::string wisdomFile = parset.getString("gridder.fft.wisdom", "");
+        scimath::configureFFT(nThreads, scimath::fftPlanEffort(effort), wisdomFile);
+    }
+
     // Initialize the Visibility Weights
     if (parset.getString("visweights","")=="MFS")
     {
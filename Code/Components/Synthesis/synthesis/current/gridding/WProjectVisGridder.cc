@@ -58,7 +58,8 @@ WProjectVisGridder::WProjectVisGridder(const double wmax,
                                        const float alpha) :
         WDependentGridderBase(wmax, nwplanes, alpha),
         itsMaxSupport(maxSupport), itsCutoff(cutoff), itsLimitSupport(limitSupport),
-        itsPlaneDependentCFSupport(false), itsOffsetSupportAllowed(false), itsCutoffAbs(false)
+        itsPlaneDependentCFSupport(false), itsOffsetSupportAllowed(false), itsCutoffAbs(false),
+        itsCFConfigKey(0)
 {
     ASKAPCHECK(overSample > 0, "Oversampling must be greater than 0");
     ASKAPCHECK(maxSupport > 0, "Maximum support must be greater than 0")
@@ -78,11 +79,11 @@ WProjectVisGridder::~WProjectVisGridder()
 /// @param[in] other input object
 WProjectVisGridder::WProjectVisGridder(const WProjectVisGridder &other) :
         IVisGridder(other), WDependentGridderBase(other),
-        itsCMap(other.itsCMap.copy()), itsMaxSupport(other.itsMaxSupport),
+        itsCMap(other.itsCMap.copy()), itsCFCache(other.itsCFCache), itsMaxSupport(other.itsMaxSupport),
         itsCutoff(other.itsCutoff), itsLimitSupport(other.itsLimitSupport),
         itsPlaneDependentCFSupport(other.itsPlaneDependentCFSupport),
         itsOffsetSupportAllowed(other.itsOffsetSupportAllowed),
-        itsCutoffAbs(other.itsCutoffAbs) {}
+        itsCutoffAbs(other.itsCutoffAbs), itsCFConfigKey(other.itsCFConfigKey) {}
 
 
 /// Clone a copy of this Gridder
@@ -199,8 +200,8 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
             for (int fracv = 0; fracv < itsOverSample; ++fracv) {
                 const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
                 ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
+                // a new matrix is assigned as the old one could be shared with the cache
+                itsConvFunc[plane].reference(casa::Matrix<casa::Complex>(cSize, cSize, casa::Complex(0.)));
                 // are fracu and fracv being correctly used here?
                 // I think they should be -ve, since the offset in nux & nuy is +ve.
                 const int ix = -float(fracu)/float(itsOverSample);
@@ -272,6 +273,18 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
     ASKAPDEBUGASSERT(thisPlane.ncolumn() == casa::uInt(ny));
 
     for (int iw = 0; iw < nWPlanes(); ++iw) {
+        // the common support is determined by the first plane (largest support as we have the largest w-term)
+        const int commonSupport = isSupportPlaneDependent() ? -1 : itsSupport;
+        const casa::uInt64 key = itsCFCache ? cfCacheKey(getWTerm(iw), commonSupport) : 0;
+        boost::shared_ptr<const ConvFuncCacheEntry> entry;
+        if (itsCFCache) {
+            entry = itsCFCache->find(key);
+        }
+        if (entry) {
+            useCFCacheEntry(*entry, iw);
+            continue;
+        }
+
         thisPlane.set(0.0);
 
         //const double w = isPSFGridder() ? 0. : 2.0f*casa::C::pi*getWTerm(iw);
@@ -308,21 +321,7 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
 
         // Now we have to calculate the Fourier transform to get the
         // convolution function in uv space
-        //casa::Matrix<casa::DComplex> buffer(thisPlane.nrow(),thisPlane.ncolumn());
-        //casa::convertArray<casa::DComplex,casa::Complex>(buffer,thisPlane);
         scimath::fft2d(thisPlane, true);
-        //scimath::fft2d(buffer, true);
-        //casa::convertArray<casa::Complex,casa::DComplex>(thisPlane,buffer);
-
-        /*
-            for (uint xx=0;xx<thisPlane.nrow();++xx) {
-             for (uint yy=0;yy<thisPlane.ncolumn();++yy) {
-                  ASKAPCHECK(!std::isinf(casa::abs(thisPlane(xx,yy))),
-                      "Infinite value detected for plane="<<iw<<
-                      " at "<<xx<<","<<yy<<" "<<thisPlane(xx,yy));
-                 }
-        }
-        */
 
         // Now thisPlane is filled with convolution function
         // sampled on a finer grid in u,v
@@ -342,30 +341,25 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
                        " - increase maxSupport or decrease overSample; support=" <<
                        support << " oversample=" << itsOverSample << " nx=" << nx);
             cfSupport.itsSize = limitSupportIfNecessary(support);
-
-            if (itsSupport == 0) {
-                itsSupport = cfSupport.itsSize;
-            }
-
-            if (isOffsetSupportAllowed()) {
-                setConvFuncOffset(iw, cfSupport.itsOffsetU, cfSupport.itsOffsetV);
-            }
-        
         }
 
-        ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
         // use either support determined for this particular plane or a generic one,
         // determined from the first plane (largest support as we have the largest w-term)
-        const int support = isSupportPlaneDependent() ? cfSupport.itsSize : itsSupport;
+        const int support = cfSupport.itsSize;
 
         const int cSize = 2 * support + 1;
 
+        boost::shared_ptr<ConvFuncCacheEntry> newEntry(new ConvFuncCacheEntry);
+        newEntry->itsSupport = support;
+        newEntry->itsOffsetU = cfSupport.itsOffsetU;
+        newEntry->itsOffsetV = cfSupport.itsOffsetV;
+        newEntry->itsPlanes.resize(itsOverSample * itsOverSample);
+
         for (int fracu = 0; fracu < itsOverSample; ++fracu) {
             for (int fracv = 0; fracv < itsOverSample; ++fracv) {
-                const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
-                ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
+                casa::Matrix<casa::Complex> &thisCF = newEntry->itsPlanes[fracu + itsOverSample * fracv];
+                thisCF.resize(cSize, cSize);
+                thisCF.set(0.0);
 
                 // Now cut out the inner part of the convolution function and
                 // insert it into the convolution function
@@ -374,43 +368,32 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
                         const int kx = (ix + cfSupport.itsOffsetU)*itsOverSample + fracu + nx / 2;
                         const int ky = (iy + cfSupport.itsOffsetV)*itsOverSample + fracv + ny / 2;
                         ASKAPDEBUGASSERT((ix + support >= 0) && (iy + support >= 0));
-                        ASKAPDEBUGASSERT(ix + support < int(itsConvFunc[plane].nrow()));
-                        ASKAPDEBUGASSERT(iy + support < int(itsConvFunc[plane].ncolumn()));
+                        ASKAPDEBUGASSERT(ix + support < int(thisCF.nrow()));
+                        ASKAPDEBUGASSERT(iy + support < int(thisCF.ncolumn()));
                         ASKAPDEBUGASSERT(kx >= 0);
                         ASKAPDEBUGASSERT(ky >= 0);
                         ASKAPDEBUGASSERT(kx < int(thisPlane.nrow()));
                         ASKAPDEBUGASSERT(ky < int(thisPlane.ncolumn()));
-                        //if (w < 0) {
-                        //    itsConvFunc[plane](ix + support, iy + support) =
-                        //        conj(thisPlane((ix + cfSupport.itsOffsetU) * itsOverSample + fracu + nx / 2,
-                        //              (iy + cfSupport.itsOffsetV) * itsOverSample + fracv + ny / 2));
-                        //} else {
-                        itsConvFunc[plane](ix + support, iy + support) = thisPlane(kx, ky);
-                        //}
+                        thisCF(ix + support, iy + support) = thisPlane(kx, ky);
                     }
                 }
 
+                // force normalization for all fractional offsets (or planes)
+                const double norm = sum(casa::real(thisCF));
+                ASKAPDEBUGASSERT(norm > 0.);
+
+                if (norm > 0.) {
+                    const casa::Complex invNorm = casa::Complex(1.0/norm);
+                    thisCF *= invNorm;
+                }
             } // for fracv
         } // for fracu
 
-    } // for iw
-
-    // force normalization for all fractional offsets (or planes)
-    for (size_t plane = 0; plane < itsConvFunc.size(); ++plane) {
-        if (itsConvFunc[plane].nelements() == 0) {
-            // this plane of the cache is unused
-            continue;
-        }
-
-        const double norm = sum(casa::real(itsConvFunc[plane]));
-        // ASKAPLOG_INFO_STR(logger, "Sum of convolution function = " << norm);
-        ASKAPDEBUGASSERT(norm > 0.);
-
-        if (norm > 0.) {
-            const casa::Complex invNorm = casa::Complex(1.0/norm);
-            itsConvFunc[plane] *= invNorm;
+        if (itsCFCache) {
+            itsCFCache->add(key, newEntry);
         }
-    } // for plane
+        useCFCacheEntry(*newEntry, iw);
+    } // for iw
 
     if (isSupportPlaneDependent()) {
         ASKAPLOG_DEBUG_STR(logger, "Convolution function cache has " << itsConvFunc.size() << " planes");
@@ -431,6 +414,66 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
     itsCFBuffer.reset();
 }
 
+/// @brief set the cache of convolution functions
+/// @details If the cache is set, convolution functions are looked up in the cache
+/// before they are computed and new ones are added to it. Gridders sharing the cache
+/// (e.g. the image, PSF and preconditioner gridders, clones for different Taylor terms
+/// or gridders created for different channels) then share the same planes in memory.
+/// @param[in] cache shared pointer to the cache, an empty pointer disables caching (default)
+/// @param[in] configKey fingerprint of the gridder configuration not known to this class
+/// (e.g. illumination parameters)
+void WProjectVisGridder::setCFCache(const ConvFuncCache::ShPtr &cache, const casa::uInt64 configKey)
+{
+    itsCFCache = cache;
+    itsCFConfigKey = configKey;
+}
+
+/// @brief fingerprint of a w-plane of convolution functions
+/// @details The fingerprint covers all gridder parameters which affect the convolution
+/// function, the grid geometry, the w-term and the support. Derived classes can extend it
+/// with additional dependencies (see GriddingPlanCache::hash).
+/// @param[in] wTerm w-term of the plane
+/// @param[in] support common support used to cut the plane (0 if not yet known,
+/// negative if the support is searched for every plane)
+/// @return fingerprint to be used with the cache of convolution functions
+casa::uInt64 WProjectVisGridder::cfCacheKey(const double wTerm, const int support) const
+{
+    ASKAPDEBUGASSERT(itsShape.nelements() >= 2);
+    ASKAPDEBUGASSERT(itsUVCellSize.nelements() >= 2);
+    const int intParams[9] = {int(itsShape(0)), int(itsShape(1)), itsOverSample, itsMaxSupport,
+                              itsLimitSupport, int(itsPlaneDependentCFSupport),
+                              int(itsOffsetSupportAllowed), int(itsCutoffAbs), support};
+    const double doubleParams[4] = {itsUVCellSize(0), itsUVCellSize(1), itsCutoff, wTerm};
+    casa::uInt64 key = GriddingPlanCache::hash(GriddingPlanCache::theirInitialHash,
+                                               &itsCFConfigKey, sizeof(itsCFConfigKey));
+    key = GriddingPlanCache::hash(key, intParams, sizeof(intParams));
+    return GriddingPlanCache::hash(key, doubleParams, sizeof(doubleParams));
+}
+
+/// @brief use convolution functions of one w-plane
+/// @details The oversampled planes are referenced (not copied) in itsConvFunc. The
+/// common support and the offsets are set up from the entry as necessary.
+/// @param[in] entry convolution functions and their support
+/// @param[in] zIndex index of the plane before oversampling
+void WProjectVisGridder::useCFCacheEntry(const ConvFuncCacheEntry &entry, const int zIndex)
+{
+    ASKAPCHECK(int(entry.itsPlanes.size()) == itsOverSample * itsOverSample,
+               "Cached convolution function has "<<entry.itsPlanes.size()<<
+               " oversampled planes, oversampling factor is "<<itsOverSample);
+    if (itsSupport == 0) {
+        itsSupport = entry.itsSupport;
+    }
+    if (isOffsetSupportAllowed()) {
+        setConvFuncOffset(zIndex, entry.itsOffsetU, entry.itsOffsetV);
+    }
+    ASKAPCHECK(itsConvFunc.size() > 0, "Convolution function not sized correctly");
+    for (size_t plane = 0; plane < entry.itsPlanes.size(); ++plane) {
+         const size_t index = plane + entry.itsPlanes.size() * zIndex;
+         ASKAPDEBUGASSERT(index < itsConvFunc.size());
+         itsConvFunc[index].reference(entry.itsPlanes[plane]);
+    }
+}
+
 /// @brief search for support parameters
 /// @details This method encapsulates support search operation, taking into account the
 /// cutoff parameter and whether or not an offset is allowed.
@@ -31,6 +31,7 @@
 
 // ASKAPsoft includes
 #include <gridding/WDependentGridderBase.h>
+#include <gridding/ConvFuncCache.h>
 
 // Local package includes
 #include <dataaccess/IConstDataAccessor.h>
@@ -98,6 +99,16 @@ namespace askap
                 /// @return a shared pointer to the gridder instance					 
                 static IVisGridder::ShPtr createGridder(const LOFAR::ParameterSet& parset);
 
+                /// @brief set the cache of convolution functions
+                /// @details If the cache is set, convolution functions are looked up in the cache
+                /// before they are computed and new ones are added to it. Gridders sharing the cache
+                /// (e.g. the image, PSF and preconditioner gridders, clones for different Taylor terms
+                /// or gridders created for different channels) then share the same planes in memory.
+                /// @param[in] cache shared pointer to the cache, an empty pointer disables caching (default)
+                /// @param[in] configKey fingerprint of the gridder configuration not known to this class
+                /// (e.g. illumination parameters)
+                void setCFCache(const ConvFuncCache::ShPtr &cache, const casa::uInt64 configKey = 0);
+
             protected:
                 /// @brief additional operations to configure gridder
                 /// @details This method is supposed to be called from createGridder and could be
@@ -191,6 +202,26 @@ namespace askap
                 /// Mapping from row, pol, and channel to planes of convolution function
                 casa::Cube<int> itsCMap;
 
+                /// @brief fingerprint of a w-plane of convolution functions
+                /// @details The fingerprint covers all gridder parameters which affect the convolution
+                /// function, the grid geometry, the w-term and the support. Derived classes can extend it
+                /// with additional dependencies (see GriddingPlanCache::hash).
+                /// @param[in] wTerm w-term of the plane
+                /// @param[in] support common support used to cut the plane (0 if not yet known,
+                /// negative if the support is searched for every plane)
+                /// @return fingerprint to be used with the cache of convolution functions
+                casa::uInt64 cfCacheKey(const double wTerm, const int support) const;
+
+                /// @brief use convolution functions of one w-plane
+                /// @details The oversampled planes are referenced (not copied) in itsConvFunc. The
+                /// common support and the offsets are set up from the entry as necessary.
+                /// @param[in] entry convolution functions and their support
+                /// @param[in] zIndex index of the plane before oversampling
+                void useCFCacheEntry(const ConvFuncCacheEntry &entry, const int zIndex);
+
+                /// @brief cache of convolution functions (shared between gridders, may be empty)
+                ConvFuncCache::ShPtr itsCFCache;
+
                 /// @brief obtain absolute cutoff flag
                 /// @return true if itsCutoff is an absolute cutoff rather than relative to the peak
                 inline bool isCutoffAbsolute() const { return itsCutoffAbs;}
@@ -234,6 +265,9 @@ namespace askap
 
                 /// @brief itsCutoff is an absolute cutoff, rather than relative to the peak of a particular CF plane
                 bool itsCutoffAbs;       
+
+                /// @brief fingerprint of the configuration passed to setCFCache
+                casa::uInt64 itsCFConfigKey;
         };
     }
 }
@@ -230,7 +230,6 @@ namespace askap
       for (vector<string>::const_iterator it=completions.begin();it!=completions.end();it++)
       {
         string imageName("image"+(*it));
-        SynthesisParamsHelper::clipImage(parameters(),imageName);
 
         if(itsModelGridders.count(imageName)==0) {
           itsModelGridders[imageName]=itsGridder->clone();
@@ -241,6 +240,8 @@ namespace askap
             ASKAPLOG_DEBUG_STR(logger, "Degridding image "<<imageName);
             const Axes axes(parameters().axes(imageName));
             casa::Array<double> imagePixels(parameters().value(imageName).copy());
+            // the model may be shared with other processes, clip the copy only
+            SynthesisParamsHelper::clipImage(axes, imagePixels);
             const casa::IPosition imageShape(imagePixels.shape());
             itsModelGridders[imageName]->initialiseDegrid(axes, imagePixels);
         }              
@@ -311,7 +312,6 @@ namespace askap
       for (vector<string>::const_iterator it=completions.begin();it!=completions.end();it++)
       {
         const string imageName("image"+(*it));
-        SynthesisParamsHelper::clipImage(parameters(),imageName);
         if(itsModelGridders.count(imageName)==0) {
            itsModelGridders[imageName]=itsGridder->clone();
         }
@@ -352,6 +352,8 @@ namespace askap
         string imageName("image"+(*it));
         const Axes axes(parameters().axes(imageName));
         casa::Array<double> imagePixels(parameters().value(imageName).copy());
+        // the model may be shared with other processes, clip the copy only
+        SynthesisParamsHelper::clipImage(axes, imagePixels);
         const casa::IPosition imageShape(imagePixels.shape());
         /// First the model
         itsModelGridders[imageName]->customiseForContext(*it);
@@ -409,16 +409,26 @@ namespace askap
     /// along the directional axes.
     /// @param[in] ip parameters
     /// @param[in] name full name of the image (i.e. with .facet.x.y for facets)
-    void SynthesisParamsHelper::clipImage(const askap::scimath::Params &ip, const string &name)
+    void SynthesisParamsHelper::clipImage(askap::scimath::Params &ip, const string &name)
+    {
+       // non-const access rejects parameters referring to shared storage
+       casa::Array<double> &pixels = ip.value(name);
+       clipImage(ip.axes(name), pixels);
+    }
+
+    /// @brief helper method to clip the outer edges of the image
+    /// @details This version of the method works with the given array, e.g. a copy of
+    /// the model image, which can be clipped without changing the model itself.
+    /// @param[in] axes axes of the image
+    /// @param[in,out] pixels image to clip in situ
+    void SynthesisParamsHelper::clipImage(const askap::scimath::Axes &axes, casa::Array<double> &pixels)
     {
-       const askap::scimath::Axes axes(ip.axes(name));
        if (!axes.has("FACETSTEP")) {
            // it is not a facet image, do nothing.
            return;
        }
        const int facetStep = int(axes.start("FACETSTEP"));
        ASKAPDEBUGASSERT(facetStep>0);
-       casa::Array<double> pixels = ip.value(name);
        const casa::IPosition shape = pixels.shape();
        ASKAPDEBUGASSERT(shape.nelements()>=2);
        casa::IPosition end(shape);
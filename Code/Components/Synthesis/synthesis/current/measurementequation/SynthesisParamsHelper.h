@@ -203,7 +203,14 @@ namespace askap
         /// along the directional axes.
         /// @param[in] ip parameters
         /// @param[in] name full name of the image (i.e. with .facet.x.y for facets)
-        static void clipImage(const askap::scimath::Params &ip, const string &name);
+        static void clipImage(askap::scimath::Params &ip, const string &name);
+
+        /// @brief helper method to clip the outer edges of the image
+        /// @details This version of the method works with the given array, e.g. a copy of
+        /// the model image, which can be clipped without changing the model itself.
+        /// @param[in] axes axes of the image
+        /// @param[in,out] pixels image to clip in situ
+        static void clipImage(const askap::scimath::Axes &axes, casa::Array<double> &pixels);
         
         
         /// @brief helper method to store restoring beam for an image
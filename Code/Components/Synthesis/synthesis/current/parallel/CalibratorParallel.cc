@@ -60,6 +60,7 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <dataaccess/TableDataSource.h>
 #include <dataaccess/ParsetInterface.h>
 #include <dataaccess/TimeChunkIteratorAdapter.h>
+#include <dataaccess/PrefetchingDataIterator.h>
 
 #include <fitting/LinearSolver.h>
 #include <fitting/GenericNormalEquations.h>
@@ -308,7 +309,13 @@ void CalibratorParallel::calcOne(const std::string& ms, bool discard)
           // ensure that time is counted in seconds since 0 MJD
           conv->setEpochFrame();
           //IDataSharedIter it=ds.createIterator(sel, conv);
-          itsIteratorAdapter.reset(new accessors::TimeChunkIteratorAdapter(ds.createIterator(sel, conv), itsSolutionInterval));
+          boost::shared_ptr<accessors::IConstDataIterator> dataIt = ds.createIterator(sel, conv);
+          if (prefetchChunks() > 0) {
+              // calibration only reads the data, so chunks can be read ahead in a separate thread
+              dataIt.reset(new accessors::PrefetchingDataIterator(dataIt, prefetchChunks(),
+                                uvwMachineCacheSize(), uvwMachineCacheTolerance()));
+          }
+          itsIteratorAdapter.reset(new accessors::TimeChunkIteratorAdapter(dataIt, itsSolutionInterval));
           if (itsSolutionInterval >= 0) {
               ASKAPLOG_INFO_STR(logger, "Iterator has been created, solution interval = "<<itsSolutionInterval<<" s");
           } else {
@@ -47,6 +47,8 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <dataaccess/DataAccessError.h>
 #include <dataaccess/TableDataSource.h>
 #include <dataaccess/ParsetInterface.h>
+#include <dataaccess/PrefetchingDataIterator.h>
+#include <dataaccess/DataIteratorAdapter.h>
 
 #include <measurementequation/ImageFFTEquation.h>
 #include <measurementequation/SynthesisParamsHelper.h>
@@ -479,7 +481,16 @@ namespace askap
         // ensure that time is counted in seconds since 0 MJD
         conv->setEpochFrame();
 
-        IDataSharedIter it=ds.createIterator(sel, conv);
+        IDataSharedIter it;
+        if (prefetchChunks() > 0) {
+            // the equation only reads the data, so chunks can be read ahead in a separate thread
+            const boost::shared_ptr<IConstDataIterator> prefetchIt(
+                 new PrefetchingDataIterator(ds.createIterator(sel, conv), prefetchChunks(),
+                              uvwMachineCacheSize(), uvwMachineCacheTolerance()));
+            it = IDataSharedIter(new DataIteratorAdapter(prefetchIt));
+        } else {
+            it = ds.createIterator(sel, conv);
+        }
         ASKAPCHECK(itsModel, "Model not defined");
         ASKAPCHECK(gridder(), "Gridder not defined");
         if (!itsSolutionSource) {
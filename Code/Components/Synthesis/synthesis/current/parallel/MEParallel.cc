@@ -39,6 +39,9 @@
 
 // System includes
 #include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
 
 // Askapsoft includes
 #include <askap/AskapLogging.h>
@@ -48,6 +51,9 @@
 #include <askapparallel/BlobOBufMW.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOBufString.h>
 #include <Common/ParameterSet.h>
 #include <fitting/Equation.h>
 #include <fitting/Solver.h>
@@ -67,10 +73,25 @@ namespace askap {
 namespace synthesis {
 
 MEParallel::MEParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
-        SynParallel(comms, parset)
+        SynParallel(comms, parset), itsCollectiveReduction(false),
+        itsReductionChunkSize(1048576), itsReductionMaxPending(4)
 {
     itsSolver = Solver::ShPtr(new Solver);
     itsNe = ImagingNormalEquations::ShPtr(new ImagingNormalEquations(*itsModel));
+
+    const std::string reduction = parset.getString("nereduction", "tree");
+    ASKAPCHECK((reduction == "tree") || (reduction == "collective"),
+               "nereduction should be either tree or collective, you have "<<reduction);
+    itsCollectiveReduction = (reduction == "collective");
+    if (itsCollectiveReduction) {
+        const int chunkSize = parset.getInt32("nereduction.chunksize", 1048576);
+        ASKAPCHECK(chunkSize > 0, "nereduction.chunksize should be positive, you have "<<chunkSize);
+        itsReductionChunkSize = size_t(chunkSize);
+        itsReductionMaxPending = parset.getUint("nereduction.npending", 4);
+        ASKAPCHECK(itsReductionMaxPending > 0, "nereduction.npending should be positive");
+        ASKAPLOG_INFO_STR(logger, "Normal equations will be summed with collective reductions in chunks of "<<
+                          itsReductionChunkSize<<" elements, up to "<<itsReductionMaxPending<<" chunks in flight");
+    }
 }
 
 MEParallel::~MEParallel()
@@ -141,6 +162,10 @@ void MEParallel::receiveNE()
  */ 
 void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
 {
+    if (itsCollectiveReduction && reduceNECollective(ne)) {
+        return;
+    }
+
     // Number of processes in the reduction
     const int nProcs = itsComms.nProcs();
 
@@ -193,6 +218,75 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
     }
 }
 
+bool MEParallel::reduceNECollective(const askap::scimath::INormalEquations::ShPtr &ne)
+{
+    ASKAPDEBUGTRACE("MEParallel::reduceNECollective");
+
+    const int nProcs = itsComms.nProcs();
+    const int rank = itsComms.rank();
+    if (nProcs < 2) {
+        return true;
+    }
+    casa::Timer timer;
+    timer.mark();
+
+    // all ranks have to agree on the reduction method, the collective reduction
+    // is only implemented for imaging normal equations
+    ImagingNormalEquations *imagingNE = dynamic_cast<ImagingNormalEquations*>(ne.get());
+    bool unsupported = (imagingNE == 0);
+    itsComms.aggregateFlag(unsupported, 0);
+    if (unsupported) {
+        ASKAPLOG_DEBUG_STR(logger, "Collective reduction is not supported for these normal equations");
+        return false;
+    }
+
+    // the master usually has no data, so the layout is taken from the first worker
+    const int layoutSource = 1;
+    LOFAR::BlobString bs;
+    bs.resize(0);
+    if (rank == layoutSource) {
+        LOFAR::BlobOBufString bob(bs);
+        LOFAR::BlobOStream out(bob);
+        imagingNE->writeLayoutToBlob(out);
+    }
+    // the tree reduction works with the default communicator, do the same here
+    // (broadcastBlob may be configured for a group of workers)
+    unsigned long size = bs.size();
+    itsComms.broadcast(&size, sizeof(unsigned long), layoutSource, 0);
+    bs.resize(size);
+    itsComms.broadcast(bs.data(), size, layoutSource, 0);
+
+    bool mismatch = false;
+    if (rank != layoutSource) {
+        LOFAR::BlobIBufString bib(bs);
+        LOFAR::BlobIStream in(bib);
+        mismatch = !imagingNE->matchLayoutFromBlob(in, false);
+    }
+    itsComms.aggregateFlag(mismatch, 0);
+    if (mismatch) {
+        ASKAPLOG_INFO_STR(logger, "Layout of normal equations differs between ranks, using the tree reduction");
+        return false;
+    }
+    if (rank != layoutSource) {
+        // this sets up zero vectors if this rank has no data
+        LOFAR::BlobIBufString bib(bs);
+        LOFAR::BlobIStream in(bib);
+        ASKAPCHECK(imagingNE->matchLayoutFromBlob(in, true), "Unable to set up the layout of normal equations");
+    }
+
+    std::vector<std::pair<double*, size_t> > buffers;
+    imagingNE->contiguousBuffers(buffers);
+    size_t nElements = 0;
+    for (std::vector<std::pair<double*, size_t> >::const_iterator ci = buffers.begin();
+         ci != buffers.end(); ++ci) {
+         itsComms.sumToRoot(ci->first, ci->second, 0, itsReductionChunkSize, itsReductionMaxPending);
+         nElements += ci->second;
+    }
+    ASKAPLOG_DEBUG_STR(logger, "Summed "<<buffers.size()<<" vectors ("<<nElements<<
+                       " elements) of normal equations in "<<timer.real()<<" seconds");
+    return true;
+}
+
 void MEParallel::sendNormalEquations(const askap::scimath::INormalEquations::ShPtr ne, int dest)
 {
     ASKAPDEBUGTRACE("MEParallel::sendNormalEquations");
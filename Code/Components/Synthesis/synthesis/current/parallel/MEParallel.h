@@ -127,6 +127,11 @@ namespace askap
 
                 /// @brief Perform a reduction for normal equations from all
                 /// workers to the master.
+                /// @details By default, normal equations are serialised and merged
+                /// along a binary tree. If the collective reduction is selected in the
+                /// parset (nereduction = collective) and all ranks hold imaging normal
+                /// equations with the same layout, the vectors are summed in place with
+                /// chunked MPI reductions instead (see reduceNECollective).
                 void reduceNE(askap::scimath::INormalEquations::ShPtr ne);
 
 			protected:
@@ -142,6 +147,18 @@ namespace askap
                 // @return a shared pointer, pointing to the received normal equations
                 askap::scimath::INormalEquations::ShPtr receiveNormalEquations(int source);
 
+                /// @brief reduce normal equations by summing raw vectors to the master
+                /// @details The layout of the normal equations (shapes, coordinate systems,
+                /// vector lengths) is broadcast once from the first worker and checked by all
+                /// ranks. Ranks without data (e.g. the master) adopt this layout. If all
+                /// layouts match, the vectors are summed element by element to rank 0 with
+                /// chunked non-blocking reductions, which is equivalent to merge but
+                /// avoids serialisation and the serial stages of the tree. Otherwise,
+                /// nothing is done and the tree reduction has to be used.
+                /// @param[in] ne normal equations to reduce (the result is on rank 0)
+                /// @return true, if the reduction has been done
+                bool reduceNECollective(const askap::scimath::INormalEquations::ShPtr &ne);
+
 				/// Holder for the normal equations
 				askap::scimath::INormalEquations::ShPtr itsNe;
 
@@ -150,6 +167,16 @@ namespace askap
 				
 				/// Holder for the equation
 				askap::scimath::Equation::ShPtr itsEquation;
+
+			private:
+				/// @brief true, if the collective reduction of normal equations is requested
+				bool itsCollectiveReduction;
+
+				/// @brief number of elements summed in one collective reduction call
+				size_t itsReductionChunkSize;
+
+				/// @brief maximum number of outstanding chunk reductions
+				unsigned int itsReductionMaxPending;
 		};
 
 	}
@@ -53,7 +53,8 @@ using namespace askap::synthesis;
 /// @param[in] parset parameter set
 MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
    MEParallel(comms,parset),
-   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6)
+   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6),
+   itsPrefetchChunks(0)
 {
    // set up image handler, needed for both master and worker
    SynthesisParamsHelper::setUpImageHandler(parset);
@@ -105,6 +106,13 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
        ASKAPLOG_DEBUG_STR(logger, "Tolerance on the directions is "<<
            itsUVWMachineCacheTolerance/casa::C::pi*180.*3600.<<" arcsec");
 
+       // number of iteration chunks read ahead in a background thread (0 - no prefetching)
+       itsPrefetchChunks = parset.getUint("nPrefetchChunks", 0);
+       if (itsPrefetchChunks > 0) {
+           ASKAPLOG_INFO_STR(logger, "Up to "<<itsPrefetchChunks<<
+               " iteration chunks will be read ahead in a separate thread");
+       }
+
        // Create the gridder using a factory acting on a parameterset
        itsGridder = createGridder(comms, parset);
        ASKAPCHECK(itsGridder, "Gridder is not defined correctly");
@@ -83,6 +83,12 @@ protected:
    /// @details to be used in derived classes
    /// @return direction tolerance (in radians) for uvw machine cache
    inline double uvwMachineCacheTolerance() const { return itsUVWMachineCacheTolerance; }
+
+   /// @brief number of iteration chunks to prefetch
+   /// @details If positive, data are read ahead in a separate thread. The value
+   /// is the maximum number of chunks read in advance (0 means no prefetching).
+   /// @return number of chunks to prefetch
+   inline casa::uInt prefetchChunks() const { return itsPrefetchChunks; }
    
    /// @brief obtain gridder
    /// @details to be used in derived classes
@@ -113,6 +119,9 @@ private:
    /// @brief direction tolerance (in radians) for uvw machine cache
    double itsUVWMachineCacheTolerance;
 
+   /// @brief number of iteration chunks to prefetch (0 - no prefetching)
+   casa::uInt itsPrefetchChunks;
+
    /// @brief gridder to be used
    IVisGridder::ShPtr itsGridder;		    			  	
 }; 
@@ -33,6 +33,7 @@
 
 // Include own header file first
 #include <parallel/SynParallel.h>
+#include <fitting/Axes.h>
 
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <measurementequation/ImageParamsHelper.h>
@@ -53,6 +54,8 @@
 #include <Blob/BlobOBufString.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+#include <Blob/BlobSTL.h>
+#include <Blob/BlobArray.h>
 
 #include <casacore/casa/OS/Timer.h>
 #include <casacore/casa/Utilities/Regex.h>
@@ -77,11 +80,24 @@ namespace askap
   {
 
     SynParallel::SynParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) : 
-                         itsComms(comms), itsParset(parset)
+                         itsComms(comms), itsParset(parset), itsSharedModel(false),
+                         itsSharedModelReady(false), itsNodeLeadersComm(0), itsNodeWorkersComm(0),
+                         itsNodeLeader(false), itsSharedModelStorage(0), itsSharedModelStorageSize(0)
     {
       itsModel.reset(new Params());
       ASKAPCHECK(itsModel, "Model not defined correctly");
 
+      // one copy of the model per node instead of one copy per worker
+      itsSharedModel = parset.getBool("sharedmodel", false);
+      if (itsSharedModel && itsComms.isParallel()) {
+          if (itsComms.nGroups() > 1) {
+              ASKAPLOG_WARN_STR(logger, "The shared model is not supported with groups of workers, "
+                                "each worker will keep its own copy of the model");
+          } else {
+              ASKAPLOG_INFO_STR(logger, "Workers on the same node will share a single copy of the model");
+          }
+      }
+
       // setup frequency frame
       const std::string freqFrame = parset.getString("freqframe","topo");
       if (freqFrame == "topo") {
@@ -279,7 +295,13 @@ namespace askap
         out.putStart("model", 1);
         out << model;
         out.putEnd();
-        itsComms.broadcastBlob(bs ,0);
+        if (useSharedModel()) {
+            // only one worker per node receives the model
+            setupSharedModel();
+            broadcastBlobString(bs, 0, itsNodeLeadersComm);
+        } else {
+            itsComms.broadcastBlob(bs ,0);
+        }
     }
 
     /// @brief actual implementation of the model receive
@@ -292,6 +314,10 @@ namespace askap
         ASKAPDEBUGTRACE("SynParallel::receiveModelImpl");
 
         ASKAPDEBUGASSERT(itsComms.isParallel() && itsComms.isWorker());
+        if (useSharedModel()) {
+            receiveSharedModel(model);
+            return;
+        }
         LOFAR::BlobString bs;
         bs.resize(0);
         itsComms.broadcastBlob(bs, 0);
@@ -303,6 +329,154 @@ namespace askap
         in.getEnd();
     }
     
+    /// @brief check whether the model is shared between workers on the same node
+    /// @return true, if the shared-memory model broadcast is in use
+    bool SynParallel::useSharedModel() const
+    {
+        return itsSharedModel && itsComms.isParallel() && (itsComms.nGroups() == 1);
+    }
+
+    /// @brief set up communicators for the shared-memory model broadcast
+    /// @details This is a collective operation for all ranks. It is done on
+    /// the first broadcast (master) or receive (workers) of the model. One worker
+    /// per node (node leader) receives the model from the master and exposes it
+    /// to other workers on the same node via shared memory.
+    void SynParallel::setupSharedModel()
+    {
+        if (itsSharedModelReady) {
+            return;
+        }
+        ASKAPDEBUGASSERT(itsComms.isParallel());
+        const int rank = itsComms.rank();
+        const size_t nodeComm = itsComms.createSharedMemoryComm(0);
+        // the master doesn't need a shared copy, split it off the workers on its node
+        itsNodeWorkersComm = itsComms.splitComm(itsComms.isWorker() ? 1 : 0, rank, nodeComm);
+        itsNodeLeader = itsComms.isWorker() && (itsComms.rank(itsNodeWorkersComm) == 0);
+        // ordering by the global rank ensures the master is the root (rank 0) of this communicator
+        itsNodeLeadersComm = itsComms.splitComm((itsComms.isMaster() || itsNodeLeader) ? 0 : 1, rank, 0);
+        if (itsComms.isMaster()) {
+            ASKAPLOG_INFO_STR(logger, "The model will be sent to "<<itsComms.nProcs(itsNodeLeadersComm) - 1<<
+                              " node leader(s) and shared with other workers on the same node");
+        } else if (itsNodeLeader) {
+            ASKAPLOG_INFO_STR(logger, "This worker receives the model for "<<
+                              itsComms.nProcs(itsNodeWorkersComm)<<" worker(s) on node "<<itsComms.nodeName());
+        }
+        itsSharedModelReady = true;
+    }
+
+    /// @brief receive the model into shared memory
+    /// @details The node leader receives the model from the master and copies
+    /// values into the memory shared by all workers on the node. All workers then
+    /// set up the model to refer to this memory without copying.
+    /// @param[in] model the model to fill
+    void SynParallel::receiveSharedModel(scimath::Params &model)
+    {
+        ASKAPDEBUGTRACE("SynParallel::receiveSharedModel");
+        setupSharedModel();
+
+        // the layout is everything except the values
+        LOFAR::BlobString layout;
+        layout.resize(0);
+        scimath::Params received;
+        if (itsNodeLeader) {
+            LOFAR::BlobString bs;
+            bs.resize(0);
+            broadcastBlobString(bs, 0, itsNodeLeadersComm);
+            {
+              LOFAR::BlobIBufString bib(bs);
+              LOFAR::BlobIStream in(bib);
+              const int version = in.getStart("model");
+              ASKAPASSERT(version == 1);
+              in >> received;
+              in.getEnd();
+            }
+            LOFAR::BlobOBufString bob(layout);
+            LOFAR::BlobOStream out(bob);
+            out.putStart("sharedmodel", 1);
+            const std::vector<std::string> names = received.names();
+            out << names;
+            for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+                 out << received.axes(*ci) << received.isFree(*ci) << received.value(*ci).shape();
+            }
+            out.putEnd();
+        }
+        broadcastBlobString(layout, 0, itsNodeWorkersComm);
+
+        std::vector<std::string> names;
+        std::vector<scimath::Axes> axes;
+        std::vector<bool> freeFlags;
+        std::vector<casa::IPosition> shapes;
+        {
+          LOFAR::BlobIBufString bib(layout);
+          LOFAR::BlobIStream in(bib);
+          const int version = in.getStart("sharedmodel");
+          ASKAPASSERT(version == 1);
+          in >> names;
+          axes.resize(names.size());
+          freeFlags.resize(names.size());
+          shapes.resize(names.size());
+          for (size_t i = 0; i < names.size(); ++i) {
+               bool isFree = true;
+               in >> axes[i] >> isFree >> shapes[i];
+               freeFlags[i] = isFree;
+          }
+          in.getEnd();
+        }
+        std::vector<size_t> offsets(names.size(), 0);
+        size_t nElements = 0;
+        for (size_t i = 0; i < names.size(); ++i) {
+             offsets[i] = nElements;
+             nElements += size_t(shapes[i].product());
+        }
+
+        double *oldStorage = 0;
+        if ((itsSharedModelStorage == 0) || (nElements > itsSharedModelStorageSize)) {
+            oldStorage = itsSharedModelStorage;
+            itsSharedModelStorage = static_cast<double*>(itsComms.allocateSharedMemory(
+                     std::max(nElements, size_t(1)) * sizeof(double), itsNodeWorkersComm));
+            itsSharedModelStorageSize = nElements;
+        } else {
+            // the storage is reused, other workers may still read the current model
+            itsComms.barrier(itsNodeWorkersComm);
+        }
+        ASKAPDEBUGASSERT(itsSharedModelStorage);
+
+        if (itsNodeLeader) {
+            for (size_t i = 0; i < names.size(); ++i) {
+                 if (shapes[i].product() > 0) {
+                     casa::Array<double> dest(shapes[i], itsSharedModelStorage + offsets[i], casa::SHARE);
+                     dest = received.value(names[i]);
+                 }
+            }
+            received.reset();
+        }
+        itsComms.syncSharedMemory(itsSharedModelStorage, itsNodeWorkersComm);
+
+        // the model refers to the shared memory, no copy is made
+        model.reset();
+        for (size_t i = 0; i < names.size(); ++i) {
+             const casa::Array<double> value(shapes[i], itsSharedModelStorage + offsets[i], casa::SHARE);
+             model.share(names[i], value, axes[i], freeFlags[i]);
+        }
+        if (oldStorage != 0) {
+            // the model refers to the new storage now, copies of the model (e.g. held by
+            // the measurement equation) are re-referenced by setParameters before use
+            itsComms.freeSharedMemory(oldStorage);
+        }
+    }
+
+    /// @brief broadcast a blob string using the given communicator
+    /// @param[in,out] bs blob string (resized as needed on ranks other than the root)
+    /// @param[in] root rank of the root process in the given communicator
+    /// @param[in] comm communicator index
+    void SynParallel::broadcastBlobString(LOFAR::BlobString &bs, int root, size_t comm)
+    {
+        unsigned long size = (itsComms.rank(comm) == root) ? bs.size() : 0;
+        itsComms.broadcast(&size, sizeof(unsigned long), root, comm);
+        bs.resize(size);
+        itsComms.broadcast(bs.data(), size, root, comm);
+    }
+
     /// @brief helper method to identify model parameters to broadcast
     /// @details We use itsModel to buffer some derived images like psf, weights, etc
     /// which are not required for prediffers. It just wastes memory and CPU time if
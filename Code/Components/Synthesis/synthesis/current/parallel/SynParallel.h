@@ -38,6 +38,7 @@
 
 
 #include <askapparallel/AskapParallel.h>
+#include <Blob/BlobString.h>
 #include <casacore/measures/Measures/MFrequency.h>
 
 namespace askap
@@ -109,6 +110,10 @@ namespace askap
       /// broadcastModelImpl and receiveModelImpl.
       /// @param[in] model the model to fill
       void receiveModelImpl(scimath::Params &model);
+
+      /// @brief check whether the model is shared between workers on the same node
+      /// @return true, if the shared-memory model broadcast is in use
+      bool useSharedModel() const;
       
       
       /// @brief obtain parameter set
@@ -141,8 +146,49 @@ namespace askap
       static IVisGridder::ShPtr createGridder(const askap::askapparallel::AskapParallel& comms, 
                            const LOFAR::ParameterSet& parset);
   private:
+      /// @brief set up communicators for the shared-memory model broadcast
+      /// @details This is a collective operation for all ranks. It is done on
+      /// the first broadcast (master) or receive (workers) of the model. One worker
+      /// per node (node leader) receives the model from the master and exposes it
+      /// to other workers on the same node via shared memory.
+      void setupSharedModel();
+
+      /// @brief receive the model into shared memory
+      /// @details The node leader receives the model from the master and copies
+      /// values into the memory shared by all workers on the node. All workers then
+      /// set up the model to refer to this memory without copying.
+      /// @param[in] model the model to fill
+      void receiveSharedModel(scimath::Params &model);
+
+      /// @brief broadcast a blob string using the given communicator
+      /// @param[in,out] bs blob string (resized as needed on ranks other than the root)
+      /// @param[in] root rank of the root process in the given communicator
+      /// @param[in] comm communicator index
+      void broadcastBlobString(LOFAR::BlobString &bs, int root, size_t comm);
+
       /// @brief parameter set to get the parameters from
       LOFAR::ParameterSet itsParset;
+
+      /// @brief true, if the model is to be shared between workers on the same node
+      bool itsSharedModel;
+
+      /// @brief true, if communicators for the shared model have been set up
+      bool itsSharedModelReady;
+
+      /// @brief communicator index for the master and node leaders
+      size_t itsNodeLeadersComm;
+
+      /// @brief communicator index for workers on the same node
+      size_t itsNodeWorkersComm;
+
+      /// @brief true, if this rank receives the model on behalf of other workers on the node
+      bool itsNodeLeader;
+
+      /// @brief shared memory holding the model values (if the model is shared)
+      double *itsSharedModelStorage;
+
+      /// @brief number of elements in the shared memory
+      size_t itsSharedModelStorageSize;
  
       /// @brief reference frame for frequency
       /// @details We may want to simulate/image in different reference frames.
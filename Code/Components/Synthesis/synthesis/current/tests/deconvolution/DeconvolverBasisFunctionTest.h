@@ -33,9 +33,14 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <Common/ParameterSet.h>
 
 #include <boost/shared_ptr.hpp>
 
+#include <cmath>
+
 using namespace casa;
 
 namespace askap {
@@ -47,6 +52,7 @@ class DeconvolverBasisFunctionTest : public CppUnit::TestFixture
   CPPUNIT_TEST_SUITE(DeconvolverBasisFunctionTest);
   CPPUNIT_TEST(testCreate);
   CPPUNIT_TEST(testDeconvolveCenter);
+  CPPUNIT_TEST(testThreadsGiveSameResult);
   CPPUNIT_TEST_EXCEPTION(testWrongShape, casa::ArrayShapeError);
   CPPUNIT_TEST_EXCEPTION(testDeconvolveOffsetPSF, AskapError);
   CPPUNIT_TEST_SUITE_END();
@@ -64,18 +70,18 @@ public:
     scales[0]=0.0;
     scales[1]=3.0;
     scales[2]=6.0;
-    itsBasisFunction=boost::shared_ptr<BasisFunction<Float> >(new MultiScaleBasisFunction<Float>::MultiScaleBasisFunction(IPosition(4,100,100,1,1), scales));
+    itsBasisFunction=boost::shared_ptr<BasisFunction<Float> >(new MultiScaleBasisFunction<Float>(IPosition(4,100,100,1,1), scales));
     itsDB->setBasisFunction(itsBasisFunction);
     CPPUNIT_ASSERT(itsDB);
     CPPUNIT_ASSERT(itsDB->control());
     CPPUNIT_ASSERT(itsDB->monitor());
     CPPUNIT_ASSERT(itsDB->state());
     CPPUNIT_ASSERT(itsDB->basisFunction());
-    boost::shared_ptr<DeconvolverControl<Float> > DC(new DeconvolverControl<Float>::DeconvolverControl());
+    boost::shared_ptr<DeconvolverControl<Float> > DC(new DeconvolverControl<Float>());
     CPPUNIT_ASSERT(itsDB->setControl(DC));
-    boost::shared_ptr<DeconvolverMonitor<Float> > DM(new DeconvolverMonitor<Float>::DeconvolverMonitor());
+    boost::shared_ptr<DeconvolverMonitor<Float> > DM(new DeconvolverMonitor<Float>());
     CPPUNIT_ASSERT(itsDB->setMonitor(DM));
-    boost::shared_ptr<DeconvolverState<Float> > DS(new DeconvolverState<Float>::DeconvolverState());
+    boost::shared_ptr<DeconvolverState<Float> > DS(new DeconvolverState<Float>());
     CPPUNIT_ASSERT(itsDB->setControl(DC));
     itsWeight.reset(new Array<Float>(dimensions));
     itsWeight->set(10.0);
@@ -105,18 +111,64 @@ public:
     itsDB->updateDirty(newDirty);
   }
   void testDeconvolveOffsetPSF() {
-    itsPsf.reset(new Array<Float>(dimensions));
-    itsPsf->set(0.0);
-    (*itsPsf)(IPosition(4,70,70,0,0))=1.0;
+    itsDB->dirty()(IPosition(2,30,20))=1.0;
+    itsDB->psf().set(0.0);
+    itsDB->psf()(IPosition(2,70,70))=1.0;
     CPPUNIT_ASSERT(itsDB->deconvolve());
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
    
   void testDeconvolveCenter() {
-    itsDB->dirty()(IPosition(4,50,50,0,0))=1.0;
+    itsDB->dirty()(IPosition(2,50,50))=1.0;
     CPPUNIT_ASSERT(itsDB->deconvolve());
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
+
+  // the scales are processed in parallel, but each plane is updated in a fixed order,
+  // so the result should not depend on the number of threads
+  void testThreadsGiveSameResult() {
+    const IPosition shape(4,100,100,1,1);
+    Array<Float> dirty(shape);
+    Array<Float> psf(shape);
+    IPosition pos(shape.nelements(),0);
+    for (pos[0] = 0; pos[0] < shape[0]; ++pos[0]) {
+         for (pos[1] = 0; pos[1] < shape[1]; ++pos[1]) {
+              const Float dx = Float(pos[0] - 50);
+              const Float dy = Float(pos[1] - 50);
+              psf(pos) = exp(-(dx * dx + dy * dy) / 8.);
+              // extended source and a point source
+              const Float ex = Float(pos[0] - 40);
+              const Float ey = Float(pos[1] - 55);
+              dirty(pos) = 2. * exp(-(ex * ex + ey * ey) / 50.) + psf(pos);
+         }
+    }
+    Array<Float> weight(shape);
+    weight.set(1.0);
+
+    LOFAR::ParameterSet parset;
+    parset.add("beam", "[3, 3, 0]");
+    parset.add("scales", "[0, 3, 6]");
+    parset.add("niter", "50");
+    parset.add("gain", "0.3");
+
+    Array<Float> models[2];
+    Array<Float> residuals[2];
+    for (int run = 0; run < 2; ++run) {
+         parset.replace("nthreads", run == 0 ? "1" : "3");
+         Array<Float> thisDirty(dirty.copy());
+         Array<Float> thisPsf(psf.copy());
+         DeconvolverBasisFunction<Float, Complex> db(thisDirty, thisPsf);
+         db.configure(parset);
+         db.setWeight(weight);
+         db.state()->setCurrentIter(0);
+         CPPUNIT_ASSERT(db.deconvolve());
+         models[run] = db.model().copy();
+         residuals[run] = db.dirty().copy();
+    }
+    CPPUNIT_ASSERT(max(abs(models[0])) > 0.);
+    CPPUNIT_ASSERT(allEQ(models[0], models[1]));
+    CPPUNIT_ASSERT(allEQ(residuals[0], residuals[1]));
+  }
    
 private:
 
@@ -0,0 +1,127 @@
+/// @file
+///
+/// Unit test for the tiled peak search used by the deconvolvers
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <deconvolution/TiledPeakFinder.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/MaskArrMath.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicMath/Random.h>
+
+using namespace casa;
+
+namespace askap {
+
+namespace synthesis {
+
+class TiledPeakFinderTest : public CppUnit::TestFixture
+{
+  CPPUNIT_TEST_SUITE(TiledPeakFinderTest);
+  CPPUNIT_TEST(testMinMax);
+  CPPUNIT_TEST(testMinMaxMasked);
+  CPPUNIT_TEST(testTies);
+  CPPUNIT_TEST_SUITE_END();
+public:
+
+  void setUp() {
+    // deliberately not a multiple of the tile size
+    itsImage.resize(IPosition(2, 173, 131));
+    itsWeight.resize(itsImage.shape());
+    MLCG generator(1, 1);
+    Uniform random(&generator, -1.0, 1.0);
+    for (uInt y = 0; y < itsImage.ncolumn(); ++y) {
+      for (uInt x = 0; x < itsImage.nrow(); ++x) {
+        itsImage(x, y) = random();
+        itsWeight(x, y) = (random() > 0.5) ? 0.0 : 1.0;
+      }
+    }
+  }
+
+  void testMinMax() {
+    TiledPeakFinder<Float> finder(16);
+    check(finder, false);
+    // update a few patches, including ones overlapping the edges
+    update(finder, IPosition(2, 10, 20), IPosition(2, 40, 35), 5.0, false);
+    update(finder, IPosition(2, 160, 0), IPosition(2, 172, 10), -5.0, false);
+    update(finder, IPosition(2, 10, 20), IPosition(2, 40, 35), -10.0, false);
+  }
+
+  void testMinMaxMasked() {
+    TiledPeakFinder<Float> finder(16);
+    check(finder, true);
+    update(finder, IPosition(2, 0, 100), IPosition(2, 50, 130), 3.0, true);
+    update(finder, IPosition(2, 90, 60), IPosition(2, 91, 61), -7.0, true);
+    update(finder, IPosition(2, 0, 100), IPosition(2, 50, 130), -6.0, true);
+  }
+
+  void testTies() {
+    // casa::minMax returns the first occurrence of the extrema
+    itsImage.set(1.0);
+    itsImage(5, 100) = 2.0;
+    itsImage(150, 3) = 2.0;
+    itsImage(170, 20) = -1.0;
+    itsImage(20, 120) = -1.0;
+    TiledPeakFinder<Float> finder(16);
+    check(finder, false);
+  }
+
+private:
+  void update(TiledPeakFinder<Float> &finder, const IPosition &blc, const IPosition &trc,
+              const Float offset, const bool masked) {
+    Matrix<Float> patch = itsImage(blc, trc);
+    patch += offset;
+    finder.invalidate(blc, trc);
+    check(finder, masked);
+  }
+
+  void check(TiledPeakFinder<Float> &finder, const bool masked) {
+    Float minVal, maxVal, refMinVal, refMaxVal;
+    IPosition minPos, maxPos, refMinPos, refMaxPos;
+    if (masked) {
+      finder.minMaxMasked(minVal, maxVal, minPos, maxPos, itsImage, itsWeight);
+      casa::minMaxMasked(refMinVal, refMaxVal, refMinPos, refMaxPos, itsImage, itsWeight);
+    } else {
+      finder.minMax(minVal, maxVal, minPos, maxPos, itsImage);
+      casa::minMax(refMinVal, refMaxVal, refMinPos, refMaxPos, itsImage);
+    }
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(refMinVal, minVal, 1e-7);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(refMaxVal, maxVal, 1e-7);
+    CPPUNIT_ASSERT(minPos == refMinPos);
+    CPPUNIT_ASSERT(maxPos == refMaxPos);
+  }
+
+  Matrix<Float> itsImage;
+  Matrix<Float> itsWeight;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
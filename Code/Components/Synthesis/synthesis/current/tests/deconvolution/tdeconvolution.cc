@@ -33,11 +33,13 @@ ASKAP_LOGGER(logger, ".deconvolution");
 #include <BasisFunctionTest.h>
 #include <DeconvolverBaseTest.h>
 #include <DeconvolverFistaTest.h>
+#include <DeconvolverBasisFunctionTest.h>
 #include <DeconvolverHogbomTest.h>
 #include <DeconvolverMultiTermBasisFunctionTest.h>
 #include <DeconvolverControlTest.h>
 #include <DeconvolverMonitorTest.h>
 #include <DeconvolverStateTest.h>
+#include <TiledPeakFinderTest.h>
 
 int main(int argc, char *argv[])
 {
@@ -48,6 +50,7 @@ int main(int argc, char *argv[])
 
     runner.addTest( askap::synthesis::DeconvolverBaseTest::suite());
     runner.addTest( askap::synthesis::DeconvolverFistaTest::suite());
+    runner.addTest( askap::synthesis::DeconvolverBasisFunctionTest::suite());
     runner.addTest( askap::synthesis::DeconvolverHogbomTest::suite());
     runner.addTest( askap::synthesis::DeconvolverMultiTermBasisFunctionTest::suite());
     runner.addTest( askap::synthesis::DeconvolverControlTest::suite());
@@ -55,6 +58,7 @@ int main(int argc, char *argv[])
     runner.addTest( askap::synthesis::DeconvolverStateTest::suite());
     runner.addTest( askap::synthesis::EntropyTest::suite());
     runner.addTest( askap::synthesis::BasisFunctionTest::suite());
+    runner.addTest( askap::synthesis::TiledPeakFinderTest::suite());
     bool wasSuccessful = runner.run();
 
     return wasSuccessful ? 0 : 1;
@@ -0,0 +1,159 @@
+/// @file
+///
+/// Unit test for the gridding/degridding kernels
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/GridKernel.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+class GridKernelTest : public CppUnit::TestFixture 
+{
+   CPPUNIT_TEST_SUITE(GridKernelTest);
+   CPPUNIT_TEST(testGrid);
+   CPPUNIT_TEST(testDegrid);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   void setUp() {
+      itsGrid.resize(64,64);
+      for (casa::uInt x = 0; x < itsGrid.nrow(); ++x) {
+           for (casa::uInt y = 0; y < itsGrid.ncolumn(); ++y) {
+                itsGrid(x,y) = casa::Complex(sin(0.1 * x + 0.3 * y), cos(0.2 * x - 0.1 * y));
+           }
+      }
+      itsDefaultISA = GridKernel::isa();
+   }
+
+   void tearDown() {
+      GridKernel::selectISA(itsDefaultISA);
+   }
+   
+   /// @brief fill the convolution function for a given support
+   /// @param[in] support support size
+   /// @return convolution function of (2*support+1) x (2*support+1) size
+   static casa::Matrix<casa::Complex> makeCF(const int support) {
+      casa::Matrix<casa::Complex> cf(2 * support + 1, 2 * support + 1);
+      for (casa::uInt x = 0; x < cf.nrow(); ++x) {
+           for (casa::uInt y = 0; y < cf.ncolumn(); ++y) {
+                const float r2 = casa::square(float(x) - support) + casa::square(float(y) - support);
+                cf(x,y) = casa::Complex(exp(-r2 / 10.), 0.1 * (float(x) - float(y)));
+           }
+      }
+      return cf;
+   }
+
+   /// @brief instruction sets supported by this CPU
+   static std::vector<GridKernel::ISA> supportedISAs() {
+      std::vector<GridKernel::ISA> result;
+      const GridKernel::ISA isas[3] = {GridKernel::SCALAR, GridKernel::AVX2, GridKernel::AVX512};
+      for (int i = 0; i < 3; ++i) {
+           if (GridKernel::supports(isas[i])) {
+               result.push_back(isas[i]);
+           }
+      }
+      return result;
+   }
+   
+   void testGrid() {
+      const std::vector<GridKernel::ISA> isas = supportedISAs();
+      CPPUNIT_ASSERT(isas.size() > 0);
+      for (size_t i = 0; i < isas.size(); ++i) {
+           GridKernel::selectISA(isas[i]);
+           CPPUNIT_ASSERT_EQUAL(isas[i], GridKernel::isa());
+           // odd supports exercise the scalar tail of the vectorised kernels
+           for (int support = 1; support < 12; ++support) {
+                const casa::Matrix<casa::Complex> cf = makeCF(support);
+                casa::Matrix<casa::Complex> cfCopy(cf.copy());
+                casa::Matrix<casa::Complex> gridMatrix(itsGrid.copy());
+                casa::Matrix<casa::Complex> gridRaw(itsGrid.copy());
+                casa::Matrix<casa::Complex> gridRef(itsGrid.copy());
+                const casa::Complex cVis(0.3,-1.7);
+                // reference: explicit scalar loop
+                for (int suppv = -support; suppv < support; ++suppv) {
+                     for (int suppu = -support; suppu < support; ++suppu) {
+                          gridRef(30 + suppu, 33 + suppv) += cVis * cf(suppu + support, suppv + support);
+                     }
+                }
+                GridKernel::grid(gridMatrix, cfCopy, cVis, 30, 33, support);
+                GridKernel::grid(gridRaw.data(), int(gridRaw.nrow()), cf.data(), int(cf.nrow()), cVis,
+                                 30, 33, support);
+                for (casa::uInt x = 0; x < itsGrid.nrow(); ++x) {
+                     for (casa::uInt y = 0; y < itsGrid.ncolumn(); ++y) {
+                          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(gridRef(x,y) - gridMatrix(x,y)), 1e-5);
+                          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., casa::abs(gridRef(x,y) - gridRaw(x,y)), 1e-5);
+                     }
+                }
+           }
+      }
+   }
+   
+   void testDegrid() {
+      const std::vector<GridKernel::ISA> isas = supportedISAs();
+      CPPUNIT_ASSERT(isas.size() > 0);
+      for (size_t i = 0; i < isas.size(); ++i) {
+           GridKernel::selectISA(isas[i]);
+           CPPUNIT_ASSERT_EQUAL(isas[i], GridKernel::isa());
+           for (int support = 1; support < 12; ++support) {
+                const casa::Matrix<casa::Complex> cf = makeCF(support);
+                // reference: explicit scalar loop
+                casa::Complex visRef(0., 0.);
+                for (int suppv = -support; suppv < support; ++suppv) {
+                     for (int suppu = -support; suppu < support; ++suppu) {
+                          visRef += cf(suppu + support, suppv + support) * conj(itsGrid(31 + suppu, 29 + suppv));
+                     }
+                }
+                casa::Complex visMatrix, visRaw;
+                GridKernel::degrid(visMatrix, cf, itsGrid, 31, 29, support);
+                GridKernel::degrid(visRaw, cf.data(), int(cf.nrow()), itsGrid.data(), int(itsGrid.nrow()),
+                                   31, 29, support);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(casa::real(visRef), casa::real(visMatrix), 1e-4);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(casa::imag(visRef), casa::imag(visMatrix), 1e-4);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(casa::real(visRef), casa::real(visRaw), 1e-4);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(casa::imag(visRef), casa::imag(visRaw), 1e-4);
+           }
+      }
+   }
+
+private:
+   /// @brief grid to work with
+   casa::Matrix<casa::Complex> itsGrid;
+
+   /// @brief instruction set selected at load time, restored after each test
+   GridKernel::ISA itsDefaultISA;
+};
+    
+} // namespace synthesis
+
+} // namespace askap
@@ -35,6 +35,7 @@
 #include <dataaccess/DataIteratorStub.h>
 #include <casacore/casa/aips.h>
 #include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
 #include <casacore/measures/Measures/MPosition.h>
 #include <casacore/casa/Quanta/Quantum.h>
 #include <casacore/casa/Quanta/MVPosition.h>
@@ -46,6 +47,8 @@
 
 #include <stdexcept>
 #include <boost/shared_ptr.hpp>
+#include <boost/filesystem.hpp>
+#include <string>
 
 using namespace askap::scimath;
 
@@ -64,6 +67,9 @@ namespace askap
       CPPUNIT_TEST_EXCEPTION(testUnknownGridder,AskapError);      
       CPPUNIT_TEST(testForwardSph);
       CPPUNIT_TEST(testReverseSph);
+      CPPUNIT_TEST(testReverseThreadedSph);
+      CPPUNIT_TEST(testPlanCache);
+      CPPUNIT_TEST(testCFCache);
       CPPUNIT_TEST(testForwardAWProject);
       CPPUNIT_TEST(testReverseAWProject);
       CPPUNIT_TEST(testForwardWProject);
@@ -91,10 +97,15 @@ namespace askap
       boost::shared_ptr<casa::Array<double> > itsModel;
       boost::shared_ptr<casa::Array<double> > itsModelPSF;
       boost::shared_ptr<casa::Array<double> > itsModelWeights;
+      /// @brief temporary directory for the cache tests, removed in tearDown
+      std::string itsCacheDir;
 
   public:
       void setUp()
       {
+        itsCacheDir = (boost::filesystem::temp_directory_path() /
+                       boost::filesystem::unique_path("gridcache-%%%%-%%%%-%%%%")).string();
+        CPPUNIT_ASSERT(boost::filesystem::create_directory(itsCacheDir));
         idi = accessors::IDataSharedIter(new accessors::DataIteratorStub(1));
 
         Params ip;
@@ -137,6 +148,10 @@ namespace askap
 
       void tearDown()
       {
+        if (!itsCacheDir.empty()) {
+            boost::filesystem::remove_all(itsCacheDir);
+            itsCacheDir.clear();
+        }
       }
 
       //      void testReverseBox()
@@ -182,6 +197,86 @@ namespace askap
         itsSphFunc->finaliseGrid(*itsModel);
         itsSphFunc->finaliseWeights(*itsModelWeights);
       }
+      void testReverseThreadedSph()
+      {
+        itsSphFunc->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsSphFunc->grid(*idi);
+        itsSphFunc->finaliseGrid(*itsModel);
+        // tiled gridding changes the order of summation, so allow for rounding
+        boost::shared_ptr<SphFuncVisGridder> threadedGridder(new SphFuncVisGridder());
+        threadedGridder->numberOfThreads(4);
+        threadedGridder->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        threadedGridder->grid(*idi);
+        casa::Array<double> threadedModel(itsModel->shape());
+        threadedGridder->finaliseGrid(threadedModel);
+        const double peak = casa::max(casa::abs(*itsModel));
+        CPPUNIT_ASSERT(peak > 0.);
+        CPPUNIT_ASSERT(casa::max(casa::abs(threadedModel - *itsModel)) < 1e-5 * peak);
+      }
+      void testPlanCache()
+      {
+        itsSphFunc->initialiseGrid(*itsAxes, itsModel->shape(), false);
+        itsSphFunc->grid(*idi);
+        itsSphFunc->finaliseGrid(*itsModel);
+        // zero budget with spilling and a normal budget should give the same result
+        // when the plan is computed and when it is replayed
+        for (int spill = 0; spill < 2; ++spill) {
+             GriddingPlanCache::ShPtr cache(spill == 0 ? new GriddingPlanCache(1024*1024*1024) :
+                                                         new GriddingPlanCache(0, itsCacheDir));
+             for (int pass = 0; pass < 2; ++pass) {
+                  boost::shared_ptr<SphFuncVisGridder> gridder(new SphFuncVisGridder());
+                  gridder->setPlanCache(cache);
+                  gridder->initialiseGrid(*itsAxes, itsModel->shape(), false);
+                  gridder->grid(*idi);
+                  casa::Array<double> cachedModel(itsModel->shape());
+                  gridder->finaliseGrid(cachedModel);
+                  CPPUNIT_ASSERT(casa::allEQ(cachedModel, *itsModel));
+                  // the plan is built in the first pass and replayed in the second
+                  CPPUNIT_ASSERT_EQUAL(1l, cache->misses());
+                  CPPUNIT_ASSERT_EQUAL(long(pass), cache->hits());
+             }
+        }
+      }
+      void testCFCache()
+      {
+        boost::shared_ptr<IBasicIllumination> illum(new DiskIllumination(120.0, 10.0));
+        // the second gridder of each type takes all convolution functions from memory,
+        // the third one reads them back from disk
+        for (int type = 0; type < 2; ++type) {
+             casa::Array<double> reference;
+             ConvFuncCache::ShPtr cache(new ConvFuncCache(1024*1024*1024, itsCacheDir));
+             for (int pass = 0; pass < 3; ++pass) {
+                  if (pass == 2) {
+                      cache.reset(new ConvFuncCache(0, itsCacheDir));
+                  }
+                  const long hits = cache->hits();
+                  const long diskHits = cache->diskHits();
+                  const long misses = cache->misses();
+                  boost::shared_ptr<WProjectVisGridder> gridder(type == 0 ?
+                        new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, "") :
+                        new AWProjectVisGridder(illum, 10000.0, 9, 1e-3, 1, 128, 1));
+                  gridder->setCFCache(cache);
+                  gridder->initialiseGrid(*itsAxes, itsModel->shape(), false);
+                  gridder->grid(*idi);
+                  casa::Array<double> model(itsModel->shape());
+                  gridder->finaliseGrid(model);
+                  if (pass == 0) {
+                      reference = model;
+                      CPPUNIT_ASSERT(cache->misses() > 0);
+                  } else {
+                      CPPUNIT_ASSERT(casa::allEQ(model, reference));
+                      // nothing should be recomputed
+                      CPPUNIT_ASSERT_EQUAL(misses, cache->misses());
+                      if (pass == 1) {
+                          CPPUNIT_ASSERT(cache->hits() > hits);
+                          CPPUNIT_ASSERT_EQUAL(diskHits, cache->diskHits());
+                      } else {
+                          CPPUNIT_ASSERT(cache->diskHits() > diskHits);
+                      }
+                  }
+             }
+        }
+      }
       void testForwardSph()
       {
         itsSphFunc->initialiseDegrid(*itsAxes, *itsModel);
@@ -32,6 +32,7 @@
 #include <SupportSearcherTest.h>
 #include <FrequencyMapperTest.h>
 #include <NonLinearWSamplingTest.h>
+#include <GridKernelTest.h>
 
 int main(int argc, char *argv[])
 {
@@ -40,6 +41,7 @@ int main(int argc, char *argv[])
     runner.addTest( askap::synthesis::SupportSearcherTest::suite());
     runner.addTest( askap::synthesis::FrequencyMapperTest::suite());
     runner.addTest( askap::synthesis::NonLinearWSamplingTest::suite());
+    runner.addTest( askap::synthesis::GridKernelTest::suite());
 
     bool wasSucessful = runner.run();
 
@@ -181,13 +181,56 @@ casa::Vector<int> BufferManager::readyBuffers(const std::pair<int,int> &index) c
 BufferManager::BufferSet BufferManager::getFilledBuffers() const
 {
   boost::unique_lock<boost::mutex> lock(itsStatusCVMutex);
+  const std::pair<int,int> index = waitForCompleteSet(lock);
+  BufferManager::BufferSet result = newBufferSet(index);
+  markBeingProcessed(index);
+  return result;
+}
+
+/// @brief get filled buffers for all antennas of a matching channel + beam
+/// @details This method is an alternative to getFilledBuffers used when
+/// all antennas are correlated at once. It returns buffer IDs for the first
+/// available complete set of buffers corresponding to the same channel and beam.
+/// The calling thread is blocked until a suitable set is available for correlation.
+/// @return vector with buffer IDs, one per antenna
+/// @note If the 2nd antenna is duplicated, the last element is the same as the
+/// second one. It should be set to a negative value before the buffers are released
+/// via releaseBuffers.
+casa::Vector<int> BufferManager::getFilledBufferGroup() const
+{
+  boost::unique_lock<boost::mutex> lock(itsStatusCVMutex);
+  const std::pair<int,int> index = waitForCompleteSet(lock);
+  casa::Vector<int> result = readyBuffers(index).copy();
+  if (itsDuplicate2nd) {
+      result[result.nelements() - 1] = result[1];
+  }
+  markBeingProcessed(index);
+  return result;
+}
+
+/// @brief wait for a complete set of data
+/// @details This method blocks until a complete set of buffers is available 
+/// for some channel/beam pair.
+/// @param[in] lock lock on the status mutex to wait with
+/// @return channel/beam pair ready to be correlated
+std::pair<int,int> BufferManager::waitForCompleteSet(boost::unique_lock<boost::mutex> &lock) const
+{
   std::pair<int,int> index;
   while (findCompleteSet(index)) {  
      itsStatusCV.wait(lock);
   }
   ASKAPDEBUGASSERT(itsReadyBuffers.nrow() >= 3);
-  BufferManager::BufferSet result = newBufferSet(index);
-  // remove buffers for the given channel/beam pair, so the next complete set should correspond to a different one
+  return index;
+}
+
+/// @brief mark buffers of a complete set as being processed
+/// @details This method removes buffers for the given channel/beam pair from the 
+/// list of buffers ready for correlation, so the next complete set corresponds to
+/// a different channel/beam.
+/// @param[in] index channel/beam pair
+/// @note The method assumes that a lock has been acquired
+void BufferManager::markBeingProcessed(const std::pair<int,int> &index) const
+{
   const casa::uInt nAntToIterate = itsDuplicate2nd ? itsReadyBuffers.nrow() - 1 : itsReadyBuffers.nrow();    
   for (casa::uInt ant = 0; ant < nAntToIterate; ++ant) {
        const int id = itsReadyBuffers(ant, index.first, index.second);
@@ -196,7 +239,6 @@ BufferManager::BufferSet BufferManager::getFilledBuffers() const
        itsStatus[id] = BUF_BEING_PROCESSED;      
        itsReadyBuffers(ant, index.first, index.second) = -1;
   }
-  return result;
 }
 
 /// @brief find a complete set of data 
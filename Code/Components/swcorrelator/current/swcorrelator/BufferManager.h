@@ -130,6 +130,17 @@ public:
    /// is available for correlation.
    /// @return a set of buffers ready for correlation
    virtual BufferSet getFilledBuffers() const;
+
+   /// @brief get filled buffers for all antennas of a matching channel + beam
+   /// @details This method is an alternative to getFilledBuffers used when
+   /// all antennas are correlated at once. It returns buffer IDs for the first
+   /// available complete set of buffers corresponding to the same channel and beam.
+   /// The calling thread is blocked until a suitable set is available for correlation.
+   /// @return vector with buffer IDs, one per antenna
+   /// @note If the 2nd antenna is duplicated, the last element is the same as the
+   /// second one. It should be set to a negative value before the buffers are released
+   /// via releaseBuffers.
+   casa::Vector<int> getFilledBufferGroup() const;
    
    /// @brief get one filled buffer
    /// @details This method is only used with the capture, correlation
@@ -215,6 +226,21 @@ protected:
    /// @note The method assumes that a lock has been acquired
    bool findCompleteSet(std::pair<int,int> &index) const;
 
+   /// @brief wait for a complete set of data
+   /// @details This method blocks until a complete set of buffers is available 
+   /// for some channel/beam pair.
+   /// @param[in] lock lock on the status mutex to wait with
+   /// @return channel/beam pair ready to be correlated
+   std::pair<int,int> waitForCompleteSet(boost::unique_lock<boost::mutex> &lock) const;
+
+   /// @brief mark buffers of a complete set as being processed
+   /// @details This method removes buffers for the given channel/beam pair from the 
+   /// list of buffers ready for correlation, so the next complete set corresponds to
+   /// a different channel/beam.
+   /// @param[in] index channel/beam pair
+   /// @note The method assumes that a lock has been acquired
+   void markBeingProcessed(const std::pair<int,int> &index) const;
+
    /// @brief exception used internally
    struct HelperException : public std::exception {};
    
@@ -68,7 +68,7 @@ void CorrServer::stop()
 CorrServer::CorrServer(const LOFAR::ParameterSet &parset) : itsAcceptor(theirIOService), 
      itsCaptureMode(parset.getBool("capturemode", false)),
      itsStatsOnly(parset.getBool("capturemode.statsonly",false)),
-     itsStreamType(parset.getString("streamtype","int"))
+     itsStreamType(parset.getString("streamtype","int")), itsAllAntennas(false)
 {
   theirStopRequested = false;
   ASKAPCHECK((itsStreamType == "int") || (itsStreamType == "float"), "Only 'int' and 'float' stream types are supported, you have "<<itsStreamType);
@@ -84,15 +84,23 @@ CorrServer::CorrServer(const LOFAR::ParameterSet &parset) : itsAcceptor(theirIOS
   } else {
      itsFiller.reset(new CorrFiller(parset));
      boost::shared_ptr<HeaderPreprocessor> hdrProc(new HeaderPreprocessor(parset));
-     if (itsFiller->nAnt() == 3) {
+     // by default, correlate all antennas at once unless we have exactly 3 antennas
+     itsAllAntennas = parset.getBool("xengine", itsFiller->nAnt() > 3);
+     if (itsFiller->nAnt() == 3 && !itsAllAntennas) {
          // special case of the 3-antenna correlator
          ASKAPLOG_INFO_STR(logger, "Number of antennas is exactly 3, use special 3-baseline version of the correlator");
          itsBufferManager.reset(new BufferManager(itsFiller->nBeam(),itsFiller->nChan(), itsFiller->nAnt(), hdrProc));
      } else {
-         ASKAPCHECK(itsFiller->nAnt() > 3, "Less than 3 antennas are not supported.");
-         // generic case of more than 3 antennas
-         ASKAPLOG_INFO_STR(logger, "Number of antennas is "<<itsFiller->nAnt()<<", use generic version of the correlator");
-         itsBufferManager.reset(new ExtendedBufferManager(itsFiller->nBeam(),itsFiller->nChan(), itsFiller->nAnt(), hdrProc));         
+         ASKAPCHECK(itsFiller->nAnt() >= 3, "Less than 3 antennas are not supported.");
+         if (itsAllAntennas) {
+             ASKAPLOG_INFO_STR(logger, "Number of antennas is "<<itsFiller->nAnt()<<
+                               ", all baselines will be correlated at once");
+             itsBufferManager.reset(new BufferManager(itsFiller->nBeam(),itsFiller->nChan(), itsFiller->nAnt(), hdrProc));
+         } else {
+             // generic case of more than 3 antennas split into triangles
+             ASKAPLOG_INFO_STR(logger, "Number of antennas is "<<itsFiller->nAnt()<<", use generic version of the correlator");
+             itsBufferManager.reset(new ExtendedBufferManager(itsFiller->nBeam(),itsFiller->nChan(), itsFiller->nAnt(), hdrProc));         
+         }
      }
   }
   const bool duplicate2nd = parset.getBool("duplicate2nd", false);
@@ -124,7 +132,7 @@ void CorrServer::run()
       const int nCorrThreads = itsFiller->nBeam() * itsFiller->nChan();
       ASKAPLOG_INFO_STR(logger, "About to start "<<nCorrThreads<<" correlator thread(s)");
       for (int i = 0; i<nCorrThreads; ++i) {
-          itsThreads.create_thread(CorrWorker(itsFiller,itsBufferManager));
+          itsThreads.create_thread(CorrWorker(itsFiller,itsBufferManager,itsAllAntennas));
       }
   } else {
       ASKAPLOG_INFO_STR(logger, "About to start data dump thread");
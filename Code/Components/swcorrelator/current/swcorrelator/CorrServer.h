@@ -108,6 +108,9 @@ private:
 
   /// @brief stream type (float or int)
   std::string itsStreamType;
+
+  /// @brief true if all antennas are correlated at once rather than in triangles
+  bool itsAllAntennas;
 };
 
 } // namespace swcorrelator
@@ -38,6 +38,9 @@
 #include <askap/AskapLogging.h>
 #include <boost/thread.hpp>
 
+#include <vector>
+#include <complex>
+
 ASKAP_LOGGER(logger, ".corrworker");
 
 namespace askap {
@@ -48,8 +51,11 @@ namespace swcorrelator {
 /// @details 
 /// @param[in] filler shared pointer to a filler
 /// @param[in] bm shared pointer to a buffer manager
+/// @param[in] allAntennas if true, all antennas are correlated at once
+/// (buffer manager should not split antennas into triangles in this case)
 CorrWorker::CorrWorker(const boost::shared_ptr<CorrFiller> &filler,
-           const boost::shared_ptr<BufferManager> &bm) : itsFiller(filler), itsBufferManager(bm)
+           const boost::shared_ptr<BufferManager> &bm, const bool allAntennas) : 
+           itsAllAntennas(allAntennas), itsFiller(filler), itsBufferManager(bm)
 {
   ASKAPDEBUGASSERT(itsFiller);
   ASKAPDEBUGASSERT(itsBufferManager);
@@ -62,6 +68,9 @@ void CorrWorker::operator()()
   try {
     ASKAPDEBUGASSERT(itsFiller);
     ASKAPDEBUGASSERT(itsBufferManager);
+    if (itsAllAntennas) {
+        correlateAllAntennas();
+    }
     Simple3BaselineCorrelator<std::complex<float>, int> s3bc;
     // buffer size in complex floats
     const int size = (itsBufferManager->bufferSize() - int(sizeof(BufferHeader))) / sizeof(float) / 2;
@@ -148,6 +157,75 @@ void CorrWorker::operator()()
   }  
 }
 
+/// @brief correlation loop for all antennas at once
+/// @details This method is called from the parallel thread if the worker is
+/// set up to correlate all antennas at once. It runs until the thread is interrupted.
+void CorrWorker::correlateAllAntennas()
+{
+  const int nAnt = itsFiller->nAnt();
+  ASKAPLOG_INFO_STR(logger, "Correlator thread (id="<<boost::this_thread::get_id()<<") will correlate "<<
+                    nAnt<<" antennas at once");
+  MultiAntennaCorrelator<std::complex<float>, int> xEngine(nAnt);
+  // buffer size in complex floats
+  const int size = (itsBufferManager->bufferSize() - int(sizeof(BufferHeader))) / sizeof(float) / 2;
+  std::vector<const std::complex<float>*> streams(nAnt);
+  std::vector<int> frames(nAnt);
+  std::vector<uint32_t> controls(nAnt);
+  while (true) {
+     // extract the first complete set of buffers
+     casa::Vector<int> ids = itsBufferManager->getFilledBufferGroup();
+     ASKAPDEBUGASSERT(int(ids.nelements()) == nAnt);
+     const BufferHeader& hdrAnt1 = itsBufferManager->header(ids[0]); 
+     const uint64_t bat = hdrAnt1.bat;
+     const int beam = hdrAnt1.beam;
+     const int chan = hdrAnt1.freqId;
+     for (int ant = 0; ant < nAnt; ++ant) {
+          const BufferHeader& hdr = itsBufferManager->header(ids[ant]);
+          // consistency checks
+          ASKAPDEBUGASSERT(beam == int(hdr.beam));
+          ASKAPDEBUGASSERT(chan == int(hdr.freqId));
+          ASKAPDEBUGASSERT(bat == hdr.bat);
+          frames[ant] = int(hdr.frame);
+          controls[ant] = hdr.control;
+          streams[ant] = itsBufferManager->data(ids[ant]);
+     }
+     // run correlation, derive offsets from frame differences w.r.t. the first antenna
+     std::vector<int> delays(nAnt);
+     for (int ant = 0; ant < nAnt; ++ant) {
+          delays[ant] = frames[0] - frames[ant];
+     }
+     xEngine.reset(delays);
+     xEngine.accumulate(streams, size);
+     // store the result, baselines are identified by the antenna index rather than the header
+     // because the same buffer is used for two antennas if the 2nd antenna is duplicated
+     CorrProducts& cp = itsFiller->productsBuffer(beam, bat);
+     cp.itsBAT = bat;
+     ASKAPDEBUGASSERT(int(cp.nAnt()) == nAnt);
+     if (chan == 0) {
+         for (int ant = 0; ant < nAnt; ++ant) {
+              cp.itsControl[ant] = controls[ant];
+         }
+     }
+     if (itsBufferManager->is2ndDuplicated()) {
+         // this buffer is released as the second antenna
+         ids[nAnt - 1] = -1;
+     }
+     itsBufferManager->releaseBuffers(ids);
+     const float nSamples = float(xEngine.nSamples() != 0 ? xEngine.nSamples() : 1.);
+     for (int ant2 = 1; ant2 < nAnt; ++ant2) {
+          for (int ant1 = 0; ant1 < ant2; ++ant1) {
+               const int baseline = cp.baseline(ant1, ant2);
+               ASKAPDEBUGASSERT(baseline < int(cp.nBaseline()));
+               // unflag if the frame offset is less than 100 by absolute value and control words match
+               cp.itsFlag(baseline, chan) = (abs(frames[ant1] - frames[ant2]) >= 100) || 
+                                            (controls[ant1] != controls[ant2]);
+               cp.itsVisibility(baseline, chan) = xEngine.getVis(ant1, ant2) / nSamples;
+          }
+     }
+     itsFiller->notifyProductsReady(beam);
+  }
+}
+
 
 } // namespace swcorrelator
 
@@ -55,13 +55,22 @@ struct CorrWorker {
   /// @details 
   /// @param[in] filler shared pointer to a filler
   /// @param[in] bm shared pointer to a buffer manager
+  /// @param[in] allAntennas if true, all antennas are correlated at once
+  /// (buffer manager should not split antennas into triangles in this case)
   CorrWorker(const boost::shared_ptr<CorrFiller> &filler,
-             const boost::shared_ptr<BufferManager> &bm);
+             const boost::shared_ptr<BufferManager> &bm, const bool allAntennas = false);
 
   /// @brief entry point for the parallel thread
   void operator()();
   
 private:
+  /// @brief correlation loop for all antennas at once
+  /// @details This method is called from the parallel thread if the worker is
+  /// set up to correlate all antennas at once. It runs until the thread is interrupted.
+  void correlateAllAntennas();
+
+  /// @brief true if all antennas are correlated at once
+  bool itsAllAntennas;
   /// @brief filler
   boost::shared_ptr<CorrFiller> itsFiller;
   /// @brief buffer manager
@@ -42,6 +42,7 @@
 #include <stdexcept>
 #include <vector>
 #include <complex>
+#include <algorithm>
 
 namespace askap {
 
@@ -254,6 +255,139 @@ private:
   
 };
 
+/// @brief correlator for an arbitrary number of antennas and delay lags
+/// @details This is a generalisation of Simple3BaselineCorrelator (an X-engine) which
+/// correlates all antennas of the buffer set in one go, producing all baselines including
+/// autocorrelations, optionally for a number of delay lags. The streams are processed in
+/// blocks of BlockSize samples. Each block is unpacked into separate real and imaginary
+/// parts for all antennas first, so it stays in cache while all baselines are accumulated.
+/// The complex multiply-accumulate is written as VectorWidth independent lanes in single
+/// precision, which the compiler can map onto SIMD instructions without reordering the sums.
+/// All lags of a given baseline are computed in the same pass over the block. The partial
+/// sums of each block are added to the accumulators of AccType.
+///
+/// Lag l of the product for antennas ant1 and ant2 is the sum of s1[t] * conj(s2[t + l]),
+/// all lags are accumulated over the same range of t.
+///
+/// Template parameters:
+///    AccType - type of the accumulated values (may be different from the input data type 
+///              to allow overflow)
+///    IndexType - type of the sample index 
+/// @ingroup swcorrelator
+template<typename AccType = std::complex<float>, typename IndexType = int>         
+class MultiAntennaCorrelator {
+public:
+  /// @brief constructor
+  /// @details All delays are initialised with zeros
+  /// @param[in] nAnt number of antennas (streams)
+  /// @param[in] nLags number of delay lags
+  explicit MultiAntennaCorrelator(const IndexType nAnt, const IndexType nLags = 1);
+  
+  /// @brief reset accumulator, adjust delays
+  /// @details 
+  /// @param[in] delays delays (in samples) for all streams, one element per antenna
+  /// @note the buffers are treated as parts of the continuous
+  /// stream. Incomplete buffers are ignored for simplicity.
+  void reset(const std::vector<IndexType> &delays);
+  
+  /// @brief just reset accumulator
+  /// @details This method can be used to move to the next integration cycle
+  void reset();
+  
+  /// @return number of antennas
+  inline IndexType nAnt() const { return itsNAnt; }
+  
+  /// @return number of delay lags
+  inline IndexType nLags() const { return itsNLags; }
+  
+  /// @brief index of the product for a pair of antennas
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna, should not be less than ant1
+  /// @return product index (0..nAnt*(nAnt+1)/2-1)
+  static inline IndexType product(const IndexType ant1, const IndexType ant2) 
+         { return ant2 * (ant2 + 1) / 2 + ant1; }
+  
+  /// @brief obtain accumulated product
+  /// @details If SUBTRACT_DC is defined, the contribution of the mean is subtracted.
+  /// The sums are accumulated for zero lag, so this correction is approximate for other lags.
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna, should not be less than ant1
+  /// @param[in] lag delay lag
+  /// @return accumulated product (not normalised by the number of samples)
+  AccType getVis(const IndexType ant1, const IndexType ant2, const IndexType lag = 0) const;
+
+#ifdef SUBTRACT_DC
+  /// @brief obtain buffer with the sum
+  /// @param[in] ant antenna index
+  /// @return sum of all samples for the given antenna
+  inline AccType getSum(const IndexType ant) const { return itsAntSums[ant]; }
+#endif
+
+  /// @return obtain number of accumulated samples (the same for all products)
+  inline IndexType nSamples() const { return itsSamples; }
+
+  /// @brief accumulate buffers
+  /// @details 
+  /// The parameter of the template is as follows.
+  ///    Iter - type of the read-only random-access iterator to read the data buffer
+  ///           (it could be just an ordinary pointer)
+  /// @param[in] streams start iterators of all streams, one element per antenna
+  /// @param[in] size number of samples
+  template<typename Iter>
+  void accumulate(const std::vector<Iter> &streams, const IndexType size);
+
+  /// @brief number of samples processed at once
+  /// @details Unpacked blocks of all antennas should fit into the cache 
+  /// (about 2kB per antenna for the default value)
+  enum { BlockSize = 256 };
+  
+  /// @brief number of independent lanes in the multiply-accumulate loop
+  enum { VectorWidth = 8 };
+    
+private:
+  /// @brief correlate unpacked blocks of two antennas for all lags
+  /// @param[in] re1 real part of the first stream
+  /// @param[in] im1 imaginary part of the first stream
+  /// @param[in] re2 real part of the second stream (at least nSamples + nLags - 1 elements)
+  /// @param[in] im2 imaginary part of the second stream (at least nSamples + nLags - 1 elements)
+  /// @param[in] nSamples number of samples to correlate
+  /// @param[in] out iterator to the accumulators of this product, one element per lag
+  void correlateBlock(const float *re1, const float *im1, const float *re2, const float *im2,
+                      const IndexType nSamples, typename std::vector<AccType>::iterator out);
+
+  /// @brief number of antennas
+  IndexType itsNAnt;
+  
+  /// @brief number of delay lags
+  IndexType itsNLags;
+  
+  /// @brief delays (in samples) for all streams w.r.t. the least delayed one
+  std::vector<IndexType> itsDelays;
+  
+  /// @brief accumulators for all products and lags (lag index varies fastest)
+  std::vector<AccType> itsAccumulator;
+  
+  /// @brief number of accumulated samples
+  IndexType itsSamples;
+  
+#ifdef SUBTRACT_DC
+  /// @brief sum of samples for every antenna
+  std::vector<AccType> itsAntSums;
+#endif
+
+  /// @brief real part of the current block for all antennas
+  std::vector<float> itsBlockRe;
+
+  /// @brief imaginary part of the current block for all antennas
+  std::vector<float> itsBlockIm;
+  
+  /// @brief real part of the partial sums (VectorWidth lanes for every lag)
+  std::vector<float> itsLanesRe;
+
+  /// @brief imaginary part of the partial sums (VectorWidth lanes for every lag)
+  std::vector<float> itsLanesIm;
+};
+
 } // namespace swcorrelator
 
 } // namespace askap
@@ -230,6 +230,173 @@ void Simple3BaselineCorrelator<AccType, IndexType>::accumulate(const Iter stream
 #endif
 }            
 
+/// @brief constructor
+/// @details All delays are initialised with zeros
+/// @param[in] nAnt number of antennas (streams)
+/// @param[in] nLags number of delay lags
+template<typename AccType, typename IndexType>         
+MultiAntennaCorrelator<AccType, IndexType>::MultiAntennaCorrelator(const IndexType nAnt, const IndexType nLags) : 
+         itsNAnt(nAnt), itsNLags(nLags), itsDelays(nAnt, IndexType(0)), 
+         itsAccumulator(nAnt * (nAnt + 1) / 2 * nLags, AccType(0)), itsSamples(0),
+#ifdef SUBTRACT_DC
+         itsAntSums(nAnt, AccType(0)),
+#endif
+         itsBlockRe(nAnt * (BlockSize + nLags - 1), 0.f), itsBlockIm(nAnt * (BlockSize + nLags - 1), 0.f),
+         itsLanesRe(nLags * VectorWidth, 0.f), itsLanesIm(nLags * VectorWidth, 0.f)
+{
+  if ((nAnt < 1) || (nLags < 1)) {
+      throw std::invalid_argument("MultiAntennaCorrelator requires at least one antenna and one delay lag");
+  }
+}
+
+/// @brief reset accumulator, adjust delays
+/// @details 
+/// @param[in] delays delays (in samples) for all streams, one element per antenna
+/// @note the buffers are treated as parts of the continuous
+/// stream. Incomplete buffers are ignored for simplicity.
+template<typename AccType, typename IndexType>         
+void MultiAntennaCorrelator<AccType, IndexType>::reset(const std::vector<IndexType> &delays)
+{
+  if (delays.size() != itsDelays.size()) {
+      throw std::invalid_argument("MultiAntennaCorrelator::reset - number of delays should match the number of antennas");
+  }
+  const IndexType minDelay = *std::min_element(delays.begin(), delays.end());
+  for (size_t ant = 0; ant < delays.size(); ++ant) {
+       itsDelays[ant] = delays[ant] - minDelay;
+  }
+  reset();
+}
+
+/// @brief just reset accumulator
+/// @details This method can be used to move to the next integration cycle
+template<typename AccType, typename IndexType>         
+void MultiAntennaCorrelator<AccType, IndexType>::reset()
+{
+  std::fill(itsAccumulator.begin(), itsAccumulator.end(), AccType(0));
+  itsSamples = IndexType(0);
+#ifdef SUBTRACT_DC
+  std::fill(itsAntSums.begin(), itsAntSums.end(), AccType(0));
+#endif
+}
+
+/// @brief obtain accumulated product
+/// @details If SUBTRACT_DC is defined, the contribution of the mean is subtracted.
+/// The sums are accumulated for zero lag, so this correction is approximate for other lags.
+/// @param[in] ant1 index of the first antenna
+/// @param[in] ant2 index of the second antenna, should not be less than ant1
+/// @param[in] lag delay lag
+/// @return accumulated product (not normalised by the number of samples)
+template<typename AccType, typename IndexType>         
+AccType MultiAntennaCorrelator<AccType, IndexType>::getVis(const IndexType ant1, const IndexType ant2, 
+                                                           const IndexType lag) const
+{
+  const AccType vis = itsAccumulator[product(ant1, ant2) * itsNLags + lag];
+#ifdef SUBTRACT_DC
+  return vis - itsAntSums[ant1] * conj(itsAntSums[ant2]) / float(itsSamples != 0 ? itsSamples : 1);
+#else
+  return vis;
+#endif
+}
+
+/// @brief accumulate buffers
+/// @details 
+/// The parameter of the template is as follows.
+///    Iter - type of the read-only random-access iterator to read the data buffer
+///           (it could be just an ordinary pointer)
+/// @param[in] streams start iterators of all streams, one element per antenna
+/// @param[in] size number of samples
+template<typename AccType, typename IndexType>         
+template<typename Iter>
+void MultiAntennaCorrelator<AccType, IndexType>::accumulate(const std::vector<Iter> &streams, const IndexType size)
+{
+  if (streams.size() != itsDelays.size()) {
+      throw std::invalid_argument("MultiAntennaCorrelator::accumulate - number of streams should match the number of antennas");
+  }
+  const IndexType largestDelay = *std::max_element(itsDelays.begin(), itsDelays.end());
+  // all lags are computed for the same samples of the first stream
+  const IndexType usable = size - largestDelay - (itsNLags - 1);
+  const IndexType stride = BlockSize + itsNLags - 1;
+  for (IndexType start = 0; start < usable; start += BlockSize) {
+       const IndexType nSamples = std::min(IndexType(BlockSize), usable - start);
+       const IndexType span = nSamples + itsNLags - 1;
+       // unpack the current block for all antennas
+       for (IndexType ant = 0; ant < itsNAnt; ++ant) {
+            Iter it = streams[ant] + (itsDelays[ant] + start);
+            float *re = &itsBlockRe[ant * stride];
+            float *im = &itsBlockIm[ant * stride];
+            for (IndexType t = 0; t < span; ++t, ++it) {
+                 const std::complex<float> sample(*it);
+                 re[t] = real(sample);
+                 im[t] = imag(sample);
+            }
+#ifdef SUBTRACT_DC
+            float sumRe = 0.f, sumIm = 0.f;
+            for (IndexType t = 0; t < nSamples; ++t) {
+                 sumRe += re[t];
+                 sumIm += im[t];
+            }
+            itsAntSums[ant] += AccType(sumRe, sumIm);
+#endif
+       }
+       // accumulate all products while the block is in cache
+       typename std::vector<AccType>::iterator out = itsAccumulator.begin();
+       for (IndexType ant2 = 0; ant2 < itsNAnt; ++ant2) {
+            const float *re2 = &itsBlockRe[ant2 * stride];
+            const float *im2 = &itsBlockIm[ant2 * stride];
+            for (IndexType ant1 = 0; ant1 <= ant2; ++ant1, out += itsNLags) {
+                 correlateBlock(&itsBlockRe[ant1 * stride], &itsBlockIm[ant1 * stride], re2, im2, nSamples, out);
+            }
+       }
+  }
+  if (usable > 0) {
+      itsSamples += usable;
+  }
+}
+
+/// @brief correlate unpacked blocks of two antennas for all lags
+/// @param[in] re1 real part of the first stream
+/// @param[in] im1 imaginary part of the first stream
+/// @param[in] re2 real part of the second stream (at least nSamples + nLags - 1 elements)
+/// @param[in] im2 imaginary part of the second stream (at least nSamples + nLags - 1 elements)
+/// @param[in] nSamples number of samples to correlate
+/// @param[in] out iterator to the accumulators of this product, one element per lag
+template<typename AccType, typename IndexType>         
+void MultiAntennaCorrelator<AccType, IndexType>::correlateBlock(const float *re1, const float *im1, 
+          const float *re2, const float *im2, const IndexType nSamples, typename std::vector<AccType>::iterator out)
+{
+  std::fill(itsLanesRe.begin(), itsLanesRe.end(), 0.f);
+  std::fill(itsLanesIm.begin(), itsLanesIm.end(), 0.f);
+  IndexType t = 0;
+  for (; t + VectorWidth <= nSamples; t += VectorWidth) {
+       const float *r1 = re1 + t;
+       const float *i1 = im1 + t;
+       for (IndexType lag = 0; lag < itsNLags; ++lag) {
+            const float *r2 = re2 + t + lag;
+            const float *i2 = im2 + t + lag;
+            float *lanesRe = &itsLanesRe[lag * VectorWidth];
+            float *lanesIm = &itsLanesIm[lag * VectorWidth];
+            // s1 * conj(s2), lanes are independent
+            for (int k = 0; k < VectorWidth; ++k) {
+                 lanesRe[k] += r1[k] * r2[k] + i1[k] * i2[k];
+                 lanesIm[k] += i1[k] * r2[k] - r1[k] * i2[k];
+            }
+       }
+  }
+  for (IndexType lag = 0; lag < itsNLags; ++lag, ++out) {
+       float sumRe = 0.f, sumIm = 0.f;
+       for (int k = 0; k < VectorWidth; ++k) {
+            sumRe += itsLanesRe[lag * VectorWidth + k];
+            sumIm += itsLanesIm[lag * VectorWidth + k];
+       }
+       // remaining samples which do not fill all lanes
+       for (IndexType tail = t; tail < nSamples; ++tail) {
+            sumRe += re1[tail] * re2[tail + lag] + im1[tail] * im2[tail + lag];
+            sumIm += im1[tail] * re2[tail + lag] - re1[tail] * im2[tail + lag];
+       }
+       *out += AccType(sumRe, sumIm);
+  }
+}
+
 } // namespace swcorrelator
 
 } // namespace askap
@@ -0,0 +1,145 @@
+/// @file
+///
+/// @brief Test of the multi-antenna correlator against the 3-baseline one
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SWCORRELATOR_SIMPLE_CORRELATOR_TEST_H
+#define ASKAP_SWCORRELATOR_SIMPLE_CORRELATOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+// Class under test
+#include <swcorrelator/SimpleCorrelator.h>
+
+#include <vector>
+#include <complex>
+
+namespace askap {
+
+namespace swcorrelator {
+
+class SimpleCorrelatorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SimpleCorrelatorTest);
+  CPPUNIT_TEST(testThreeAntennas);
+  CPPUNIT_TEST(testLags);
+  CPPUNIT_TEST_SUITE_END();
+public:
+
+  void setUp() {
+     // integer values are represented exactly, so all sums are exact
+     // unless the mean is subtracted
+     itsStreams.resize(4);
+     for (size_t ant = 0; ant < itsStreams.size(); ++ant) {
+          itsStreams[ant].resize(itsSize);
+          for (int i = 0; i < itsSize; ++i) {
+               itsStreams[ant][i] = std::complex<float>(float((i * (ant + 3) + 7 * ant) % 17) - 8.,
+                                                        float((i * (2 * ant + 5) + ant) % 13) - 6.);
+          }
+     }
+  }
+
+  void testThreeAntennas() {
+     Simple3BaselineCorrelator<std::complex<float>, int> s3bc(0, 3, -2);
+     s3bc.accumulate(&itsStreams[0][0], &itsStreams[1][0], &itsStreams[2][0], itsSize);
+
+     MultiAntennaCorrelator<std::complex<float>, int> corr(3);
+     std::vector<int> delays(3, 0);
+     delays[1] = 3;
+     delays[2] = -2;
+     corr.reset(delays);
+     corr.accumulate(streams(3), itsSize);
+
+     CPPUNIT_ASSERT_EQUAL(s3bc.nSamples12(), corr.nSamples());
+     compare(s3bc.getVis12(), corr.getVis(0, 1));
+     compare(s3bc.getVis23(), corr.getVis(1, 2));
+     compare(s3bc.getVis13(), corr.getVis(0, 2));
+     // autocorrelations should be real
+     for (int ant = 0; ant < 3; ++ant) {
+          CPPUNIT_ASSERT(real(corr.getVis(ant, ant)) > 0.);
+          CPPUNIT_ASSERT_DOUBLES_EQUAL(0., imag(corr.getVis(ant, ant)), 1e-3);
+     }
+  }
+
+  void testLags() {
+     const int nLags = 5;
+     MultiAntennaCorrelator<std::complex<float>, int> corr(4, nLags);
+     std::vector<int> delays(4, 0);
+     delays[0] = 2;
+     delays[3] = 1;
+     corr.reset(delays);
+     corr.accumulate(streams(4), itsSize);
+
+     const int nSamples = itsSize - 2 - (nLags - 1);
+     CPPUNIT_ASSERT_EQUAL(nSamples, corr.nSamples());
+     for (int ant2 = 0; ant2 < 4; ++ant2) {
+          for (int ant1 = 0; ant1 <= ant2; ++ant1) {
+               for (int lag = 0; lag < nLags; ++lag) {
+                    std::complex<double> vis(0.), sum1(0.), sum2(0.);
+                    for (int t = 0; t < nSamples; ++t) {
+                         const std::complex<double> s1 = itsStreams[ant1][t + delays[ant1]];
+                         vis += s1 * conj(std::complex<double>(itsStreams[ant2][t + delays[ant2] + lag]));
+                         sum1 += s1;
+                         sum2 += std::complex<double>(itsStreams[ant2][t + delays[ant2]]);
+                    }
+#ifdef SUBTRACT_DC
+                    vis -= sum1 * conj(sum2) / double(nSamples);
+#endif
+                    compare(std::complex<float>(vis), corr.getVis(ant1, ant2, lag));
+               }
+          }
+     }
+  }
+
+protected:
+  /// @brief start pointers of the given number of streams
+  std::vector<const std::complex<float>*> streams(const size_t nAnt) const {
+     std::vector<const std::complex<float>*> result(nAnt);
+     for (size_t ant = 0; ant < nAnt; ++ant) {
+          result[ant] = &itsStreams[ant][0];
+     }
+     return result;
+  }
+
+  /// @brief compare two complex numbers with a relative tolerance
+  static void compare(const std::complex<float> &expected, const std::complex<float> &obtained) {
+     const double tolerance = 1e-5 * (abs(expected) + 1.);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(real(expected), real(obtained), tolerance);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(imag(expected), imag(obtained), tolerance);
+  }
+
+private:
+  /// @brief number of samples (not a multiple of the block size to test incomplete blocks)
+  static const int itsSize = 1000;
+
+  /// @brief test streams
+  std::vector<std::vector<std::complex<float> > > itsStreams;
+};
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SWCORRELATOR_SIMPLE_CORRELATOR_TEST_H
+
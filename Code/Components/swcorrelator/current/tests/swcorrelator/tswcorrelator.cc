@@ -28,6 +28,7 @@
 #include <askap_swcorrelator.h>
 #include <FillerMSSinkTest.h>
 #include <CorrProductsTest.h>
+#include <SimpleCorrelatorTest.h>
 
 
 int main(int argc, char *argv[])
@@ -36,6 +37,7 @@ int main(int argc, char *argv[])
 
     runner.addTest(askap::swcorrelator::FillerMSSinkTest::suite());
     runner.addTest(askap::swcorrelator::CorrProductsTest::suite());
+    runner.addTest(askap::swcorrelator::SimpleCorrelatorTest::suite());
 
     bool wasSucessful = runner.run();
 